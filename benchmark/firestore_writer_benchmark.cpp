@@ -0,0 +1,133 @@
+// Micro-benchmark for the scan value writers.
+//
+// Builds a synthetic runQuery page, decodes it once, then fills DuckDB chunks from the decoded
+// documents twice: through SetDuckDBValue for every cell (the generic path) and through the
+// per-column writers from GetFirestoreColumnWriter (the path FirestoreScanFunction uses).
+//
+// Build with -DFIRE_DUCK_EXT_BUILD_BENCHMARKS=ON, then run:
+//   firestore_writer_benchmark [documents] [iterations]
+
+#include "firestore_json_decoder.hpp"
+#include "firestore_types.hpp"
+#include "duckdb/common/types/data_chunk.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace duckdb;
+
+static constexpr idx_t kVectorDimension = 8;
+
+static std::string BuildSyntheticPage(idx_t documents) {
+	json page = json::array();
+	for (idx_t i = 0; i < documents; i++) {
+		json embedding = json::array();
+		for (idx_t d = 0; d < kVectorDimension; d++) {
+			embedding.push_back({{"doubleValue", static_cast<double>(i + d) / 10.0}});
+		}
+		json fields = {
+		    {"name", {{"stringValue", "user_" + std::to_string(i)}}},
+		    {"age", {{"integerValue", std::to_string(20 + i % 60)}}},
+		    {"score", {{"doubleValue", static_cast<double>(i) * 1.5}}},
+		    {"active", {{"booleanValue", i % 2 == 0}}},
+		    {"created", {{"timestampValue", "2024-01-15T10:30:00.000000Z"}}},
+		    {"tags", {{"arrayValue", {{"values", json::array({{{"stringValue", "a"}}, {{"stringValue", "b"}}})}}}}}},
+		    {"location", {{"geoPointValue", {{"latitude", 37.7749}, {"longitude", -122.4194}}}}},
+		    {"embedding",
+		     {{"mapValue",
+		       {{"fields",
+		         {{"__type__", {{"stringValue", "__vector__"}}},
+		          {"value", {{"arrayValue", {{"values", embedding}}}}}}}}}}}}};
+		page.push_back({{"document",
+		                 {{"name", "projects/p/databases/(default)/documents/users/u" + std::to_string(i)},
+		                  {"fields", fields},
+		                  {"createTime", "2024-01-15T10:30:00.000000Z"},
+		                  {"updateTime", "2024-01-15T10:30:00.000000Z"}}}});
+	}
+	return page.dump();
+}
+
+struct BenchmarkColumns {
+	std::vector<std::string> names;
+	vector<LogicalType> types;
+};
+
+static BenchmarkColumns GetColumns() {
+	child_list_t<LogicalType> geo;
+	geo.push_back(make_pair("latitude", LogicalType::DOUBLE));
+	geo.push_back(make_pair("longitude", LogicalType::DOUBLE));
+
+	BenchmarkColumns columns;
+	columns.names = {"name", "age", "score", "active", "created", "tags", "location", "embedding"};
+	columns.types = {LogicalType::VARCHAR,
+	                 LogicalType::BIGINT,
+	                 LogicalType::DOUBLE,
+	                 LogicalType::BOOLEAN,
+	                 LogicalType::TIMESTAMP,
+	                 LogicalType::LIST(LogicalType::VARCHAR),
+	                 LogicalType::STRUCT(geo),
+	                 LogicalType::ARRAY(LogicalType::DOUBLE, kVectorDimension)};
+	return columns;
+}
+
+// Fill chunks from every document and return rows per second
+template <class WRITE_CELL>
+static double RunPass(const std::vector<FirestoreDocument> &documents, const BenchmarkColumns &columns,
+                      idx_t iterations, WRITE_CELL &&write_cell) {
+	DataChunk chunk;
+	chunk.Initialize(Allocator::DefaultAllocator(), columns.types);
+
+	auto start = std::chrono::steady_clock::now();
+	for (idx_t iter = 0; iter < iterations; iter++) {
+		idx_t row = 0;
+		for (auto &doc : documents) {
+			if (row == STANDARD_VECTOR_SIZE) {
+				chunk.SetCardinality(row);
+				chunk.Reset();
+				row = 0;
+			}
+			for (idx_t col = 0; col < columns.names.size(); col++) {
+				auto field = doc.fields.find(columns.names[col]);
+				if (field != doc.fields.end()) {
+					write_cell(chunk.data[col], row, *field, col);
+				}
+			}
+			row++;
+		}
+		chunk.SetCardinality(row);
+		chunk.Reset();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(documents.size() * iterations) / elapsed.count();
+}
+
+int main(int argc, char **argv) {
+	idx_t documents = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+	idx_t iterations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+
+	auto columns = GetColumns();
+	auto page = DecodeDocumentPage(BuildSyntheticPage(documents));
+
+	std::vector<FirestoreColumnWriter> writers;
+	for (auto &type : columns.types) {
+		writers.push_back(GetFirestoreColumnWriter(type));
+	}
+
+	double generic = RunPass(page.documents, columns, iterations,
+	                         [&](Vector &vector, idx_t row, const json &value, idx_t col) {
+		                         SetDuckDBValue(vector, row, value, columns.types[col]);
+	                         });
+	double specialized = RunPass(page.documents, columns, iterations,
+	                             [&](Vector &vector, idx_t row, const json &value, idx_t col) {
+		                             writers[col](vector, row, value);
+	                             });
+
+	std::printf("documents=%llu iterations=%llu columns=%llu\n", static_cast<unsigned long long>(documents),
+	            static_cast<unsigned long long>(iterations), static_cast<unsigned long long>(columns.names.size()));
+	std::printf("SetDuckDBValue:        %12.0f rows/sec\n", generic);
+	std::printf("column writers:        %12.0f rows/sec\n", specialized);
+	std::printf("speedup:               %12.2fx\n", specialized / generic);
+	return 0;
+}
@@ -0,0 +1,158 @@
+#!/bin/bash
+# Emulator benchmark suite for fire_duck_ext.
+#
+# Seeds the emulator with synthetic collections (test/scripts/seed_benchmark_data.sh), runs the
+# standard scan and write workloads BENCH_ITERATIONS times each, and writes the results to
+# BENCH_OUTPUT as JSON: per iteration the rows/sec, Firestore requests, bytes and latency
+# percentiles reported by firestore_stats(), plus the median rows/sec per workload.
+#
+# Run under the emulator (or `make emulator_benchmark`):
+#   firebase emulators:exec --only firestore --project test-project \
+#       "./benchmark/run_emulator_benchmark.sh"
+#
+# Settings (environment variables):
+#   BENCH_DOCS, BENCH_WIDTH, BENCH_DEPTH, BENCH_VECTOR_DIM, BENCH_GROUP_DOCS
+#                       Shape of the seeded collections (see seed_benchmark_data.sh)
+#   BENCH_WRITES        Documents inserted, updated and deleted by the write workloads (2000)
+#   BENCH_ITERATIONS    Runs of each workload (3). The first scan of a collection also infers
+#                       its schema; later runs use the schema cache.
+#   BENCH_OUTPUT        Result file (emulator_benchmark.json)
+#   BENCH_SKIP_SEED     Set to 1 to reuse collections seeded by an earlier run
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+
+if [ -z "$FIRESTORE_EMULATOR_HOST" ]; then
+    echo "Error: FIRESTORE_EMULATOR_HOST is not set. Run this script under firebase emulators:exec."
+    exit 1
+fi
+
+if [ -x "./build/release/duckdb" ]; then
+    DUCKDB="./build/release/duckdb"
+elif command -v duckdb &> /dev/null; then
+    DUCKDB="duckdb"
+else
+    echo "Error: duckdb not found. Install DuckDB or build from source."
+    exit 1
+fi
+
+EXT_PATH="build/release/extension/fire_duck_ext/fire_duck_ext.duckdb_extension"
+
+export BENCH_DOCS="${BENCH_DOCS:-20000}"
+export BENCH_WIDTH="${BENCH_WIDTH:-10}"
+export BENCH_DEPTH="${BENCH_DEPTH:-2}"
+export BENCH_VECTOR_DIM="${BENCH_VECTOR_DIM:-16}"
+export BENCH_GROUP_DOCS="${BENCH_GROUP_DOCS:-$((BENCH_DOCS / 4))}"
+BENCH_WRITES="${BENCH_WRITES:-2000}"
+BENCH_ITERATIONS="${BENCH_ITERATIONS:-3}"
+BENCH_OUTPUT="${BENCH_OUTPUT:-emulator_benchmark.json}"
+
+if [ "${BENCH_SKIP_SEED:-0}" != "1" ]; then
+    "$SCRIPT_DIR/../test/scripts/seed_benchmark_data.sh"
+fi
+
+# Workloads in run order, as parallel arrays of names, setup SQL and measured SQL. Scans count
+# their rows into bench_rows; the writes come last so that update_batch and delete_batch find
+# the inserted documents.
+WRITE_IDS="SET VARIABLE bench_ids = (SELECT list('w' || i) FROM range(${BENCH_WRITES}) t(i));"
+WORKLOAD_NAMES=()
+WORKLOAD_SETUP=()
+WORKLOAD_SQL=()
+add_workload() {
+    WORKLOAD_NAMES+=("$1")
+    WORKLOAD_SETUP+=("$2")
+    WORKLOAD_SQL+=("$3")
+}
+add_workload full_scan "" \
+    "SET VARIABLE bench_rows = (SELECT count(*) FROM (SELECT hash(t) FROM firestore_scan('bench_docs') t));"
+add_workload projected_scan "" \
+    "SET VARIABLE bench_rows = (SELECT count(*) FROM (SELECT hash(name, score) FROM firestore_scan('bench_docs')));"
+add_workload pushed_filter_scan "" \
+    "SET VARIABLE bench_rows = (SELECT count(*) FROM (SELECT hash(t) FROM firestore_scan('bench_docs') t WHERE category = 'c3'));"
+add_workload collection_group_scan "" \
+    "SET VARIABLE bench_rows = (SELECT count(*) FROM (SELECT hash(t) FROM firestore_scan('~bench_items') t));"
+add_workload order_by_limit "" \
+    "SET VARIABLE bench_rows = (SELECT count(*) FROM (SELECT name, value FROM firestore_scan('bench_docs') ORDER BY value DESC LIMIT 100));"
+add_workload insert "" \
+    "CALL firestore_insert('bench_writes', (SELECT 'w' || i AS id, i AS value, 'new' AS status FROM range(${BENCH_WRITES}) t(i)), document_id := 'id'); SET VARIABLE bench_rows = ${BENCH_WRITES};"
+add_workload update_batch "$WRITE_IDS" \
+    "CALL firestore_update_batch('bench_writes', getvariable('bench_ids'), 'status', 'updated'); SET VARIABLE bench_rows = ${BENCH_WRITES};"
+add_workload delete_batch "$WRITE_IDS" \
+    "CALL firestore_delete_batch('bench_writes', getvariable('bench_ids')); SET VARIABLE bench_rows = ${BENCH_WRITES};"
+
+# Run one workload and print: microseconds,rows,requests,request_bytes,response_bytes,
+# documents_read,documents_written,pages,retries,p50_ms,p95_ms,p99_ms,json_parse_ms,conversion_ms
+run_workload() {
+    local setup="$1"
+    local measured="$2"
+    # now() is the start of the current statement's transaction, so the difference between the
+    # two timestamps covers the measured statements. The newest tracked query is the last one
+    # that talked to Firestore.
+    $DUCKDB -unsigned -csv -noheader 2>&1 <<SQL | tail -1
+LOAD '${EXT_PATH}';
+CREATE SECRET __bench (TYPE firestore, PROJECT_ID 'test-project', API_KEY 'fake-key');
+SET firestore_aggregate_pushdown = false;
+${setup}
+SET VARIABLE bench_t0 = epoch_us(now());
+${measured}
+SELECT epoch_us(now()) - getvariable('bench_t0'), getvariable('bench_rows'), requests, request_bytes,
+       response_bytes, documents_read, documents_written, pages, retries, round(latency_p50_ms, 3),
+       round(latency_p95_ms, 3), round(latency_p99_ms, 3), round(json_parse_ms, 3), round(conversion_ms, 3)
+FROM firestore_stats() WHERE scope = 'query' LIMIT 1;
+SQL
+}
+
+# Median of the numbers on stdin
+median() {
+    sort -g | awk '{ v[NR] = $1 } END { if (NR == 0) print 0; else if (NR % 2) print v[(NR + 1) / 2]; else print (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+declare -A ITERATIONS_JSON
+declare -A RATES
+
+for ((iteration = 1; iteration <= BENCH_ITERATIONS; iteration++)); do
+    for i in "${!WORKLOAD_NAMES[@]}"; do
+        name="${WORKLOAD_NAMES[$i]}"
+        result=$(run_workload "${WORKLOAD_SETUP[$i]}" "${WORKLOAD_SQL[$i]}")
+        if ! [[ "$result" =~ ^[0-9]+,[0-9]+, ]]; then
+            echo "FAIL: workload $name (iteration $iteration): $result"
+            exit 1
+        fi
+        IFS=',' read -r us rows requests request_bytes response_bytes documents_read documents_written pages \
+            retries p50 p95 p99 json_parse conversion <<< "$result"
+        rate=$(awk -v rows="$rows" -v us="$us" 'BEGIN { printf "%.1f", (us > 0 ? rows * 1e6 / us : 0) }')
+        seconds=$(awk -v us="$us" 'BEGIN { printf "%.6f", us / 1e6 }')
+        echo "$name #$iteration: $rows rows in ${seconds}s ($rate rows/sec), $requests requests, p99 ${p99} ms"
+
+        entry="{\"iteration\": $iteration, \"rows\": $rows, \"seconds\": $seconds, \"rows_per_sec\": $rate"
+        entry+=", \"requests\": $requests, \"request_bytes\": $request_bytes, \"response_bytes\": $response_bytes"
+        entry+=", \"documents_read\": $documents_read, \"documents_written\": $documents_written, \"pages\": $pages"
+        entry+=", \"retries\": $retries, \"latency_p50_ms\": $p50, \"latency_p95_ms\": $p95, \"latency_p99_ms\": $p99"
+        entry+=", \"json_parse_ms\": $json_parse, \"conversion_ms\": $conversion}"
+        ITERATIONS_JSON[$name]+="${ITERATIONS_JSON[$name]:+, }$entry"
+        RATES[$name]+="$rate"$'\n'
+    done
+done
+
+{
+    echo "{"
+    echo "  \"timestamp\": \"$(date -u +%Y-%m-%dT%H:%M:%SZ)\","
+    echo "  \"revision\": \"$(git -C "$SCRIPT_DIR" describe --always --dirty 2> /dev/null || echo unknown)\","
+    echo "  \"duckdb\": \"$($DUCKDB -csv -noheader -c 'SELECT version();' | tail -1)\","
+    echo "  \"config\": {\"documents\": $BENCH_DOCS, \"width\": $BENCH_WIDTH, \"depth\": $BENCH_DEPTH," \
+        "\"vector_dim\": $BENCH_VECTOR_DIM, \"group_documents\": $BENCH_GROUP_DOCS," \
+        "\"writes\": $BENCH_WRITES, \"iterations\": $BENCH_ITERATIONS},"
+    echo "  \"workloads\": ["
+    separator=""
+    for name in "${WORKLOAD_NAMES[@]}"; do
+        printf '%s    {"name": "%s", "median_rows_per_sec": %s, "iterations": [%s]}' "$separator" "$name" \
+            "$(printf '%s' "${RATES[$name]}" | median)" "${ITERATIONS_JSON[$name]}"
+        separator=$',\n'
+    done
+    echo ""
+    echo "  ]"
+    echo "}"
+} > "$BENCH_OUTPUT"
+
+echo "Results written to $BENCH_OUTPUT"
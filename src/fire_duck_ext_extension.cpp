@@ -7,6 +7,13 @@
 #include "firestore_settings.hpp"
 #include "firestore_logger.hpp"
 #include "firestore_optimizer.hpp"
+#include "firestore_connection_pool.hpp"
+#include "firestore_rate_limiter.hpp"
+#include "firestore_retry.hpp"
+#include "firestore_sync.hpp"
+#include "firestore_listen.hpp"
+#include "firestore_collection_tree.hpp"
+#include "firestore_stats.hpp"
 #include "duckdb.hpp"
 #include "duckdb/main/extension/extension_loader.hpp"
 #include "duckdb/main/config.hpp"
@@ -21,6 +28,13 @@ static void InitializeLogging() {
 	if (log_level) {
 		FirestoreLogger::Instance().SetLogLevel(ParseLogLevel(log_level));
 	}
+	const char *log_file = std::getenv("FIRESTORE_LOG_FILE");
+	if (log_file && *log_file) {
+		auto file_sink = std::make_shared<FileLogSink>(log_file);
+		if (file_sink->IsOpen()) {
+			FirestoreLogger::Instance().SetSink(std::make_shared<AsyncLogSink>(file_sink));
+		}
+	}
 }
 
 // Global state for one-shot functions (connect, disconnect, clear_cache)
@@ -48,7 +62,7 @@ static void FirestoreClearCacheFunction(ClientContext &context, TableFunctionInp
 	}
 
 	auto &bind_data = data.bind_data->Cast<FirestoreClearCacheBindData>();
-	ClearFirestoreSchemaCache(bind_data.collection);
+	ClearFirestoreSchemaCache(bind_data.collection, FirestoreSettings::SchemaCacheDir(context));
 	FlatVector::GetData<bool>(output.data[0])[0] = true;
 	output.SetCardinality(1);
 	state.finished = true;
@@ -148,6 +162,90 @@ static void FirestoreDisconnectFunction(ClientContext &context, TableFunctionInp
 	state.finished = true;
 }
 
+// ============================================================================
+// firestore_http_pool_stats function
+// ============================================================================
+
+static unique_ptr<FunctionData> FirestoreHttpPoolStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                           vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"hits", "misses", "evictions", "idle_connections"};
+	return_types = {LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::UBIGINT};
+	return make_uniq<TableFunctionData>();
+}
+
+static void FirestoreHttpPoolStatsFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<FirestoreOneShotState>();
+	if (state.finished) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	auto stats = FirestoreConnectionPool::Instance().GetStats();
+	FlatVector::GetData<uint64_t>(output.data[0])[0] = stats.hits;
+	FlatVector::GetData<uint64_t>(output.data[1])[0] = stats.misses;
+	FlatVector::GetData<uint64_t>(output.data[2])[0] = stats.evictions;
+	FlatVector::GetData<uint64_t>(output.data[3])[0] = stats.idle;
+	output.SetCardinality(1);
+	state.finished = true;
+}
+
+// firestore_write_rate_stats function
+// Returns one row per database written to: the ramp-up ceiling and the rate currently granted
+
+static unique_ptr<FunctionData> FirestoreWriteRateStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                            vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"database", "ramp_ceiling_ops", "current_ops", "granted_ops", "throttled", "waited_seconds"};
+	return_types = {LogicalType::VARCHAR, LogicalType::DOUBLE,  LogicalType::DOUBLE,
+	                LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::DOUBLE};
+	return make_uniq<TableFunctionData>();
+}
+
+static void FirestoreWriteRateStatsFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<FirestoreOneShotState>();
+	if (state.finished) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	auto stats = FirestoreRateLimiter::Instance().GetStats();
+	idx_t count = MinValue<idx_t>(stats.size(), STANDARD_VECTOR_SIZE);
+	for (idx_t i = 0; i < count; i++) {
+		output.SetValue(0, i, Value(stats[i].database));
+		output.SetValue(1, i, Value::DOUBLE(stats[i].ramp_ceiling));
+		output.SetValue(2, i, Value::DOUBLE(stats[i].current_rate));
+		output.SetValue(3, i, Value::UBIGINT(stats[i].granted_ops));
+		output.SetValue(4, i, Value::UBIGINT(stats[i].throttled));
+		output.SetValue(5, i, Value::DOUBLE(stats[i].waited_seconds));
+	}
+	output.SetCardinality(count);
+	state.finished = true;
+}
+
+// firestore_retry_stats function
+
+static unique_ptr<FunctionData> FirestoreRetryStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                        vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"retries", "recovered", "exhausted", "write_retries"};
+	return_types = {LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::UBIGINT, LogicalType::UBIGINT};
+	return make_uniq<TableFunctionData>();
+}
+
+static void FirestoreRetryStatsFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<FirestoreOneShotState>();
+	if (state.finished) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	auto stats = FirestoreRetry::GetStats();
+	FlatVector::GetData<uint64_t>(output.data[0])[0] = stats.retries;
+	FlatVector::GetData<uint64_t>(output.data[1])[0] = stats.recovered;
+	FlatVector::GetData<uint64_t>(output.data[2])[0] = stats.exhausted;
+	FlatVector::GetData<uint64_t>(output.data[3])[0] = stats.write_retries;
+	output.SetCardinality(1);
+	state.finished = true;
+}
+
 static void LoadInternal(ExtensionLoader &loader) {
 	// Initialize logging from environment variable
 	InitializeLogging();
@@ -157,6 +255,74 @@ static void LoadInternal(ExtensionLoader &loader) {
 	config.AddExtensionOption("firestore_schema_cache_ttl", "Schema cache TTL in seconds (0 to disable caching)",
 	                          LogicalType::BIGINT, Value::BIGINT(FirestoreSettings::kDefaultSchemaCacheTTLSeconds),
 	                          FirestoreSettings::SetSchemaCacheTTLSeconds);
+	config.AddExtensionOption("firestore_schema_cache_dir",
+	                          "Directory the schema and index cache is persisted to for fast cold starts (empty to "
+	                          "keep it in memory only)",
+	                          LogicalType::VARCHAR, Value(""));
+	config.AddExtensionOption("firestore_schema_cache_stale_while_revalidate",
+	                          "Keep serving an expired schema cache entry (for up to another TTL) while it is "
+	                          "re-inferred in the background",
+	                          LogicalType::BOOLEAN,
+	                          Value::BOOLEAN(FirestoreSettings::kDefaultSchemaCacheStaleWhileRevalidate));
+	config.AddExtensionOption("firestore_scan_partitions",
+	                          "Split large unordered scans into this many parallel partitionQuery ranges (0 to disable)",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreSettings::kDefaultScanPartitions),
+	                          FirestoreSettings::SetScanPartitions);
+	config.AddExtensionOption("firestore_scan_prefetch_pages",
+	                          "Result pages each scan stream fetches ahead in the background (0 to disable)",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreSettings::kDefaultScanPrefetchPages),
+	                          FirestoreSettings::SetScanPrefetchPages);
+	config.AddExtensionOption("firestore_aggregate_pushdown",
+	                          "Answer COUNT(*), SUM and AVG over firestore_scan with one runAggregationQuery when "
+	                          "all filters can be pushed",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(FirestoreSettings::kDefaultAggregatePushdown));
+	config.AddExtensionOption("firestore_vector_search_pushdown",
+	                          "Answer ORDER BY a vector distance LIMIT k over firestore_scan with one findNearest "
+	                          "query",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(FirestoreSettings::kDefaultVectorSearchPushdown));
+	config.AddExtensionOption("firestore_write_concurrency",
+	                          "BatchWrite requests firestore_insert keeps in flight at once (1 sends them one by one)",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreSettings::kDefaultWriteConcurrency),
+	                          FirestoreSettings::SetWriteConcurrency);
+	config.AddExtensionOption("firestore_discovery_concurrency",
+	                          "listCollectionIds and document listing requests a collection tree walk keeps in flight",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreSettings::kDefaultDiscoveryConcurrency),
+	                          FirestoreSettings::SetDiscoveryConcurrency);
+	config.AddExtensionOption("firestore_write_rate_limit",
+	                          "Pace document writes with Firestore's 500/50/5 ramp-up rule and back off when throttled",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(FirestoreSettings::kDefaultWriteRateLimit),
+	                          FirestoreSettings::SetWriteRateLimit);
+	config.AddExtensionOption("firestore_retry_max_attempts",
+	                          "Attempts per read or BatchWrite request on transient errors, including the first (1 "
+	                          "disables retries)",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreRetryPolicy::kDefaultMaxAttempts),
+	                          FirestoreSettings::SetRetryMaxAttempts);
+	config.AddExtensionOption("firestore_retry_base_delay_ms",
+	                          "Backoff before the first retry in milliseconds; doubles on every further retry",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreRetryPolicy::kDefaultBaseDelayMs),
+	                          FirestoreSettings::SetRetryBaseDelayMs);
+	config.AddExtensionOption("firestore_retry_deadline_ms",
+	                          "Stop retrying a request once this many milliseconds have passed (0 for no deadline)",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreRetryPolicy::kDefaultDeadlineMs),
+	                          FirestoreSettings::SetRetryDeadlineMs);
+	config.AddExtensionOption("firestore_http_pool_size",
+	                          "Maximum idle keep-alive HTTP connections kept per host (0 to disable pooling)",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreSettings::kDefaultHttpPoolSize),
+	                          FirestoreSettings::SetHttpPoolSize);
+	config.AddExtensionOption("firestore_http_idle_timeout",
+	                          "Seconds an idle pooled HTTP connection may be reused before it is closed",
+	                          LogicalType::BIGINT, Value::BIGINT(FirestoreSettings::kDefaultHttpIdleTimeoutSeconds),
+	                          FirestoreSettings::SetHttpIdleTimeoutSeconds);
+	config.AddExtensionOption("firestore_http_record",
+	                          "Append every Firestore request and response to this JSON Lines file ('' to stop)",
+	                          LogicalType::VARCHAR, Value(""), FirestoreSettings::SetHttpRecord);
+	config.AddExtensionOption("firestore_http_replay",
+	                          "Serve Firestore responses from a file written by firestore_http_record instead of the "
+	                          "network ('' to stop)",
+	                          LogicalType::VARCHAR, Value(""), FirestoreSettings::SetHttpReplay);
+	config.AddExtensionOption("firestore_http_replay_latency_ms",
+	                          "Delay added to every replayed response in milliseconds, to model round trips",
+	                          LogicalType::BIGINT, Value::BIGINT(0), FirestoreSettings::SetHttpReplayLatencyMs);
 
 	// Register the firestore secret type for credential management
 	RegisterFirestoreSecretType(loader);
@@ -168,6 +334,15 @@ static void LoadInternal(ExtensionLoader &loader) {
 	// Register write functions
 	RegisterFirestoreWriteFunctions(loader);
 
+	// Register delta sync: call firestore_sync('collection', 'target_table')
+	RegisterFirestoreSyncFunction(loader);
+
+	// Register change stream: select * from firestore_listen('collection')
+	RegisterFirestoreListenFunction(loader);
+
+	// Register discovery: select * from firestore_collection_tree('users')
+	RegisterFirestoreCollectionTreeFunction(loader);
+
 	// Register cache clear function: call firestore_clear_cache()
 	// Overload 1: No arguments - clears entire cache
 	TableFunction clear_cache_all("firestore_clear_cache", {}, FirestoreClearCacheFunction, FirestoreClearCacheBindAll,
@@ -189,6 +364,24 @@ static void LoadInternal(ExtensionLoader &loader) {
 	                              FirestoreOneShotInit);
 	loader.RegisterFunction(disconnect_func);
 
+	// Register firestore_http_pool_stats() - connection reuse counters
+	TableFunction pool_stats_func("firestore_http_pool_stats", {}, FirestoreHttpPoolStatsFunction,
+	                              FirestoreHttpPoolStatsBind, FirestoreOneShotInit);
+	loader.RegisterFunction(pool_stats_func);
+
+	// Register firestore_stats() - request, byte, document and latency counters
+	RegisterFirestoreStatsFunction(loader);
+
+	// Register firestore_retry_stats() - transient failure retry counters
+	TableFunction retry_stats_func("firestore_retry_stats", {}, FirestoreRetryStatsFunction, FirestoreRetryStatsBind,
+	                               FirestoreOneShotInit);
+	loader.RegisterFunction(retry_stats_func);
+
+	// Register firestore_write_rate_stats() - write rate limiter state per database
+	TableFunction write_rate_stats_func("firestore_write_rate_stats", {}, FirestoreWriteRateStatsFunction,
+	                                    FirestoreWriteRateStatsBind, FirestoreOneShotInit);
+	loader.RegisterFunction(write_rate_stats_func);
+
 	// Register optimizer extension for SQL ORDER BY / LIMIT pushdown to Firestore.
 	// This walks the logical plan tree to find ORDER BY / LIMIT nodes above firestore_scan
 	// and injects the info into bind data so Firestore can apply them server-side.
@@ -0,0 +1,430 @@
+#include "firestore_aggregate.hpp"
+#include "firestore_page_cursor.hpp"
+#include "firestore_path_utils.hpp"
+#include "firestore_scanner.hpp"
+#include "firestore_types.hpp"
+#include "firestore_logger.hpp"
+#include "duckdb/common/operator/add.hpp"
+#include "duckdb/planner/operator/logical_aggregate.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/expression/bound_aggregate_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include <map>
+
+namespace duckdb {
+
+// Firestore accepts at most this many aggregations in one runAggregationQuery
+static constexpr idx_t kMaxFirestoreAggregations = 5;
+
+// ============================================================================
+// Request building
+// ============================================================================
+
+// Alias of each Firestore aggregation the query sends, keyed by "count", "sum:<field>" or
+// "avg:<field>". SUM also asks for AVG of its field: Firestore sums no values to 0, while
+// DuckDB returns NULL, and an AVG of NULL tells the two apart.
+static std::map<std::string, std::string> GetAggregationAliases(const std::vector<FirestoreAggregation> &aggregations) {
+	std::map<std::string, std::string> aliases;
+	auto add = [&](const std::string &key) {
+		if (aliases.find(key) == aliases.end()) {
+			aliases[key] = "a" + std::to_string(aliases.size());
+		}
+	};
+	for (auto &agg : aggregations) {
+		switch (agg.kind) {
+		case FirestoreAggregation::Kind::COUNT:
+			add("count");
+			break;
+		case FirestoreAggregation::Kind::SUM:
+			add("sum:" + agg.field_path);
+			add("avg:" + agg.field_path);
+			break;
+		case FirestoreAggregation::Kind::AVG:
+			add("avg:" + agg.field_path);
+			break;
+		}
+	}
+	return aliases;
+}
+
+static json BuildAggregationsJson(const std::map<std::string, std::string> &aliases) {
+	json result = json::array();
+	for (auto &entry : aliases) {
+		auto &key = entry.first;
+		if (key == "count") {
+			result.push_back({{"alias", entry.second}, {"count", json::object()}});
+			continue;
+		}
+		auto separator = key.find(':');
+		auto op = key.substr(0, separator);
+		auto field = QuoteFirestoreFieldPath(key.substr(separator + 1));
+		result.push_back({{"alias", entry.second}, {op, {{"field", {{"fieldPath", field}}}}}});
+	}
+	return result;
+}
+
+static json BuildBaseQuery(const FirestoreAggregateBindData &bind_data) {
+	json sq;
+	sq["from"] = {{{"collectionId", GetFirestoreCollectionId(bind_data.collection)},
+	               {"allDescendants", bind_data.is_collection_group}}};
+	if (!bind_data.filters.empty()) {
+		sq["where"] = BuildWhereClause(bind_data.filters);
+	}
+	return sq;
+}
+
+// ============================================================================
+// Client-side fallback
+// ============================================================================
+
+// Computes the aggregations the way Firestore does (only integer and double values take part)
+// by reading the matching documents. Used when the server rejects the aggregation query,
+// e.g. because SUM/AVG with filters needs a composite index that does not exist.
+static json ComputeAggregationsLocally(FirestoreClient &client, const FirestoreAggregateBindData &bind_data,
+                                       const std::map<std::string, std::string> &aliases) {
+	auto field_mask = std::make_shared<FirestoreFieldSet>();
+	for (auto &agg : bind_data.aggregations) {
+		if (agg.kind != FirestoreAggregation::Kind::COUNT) {
+			field_mask->insert(agg.field_path);
+		}
+	}
+
+	FirestorePageCursor cursor;
+	cursor.mode = FirestorePageCursor::Mode::RUN_QUERY;
+	cursor.collection = bind_data.collection;
+	cursor.is_collection_group = bind_data.is_collection_group;
+	cursor.field_mask = field_mask;
+	cursor.structured_query = BuildBaseQuery(bind_data);
+	cursor.structured_query["orderBy"] = {{{"field", {{"fieldPath", "__name__"}}}, {"direction", "ASCENDING"}}};
+	cursor.structured_query["limit"] = cursor.page_size;
+
+	struct FieldTotals {
+		int64_t int_sum = 0;
+		double double_sum = 0;
+		bool is_double = false; // A double value or an integer overflow was seen
+		int64_t values = 0;
+	};
+	std::map<std::string, FieldTotals> totals;
+	for (auto &field : *field_mask) {
+		totals[field];
+	}
+	int64_t count = 0;
+
+	std::vector<FirestoreDocument> page;
+	while (cursor.NextPage(client, page)) {
+		for (auto &doc : page) {
+			count++;
+			for (auto &entry : totals) {
+				auto it = doc.fields.find(entry.first);
+				if (it == doc.fields.end()) {
+					continue;
+				}
+				auto &fv = *it;
+				auto &t = entry.second;
+				if (fv.contains("integerValue")) {
+					auto &raw = fv["integerValue"];
+					int64_t v = raw.is_string() ? std::stoll(raw.get<std::string>()) : raw.get<int64_t>();
+					t.double_sum += static_cast<double>(v);
+					if (!t.is_double && !TryAddOperator::Operation(t.int_sum, v, t.int_sum)) {
+						t.is_double = true;
+					}
+					t.values++;
+				} else if (fv.contains("doubleValue") && fv["doubleValue"].is_number()) {
+					t.double_sum += fv["doubleValue"].get<double>();
+					t.is_double = true;
+					t.values++;
+				}
+			}
+		}
+	}
+
+	json result = json::object();
+	for (auto &entry : aliases) {
+		auto &key = entry.first;
+		if (key == "count") {
+			result[entry.second] = {{"integerValue", std::to_string(count)}};
+			continue;
+		}
+		auto separator = key.find(':');
+		auto &t = totals[key.substr(separator + 1)];
+		if (key.compare(0, separator, "sum") == 0) {
+			if (t.is_double) {
+				result[entry.second] = {{"doubleValue", t.double_sum}};
+			} else {
+				result[entry.second] = {{"integerValue", std::to_string(t.int_sum)}};
+			}
+		} else if (t.values == 0) {
+			result[entry.second] = {{"nullValue", nullptr}};
+		} else {
+			result[entry.second] = {{"doubleValue", t.double_sum / static_cast<double>(t.values)}};
+		}
+	}
+	return result;
+}
+
+// ============================================================================
+// firestore_aggregate table function
+// ============================================================================
+
+struct FirestoreAggregateGlobalState : public GlobalTableFunctionState {
+	bool done = false;
+};
+
+static unique_ptr<GlobalTableFunctionState> FirestoreAggregateInit(ClientContext &context,
+                                                                   TableFunctionInitInput &input) {
+	return make_uniq<FirestoreAggregateGlobalState>();
+}
+
+static Value AggregateResultToDuckDB(const json &fv, const LogicalType &type) {
+	if (fv.is_null() || IsFirestoreNull(fv)) {
+		return Value(type);
+	}
+	if (fv.contains("integerValue")) {
+		auto &raw = fv["integerValue"];
+		int64_t v = raw.is_string() ? std::stoll(raw.get<std::string>()) : raw.get<int64_t>();
+		return Value::BIGINT(v).DefaultCastAs(type);
+	}
+	if (fv.contains("doubleValue") && fv["doubleValue"].is_number()) {
+		return Value::DOUBLE(fv["doubleValue"].get<double>()).DefaultCastAs(type);
+	}
+	FS_LOG_WARN("Unexpected aggregation result value: " + fv.dump());
+	return Value(type);
+}
+
+static void FirestoreAggregateScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<FirestoreAggregateBindData>();
+	auto &state = data.global_state->Cast<FirestoreAggregateGlobalState>();
+	if (state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	state.done = true;
+
+	FirestoreClient client(bind_data.credentials);
+	client.SetStats(GetFirestoreQueryStats(context));
+	auto aliases = GetAggregationAliases(bind_data.aggregations);
+
+	json fields;
+	try {
+		fields = client.RunAggregationQuery(bind_data.collection, BuildBaseQuery(bind_data),
+		                                    BuildAggregationsJson(aliases), bind_data.is_collection_group);
+	} catch (const FirestoreError &e) {
+		FS_LOG_WARN(std::string("runAggregationQuery failed, aggregating documents client-side: ") + e.what());
+		fields = ComputeAggregationsLocally(client, bind_data, aliases);
+	}
+
+	auto result_value = [&](const std::string &key) -> json {
+		auto it = fields.find(aliases[key]);
+		return it == fields.end() ? json() : *it;
+	};
+
+	for (idx_t i = 0; i < bind_data.aggregations.size(); i++) {
+		auto &agg = bind_data.aggregations[i];
+		Value value;
+		switch (agg.kind) {
+		case FirestoreAggregation::Kind::COUNT:
+			value = AggregateResultToDuckDB(result_value("count"), agg.result_type);
+			break;
+		case FirestoreAggregation::Kind::SUM:
+			if (AggregateResultToDuckDB(result_value("avg:" + agg.field_path), LogicalType::DOUBLE).IsNull()) {
+				value = Value(agg.result_type);
+			} else {
+				value = AggregateResultToDuckDB(result_value("sum:" + agg.field_path), agg.result_type);
+			}
+			break;
+		case FirestoreAggregation::Kind::AVG:
+			value = AggregateResultToDuckDB(result_value("avg:" + agg.field_path), agg.result_type);
+			break;
+		}
+		output.SetValue(i, 0, value);
+	}
+	output.SetCardinality(1);
+}
+
+static TableFunction GetFirestoreAggregateFunction() {
+	return TableFunction("firestore_aggregate", {}, FirestoreAggregateScan, nullptr, FirestoreAggregateInit);
+}
+
+// ============================================================================
+// Plan rewrite
+// ============================================================================
+
+static std::string FormatAggregation(const FirestoreAggregation &agg) {
+	switch (agg.kind) {
+	case FirestoreAggregation::Kind::COUNT:
+		return "count(*)";
+	case FirestoreAggregation::Kind::SUM:
+		return "sum(" + agg.field_path + ")";
+	case FirestoreAggregation::Kind::AVG:
+	default:
+		return "avg(" + agg.field_path + ")";
+	}
+}
+
+static bool TryPushDownAggregate(unique_ptr<LogicalOperator> &op) {
+	if (op->type != LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY || op->children.size() != 1) {
+		return false;
+	}
+	auto &aggr = op->Cast<LogicalAggregate>();
+	if (!aggr.groups.empty() || !aggr.grouping_functions.empty() || aggr.expressions.empty()) {
+		return false;
+	}
+
+	// AGGREGATE -> [FILTER] -> GET(firestore_scan)
+	LogicalOperator *child = op->children[0].get();
+	LogicalFilter *filter = nullptr;
+	if (child->type == LogicalOperatorType::LOGICAL_FILTER) {
+		filter = &child->Cast<LogicalFilter>();
+		if (child->children.size() != 1) {
+			return false;
+		}
+		child = child->children[0].get();
+	}
+	if (child->type != LogicalOperatorType::LOGICAL_GET) {
+		return false;
+	}
+	auto &get = child->Cast<LogicalGet>();
+	if (get.function.name != "firestore_scan" || !get.bind_data || !get.table_filters.filters.empty()) {
+		return false;
+	}
+	auto &scan = get.bind_data->Cast<FirestoreScanBindData>();
+	// scan_limit and document_ids cap the rows the aggregate sees; document paths are not
+	// document queries, and recursive scans are one query per collection
+	if (scan.limit.has_value() || scan.document_ids.has_value() || scan.is_document_path || scan.recursive ||
+	    IsFirestoreDocumentPathCollection(scan.collection)) {
+		return false;
+	}
+
+	std::vector<idx_t> column_id_map;
+	for (auto &cid : get.GetColumnIds()) {
+		column_id_map.push_back(cid.GetPrimaryIndex());
+	}
+
+	// Every conjunct must become exactly one Firestore filter, and all of them must be pushable:
+	// nothing re-checks the rows an aggregation query counted.
+	std::vector<FirestorePushdownFilter> filters;
+	if (filter) {
+		std::vector<const Expression *> conjuncts;
+		for (auto &expr : filter->expressions) {
+			CollectConjuncts(*expr, conjuncts);
+		}
+		for (auto *conjunct : conjuncts) {
+			auto converted =
+			    ConvertExpressionToFilters(*conjunct, get.table_index, get.names, get.returned_types, column_id_map);
+			if (converted.size() != 1) {
+				FS_LOG_DEBUG("Aggregate pushdown: WHERE clause has a filter Firestore cannot apply");
+				return false;
+			}
+			filters.push_back(std::move(converted[0]));
+		}
+		if (!scan.index_cache) {
+			return false;
+		}
+		auto matched = MatchFiltersToIndexes(filters, *scan.index_cache, scan.is_collection_group);
+		if (matched.pushed_filters.size() != filters.size()) {
+			FS_LOG_DEBUG("Aggregate pushdown: not every filter is supported by an index");
+			return false;
+		}
+		filters = std::move(matched.pushed_filters);
+		// One aggregation query cannot cover filters that the scan splits into sub-queries
+		if (std::any_of(filters.begin(), filters.end(), RequiresSplitting)) {
+			FS_LOG_DEBUG("Aggregate pushdown: WHERE clause needs several Firestore queries");
+			return false;
+		}
+	}
+
+	std::vector<FirestoreAggregation> aggregations;
+	bool has_count = false;
+	for (auto &expr : aggr.expressions) {
+		if (expr->expression_class != ExpressionClass::BOUND_AGGREGATE) {
+			return false;
+		}
+		auto &agg_expr = expr->Cast<BoundAggregateExpression>();
+		if (agg_expr.IsDistinct() || agg_expr.filter || agg_expr.order_bys) {
+			return false;
+		}
+
+		FirestoreAggregation agg;
+		agg.result_type = agg_expr.return_type;
+		auto &name = agg_expr.function.name;
+		if (name == "count_star" && agg_expr.children.empty()) {
+			agg.kind = FirestoreAggregation::Kind::COUNT;
+			has_count = true;
+		} else if ((name == "sum" || name == "avg" || name == "mean") && agg_expr.children.size() == 1) {
+			auto &arg = *agg_expr.children[0];
+			if (arg.expression_class != ExpressionClass::BOUND_COLUMN_REF) {
+				return false;
+			}
+			auto &colref = arg.Cast<BoundColumnRefExpression>();
+			if (colref.binding.table_index != get.table_index || colref.binding.column_index >= column_id_map.size()) {
+				return false;
+			}
+			auto col_idx = column_id_map[colref.binding.column_index];
+			// Column 0 is __document_id
+			if (col_idx == 0 || col_idx >= get.names.size()) {
+				return false;
+			}
+			auto type_id = get.returned_types[col_idx].id();
+			if (type_id != LogicalTypeId::BIGINT && type_id != LogicalTypeId::DOUBLE) {
+				return false;
+			}
+			agg.kind = name == "sum" ? FirestoreAggregation::Kind::SUM : FirestoreAggregation::Kind::AVG;
+			agg.field_path = get.names[col_idx];
+		} else {
+			return false;
+		}
+		aggregations.push_back(std::move(agg));
+	}
+
+	// An unfiltered collection scan with show_missing counts phantom documents, which queries never return
+	if (has_count && filters.empty() && !scan.is_collection_group && scan.show_missing) {
+		FS_LOG_DEBUG("Aggregate pushdown: count(*) would drop phantom documents (show_missing=true)");
+		return false;
+	}
+	if (GetAggregationAliases(aggregations).size() > kMaxFirestoreAggregations) {
+		return false;
+	}
+
+	auto bind_data = make_uniq<FirestoreAggregateBindData>();
+	bind_data->credentials = scan.credentials;
+	bind_data->collection = scan.collection;
+	bind_data->is_collection_group = scan.is_collection_group;
+	bind_data->filters = std::move(filters);
+	bind_data->aggregations = std::move(aggregations);
+
+	std::string info;
+	vector<LogicalType> types;
+	vector<string> names;
+	for (idx_t i = 0; i < aggr.expressions.size(); i++) {
+		types.push_back(bind_data->aggregations[i].result_type);
+		names.push_back(aggr.expressions[i]->GetName());
+		if (!info.empty()) {
+			info += ", ";
+		}
+		info += FormatAggregation(bind_data->aggregations[i]);
+	}
+	FS_LOG_DEBUG("Aggregate pushdown: " + info + " on " + scan.collection);
+
+	// The new scan takes over the aggregate's table index, so operators above keep their bindings
+	auto aggregate_index = aggr.aggregate_index;
+	auto new_get = make_uniq<LogicalGet>(aggregate_index, GetFirestoreAggregateFunction(), std::move(bind_data),
+	                                     std::move(types), std::move(names));
+	for (idx_t i = 0; i < new_get->names.size(); i++) {
+		new_get->AddColumnId(i);
+	}
+	new_get->extra_info.file_filters = "Firestore Aggregation: " + info;
+	op = std::move(new_get);
+	return true;
+}
+
+void PushDownFirestoreAggregates(ClientContext &context, unique_ptr<LogicalOperator> &plan) {
+	if (TryPushDownAggregate(plan)) {
+		return;
+	}
+	for (auto &child : plan->children) {
+		PushDownFirestoreAggregates(context, child);
+	}
+}
+
+} // namespace duckdb
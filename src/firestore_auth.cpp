@@ -1,9 +1,15 @@
 #include "firestore_auth.hpp"
 #include "firestore_error.hpp"
 #include "firestore_logger.hpp"
+#include "firestore_connection_pool.hpp"
 #include <fstream>
 #include <sstream>
 #include <ctime>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
 #define CPPHTTPLIB_OPENSSL_SUPPORT
 #include "httplib.h"
 #include <openssl/pem.h>
@@ -21,28 +27,26 @@ using json = nlohmann::json;
 // Token validity buffer (refresh 5 minutes before expiry)
 static const int TOKEN_REFRESH_BUFFER_SECONDS = 300;
 
+// A token this close to expiry is no longer handed out, so requests finish before it lapses
+static const int TOKEN_EXPIRY_MARGIN_SECONDS = 30;
+
+// Delay before retrying a failed background refresh while the current token is still usable
+static const int TOKEN_REFRESH_RETRY_SECONDS = 10;
+
+// Lifetime assumed when the token response has no expires_in
+static const int DEFAULT_TOKEN_LIFETIME_SECONDS = 3600;
+
 // Google OAuth2 token endpoint
 static const char *GOOGLE_TOKEN_URL = "https://oauth2.googleapis.com/token";
 
 // Firestore scope
 static const char *FIRESTORE_SCOPE = "https://www.googleapis.com/auth/datastore";
 
-bool FirestoreCredentials::IsTokenValid() const {
-	if (type == FirestoreAuthType::API_KEY) {
-		return true; // API keys don't expire
-	}
-	if (access_token.empty()) {
-		return false;
-	}
-	auto now = std::chrono::system_clock::now();
-	return now < (token_expiry - std::chrono::seconds(TOKEN_REFRESH_BUFFER_SECONDS));
-}
-
 std::string FirestoreCredentials::GetAuthHeader() const {
 	if (type == FirestoreAuthType::API_KEY) {
 		return ""; // API key goes in URL, not header
 	}
-	return "Bearer " + access_token;
+	return "Bearer " + FirestoreAuthManager::GetAccessToken(*this);
 }
 
 std::string FirestoreCredentials::GetUrlSuffix() const {
@@ -86,6 +90,7 @@ std::unique_ptr<FirestoreCredentials> FirestoreAuthManager::ParseServiceAccountJ
 		if (j.contains("private_key_id")) {
 			creds->private_key_id = j["private_key_id"].get<std::string>();
 		}
+		creds->token_provider = std::make_shared<FirestoreTokenProvider>(creds->client_email, creds->private_key);
 
 		FS_LOG_DEBUG("Loaded service account for project: " + creds->project_id);
 	} catch (const FirestoreAuthError &) {
@@ -145,7 +150,7 @@ std::string FirestoreAuthManager::Base64UrlEncode(const unsigned char *data, siz
 	return result;
 }
 
-std::string FirestoreAuthManager::SignRS256(const std::string &data, const std::string &private_key) {
+evp_pkey_st *FirestoreAuthManager::ParsePrivateKey(const std::string &private_key) {
 	// Create BIO from private key string
 	BIO *bio = BIO_new_mem_buf(private_key.data(), private_key.size());
 	if (!bio) {
@@ -163,25 +168,25 @@ std::string FirestoreAuthManager::SignRS256(const std::string &data, const std::
 		throw FirestoreAuthError(FirestoreErrorCode::AUTH_PRIVATE_KEY_INVALID,
 		                         "Failed to read private key: " + std::string(err_buf));
 	}
+	return pkey;
+}
 
+std::string FirestoreAuthManager::SignRS256(const std::string &data, evp_pkey_st *signing_key) {
 	// Create signing context
 	EVP_MD_CTX *ctx = EVP_MD_CTX_new();
 	if (!ctx) {
-		EVP_PKEY_free(pkey);
 		throw FirestoreAuthError(FirestoreErrorCode::AUTH_SIGNING_FAILED, "Failed to create signing context");
 	}
 
 	// Initialize signing
-	if (EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, pkey) != 1) {
+	if (EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, signing_key) != 1) {
 		EVP_MD_CTX_free(ctx);
-		EVP_PKEY_free(pkey);
 		throw FirestoreAuthError(FirestoreErrorCode::AUTH_SIGNING_FAILED, "Failed to initialize signing");
 	}
 
 	// Sign
 	if (EVP_DigestSignUpdate(ctx, data.data(), data.size()) != 1) {
 		EVP_MD_CTX_free(ctx);
-		EVP_PKEY_free(pkey);
 		throw FirestoreAuthError(FirestoreErrorCode::AUTH_SIGNING_FAILED, "Failed to update signing");
 	}
 
@@ -189,7 +194,6 @@ std::string FirestoreAuthManager::SignRS256(const std::string &data, const std::
 	size_t sig_len;
 	if (EVP_DigestSignFinal(ctx, nullptr, &sig_len) != 1) {
 		EVP_MD_CTX_free(ctx);
-		EVP_PKEY_free(pkey);
 		throw FirestoreAuthError(FirestoreErrorCode::AUTH_SIGNING_FAILED, "Failed to get signature size");
 	}
 
@@ -197,18 +201,16 @@ std::string FirestoreAuthManager::SignRS256(const std::string &data, const std::
 	std::vector<unsigned char> sig(sig_len);
 	if (EVP_DigestSignFinal(ctx, sig.data(), &sig_len) != 1) {
 		EVP_MD_CTX_free(ctx);
-		EVP_PKEY_free(pkey);
 		throw FirestoreAuthError(FirestoreErrorCode::AUTH_SIGNING_FAILED, "Failed to sign data");
 	}
 
 	EVP_MD_CTX_free(ctx);
-	EVP_PKEY_free(pkey);
 
 	return Base64UrlEncode(sig.data(), sig_len);
 }
 
-std::string FirestoreAuthManager::CreateJWT(const FirestoreCredentials &creds) {
-	FS_LOG_DEBUG("Creating JWT for: " + creds.client_email);
+std::string FirestoreAuthManager::CreateJWT(const std::string &client_email, evp_pkey_st *signing_key) {
+	FS_LOG_DEBUG("Creating JWT for: " + client_email);
 
 	auto now = std::chrono::system_clock::now();
 	auto now_secs = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
@@ -218,7 +220,7 @@ std::string FirestoreAuthManager::CreateJWT(const FirestoreCredentials &creds) {
 	json header = {{"alg", "RS256"}, {"typ", "JWT"}};
 
 	// JWT Payload
-	json payload = {{"iss", creds.client_email},
+	json payload = {{"iss", client_email},
 	                {"scope", FIRESTORE_SCOPE},
 	                {"aud", GOOGLE_TOKEN_URL},
 	                {"iat", now_secs},
@@ -228,23 +230,22 @@ std::string FirestoreAuthManager::CreateJWT(const FirestoreCredentials &creds) {
 	std::string payload_b64 = Base64UrlEncode(payload.dump());
 	std::string unsigned_token = header_b64 + "." + payload_b64;
 
-	std::string signature = SignRS256(unsigned_token, creds.private_key);
+	std::string signature = SignRS256(unsigned_token, signing_key);
 
 	return unsigned_token + "." + signature;
 }
 
-std::string FirestoreAuthManager::ExchangeJWTForToken(const std::string &jwt) {
+FirestoreAuthManager::AccessToken FirestoreAuthManager::ExchangeJWTForToken(const std::string &jwt) {
 	FS_LOG_DEBUG("Exchanging JWT for access token");
 
 	std::string post_data = "grant_type=urn:ietf:params:oauth:grant-type:jwt-bearer&assertion=" + jwt;
 
-	httplib::Client cli("https://oauth2.googleapis.com");
-	cli.set_connection_timeout(30);
-	cli.set_read_timeout(30);
+	auto cli = FirestoreConnectionPool::Instance().Acquire("https://oauth2.googleapis.com");
 
-	auto res = cli.Post("/token", post_data, "application/x-www-form-urlencoded");
+	auto res = cli->Post("/token", post_data, "application/x-www-form-urlencoded");
 
 	if (!res) {
+		cli.Discard();
 		throw FirestoreAuthError(FirestoreErrorCode::AUTH_TOKEN_EXCHANGE_FAILED,
 		                         "HTTP request failed: " + httplib::to_string(res.error()));
 	}
@@ -260,8 +261,12 @@ std::string FirestoreAuthManager::ExchangeJWTForToken(const std::string &jwt) {
 		if (!j.contains("access_token")) {
 			throw FirestoreAuthError(FirestoreErrorCode::AUTH_TOKEN_MISSING, "Token response missing access_token");
 		}
-		FS_LOG_DEBUG("Successfully obtained access token");
-		return j["access_token"].get<std::string>();
+		AccessToken result;
+		result.token = j["access_token"].get<std::string>();
+		result.expires_in = std::chrono::seconds(j.value("expires_in", DEFAULT_TOKEN_LIFETIME_SECONDS));
+		FS_LOG_DEBUG("Successfully obtained access token, expires in " + std::to_string(result.expires_in.count()) +
+		             "s");
+		return result;
 	} catch (const FirestoreAuthError &) {
 		throw; // Re-throw our own errors
 	} catch (const json::exception &e) {
@@ -270,33 +275,170 @@ std::string FirestoreAuthManager::ExchangeJWTForToken(const std::string &jwt) {
 	}
 }
 
-std::string FirestoreAuthManager::GetAccessToken(FirestoreCredentials &creds) {
-	if (creds.type != FirestoreAuthType::SERVICE_ACCOUNT) {
+std::string FirestoreAuthManager::GetAccessToken(const FirestoreCredentials &creds) {
+	if (creds.type != FirestoreAuthType::SERVICE_ACCOUNT || !creds.token_provider) {
 		throw FirestoreAuthError(FirestoreErrorCode::AUTH_INVALID_TYPE,
 		                         "GetAccessToken only works with service account credentials");
 	}
+	return creds.token_provider->GetToken();
+}
+
+// Runs the background token refreshes of every provider on one joinable thread. Refreshes log
+// and send requests over the connection pool; statics are destroyed in reverse order of
+// construction, so constructing those first keeps them alive until the thread is joined at exit.
+// Refreshes still queued then are dropped, the one in progress is finished.
+class FirestoreTokenRefresher {
+public:
+	static FirestoreTokenRefresher &Instance() {
+		static FirestoreTokenRefresher instance;
+		return instance;
+	}
+
+	~FirestoreTokenRefresher() {
+		std::thread worker;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+			queue_.clear();
+			worker = std::move(worker_);
+		}
+		cv_.notify_all();
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+
+	// Queue `refresh`; false once the process is shutting down
+	bool Schedule(std::function<void()> refresh) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (stopping_) {
+				return false;
+			}
+			queue_.push_back(std::move(refresh));
+			if (!worker_.joinable()) {
+				worker_ = std::thread(&FirestoreTokenRefresher::Run, this);
+			}
+		}
+		cv_.notify_one();
+		return true;
+	}
+
+private:
+	FirestoreTokenRefresher() {
+		FirestoreLogger::Instance();
+		FirestoreConnectionPool::Instance();
+	}
 
-	RefreshTokenIfNeeded(creds);
-	return creds.access_token;
+	void Run() {
+		while (true) {
+			std::function<void()> refresh;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+				if (stopping_) {
+					return;
+				}
+				refresh = std::move(queue_.front());
+				queue_.pop_front();
+			}
+			// RefreshToken records failures itself
+			refresh();
+		}
+	}
+
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::deque<std::function<void()>> queue_;
+	std::thread worker_;
+	bool stopping_ = false;
+};
+
+FirestoreTokenProvider::FirestoreTokenProvider(std::string client_email, std::string private_key)
+    : client_email_(std::move(client_email)), private_key_(std::move(private_key)) {
 }
 
-void FirestoreAuthManager::RefreshTokenIfNeeded(FirestoreCredentials &creds) {
-	if (creds.type != FirestoreAuthType::SERVICE_ACCOUNT) {
-		return; // API keys don't need refresh
+FirestoreTokenProvider::~FirestoreTokenProvider() {
+	if (signing_key_) {
+		EVP_PKEY_free(signing_key_);
 	}
+}
 
-	if (creds.IsTokenValid()) {
-		return; // Token still valid
+bool FirestoreTokenProvider::HasUsableToken(std::chrono::system_clock::time_point now) const {
+	return !token_.empty() && now < expiry_ - std::chrono::seconds(TOKEN_EXPIRY_MARGIN_SECONDS);
+}
+
+std::string FirestoreTokenProvider::GetToken() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	auto now = std::chrono::system_clock::now();
+	if (HasUsableToken(now)) {
+		if (now >= refresh_at_ && !refreshing_) {
+			// Refresh ahead of expiry; this request and those after it keep the current token.
+			// The queued refresh holds a reference, so the provider outlives it.
+			FS_LOG_DEBUG("Refreshing access token in the background");
+			auto self = shared_from_this();
+			refreshing_ = FirestoreTokenRefresher::Instance().Schedule([self] { self->RefreshToken(); });
+		}
+		return token_;
 	}
 
-	FS_LOG_DEBUG("Refreshing access token");
+	if (refreshing_) {
+		refreshed_cv_.wait(lock, [&] { return !refreshing_; });
+	} else {
+		refreshing_ = true;
+		lock.unlock();
+		RefreshToken();
+		lock.lock();
+	}
+	if (HasUsableToken(std::chrono::system_clock::now())) {
+		return token_;
+	}
+	if (last_error_) {
+		std::rethrow_exception(last_error_);
+	}
+	throw FirestoreAuthError(FirestoreErrorCode::AUTH_TOKEN_MISSING, "No access token available");
+}
+
+void FirestoreTokenProvider::InvalidateToken(const std::string &token) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (token_ == token) {
+		token_.clear();
+	}
+}
 
-	// Create JWT and exchange for access token
-	std::string jwt = CreateJWT(creds);
-	creds.access_token = ExchangeJWTForToken(jwt);
-	creds.token_expiry = std::chrono::system_clock::now() + std::chrono::hours(1);
+void FirestoreTokenProvider::RefreshToken() {
+	FirestoreAuthManager::AccessToken fresh;
+	std::exception_ptr error;
+	try {
+		if (!signing_key_) {
+			signing_key_ = FirestoreAuthManager::ParsePrivateKey(private_key_);
+		}
+		fresh = FirestoreAuthManager::ExchangeJWTForToken(FirestoreAuthManager::CreateJWT(client_email_, signing_key_));
+	} catch (...) {
+		error = std::current_exception();
+	}
 
-	FS_LOG_DEBUG("Access token refreshed successfully");
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto now = std::chrono::system_clock::now();
+		if (!error) {
+			token_ = std::move(fresh.token);
+			expiry_ = now + fresh.expires_in;
+			// Short-lived tokens are refreshed halfway through their lifetime
+			refresh_at_ = expiry_ - std::min(std::chrono::seconds(TOKEN_REFRESH_BUFFER_SECONDS), fresh.expires_in / 2);
+			last_error_ = nullptr;
+			FS_LOG_DEBUG("Access token refreshed successfully");
+		} else {
+			last_error_ = error;
+			refresh_at_ = now + std::chrono::seconds(TOKEN_REFRESH_RETRY_SECONDS);
+			if (!token_.empty()) {
+				FS_LOG_WARN("Background access token refresh failed; retrying in " +
+				            std::to_string(TOKEN_REFRESH_RETRY_SECONDS) + "s");
+			}
+		}
+		refreshing_ = false;
+	}
+	refreshed_cv_.notify_all();
 }
 
 } // namespace duckdb
@@ -1,11 +1,17 @@
 #include "firestore_client.hpp"
 #include "firestore_index.hpp"
 #include "firestore_types.hpp"
-#define CPPHTTPLIB_OPENSSL_SUPPORT
-#include "httplib.h"
+#include "firestore_path_utils.hpp"
+#include "firestore_json_decoder.hpp"
+#include "firestore_rate_limiter.hpp"
+#include "firestore_retry.hpp"
+#include "firestore_transport.hpp"
 #include <sstream>
 #include <cstdlib>
 #include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <thread>
 
 namespace duckdb {
 
@@ -19,24 +25,80 @@ static std::string GetEmulatorHost() {
 	return emulator_host ? std::string(emulator_host) : "";
 }
 
-// Parse a URL into scheme+host and path components
-static bool ParseUrl(const std::string &url, std::string &scheme_host, std::string &path) {
-	// Find scheme
-	auto scheme_end = url.find("://");
-	if (scheme_end == std::string::npos) {
-		return false;
+// Operations that are safe to re-send after a transient failure: reads, and BatchWrite, whose
+// writes name their documents and are applied independently
+static bool IsRetryableOperation(const std::string &operation) {
+	return operation == "list" || operation == "get" || operation == "list_collection_ids" ||
+	       operation == "run_query" || operation == "run_aggregation_query" || operation == "partition_query" ||
+	       operation == "collection_group_query" || operation == "fetch_indexes" ||
+	       operation == "check_default_indexes" || operation == "batch_get" || operation == "batch_write";
+}
+
+// Operations that count against the write rate limiter
+static bool IsWriteOperation(const std::string &operation) {
+	return operation == "create" || operation == "update" || operation == "delete" || operation == "batch_write" ||
+	       operation == "array_transform";
+}
+
+// Decode a page of documents, counting it and its parse time in `stats`
+static FirestoreListResponse DecodeCountedPage(FirestoreIOStats &stats, const std::string &body,
+                                               const FirestoreFieldSet *wanted_fields) {
+	auto start = std::chrono::steady_clock::now();
+	auto result = DecodeDocumentPage(body, wanted_fields);
+	stats.RecordPage(result.documents.size(), std::chrono::steady_clock::now() - start);
+	return result;
+}
+
+// Percent-encode a query parameter value (RFC 3986 unreserved characters pass through)
+static std::string PercentEncode(const std::string &value) {
+	static const char *hex = "0123456789ABCDEF";
+	std::string result;
+	for (unsigned char c : value) {
+		if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+			result += static_cast<char>(c);
+		} else {
+			result += '%';
+			result += hex[c >> 4];
+			result += hex[c & 0xF];
+		}
 	}
-	auto host_start = scheme_end + 3;
-	// Find path start (first '/' after host)
-	auto path_start = url.find('/', host_start);
-	if (path_start == std::string::npos) {
-		scheme_host = url;
-		path = "/";
-	} else {
-		scheme_host = url.substr(0, path_start);
-		path = url.substr(path_start);
+	return result;
+}
+
+// Field paths for a server-side projection, in a stable order. With no fields the projection
+// is __name__ alone, which returns document names only.
+static std::vector<std::string> GetMaskFieldPaths(const FirestoreFieldSet &fields) {
+	std::vector<std::string> paths;
+	for (auto &field : fields) {
+		paths.push_back(QuoteFirestoreFieldPath(field));
+	}
+	std::sort(paths.begin(), paths.end());
+	if (paths.empty()) {
+		paths.push_back("__name__");
+	}
+	return paths;
+}
+
+// StructuredQuery "select" clause for a projection
+static json BuildSelectClause(const FirestoreFieldSet &fields) {
+	json select_fields = json::array();
+	for (auto &path : GetMaskFieldPaths(fields)) {
+		select_fields.push_back({{"fieldPath", path}});
+	}
+	return {{"fields", select_fields}};
+}
+
+// Nested collections ("users/u1/orders") are queried under their parent document; the
+// StructuredQuery only names the last segment. Returns "" for top-level collections and groups.
+static std::string GetQueryParent(const std::string &collection, bool is_collection_group) {
+	if (is_collection_group) {
+		return "";
+	}
+	auto last_slash = collection.rfind('/');
+	if (last_slash != std::string::npos && last_slash > 0) {
+		return "/" + collection.substr(0, last_slash);
 	}
-	return true;
+	return "";
 }
 
 ResolvedDocumentPath ResolveDocumentPath(const std::string &collection, const std::string &document_id) {
@@ -93,8 +155,50 @@ std::string FirestoreClient::BuildUrl(const std::string &path) const {
 	return url;
 }
 
-json FirestoreClient::MakeRequest(const std::string &method, const std::string &url, const json &body,
-                                  const FirestoreErrorContext &ctx) {
+std::string FirestoreClient::MakeRequestRaw(const std::string &method, const std::string &url, const json &body,
+                                            const FirestoreErrorContext &ctx) {
+	if (!ctx.operation.has_value() || !IsRetryableOperation(*ctx.operation)) {
+		return SendRequest(method, url, body, ctx);
+	}
+
+	auto policy = FirestoreRetry::GetPolicy();
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(policy.deadline_ms);
+	for (int64_t attempt = 1;; attempt++) {
+		try {
+			auto response = SendRequest(method, url, body, ctx);
+			if (attempt > 1) {
+				FirestoreRetry::RecordOutcome(true);
+			}
+			return response;
+		} catch (const FirestoreError &e) {
+			if (!FirestoreRetry::IsRetryableError(e.code())) {
+				throw;
+			}
+			auto delay = FirestoreRetry::BackoffDelay(policy, attempt);
+			bool past_deadline = policy.deadline_ms > 0 && std::chrono::steady_clock::now() + delay > deadline;
+			if (attempt >= policy.max_attempts || past_deadline) {
+				if (attempt > 1) {
+					FirestoreRetry::RecordOutcome(false);
+				}
+				throw;
+			}
+			FS_LOG_WARN("Transient Firestore error on " + *ctx.operation + " (attempt " + std::to_string(attempt) +
+			            " of " + std::to_string(policy.max_attempts) + "), retrying in " +
+			            std::to_string(delay.count()) + "ms: " + e.what());
+			FirestoreRetry::RecordRetry();
+			stats_->RecordRetry();
+			std::this_thread::sleep_for(delay);
+			// The throttling response may just have lowered the granted rate; a retried write
+			// waits for its share of it like a new one
+			if (IsWriteOperation(*ctx.operation)) {
+				AcquireWriteBudget(body.contains("writes") ? body["writes"].size() : 1);
+			}
+		}
+	}
+}
+
+std::string FirestoreClient::SendRequest(const std::string &method, const std::string &url, const json &body,
+                                         const FirestoreErrorContext &ctx) {
 	auto start_time = std::chrono::high_resolution_clock::now();
 
 	FS_LOG_DEBUG("Making " + method + " request to: " + url);
@@ -103,69 +207,83 @@ json FirestoreClient::MakeRequest(const std::string &method, const std::string &
 	FirestoreErrorContext error_ctx = ctx;
 	error_ctx.withMethod(method).withUrl(url).withProject(credentials_->project_id);
 
-	// Ensure token is valid for service account auth
-	FirestoreAuthManager::RefreshTokenIfNeeded(*credentials_);
-
-	// Parse the URL into scheme+host and path
-	std::string scheme_host, path;
-	if (!ParseUrl(url, scheme_host, path)) {
-		throw FirestoreNetworkError(FirestoreErrorCode::NETWORK_CURL_INIT, "Failed to parse URL: " + url, error_ctx);
-	}
-
-	httplib::Client cli(scheme_host);
-	cli.set_connection_timeout(30);
-	cli.set_read_timeout(30);
-
-	// Build headers
-	httplib::Headers headers = {{"Content-Type", "application/json"}};
-
-	std::string auth_header = credentials_->GetAuthHeader();
-	if (!auth_header.empty()) {
-		headers.emplace("Authorization", auth_header);
+	// The token provider serves a cached token and refreshes it ahead of expiry. Offline
+	// transports (replay) never reach Firestore, so they need no token.
+	auto transport = FirestoreTransport::Get();
+	FirestoreHttpRequest request;
+	request.method = method;
+	request.url = url;
+	if (!transport->IsOffline()) {
+		request.auth_header = credentials_->GetAuthHeader();
 	}
-
-	// Execute request based on method
-	httplib::Result res;
-	std::string body_str;
 	if (!body.empty() && (method == "POST" || method == "PATCH")) {
-		body_str = body.dump();
+		request.body = body.dump();
 	}
 
-	if (method == "GET") {
-		res = cli.Get(path, headers);
-	} else if (method == "POST") {
-		res = cli.Post(path, headers, body_str, "application/json");
-	} else if (method == "PATCH") {
-		res = cli.Patch(path, headers, body_str, "application/json");
-	} else if (method == "DELETE") {
-		res = cli.Delete(path, headers);
-	} else {
-		res = cli.Get(path, headers);
-	}
+	auto res = transport->Send(request);
 
 	auto end_time = std::chrono::high_resolution_clock::now();
 	auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+	auto endpoint = ctx.operation.has_value() ? GetFirestoreEndpoint(*ctx.operation) : FirestoreEndpoint::OTHER;
+	stats_->RecordRequest(endpoint, request.body.size(), res.body.size(),
+	                      std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time));
 
-	if (!res) {
-		auto err = res.error();
-		std::string error_msg = "HTTP request failed: " + httplib::to_string(err);
-		FS_LOG_ERROR(error_msg + " " + error_ctx.ToString());
-		throw FirestoreNetworkError(FirestoreErrorCode::NETWORK_CURL_PERFORM, error_msg, error_ctx);
+	if (!res.transport_error.empty()) {
+		FS_LOG_ERROR(res.transport_error + " " + error_ctx.ToString());
+		throw FirestoreNetworkError(FirestoreErrorCode::NETWORK_CURL_PERFORM, res.transport_error, error_ctx);
 	}
 
-	int http_code = res->status;
-	const std::string &response_data = res->body;
+	int http_code = res.status;
 
 	FS_LOG_DEBUG("Request completed in " + std::to_string(duration_ms) + "ms, status: " + std::to_string(http_code));
 
 	error_ctx.withStatus(http_code);
 
+	// Handle errors; error bodies are small, so they are always parsed for the message
+	if (http_code < 200 || http_code >= 300) {
+		// A revoked token would otherwise be reused until it expires. Requests that never carried
+		// a token (offline transports replay recorded responses) have nothing to invalidate.
+		static const std::string bearer_prefix = "Bearer ";
+		if (http_code == 401 && credentials_->token_provider &&
+		    request.auth_header.compare(0, bearer_prefix.size(), bearer_prefix) == 0) {
+			credentials_->token_provider->InvalidateToken(request.auth_header.substr(bearer_prefix.size()));
+		}
+		bool is_write = ctx.operation.has_value() && IsWriteOperation(*ctx.operation);
+		if ((http_code == 429 || http_code == 503) && is_write && GetEmulatorHost().empty()) {
+			FirestoreRateLimiter::Instance().OnThrottled(GetRateLimitKey());
+		}
+		json error_response = json::parse(res.body, nullptr, false);
+		if (error_response.is_discarded()) {
+			error_ctx.withResponseBody(res.body.substr(0, 500));
+			error_response = json::object();
+		}
+		HandleError(http_code, error_response, error_ctx);
+	}
+
+	// Writes sent in a successful request (BatchWrite may still reject single writes)
+	if (endpoint == FirestoreEndpoint::BATCH_WRITE && body.contains("writes")) {
+		stats_->RecordDocumentsWritten(body["writes"].size());
+	} else if (endpoint == FirestoreEndpoint::WRITE) {
+		stats_->RecordDocumentsWritten(1);
+	}
+
+	return std::move(res.body);
+}
+
+json FirestoreClient::MakeRequest(const std::string &method, const std::string &url, const json &body,
+                                  const FirestoreErrorContext &ctx) {
+	std::string response_data = MakeRequestRaw(method, url, body, ctx);
+
 	// Parse response
 	json response;
 	if (!response_data.empty()) {
 		try {
+			auto parse_start = std::chrono::steady_clock::now();
 			response = json::parse(response_data);
+			stats_->RecordJsonParse(std::chrono::steady_clock::now() - parse_start);
 		} catch (const json::exception &e) {
+			FirestoreErrorContext error_ctx = ctx;
+			error_ctx.withMethod(method).withUrl(url).withProject(credentials_->project_id);
 			error_ctx.withResponseBody(response_data.substr(0, 500));
 			std::string error_msg = "Failed to parse response: " + std::string(e.what());
 			FS_LOG_ERROR(error_msg);
@@ -173,9 +291,6 @@ json FirestoreClient::MakeRequest(const std::string &method, const std::string &
 		}
 	}
 
-	// Handle errors
-	HandleError(http_code, response, error_ctx);
-
 	return response;
 }
 
@@ -289,22 +404,17 @@ FirestoreListResponse FirestoreClient::ListDocuments(const std::string &collecti
 		add_param("orderBy", query.order_by.value());
 	}
 
-	FirestoreErrorContext ctx;
-	ctx.withOperation("list").withCollection(collection);
-
-	json response = MakeRequest("GET", url, {}, ctx);
-
-	FirestoreListResponse result;
-
-	if (response.contains("documents")) {
-		for (auto &doc_json : response["documents"]) {
-			result.documents.push_back(ParseDocument(doc_json));
+	if (query.field_mask) {
+		for (auto &path : GetMaskFieldPaths(*query.field_mask)) {
+			add_param("mask.fieldPaths", PercentEncode(path));
 		}
 	}
 
-	if (response.contains("nextPageToken")) {
-		result.next_page_token = response["nextPageToken"].get<std::string>();
-	}
+	FirestoreErrorContext ctx;
+	ctx.withOperation("list").withCollection(collection);
+
+	std::string response = MakeRequestRaw("GET", url, {}, ctx);
+	auto result = DecodeCountedPage(*stats_, response, query.field_mask.get());
 
 	FS_LOG_DEBUG("Listed " + std::to_string(result.documents.size()) + " documents");
 	return result;
@@ -315,7 +425,10 @@ FirestoreCollectionIdsPage FirestoreClient::ListCollectionIdsPage(const std::str
                                                                   int64_t page_size) {
 	FS_LOG_DEBUG("Listing collection IDs under document: " + document_path);
 
-	std::string url = BuildUrl(document_path + ":listCollectionIds");
+	// An empty path lists the root collections (".../documents:listCollectionIds")
+	std::string url = document_path.empty()
+	                      ? BuildBaseUrl() + ":listCollectionIds" + credentials_->GetUrlSuffix()
+	                      : BuildUrl(document_path + ":listCollectionIds");
 
 	FirestoreErrorContext ctx;
 	ctx.withOperation("list_collection_ids").withCollection(document_path);
@@ -374,6 +487,38 @@ FirestoreDocument FirestoreClient::GetDocument(const std::string &collection, co
 	return ParseDocument(response);
 }
 
+FirestoreListResponse FirestoreClient::BatchGetDocuments(const std::vector<std::string> &document_paths,
+                                                         std::shared_ptr<const FirestoreFieldSet> field_mask) {
+	if (document_paths.empty()) {
+		return {};
+	}
+
+	FS_LOG_DEBUG("Executing batchGet for " + std::to_string(document_paths.size()) + " documents");
+
+	std::string url = BuildBaseUrl() + ":batchGet" + credentials_->GetUrlSuffix();
+
+	FirestoreErrorContext ctx;
+	ctx.withOperation("batch_get");
+
+	// batchGet names documents by their full resource name
+	std::string name_prefix =
+	    "projects/" + credentials_->project_id + "/databases/" + credentials_->database_id + "/documents/";
+	json names = json::array();
+	for (auto &path : document_paths) {
+		names.push_back(name_prefix + path);
+	}
+	json body = {{"documents", names}};
+	if (field_mask) {
+		body["mask"] = {{"fieldPaths", GetMaskFieldPaths(*field_mask)}};
+	}
+
+	std::string response = MakeRequestRaw("POST", url, body, ctx);
+	auto result = DecodeCountedPage(*stats_, response, field_mask.get());
+
+	FS_LOG_DEBUG("BatchGet returned " + std::to_string(result.documents.size()) + " documents");
+	return result;
+}
+
 FirestoreDocument FirestoreClient::CreateDocument(const std::string &collection, const json &fields,
                                                   const std::optional<std::string> &document_id) {
 	FS_LOG_DEBUG("Creating document in collection: " + collection);
@@ -393,12 +538,13 @@ FirestoreDocument FirestoreClient::CreateDocument(const std::string &collection,
 	}
 
 	json body = {{"fields", fields}};
+	AcquireWriteBudget(1);
 	json response = MakeRequest("POST", url, body, ctx);
 	return ParseDocument(response);
 }
 
 void FirestoreClient::UpdateDocument(const std::string &collection, const std::string &document_id,
-                                     const json &fields) {
+                                     const json &fields, bool must_exist) {
 	FS_LOG_DEBUG("Updating document: " + collection + "/" + document_id);
 
 	auto resolved = ResolveDocumentPath(collection, document_id);
@@ -410,11 +556,15 @@ void FirestoreClient::UpdateDocument(const std::string &collection, const std::s
 		url += (has_params ? "&" : "?") + std::string("updateMask.fieldPaths=") + it.key();
 		has_params = true;
 	}
+	if (must_exist) {
+		url += (has_params ? "&" : "?") + std::string("currentDocument.exists=true");
+	}
 
 	FirestoreErrorContext ctx;
 	ctx.withOperation("update").withCollection(collection).withDocument(document_id);
 
 	json body = {{"fields", fields}};
+	AcquireWriteBudget(1);
 	MakeRequest("PATCH", url, body, ctx);
 
 	FS_LOG_DEBUG("Document updated successfully");
@@ -429,15 +579,16 @@ void FirestoreClient::DeleteDocument(const std::string &collection, const std::s
 	FirestoreErrorContext ctx;
 	ctx.withOperation("delete").withCollection(collection).withDocument(document_id);
 
+	AcquireWriteBudget(1);
 	MakeRequest("DELETE", url, {}, ctx);
 
 	FS_LOG_DEBUG("Document deleted successfully");
 }
 
-void FirestoreClient::BatchWrite(const std::vector<json> &writes) {
+std::vector<FirestoreWriteStatus> FirestoreClient::BatchWrite(const std::vector<json> &writes) {
 	if (writes.empty()) {
 		FS_LOG_DEBUG("BatchWrite called with empty writes, skipping");
-		return;
+		return {};
 	}
 
 	FS_LOG_DEBUG("Executing batch write with " + std::to_string(writes.size()) + " operations");
@@ -449,9 +600,26 @@ void FirestoreClient::BatchWrite(const std::vector<json> &writes) {
 	ctx.withOperation("batch_write");
 
 	json body = {{"writes", writes}};
-	MakeRequest("POST", url, body, ctx);
+	AcquireWriteBudget(writes.size());
+	json response = MakeRequest("POST", url, body, ctx);
 
-	FS_LOG_DEBUG("Batch write completed successfully");
+	// The status array is omitted when every write succeeded
+	std::vector<FirestoreWriteStatus> statuses(writes.size());
+	if (response.contains("status") && response["status"].is_array()) {
+		auto &status_arr = response["status"];
+		for (size_t i = 0; i < statuses.size() && i < status_arr.size(); i++) {
+			statuses[i].code = status_arr[i].value("code", 0);
+			statuses[i].message = status_arr[i].value("message", "");
+		}
+		bool throttled = std::any_of(statuses.begin(), statuses.end(),
+		                             [](const FirestoreWriteStatus &status) { return status.code == 8; });
+		if (throttled && GetEmulatorHost().empty()) {
+			FirestoreRateLimiter::Instance().OnThrottled(GetRateLimitKey()); // RESOURCE_EXHAUSTED
+		}
+	}
+
+	FS_LOG_DEBUG("Batch write completed");
+	return statuses;
 }
 
 void FirestoreClient::ArrayTransform(const std::string &collection, const std::string &document_id,
@@ -516,6 +684,7 @@ void FirestoreClient::ArrayTransform(const std::string &collection, const std::s
 	                   {"fieldTransforms", {{{"fieldPath", field_name}, {transform_name, {{"values", elements}}}}}}}}};
 
 	json body = {{"writes", {write_op}}};
+	AcquireWriteBudget(1);
 	MakeRequest("POST", url, body, ctx);
 
 	FS_LOG_DEBUG("Array transform completed successfully");
@@ -546,28 +715,34 @@ FirestoreListResponse FirestoreClient::CollectionGroupQuery(const std::string &c
 		structured_query["orderBy"] = order_by_arr;
 	}
 
+	if (query.field_mask) {
+		structured_query["select"] = BuildSelectClause(*query.field_mask);
+	}
+
 	FirestoreErrorContext ctx;
 	ctx.withOperation("collection_group_query").withCollection(collection_id);
 
 	json body = {{"structuredQuery", structured_query}};
 
-	json response = MakeRequest("POST", url, body, ctx);
-
-	FirestoreListResponse result;
-
 	// Response is an array of results, each containing a "document" field
-	if (response.is_array()) {
-		for (auto &item : response) {
-			if (item.contains("document")) {
-				result.documents.push_back(ParseDocument(item["document"]));
-			}
-		}
-	}
+	std::string response = MakeRequestRaw("POST", url, body, ctx);
+	auto result = DecodeCountedPage(*stats_, response, query.field_mask.get());
 
 	FS_LOG_DEBUG("Collection group query returned " + std::to_string(result.documents.size()) + " documents");
 	return result;
 }
 
+std::string FirestoreClient::GetRateLimitKey() const {
+	return "projects/" + credentials_->project_id + "/databases/" + credentials_->database_id;
+}
+
+void FirestoreClient::AcquireWriteBudget(uint64_t ops) {
+	// The emulator has no traffic ramp-up to respect
+	if (GetEmulatorHost().empty()) {
+		FirestoreRateLimiter::Instance().Acquire(GetRateLimitKey(), ops);
+	}
+}
+
 std::string FirestoreClient::BuildAdminUrl(const std::string &path) const {
 	std::string emulator_host = GetEmulatorHost();
 	std::string base;
@@ -592,33 +767,117 @@ std::string FirestoreClient::BuildAdminUrl(const std::string &path) const {
 }
 
 FirestoreListResponse FirestoreClient::RunQuery(const std::string &collection, const json &structured_query,
-                                                bool is_collection_group) {
+                                                bool is_collection_group,
+                                                std::shared_ptr<const FirestoreFieldSet> field_mask) {
 	FS_LOG_DEBUG("Executing runQuery for collection: " + collection +
 	             " (collection_group=" + (is_collection_group ? "true" : "false") + ")");
 
-	std::string url = BuildBaseUrl() + ":runQuery" + credentials_->GetUrlSuffix();
+	std::string url =
+	    BuildBaseUrl() + GetQueryParent(collection, is_collection_group) + ":runQuery" + credentials_->GetUrlSuffix();
 
 	FirestoreErrorContext ctx;
 	ctx.withOperation("run_query").withCollection(collection);
 
 	json body = {{"structuredQuery", structured_query}};
+	if (field_mask && !structured_query.contains("select")) {
+		body["structuredQuery"]["select"] = BuildSelectClause(*field_mask);
+	}
 
-	FS_LOG_DEBUG("StructuredQuery: " + structured_query.dump());
+	FS_LOG_DEBUG("StructuredQuery: " + body["structuredQuery"].dump());
 
-	json response = MakeRequest("POST", url, body, ctx);
+	std::string response = MakeRequestRaw("POST", url, body, ctx);
+	auto result = DecodeCountedPage(*stats_, response, field_mask.get());
+
+	FS_LOG_DEBUG("RunQuery returned " + std::to_string(result.documents.size()) + " documents");
+	return result;
+}
+
+json FirestoreClient::RunAggregationQuery(const std::string &collection, const json &structured_query,
+                                          const json &aggregations, bool is_collection_group) {
+	FS_LOG_DEBUG("Executing runAggregationQuery for collection: " + collection);
+
+	std::string url = BuildBaseUrl() + GetQueryParent(collection, is_collection_group) + ":runAggregationQuery" +
+	                  credentials_->GetUrlSuffix();
+
+	FirestoreErrorContext ctx;
+	ctx.withOperation("run_aggregation_query").withCollection(collection);
 
-	FirestoreListResponse result;
+	json body = {{"structuredAggregationQuery",
+	              {{"structuredQuery", structured_query}, {"aggregations", aggregations}}}};
 
+	FS_LOG_DEBUG("StructuredAggregationQuery: " + body.dump());
+
+	// Response is a stream (array) of results; the aggregate values are in the entry with "result"
+	json response = MakeRequest("POST", url, body, ctx);
 	if (response.is_array()) {
-		for (auto &item : response) {
-			if (item.contains("document")) {
-				result.documents.push_back(ParseDocument(item["document"]));
+		for (auto &entry : response) {
+			if (entry.contains("result") && entry["result"].contains("aggregateFields")) {
+				return entry["result"]["aggregateFields"];
 			}
 		}
 	}
+	throw FirestoreError(FirestoreErrorCode::REQUEST_RESPONSE_PARSE,
+	                     "runAggregationQuery response contained no aggregation result", ctx);
+}
 
-	FS_LOG_DEBUG("RunQuery returned " + std::to_string(result.documents.size()) + " documents");
-	return result;
+std::vector<std::string> FirestoreClient::PartitionQuery(const std::string &collection_id, int64_t partition_count) {
+	FS_LOG_DEBUG("Partitioning collection group '" + collection_id + "' into " + std::to_string(partition_count) +
+	             " ranges");
+
+	std::vector<std::string> boundaries;
+	if (partition_count < 2) {
+		return boundaries;
+	}
+
+	std::string url = BuildBaseUrl() + ":partitionQuery" + credentials_->GetUrlSuffix();
+
+	FirestoreErrorContext ctx;
+	ctx.withOperation("partition_query").withCollection(collection_id);
+
+	// partitionQuery only accepts an unfiltered collection group query ordered by __name__
+	json structured_query = {
+	    {"from", {{{"collectionId", collection_id}, {"allDescendants", true}}}},
+	    {"orderBy", {{{"field", {{"fieldPath", "__name__"}}}, {"direction", "ASCENDING"}}}}};
+
+	// partitionCount is the number of split points, i.e. one less than the number of ranges
+	json body = {{"structuredQuery", structured_query},
+	             {"partitionCount", std::to_string(partition_count - 1)},
+	             {"pageSize", partition_count}};
+
+	std::optional<std::string> page_token;
+	do {
+		if (page_token.has_value()) {
+			body["pageToken"] = page_token.value();
+		}
+		json response = MakeRequest("POST", url, body, ctx);
+
+		if (response.contains("partitions")) {
+			for (auto &cursor : response["partitions"]) {
+				if (!cursor.contains("values") || cursor["values"].empty()) {
+					continue;
+				}
+				auto &value = cursor["values"][0];
+				if (value.contains("referenceValue")) {
+					boundaries.push_back(value["referenceValue"].get<std::string>());
+				}
+			}
+		}
+
+		if (response.contains("nextPageToken") && !response["nextPageToken"].get<std::string>().empty()) {
+			page_token = response["nextPageToken"].get<std::string>();
+		} else {
+			page_token.reset();
+		}
+	} while (page_token.has_value());
+
+	// Each page is sorted, but pages are not ordered relative to each other
+	std::sort(boundaries.begin(), boundaries.end(), [](const std::string &a, const std::string &b) {
+		return CompareFirestoreDocumentNames(a, b) < 0;
+	});
+	boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+	FS_LOG_DEBUG("partitionQuery returned " + std::to_string(boundaries.size()) + " split points");
+	return boundaries;
 }
 
 std::vector<FirestoreIndex> FirestoreClient::FetchCompositeIndexes(const std::string &collection_id) {
@@ -727,7 +986,8 @@ bool FirestoreClient::CheckDefaultSingleFieldIndexes() {
 }
 
 std::vector<std::pair<std::string, LogicalType>> FirestoreClient::InferSchema(const std::string &collection,
-                                                                              int64_t sample_size, bool show_missing) {
+                                                                              int64_t sample_size, bool show_missing,
+                                                                              FirestoreSampleStats *stats) {
 	FS_LOG_DEBUG("Inferring schema for collection: " + collection);
 
 	FirestoreQuery query;
@@ -752,12 +1012,17 @@ std::vector<std::pair<std::string, LogicalType>> FirestoreClient::InferSchema(co
 	std::map<std::string, std::map<std::string, int64_t>> array_element_types;
 	// For vector fields, track dimension from first non-null vector
 	std::map<std::string, idx_t> vector_dimensions;
+	// Distinct serialized values per field, for the sample statistics
+	std::map<std::string, std::unordered_set<std::string>> distinct_values;
 
 	for (const auto &doc : response.documents) {
 		// Skip phantom/missing documents (no fields) during schema inference
 		if (doc.fields.empty() || doc.fields.is_null()) {
 			continue;
 		}
+		if (stats) {
+			stats->documents++;
+		}
 		for (auto it = doc.fields.begin(); it != doc.fields.end(); ++it) {
 			const std::string &field_name = it.key();
 			const json &field_value = it.value();
@@ -765,6 +1030,27 @@ std::vector<std::pair<std::string, LogicalType>> FirestoreClient::InferSchema(co
 			// Use the centralized type detection function
 			std::string type_name = GetFirestoreTypeName(field_value);
 
+			if (stats && type_name != "nullValue") {
+				auto &field_stats = stats->fields[field_name];
+				field_stats.present++;
+				distinct_values[field_name].insert(field_value.dump());
+				double number;
+				bool is_number = false;
+				if (type_name == "integerValue") {
+					auto &v = field_value["integerValue"];
+					number = v.is_string() ? std::stod(v.get<std::string>()) : v.get<double>();
+					is_number = true;
+				} else if (type_name == "doubleValue" && field_value["doubleValue"].is_number()) {
+					number = field_value["doubleValue"].get<double>();
+					is_number = true;
+				}
+				if (is_number) {
+					field_stats.min = field_stats.has_range ? std::min(field_stats.min, number) : number;
+					field_stats.max = field_stats.has_range ? std::max(field_stats.max, number) : number;
+					field_stats.has_range = true;
+				}
+			}
+
 			// For array fields, sample element types
 			if (type_name == "arrayValue" && field_value["arrayValue"].contains("values")) {
 				for (const auto &elem : field_value["arrayValue"]["values"]) {
@@ -790,6 +1076,12 @@ std::vector<std::pair<std::string, LogicalType>> FirestoreClient::InferSchema(co
 		}
 	}
 
+	if (stats) {
+		for (auto &[name, values] : distinct_values) {
+			stats->fields[name].distinct = values.size();
+		}
+	}
+
 	// Convert to vector with proper LogicalTypes
 	std::vector<std::pair<std::string, LogicalType>> result;
 	for (const auto &[name, type] : field_types) {
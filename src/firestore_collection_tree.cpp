@@ -0,0 +1,330 @@
+#include "firestore_collection_tree.hpp"
+#include "firestore_path_utils.hpp"
+#include "firestore_secrets.hpp"
+#include "firestore_settings.hpp"
+#include "firestore_stats.hpp"
+#include "firestore_logger.hpp"
+#include "duckdb/main/extension/extension_loader.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+namespace duckdb {
+
+// ============================================================================
+// Walk
+// ============================================================================
+
+// Path of a document resource name below .../documents ("projects/p/.../documents/users/u1" -> "users/u1")
+static std::string GetRelativeDocumentPath(const std::string &name) {
+	static constexpr char kMarker[] = "/documents/";
+	auto pos = name.find(kMarker);
+	return pos == std::string::npos ? name : name.substr(pos + sizeof(kMarker) - 1);
+}
+
+// Shared state of one walk. Each task lists one document's subcollections or one collection's
+// documents; the tasks a listing produces are queued for whichever worker is free next. Only a
+// few document tasks per worker are queued at a time: a worker listing a large collection
+// lists the subcollections of the documents that do not fit itself, so memory follows the
+// worker count rather than the number of documents in the tree.
+class FirestoreCollectionWalker {
+public:
+	FirestoreCollectionWalker(std::shared_ptr<FirestoreCredentials> credentials, int64_t max_depth,
+	                          std::shared_ptr<FirestoreIOStats> stats)
+	    : credentials_(std::move(credentials)), stats_(std::move(stats)), max_depth_(max_depth) {
+	}
+
+	std::vector<FirestoreCollectionTreeEntry> Walk(const std::string &root, idx_t concurrency) {
+		max_queued_documents_ = kQueuedDocumentsPerWorker * MaxValue<idx_t>(concurrency, 1);
+		if (IsFirestoreDocumentPath(root) || root.empty()) {
+			queue_.push_back({root, false, 0});
+			queued_documents_++;
+		} else {
+			queue_.push_back({root, true, 0});
+		}
+		std::vector<std::thread> workers;
+		for (idx_t i = 0; i < MaxValue<idx_t>(concurrency, 1); i++) {
+			workers.emplace_back(&FirestoreCollectionWalker::Run, this);
+		}
+		for (auto &worker : workers) {
+			worker.join();
+		}
+		if (error_) {
+			std::rethrow_exception(error_);
+		}
+		std::sort(entries_.begin(), entries_.end(),
+		          [](const FirestoreCollectionTreeEntry &left, const FirestoreCollectionTreeEntry &right) {
+			          return CompareFirestoreDocumentNames(left.path, right.path) < 0;
+		          });
+		FS_LOG_DEBUG("Collection tree below '" + root + "': " + std::to_string(entries_.size()) +
+		             " collections in " + std::to_string(documents_) + " documents");
+		return std::move(entries_);
+	}
+
+private:
+	static constexpr idx_t kQueuedDocumentsPerWorker = 4;
+
+	struct Task {
+		std::string path;
+		bool is_collection; // List the collection's documents; otherwise the document's subcollections
+		int64_t depth;      // Depth of the collection (of the document's collection, for documents)
+	};
+
+	void Run() {
+		FirestoreClient client(credentials_);
+		if (stats_) {
+			client.SetStats(stats_);
+		}
+		while (true) {
+			Task task;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				// Once nothing is queued and no listing is running, no more tasks can appear
+				cv_.wait(lock, [&] { return error_ || !queue_.empty() || active_ == 0; });
+				if (error_ || queue_.empty()) {
+					return;
+				}
+				task = std::move(queue_.front());
+				queue_.pop_front();
+				if (!task.is_collection) {
+					queued_documents_--;
+				}
+				active_++;
+			}
+
+			std::exception_ptr error;
+			try {
+				if (task.is_collection) {
+					ListDocuments(client, task);
+				} else {
+					ListSubcollections(client, task);
+				}
+			} catch (...) {
+				error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				active_--;
+				if (error && !error_) {
+					error_ = error;
+					queue_.clear();
+					queued_documents_ = 0;
+				}
+			}
+			cv_.notify_all();
+		}
+	}
+
+	void ListSubcollections(FirestoreClient &client, const Task &document) {
+		auto depth = document.depth + 1;
+		if (max_depth_ > 0 && depth > max_depth_) {
+			return;
+		}
+		std::optional<std::string> page_token;
+		do {
+			auto page = client.ListCollectionIdsPage(document.path, page_token, 100);
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				for (auto &id : page.collection_ids) {
+					auto path = document.path.empty() ? id : document.path + "/" + id;
+					if (!visited_collections_.insert(path).second) {
+						continue;
+					}
+					FirestoreCollectionTreeEntry entry;
+					entry.path = path;
+					entry.collection_id = id;
+					entry.parent = document.path;
+					entry.depth = depth;
+					entries_.push_back(std::move(entry));
+					// Subcollections of its documents would be one level deeper
+					if (max_depth_ == 0 || depth < max_depth_) {
+						queue_.push_back({std::move(path), true, depth});
+					}
+				}
+			}
+			cv_.notify_all();
+			page_token.reset();
+			if (!page.next_page_token.empty()) {
+				page_token = page.next_page_token;
+			}
+		} while (page_token.has_value());
+	}
+
+	void ListDocuments(FirestoreClient &client, const Task &collection) {
+		// Names only; phantom documents (no fields, only subcollections) are listed too
+		FirestoreQuery query;
+		query.show_missing = true;
+		query.field_mask = std::make_shared<FirestoreFieldSet>();
+		// Documents of the current page that did not fit in the queue
+		std::vector<Task> inline_documents;
+		while (true) {
+			auto page = client.ListDocuments(collection.path, query);
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (error_) {
+					return;
+				}
+				for (auto &doc : page.documents) {
+					Task document {GetRelativeDocumentPath(doc.name), false, collection.depth};
+					if (queued_documents_ < max_queued_documents_) {
+						queue_.push_back(std::move(document));
+						queued_documents_++;
+					} else {
+						inline_documents.push_back(std::move(document));
+					}
+					documents_++;
+				}
+			}
+			cv_.notify_all();
+			for (auto &document : inline_documents) {
+				ListSubcollections(client, document);
+			}
+			inline_documents.clear();
+			if (page.next_page_token.empty()) {
+				return;
+			}
+			query.page_token = page.next_page_token;
+		}
+	}
+
+	std::shared_ptr<FirestoreCredentials> credentials_;
+	std::shared_ptr<FirestoreIOStats> stats_;
+	int64_t max_depth_;
+
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::deque<Task> queue_;
+	idx_t active_ = 0; // Tasks being listed
+	std::exception_ptr error_;
+	idx_t documents_ = 0;        // Documents listed, each one queued or listed inline once
+	idx_t queued_documents_ = 0; // Document tasks in queue_
+	idx_t max_queued_documents_ = 0;
+	std::unordered_set<std::string> visited_collections_;
+	std::vector<FirestoreCollectionTreeEntry> entries_;
+};
+
+std::vector<FirestoreCollectionTreeEntry>
+WalkFirestoreCollectionTree(std::shared_ptr<FirestoreCredentials> credentials, const std::string &root,
+                            int64_t max_depth, idx_t concurrency, std::shared_ptr<FirestoreIOStats> stats) {
+	FirestoreCollectionWalker walker(std::move(credentials), max_depth, std::move(stats));
+	return walker.Walk(root, concurrency);
+}
+
+// ============================================================================
+// firestore_collection_tree
+// ============================================================================
+
+struct FirestoreCollectionTreeBindData : public TableFunctionData {
+	std::shared_ptr<FirestoreCredentials> credentials;
+	std::string root;
+	int64_t max_depth = 0;
+	int64_t concurrency = 0;
+};
+
+struct FirestoreCollectionTreeGlobalState : public GlobalTableFunctionState {
+	std::vector<FirestoreCollectionTreeEntry> entries;
+	idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> FirestoreCollectionTreeBind(ClientContext &context, TableFunctionBindInput &input,
+                                                            vector<LogicalType> &return_types,
+                                                            vector<string> &names) {
+	auto result = make_uniq<FirestoreCollectionTreeBindData>();
+	result->root = input.inputs[0].IsNull() ? "" : input.inputs[0].GetValue<string>();
+	// "/users/u1/" and "users/u1" name the same document
+	auto first = result->root.find_first_not_of('/');
+	auto last = result->root.find_last_not_of('/');
+	result->root = first == std::string::npos ? "" : result->root.substr(first, last - first + 1);
+	if (!result->root.empty() && result->root[0] == '~') {
+		throw BinderException("firestore_collection_tree needs a collection or document path, not a collection group");
+	}
+
+	std::optional<std::string> project_id;
+	std::optional<std::string> credentials_path;
+	std::optional<std::string> api_key;
+	std::optional<std::string> database_id;
+	result->concurrency = FirestoreSettings::DiscoveryConcurrency(context);
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "project_id") {
+			project_id = kv.second.GetValue<string>();
+		} else if (kv.first == "credentials") {
+			credentials_path = kv.second.GetValue<string>();
+		} else if (kv.first == "api_key") {
+			api_key = kv.second.GetValue<string>();
+		} else if (kv.first == "database") {
+			database_id = kv.second.GetValue<string>();
+		} else if (kv.first == "max_depth") {
+			if (kv.second.IsNull()) {
+				continue;
+			}
+			result->max_depth = kv.second.GetValue<int64_t>();
+			if (result->max_depth < 1) {
+				throw BinderException("max_depth must be at least 1");
+			}
+		} else if (kv.first == "concurrency") {
+			if (kv.second.IsNull()) {
+				continue;
+			}
+			auto concurrency = kv.second.GetValue<int64_t>();
+			if (concurrency < 1 || concurrency > FirestoreSettings::kMaxDiscoveryConcurrency) {
+				throw BinderException("concurrency must be between 1 and " +
+				                      std::to_string(FirestoreSettings::kMaxDiscoveryConcurrency));
+			}
+			result->concurrency = concurrency;
+		}
+	}
+
+	result->credentials = ResolveFirestoreCredentials(context, project_id, credentials_path, api_key, database_id);
+	if (!result->credentials) {
+		throw BinderException(
+		    "No Firestore credentials found. Provide credentials parameter, "
+		    "create a secret with CREATE SECRET, or set GOOGLE_APPLICATION_CREDENTIALS environment variable.");
+	}
+
+	names = {"path", "collection_id", "parent", "depth"};
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT};
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> FirestoreCollectionTreeInitGlobal(ClientContext &context,
+                                                                              TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<FirestoreCollectionTreeBindData>();
+	auto state = make_uniq<FirestoreCollectionTreeGlobalState>();
+	state->entries = WalkFirestoreCollectionTree(bind_data.credentials, bind_data.root, bind_data.max_depth,
+	                                             static_cast<idx_t>(bind_data.concurrency),
+	                                             std::make_shared<FirestoreIOStats>(GetFirestoreQueryStats(context)));
+	return std::move(state);
+}
+
+static void FirestoreCollectionTreeFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<FirestoreCollectionTreeGlobalState>();
+	idx_t count = 0;
+	while (state.offset < state.entries.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &entry = state.entries[state.offset++];
+		output.SetValue(0, count, Value(entry.path));
+		output.SetValue(1, count, Value(entry.collection_id));
+		output.SetValue(2, count, Value(entry.parent));
+		output.SetValue(3, count, Value::BIGINT(entry.depth));
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+void RegisterFirestoreCollectionTreeFunction(ExtensionLoader &loader) {
+	TableFunction tree_func("firestore_collection_tree", {LogicalType::VARCHAR}, FirestoreCollectionTreeFunction,
+	                        FirestoreCollectionTreeBind, FirestoreCollectionTreeInitGlobal);
+	tree_func.named_parameters["project_id"] = LogicalType::VARCHAR;
+	tree_func.named_parameters["credentials"] = LogicalType::VARCHAR;
+	tree_func.named_parameters["api_key"] = LogicalType::VARCHAR;
+	tree_func.named_parameters["database"] = LogicalType::VARCHAR;
+	tree_func.named_parameters["max_depth"] = LogicalType::BIGINT;
+	tree_func.named_parameters["concurrency"] = LogicalType::BIGINT;
+	loader.RegisterFunction(tree_func);
+}
+
+} // namespace duckdb
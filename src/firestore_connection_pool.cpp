@@ -0,0 +1,145 @@
+#include "firestore_connection_pool.hpp"
+#include "firestore_logger.hpp"
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.h"
+
+namespace duckdb {
+
+// Timeouts applied to every pooled client (seconds)
+static constexpr time_t HTTP_CONNECTION_TIMEOUT = 30;
+static constexpr time_t HTTP_READ_TIMEOUT = 30;
+
+// ============================================================================
+// Lease
+// ============================================================================
+
+FirestoreConnectionPool::Lease::Lease(FirestoreConnectionPool *pool, std::string key,
+                                      std::unique_ptr<httplib::Client> client)
+    : pool_(pool), key_(std::move(key)), client_(std::move(client)) {
+}
+
+FirestoreConnectionPool::Lease::Lease(Lease &&other) noexcept
+    : pool_(other.pool_), key_(std::move(other.key_)), client_(std::move(other.client_)) {
+	other.pool_ = nullptr;
+}
+
+FirestoreConnectionPool::Lease::~Lease() {
+	if (pool_ && client_) {
+		pool_->Release(key_, std::move(client_));
+	}
+}
+
+void FirestoreConnectionPool::Lease::Discard() {
+	client_.reset();
+}
+
+// ============================================================================
+// Pool
+// ============================================================================
+
+FirestoreConnectionPool &FirestoreConnectionPool::Instance() {
+	static FirestoreConnectionPool instance;
+	return instance;
+}
+
+FirestoreConnectionPool::~FirestoreConnectionPool() {
+	Clear();
+}
+
+void FirestoreConnectionPool::EvictExpiredLocked(std::deque<IdleConnection> &idle,
+                                                 std::chrono::steady_clock::time_point now) {
+	auto timeout = std::chrono::seconds(idle_timeout_seconds_);
+	// Oldest connections sit at the front
+	while (!idle.empty() && now - idle.front().last_used > timeout) {
+		idle.pop_front();
+		stats_.evictions++;
+		stats_.idle--;
+	}
+}
+
+FirestoreConnectionPool::Lease FirestoreConnectionPool::Acquire(const std::string &scheme_host) {
+	std::unique_ptr<httplib::Client> client;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = idle_.find(scheme_host);
+		if (it != idle_.end()) {
+			EvictExpiredLocked(it->second, std::chrono::steady_clock::now());
+			if (!it->second.empty()) {
+				// Most recently used connection is the most likely to still be open
+				client = std::move(it->second.back().client);
+				it->second.pop_back();
+				stats_.idle--;
+			}
+		}
+		if (client) {
+			stats_.hits++;
+		} else {
+			stats_.misses++;
+		}
+	}
+
+	if (!client) {
+		FS_LOG_DEBUG("Opening new HTTP connection to " + scheme_host);
+		client = std::make_unique<httplib::Client>(scheme_host);
+		client->set_connection_timeout(HTTP_CONNECTION_TIMEOUT);
+		client->set_read_timeout(HTTP_READ_TIMEOUT);
+		client->set_keep_alive(true);
+	}
+
+	return Lease(this, scheme_host, std::move(client));
+}
+
+void FirestoreConnectionPool::Release(const std::string &key, std::unique_ptr<httplib::Client> client) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (max_idle_per_host_ <= 0) {
+		return; // Pooling disabled; client closes on destruction
+	}
+	auto &idle = idle_[key];
+	auto now = std::chrono::steady_clock::now();
+	EvictExpiredLocked(idle, now);
+	if (idle.size() >= static_cast<size_t>(max_idle_per_host_)) {
+		idle.pop_front();
+		stats_.evictions++;
+		stats_.idle--;
+	}
+	idle.push_back({std::move(client), now});
+	stats_.idle++;
+}
+
+void FirestoreConnectionPool::SetMaxIdlePerHost(int64_t max_idle) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	max_idle_per_host_ = max_idle < 0 ? 0 : max_idle;
+	for (auto &entry : idle_) {
+		while (entry.second.size() > static_cast<size_t>(max_idle_per_host_)) {
+			entry.second.pop_front();
+			stats_.evictions++;
+			stats_.idle--;
+		}
+	}
+}
+
+void FirestoreConnectionPool::SetIdleTimeoutSeconds(int64_t seconds) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	idle_timeout_seconds_ = seconds < 0 ? 0 : seconds;
+}
+
+FirestoreConnectionPoolStats FirestoreConnectionPool::GetStats() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto now = std::chrono::steady_clock::now();
+	for (auto &entry : idle_) {
+		EvictExpiredLocked(entry.second, now);
+	}
+	return stats_;
+}
+
+void FirestoreConnectionPool::Clear() {
+	std::unordered_map<std::string, std::deque<IdleConnection>> closing;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		closing.swap(idle_);
+		stats_.idle = 0;
+	}
+	// Sockets are closed here, outside the lock
+}
+
+} // namespace duckdb
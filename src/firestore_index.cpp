@@ -7,6 +7,17 @@
 #include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include "duckdb/planner/expression/bound_conjunction_expression.hpp"
 #include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/expression/between_expression.hpp"
+#include "duckdb/parser/expression/cast_expression.hpp"
+#include "duckdb/parser/expression/columnref_expression.hpp"
+#include "duckdb/parser/expression/comparison_expression.hpp"
+#include "duckdb/parser/expression/conjunction_expression.hpp"
+#include "duckdb/parser/expression/constant_expression.hpp"
+#include "duckdb/parser/expression/operator_expression.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
 
 namespace duckdb {
 
@@ -162,30 +173,39 @@ std::vector<FirestorePushdownFilter> ConvertDuckDBFilter(const std::string &fiel
 	return result;
 }
 
+static json BuildFilterJson(const FirestorePushdownFilter &f) {
+	if (f.is_disjunction) {
+		json branches = json::array();
+		for (auto &branch : f.disjuncts) {
+			branches.push_back(BuildFilterJson(branch));
+		}
+		return {{"compositeFilter", {{"op", "OR"}, {"filters", branches}}}};
+	}
+	if (f.is_unary) {
+		return {{"unaryFilter", {{"field", {{"fieldPath", f.field_path}}}, {"op", f.unary_op}}}};
+	}
+	if (f.is_in_filter) {
+		json array_value = json::array();
+		for (auto &v : f.in_values) {
+			array_value.push_back(v);
+		}
+		return {{"fieldFilter",
+		         {{"field", {{"fieldPath", f.field_path}}},
+		          {"op", f.firestore_op},
+		          {"value", {{"arrayValue", {{"values", array_value}}}}}}}};
+	}
+	return {{"fieldFilter",
+	         {{"field", {{"fieldPath", f.field_path}}}, {"op", f.firestore_op}, {"value", f.firestore_value}}}};
+}
+
 json BuildWhereClause(const std::vector<FirestorePushdownFilter> &filters) {
 	if (filters.empty()) {
 		return {};
 	}
 
 	std::vector<json> filter_jsons;
-
 	for (auto &f : filters) {
-		if (f.is_unary) {
-			filter_jsons.push_back({{"unaryFilter", {{"field", {{"fieldPath", f.field_path}}}, {"op", f.unary_op}}}});
-		} else if (f.is_in_filter) {
-			json array_value = json::array();
-			for (auto &v : f.in_values) {
-				array_value.push_back(v);
-			}
-			filter_jsons.push_back({{"fieldFilter",
-			                         {{"field", {{"fieldPath", f.field_path}}},
-			                          {"op", f.firestore_op},
-			                          {"value", {{"arrayValue", {{"values", array_value}}}}}}}});
-		} else {
-			filter_jsons.push_back(
-			    {{"fieldFilter",
-			      {{"field", {{"fieldPath", f.field_path}}}, {"op", f.firestore_op}, {"value", f.firestore_value}}}});
-		}
+		filter_jsons.push_back(BuildFilterJson(f));
 	}
 
 	if (filter_jsons.size() == 1) {
@@ -196,6 +216,84 @@ json BuildWhereClause(const std::vector<FirestorePushdownFilter> &filters) {
 	return {{"compositeFilter", {{"op", "AND"}, {"filters", filter_jsons}}}};
 }
 
+// Drop repeated values from an IN list, keeping the first of each. Sub-queries built from the
+// chunks of an IN list are only disjoint when no value is in two chunks.
+static void DedupeInValues(std::vector<json> &values) {
+	std::unordered_set<std::string> seen;
+	std::vector<json> unique;
+	unique.reserve(values.size());
+	for (auto &value : values) {
+		if (seen.insert(value.dump()).second) {
+			unique.push_back(std::move(value));
+		}
+	}
+	values = std::move(unique);
+}
+
+bool RequiresSplitting(const FirestorePushdownFilter &filter) {
+	return filter.is_disjunction ||
+	       (filter.is_in_filter && filter.firestore_op == "IN" && filter.in_values.size() > kMaxFirestoreDisjunctions);
+}
+
+std::vector<std::vector<FirestorePushdownFilter>>
+SplitDisjunctiveFilters(const std::vector<FirestorePushdownFilter> &filters, bool &may_overlap) {
+	may_overlap = false;
+	std::vector<FirestorePushdownFilter> common;
+	const FirestorePushdownFilter *split = nullptr;
+	for (auto &f : filters) {
+		if (!RequiresSplitting(f)) {
+			common.push_back(f);
+		} else if (!split) {
+			split = &f;
+		} else {
+			FS_LOG_DEBUG("Only one filter is split into sub-queries; leaving another to DuckDB");
+		}
+	}
+	if (!split) {
+		return {common};
+	}
+
+	// IN lists of the common filters multiply with each chunk in disjunctive normal form
+	idx_t common_disjunctions = 1;
+	for (auto &f : common) {
+		if (f.is_in_filter && f.firestore_op == "IN") {
+			common_disjunctions =
+			    MinValue<idx_t>(common_disjunctions * MaxValue<idx_t>(f.in_values.size(), 1), kMaxFirestoreDisjunctions);
+		}
+	}
+	idx_t chunk_size = MaxValue<idx_t>(kMaxFirestoreDisjunctions / common_disjunctions, 1);
+
+	// Branches of an OR are on different fields, so a document can match several of them.
+	// Chunks of one IN list are disjoint once its repeated values are dropped.
+	std::vector<FirestorePushdownFilter> branches;
+	if (split->is_disjunction) {
+		branches = split->disjuncts;
+		may_overlap = true;
+	} else {
+		branches.push_back(*split);
+	}
+
+	std::vector<std::vector<FirestorePushdownFilter>> result;
+	for (auto &branch : branches) {
+		if (branch.is_in_filter) {
+			DedupeInValues(branch.in_values);
+		}
+		if (!branch.is_in_filter || branch.in_values.size() <= chunk_size) {
+			result.push_back(common);
+			result.back().push_back(branch);
+			continue;
+		}
+		for (idx_t start = 0; start < branch.in_values.size(); start += chunk_size) {
+			auto end = MinValue<idx_t>(start + chunk_size, branch.in_values.size());
+			FirestorePushdownFilter chunk = branch;
+			chunk.in_values.assign(branch.in_values.begin() + start, branch.in_values.begin() + end);
+			result.push_back(common);
+			result.back().push_back(std::move(chunk));
+		}
+	}
+	return result;
+}
+
 bool HasSingleFieldIndex(const std::string &field_path, const FirestoreIndexCache &cache,
                          FirestoreIndex::QueryScope scope) {
 	// Default single-field indexes only cover COLLECTION scope, not COLLECTION_GROUP.
@@ -289,6 +387,86 @@ bool HasCompositeOrderByIndex(const std::vector<OrderByField> &order_by_fields,
 	return false;
 }
 
+// Defaults when the sample has no statistics for a field
+static constexpr double kDefaultEqualSelectivity = 0.1;
+static constexpr double kDefaultRangeSelectivity = 1.0 / 3.0;
+
+static bool GetNumericFirestoreValue(const json &value, double &out) {
+	if (value.contains("integerValue")) {
+		auto &v = value["integerValue"];
+		out = v.is_string() ? std::stod(v.get<std::string>()) : v.get<double>();
+		return true;
+	}
+	if (value.contains("doubleValue") && value["doubleValue"].is_number()) {
+		out = value["doubleValue"].get<double>();
+		return true;
+	}
+	return false;
+}
+
+double EstimateFilterSelectivity(const FirestorePushdownFilter &filter, const FirestoreSampleStats &stats) {
+	if (filter.is_disjunction) {
+		double sum = 0;
+		for (auto &d : filter.disjuncts) {
+			sum += EstimateFilterSelectivity(d, stats);
+		}
+		return std::min(sum, 1.0);
+	}
+
+	const FirestoreFieldStats *field = nullptr;
+	if (stats.documents > 0) {
+		auto it = stats.fields.find(filter.field_path);
+		if (it != stats.fields.end()) {
+			field = &it->second;
+		}
+	}
+	if (!field) {
+		if (filter.is_unary) {
+			return filter.unary_op == "IS_NULL" ? kDefaultEqualSelectivity : 1.0 - kDefaultEqualSelectivity;
+		}
+		if (filter.is_in_filter) {
+			double n = static_cast<double>(filter.in_values.size());
+			return filter.firestore_op == "NOT_IN" ? 1.0 - kDefaultEqualSelectivity
+			                                       : std::min(n * kDefaultEqualSelectivity, 1.0);
+		}
+		if (filter.firestore_op == "EQUAL") {
+			return kDefaultEqualSelectivity;
+		}
+		if (filter.firestore_op == "NOT_EQUAL") {
+			return 1.0 - kDefaultEqualSelectivity;
+		}
+		return kDefaultRangeSelectivity;
+	}
+
+	// Smoothed, so that a field missing from every sampled document is rare rather than absent
+	double presence = (static_cast<double>(field->present) + 0.5) / (static_cast<double>(stats.documents) + 1.0);
+	double distinct = static_cast<double>(std::max<idx_t>(field->distinct, 1));
+	if (filter.is_unary) {
+		return filter.unary_op == "IS_NULL" ? 1.0 - presence : presence;
+	}
+	if (filter.is_in_filter) {
+		double fraction = std::min(static_cast<double>(filter.in_values.size()) / distinct, 1.0);
+		return presence * (filter.firestore_op == "NOT_IN" ? 1.0 - fraction : fraction);
+	}
+	if (filter.firestore_op == "EQUAL") {
+		return presence / distinct;
+	}
+	if (filter.firestore_op == "NOT_EQUAL") {
+		return presence * (1.0 - 1.0 / distinct);
+	}
+
+	double value;
+	if (!field->has_range || !GetNumericFirestoreValue(filter.firestore_value, value)) {
+		return presence * kDefaultRangeSelectivity;
+	}
+	if (field->max <= field->min) {
+		return presence * 0.5;
+	}
+	double below = std::min(std::max((value - field->min) / (field->max - field->min), 0.0), 1.0);
+	bool is_lower_bound = filter.firestore_op == "GREATER_THAN" || filter.firestore_op == "GREATER_THAN_OR_EQUAL";
+	return presence * (is_lower_bound ? 1.0 - below : below);
+}
+
 FirestoreFilterResult MatchFiltersToIndexes(const std::vector<FirestorePushdownFilter> &candidate_filters,
                                             const FirestoreIndexCache &index_cache, bool is_collection_group) {
 	FirestoreFilterResult result;
@@ -309,8 +487,13 @@ FirestoreFilterResult MatchFiltersToIndexes(const std::vector<FirestorePushdownF
 	std::vector<const FirestorePushdownFilter *> equality_filters;
 	std::vector<const FirestorePushdownFilter *> range_filters;
 
+	// ORs across fields run as one sub-query per branch, each served by single-field indexes
+	std::vector<const FirestorePushdownFilter *> disjunctions;
+
 	for (auto &f : candidate_filters) {
-		if (f.is_equality || f.is_unary) {
+		if (f.is_disjunction) {
+			disjunctions.push_back(&f);
+		} else if (f.is_equality || f.is_unary) {
 			equality_filters.push_back(&f);
 		} else {
 			range_filters.push_back(&f);
@@ -326,85 +509,142 @@ FirestoreFilterResult MatchFiltersToIndexes(const std::vector<FirestorePushdownF
 				FS_LOG_DEBUG("No single-field index for equality filter on: " + ef->field_path);
 			}
 		}
+		for (auto *df : disjunctions) {
+			bool indexed = std::all_of(df->disjuncts.begin(), df->disjuncts.end(), [&](const FirestorePushdownFilter &d) {
+				return HasSingleFieldIndex(d.field_path, index_cache, required_scope);
+			});
+			if (indexed) {
+				result.pushed_filters.push_back(*df);
+			} else {
+				FS_LOG_DEBUG("No single-field index for every branch of an OR filter");
+			}
+		}
 		return result;
 	}
 
-	// Case 2: Only range filters on a single field
-	if (equality_filters.empty()) {
-		// Check if all range filters are on the same field
-		std::set<std::string> range_fields;
-		for (auto *rf : range_filters) {
-			range_fields.insert(rf->field_path);
+	// With range filters, each OR branch would need its own composite index; DuckDB applies it
+	if (!disjunctions.empty()) {
+		FS_LOG_DEBUG("OR filters combined with range filters are not pushed down");
+	}
+
+	// Ranges on several fields, or equality + range filters: Firestore serves a range on one field
+	// only, and combines it with equalities only through a composite index. Every subset some index
+	// supports is a candidate plan; the most selective one is pushed and DuckDB applies the rest.
+	struct FilterPlan {
+		std::vector<const FirestorePushdownFilter *> filters;
+		double selectivity = 1.0;
+		std::string description;
+	};
+	std::vector<FilterPlan> plans;
+	auto add_plan = [&](std::vector<const FirestorePushdownFilter *> filters, std::string description) {
+		FilterPlan plan;
+		for (auto *f : filters) {
+			plan.selectivity *= EstimateFilterSelectivity(*f, index_cache.sample_stats);
 		}
+		plan.filters = std::move(filters);
+		plan.description = std::move(description);
+		plans.push_back(std::move(plan));
+	};
 
-		if (range_fields.size() == 1) {
-			// Single field range - needs single-field index
-			if (HasSingleFieldIndex(range_filters[0]->field_path, index_cache, required_scope)) {
-				for (auto *rf : range_filters) {
-					result.pushed_filters.push_back(*rf);
-				}
-			} else {
-				FS_LOG_DEBUG("No single-field index for range filter on: " + range_filters[0]->field_path);
-			}
+	// Equality filters alone, merged over their single-field indexes
+	std::vector<const FirestorePushdownFilter *> indexed_equalities;
+	for (auto *ef : equality_filters) {
+		if (HasSingleFieldIndex(ef->field_path, index_cache, required_scope)) {
+			indexed_equalities.push_back(ef);
 		} else {
-			// Firestore doesn't support range on multiple fields
-			// Push down range filters for only the first field
-			std::string first_field = *range_fields.begin();
-			if (HasSingleFieldIndex(first_field, index_cache, required_scope)) {
-				for (auto *rf : range_filters) {
-					if (rf->field_path == first_field) {
-						result.pushed_filters.push_back(*rf);
-					}
-				}
-				FS_LOG_DEBUG("Range on multiple fields; only pushing down filters on: " + first_field);
-			}
+			FS_LOG_DEBUG("No single-field index for equality filter on: " + ef->field_path);
 		}
-		return result;
 	}
-
-	// Case 3: Equality + range on different fields - needs composite index
-	std::set<std::string> eq_field_set;
-	for (auto *ef : equality_filters) {
-		eq_field_set.insert(ef->field_path);
+	if (!indexed_equalities.empty()) {
+		add_plan(indexed_equalities, "single-field indexes");
 	}
 
-	// Collect unique range fields
 	std::set<std::string> range_field_set;
 	for (auto *rf : range_filters) {
 		range_field_set.insert(rf->field_path);
 	}
-
-	// Firestore requires range filters on a single field
-	// Pick the first range field for composite index lookup
-	std::string primary_range_field = *range_field_set.begin();
-
-	bool found_composite = FindMatchingCompositeIndex(eq_field_set, primary_range_field, index_cache, required_scope);
-
-	if (found_composite) {
-		// Push all equality + range filters for the primary range field
-		for (auto *ef : equality_filters) {
-			result.pushed_filters.push_back(*ef);
-		}
+	for (auto &range_field : range_field_set) {
+		std::vector<const FirestorePushdownFilter *> ranges;
 		for (auto *rf : range_filters) {
-			if (rf->field_path == primary_range_field) {
-				result.pushed_filters.push_back(*rf);
+			if (rf->field_path == range_field) {
+				ranges.push_back(rf);
 			}
 		}
-		FS_LOG_DEBUG("Composite index found, pushing down " + std::to_string(result.pushed_filters.size()) +
-		             " filters");
-	} else {
-		// No composite index - fall back to pushing only equality filters
-		FS_LOG_DEBUG("No composite index found for equality+range, pushing only equality filters");
-		for (auto *ef : equality_filters) {
-			if (HasSingleFieldIndex(ef->field_path, index_cache, required_scope)) {
-				result.pushed_filters.push_back(*ef);
+
+		// The range alone, on its single-field index
+		if (HasSingleFieldIndex(range_field, index_cache, required_scope)) {
+			add_plan(ranges, "single-field index on " + range_field);
+		} else {
+			FS_LOG_DEBUG("No single-field index for range filter on: " + range_field);
+		}
+
+		// The range with the equalities a composite index covers
+		for (auto &idx : index_cache.composite_indexes) {
+			if (idx.query_scope != required_scope || idx.state != FirestoreIndex::State::READY) {
+				continue;
+			}
+			std::set<std::string> idx_fields;
+			std::string idx_description;
+			for (auto &f : idx.fields) {
+				if (f.field_path != "__name__") {
+					idx_fields.insert(f.field_path);
+					idx_description += (idx_description.empty() ? "" : ", ") + f.field_path;
+				}
+			}
+			if (idx_fields.find(range_field) == idx_fields.end()) {
+				continue;
+			}
+			std::vector<const FirestorePushdownFilter *> covered;
+			for (auto *ef : equality_filters) {
+				if (idx_fields.find(ef->field_path) != idx_fields.end()) {
+					covered.push_back(ef);
+				}
+			}
+			if (covered.empty()) {
+				continue;
 			}
+			covered.insert(covered.end(), ranges.begin(), ranges.end());
+			add_plan(std::move(covered), "composite index (" + idx_description + ")");
 		}
 	}
 
+	if (plans.empty()) {
+		FS_LOG_DEBUG("No index supports any of the filters, nothing pushed down");
+		return result;
+	}
+
+	// Lowest estimated selectivity first; on a tie, the plan that leaves less work to DuckDB
+	auto best = std::min_element(plans.begin(), plans.end(), [](const FilterPlan &a, const FilterPlan &b) {
+		if (a.selectivity != b.selectivity) {
+			return a.selectivity < b.selectivity;
+		}
+		return a.filters.size() > b.filters.size();
+	});
+	for (auto *f : best->filters) {
+		result.pushed_filters.push_back(*f);
+	}
+
+	char selectivity[32];
+	std::snprintf(selectivity, sizeof(selectivity), "%.3g", best->selectivity);
+	result.plan = best->description + ", est. selectivity " + selectivity;
+	idx_t remaining = candidate_filters.size() - best->filters.size();
+	if (remaining > 0) {
+		result.plan += ", " + std::to_string(remaining) + " filter" + (remaining == 1 ? "" : "s") + " left to DuckDB";
+	}
+	FS_LOG_DEBUG("Chose filter plan from " + std::to_string(plans.size()) + " candidates: " + result.plan);
 	return result;
 }
 
+void CollectConjuncts(const Expression &expr, std::vector<const Expression *> &out) {
+	if (expr.type == ExpressionType::CONJUNCTION_AND) {
+		for (auto &child : expr.Cast<BoundConjunctionExpression>().children) {
+			CollectConjuncts(*child, out);
+		}
+		return;
+	}
+	out.push_back(&expr);
+}
+
 std::vector<FirestorePushdownFilter> ConvertExpressionToFilters(const Expression &expr, idx_t table_index,
                                                                 const std::vector<std::string> &all_column_names,
                                                                 const std::vector<LogicalType> &all_column_types,
@@ -450,71 +690,61 @@ std::vector<FirestorePushdownFilter> ConvertExpressionToFilters(const Expression
 		return result;
 	}
 
-	// Handle OR conjunction - detect OR-of-equalities-on-same-field pattern for Firestore IN
-	// DuckDB rewrites `x IN ('a', 'b')` to `(x = 'a') OR (x = 'b')`
+	// Handle OR conjunction. DuckDB rewrites `x IN ('a', 'b')` to `(x = 'a') OR (x = 'b')`, so
+	// equalities on one field become a single IN filter. Equalities and IN lists on several
+	// fields become a disjunction, which the scan runs as one sub-query per branch.
 	if (expr.type == ExpressionType::CONJUNCTION_OR) {
 		auto &conj = expr.Cast<BoundConjunctionExpression>();
 		if (conj.children.empty()) {
 			return {};
 		}
 
-		// Check if all children are equality comparisons on the same column
-		std::string common_field;
-		LogicalType common_type;
-		std::vector<json> values;
-
+		std::vector<FirestorePushdownFilter> disjuncts;
 		for (auto &child : conj.children) {
-			// Each child must be a comparison expression with EQUAL
-			if (child->expression_class != ExpressionClass::BOUND_COMPARISON ||
-			    child->type != ExpressionType::COMPARE_EQUAL) {
-				return {}; // Not all children are equalities - can't convert to IN
+			auto converted =
+			    ConvertExpressionToFilters(*child, table_index, all_column_names, all_column_types, column_id_map);
+			if (converted.size() != 1) {
+				return {}; // A branch Firestore cannot evaluate on its own
 			}
-			auto &cmp = child->Cast<BoundComparisonExpression>();
-
-			const BoundColumnRefExpression *col_ref = nullptr;
-			const BoundConstantExpression *const_val = nullptr;
-
-			if (cmp.left->expression_class == ExpressionClass::BOUND_COLUMN_REF &&
-			    cmp.right->expression_class == ExpressionClass::BOUND_CONSTANT) {
-				col_ref = &cmp.left->Cast<BoundColumnRefExpression>();
-				const_val = &cmp.right->Cast<BoundConstantExpression>();
-			} else if (cmp.right->expression_class == ExpressionClass::BOUND_COLUMN_REF &&
-			           cmp.left->expression_class == ExpressionClass::BOUND_CONSTANT) {
-				col_ref = &cmp.right->Cast<BoundColumnRefExpression>();
-				const_val = &cmp.left->Cast<BoundConstantExpression>();
+			auto &branch = converted[0];
+			if (branch.is_disjunction) {
+				// Nested OR: flatten
+				for (auto &nested : branch.disjuncts) {
+					disjuncts.push_back(std::move(nested));
+				}
+			} else if ((branch.is_in_filter && branch.firestore_op == "IN") ||
+			           (!branch.is_unary && !branch.is_in_filter && branch.firestore_op == "EQUAL")) {
+				disjuncts.push_back(std::move(branch));
 			} else {
 				return {};
 			}
-
-			std::string field_name;
-			LogicalType field_type;
-			if (!resolve_column(*col_ref, field_name, field_type)) {
-				return {};
-			}
-
-			if (common_field.empty()) {
-				common_field = field_name;
-				common_type = field_type;
-			} else if (common_field != field_name) {
-				return {}; // Different columns - can't convert to single IN filter
-			}
-
-			values.push_back(DuckDBValueToFirestore(const_val->value, common_type));
 		}
 
-		// Firestore IN filter has a limit of 30 values
-		if (values.size() > 30) {
-			FS_LOG_DEBUG("IN filter on " + common_field + " has " + std::to_string(values.size()) +
-			             " values (max 30), skipping pushdown");
-			return {};
+		bool single_field = std::all_of(disjuncts.begin(), disjuncts.end(), [&](const FirestorePushdownFilter &f) {
+			return f.field_path == disjuncts[0].field_path;
+		});
+		if (single_field) {
+			FirestorePushdownFilter pf;
+			pf.field_path = disjuncts[0].field_path;
+			pf.firestore_op = "IN";
+			pf.is_in_filter = true;
+			pf.is_equality = true;
+			for (auto &f : disjuncts) {
+				if (f.is_in_filter) {
+					pf.in_values.insert(pf.in_values.end(), f.in_values.begin(), f.in_values.end());
+				} else {
+					pf.in_values.push_back(std::move(f.firestore_value));
+				}
+			}
+			DedupeInValues(pf.in_values);
+			result.push_back(std::move(pf));
+			return result;
 		}
 
 		FirestorePushdownFilter pf;
-		pf.field_path = common_field;
-		pf.firestore_op = "IN";
-		pf.is_in_filter = true;
+		pf.is_disjunction = true;
 		pf.is_equality = true;
-		pf.in_values = std::move(values);
+		pf.disjuncts = std::move(disjuncts);
 		result.push_back(std::move(pf));
 		return result;
 	}
@@ -575,9 +805,11 @@ std::vector<FirestorePushdownFilter> ConvertExpressionToFilters(const Expression
 			auto &const_val = op_expr.children[i]->Cast<BoundConstantExpression>();
 			values.push_back(DuckDBValueToFirestore(const_val.value, field_type));
 		}
+		DedupeInValues(values);
 
-		// Firestore IN filter has a limit of 30 values
-		if (values.size() > 30) {
+		// Firestore accepts at most 30 values per NOT_IN filter. NOT_IN is a conjunction, so it
+		// cannot be split into sub-queries like a long IN list.
+		if (expr.type == ExpressionType::COMPARE_NOT_IN && values.size() > kMaxFirestoreDisjunctions) {
 			return {};
 		}
 
@@ -680,4 +912,283 @@ std::vector<FirestorePushdownFilter> ConvertExpressionToFilters(const Expression
 	return {};
 }
 
+void IntersectDocumentIds(std::vector<std::string> &ids, const std::vector<std::string> &other) {
+	std::unordered_set<std::string> keep(other.begin(), other.end());
+	ids.erase(std::remove_if(ids.begin(), ids.end(), [&](const std::string &id) { return !keep.count(id); }),
+	          ids.end());
+}
+
+std::optional<std::vector<std::string>> ExtractDocumentIdLookup(const Expression &expr, idx_t table_index,
+                                                                const std::vector<idx_t> &column_id_map) {
+	auto is_document_id = [&](const Expression &e) -> bool {
+		if (e.expression_class != ExpressionClass::BOUND_COLUMN_REF) {
+			return false;
+		}
+		auto &col_ref = e.Cast<BoundColumnRefExpression>();
+		if (col_ref.binding.table_index != table_index || col_ref.binding.column_index >= column_id_map.size()) {
+			return false;
+		}
+		return column_id_map[col_ref.binding.column_index] == 0;
+	};
+	// NULL never matches, so it contributes no ID
+	auto add_constant = [](const Expression &e, std::vector<std::string> &ids) -> bool {
+		if (e.expression_class != ExpressionClass::BOUND_CONSTANT) {
+			return false;
+		}
+		auto &value = e.Cast<BoundConstantExpression>().value;
+		if (value.type().id() != LogicalTypeId::VARCHAR) {
+			return false;
+		}
+		if (!value.IsNull()) {
+			ids.push_back(StringValue::Get(value));
+		}
+		return true;
+	};
+
+	if (expr.type == ExpressionType::COMPARE_EQUAL && expr.expression_class == ExpressionClass::BOUND_COMPARISON) {
+		auto &cmp = expr.Cast<BoundComparisonExpression>();
+		std::vector<std::string> ids;
+		if ((is_document_id(*cmp.left) && add_constant(*cmp.right, ids)) ||
+		    (is_document_id(*cmp.right) && add_constant(*cmp.left, ids))) {
+			return ids;
+		}
+		return std::nullopt;
+	}
+
+	if (expr.type == ExpressionType::COMPARE_IN) {
+		auto &op_expr = expr.Cast<BoundOperatorExpression>();
+		if (op_expr.children.size() < 2 || !is_document_id(*op_expr.children[0])) {
+			return std::nullopt;
+		}
+		std::vector<std::string> ids;
+		for (size_t i = 1; i < op_expr.children.size(); i++) {
+			if (!add_constant(*op_expr.children[i], ids)) {
+				return std::nullopt;
+			}
+		}
+		return ids;
+	}
+
+	// OR: every branch must be a lookup; the result is the union of their IDs
+	if (expr.type == ExpressionType::CONJUNCTION_OR) {
+		auto &conj = expr.Cast<BoundConjunctionExpression>();
+		std::vector<std::string> ids;
+		for (auto &child : conj.children) {
+			auto child_ids = ExtractDocumentIdLookup(*child, table_index, column_id_map);
+			if (!child_ids) {
+				return std::nullopt;
+			}
+			ids.insert(ids.end(), child_ids->begin(), child_ids->end());
+		}
+		return ids;
+	}
+
+	// AND: other branches only narrow the result further, so any lookup branch bounds it
+	if (expr.type == ExpressionType::CONJUNCTION_AND) {
+		auto &conj = expr.Cast<BoundConjunctionExpression>();
+		std::optional<std::vector<std::string>> ids;
+		for (auto &child : conj.children) {
+			auto child_ids = ExtractDocumentIdLookup(*child, table_index, column_id_map);
+			if (!child_ids) {
+				continue;
+			}
+			if (!ids) {
+				ids = std::move(child_ids);
+			} else {
+				IntersectDocumentIds(*ids, *child_ids);
+			}
+		}
+		return ids;
+	}
+
+	return std::nullopt;
+}
+
+// --- SQL predicates (firestore_delete_where / firestore_update_where) ---
+
+// Top-level field named by a column reference
+static std::string PredicateFieldName(const ParsedExpression &expr, const std::string &predicate) {
+	if (expr.GetExpressionClass() != ExpressionClass::COLUMN_REF) {
+		throw BinderException("Firestore filter '%s': expected a field name, got '%s'", predicate, expr.ToString());
+	}
+	auto &col_ref = expr.Cast<ColumnRefExpression>();
+	if (col_ref.column_names.size() != 1) {
+		throw BinderException("Firestore filter '%s': only top-level fields can be filtered, got '%s'", predicate,
+		                      expr.ToString());
+	}
+	auto &name = col_ref.GetColumnName();
+	if (name == "__document_id") {
+		throw BinderException("Firestore filter '%s': __document_id cannot be filtered; pass the IDs to "
+		                      "firestore_delete_rows / firestore_update_rows instead",
+		                      predicate);
+	}
+	return name;
+}
+
+// Firestore value of a literal: a constant, or a cast of one (TIMESTAMP '2024-01-01')
+static json PredicateLiteralToFirestore(const ParsedExpression &expr, const std::string &predicate) {
+	const ParsedExpression *literal = &expr;
+	const LogicalType *cast_type = nullptr;
+	if (expr.GetExpressionClass() == ExpressionClass::CAST) {
+		auto &cast = expr.Cast<CastExpression>();
+		literal = cast.child.get();
+		cast_type = &cast.cast_type;
+	}
+	if (literal->GetExpressionClass() != ExpressionClass::CONSTANT) {
+		throw BinderException("Firestore filter '%s': expected a literal, got '%s'", predicate, expr.ToString());
+	}
+	auto value = literal->Cast<ConstantExpression>().value;
+	if (value.IsNull()) {
+		throw BinderException("Firestore filter '%s': compare with IS NULL instead of NULL", predicate);
+	}
+	if (cast_type) {
+		value = value.DefaultCastAs(*cast_type);
+	}
+	return DuckDBValueToFirestore(value, value.type());
+}
+
+static void ConvertPredicate(const ParsedExpression &expr, const std::string &predicate,
+                             std::vector<FirestorePushdownFilter> &out) {
+	switch (expr.GetExpressionType()) {
+	case ExpressionType::CONJUNCTION_AND: {
+		for (auto &child : expr.Cast<ConjunctionExpression>().children) {
+			ConvertPredicate(*child, predicate, out);
+		}
+		return;
+	}
+	case ExpressionType::CONJUNCTION_OR: {
+		// Equalities and IN lists on one field become a single IN filter
+		FirestorePushdownFilter pf;
+		pf.firestore_op = "IN";
+		pf.is_in_filter = true;
+		pf.is_equality = true;
+		for (auto &child : expr.Cast<ConjunctionExpression>().children) {
+			std::vector<FirestorePushdownFilter> branch;
+			ConvertPredicate(*child, predicate, branch);
+			bool usable = branch.size() == 1 && !branch[0].is_unary &&
+			              (branch[0].is_in_filter ? branch[0].firestore_op == "IN" : branch[0].firestore_op == "EQUAL") &&
+			              (pf.field_path.empty() || pf.field_path == branch[0].field_path);
+			if (!usable) {
+				throw BinderException("Firestore filter '%s': OR is only supported between equalities on one field",
+				                      predicate);
+			}
+			pf.field_path = branch[0].field_path;
+			if (branch[0].is_in_filter) {
+				pf.in_values.insert(pf.in_values.end(), branch[0].in_values.begin(), branch[0].in_values.end());
+			} else {
+				pf.in_values.push_back(std::move(branch[0].firestore_value));
+			}
+		}
+		DedupeInValues(pf.in_values);
+		if (pf.in_values.size() > kMaxFirestoreDisjunctions) {
+			throw BinderException("Firestore filter '%s': Firestore accepts at most %llu values per IN", predicate,
+			                      kMaxFirestoreDisjunctions);
+		}
+		out.push_back(std::move(pf));
+		return;
+	}
+	case ExpressionType::OPERATOR_IS_NULL:
+	case ExpressionType::OPERATOR_IS_NOT_NULL: {
+		// Firestore's IS_NULL matches explicit nulls only, not documents missing the field
+		auto &op_expr = expr.Cast<OperatorExpression>();
+		FirestorePushdownFilter pf;
+		pf.field_path = PredicateFieldName(*op_expr.children[0], predicate);
+		pf.is_unary = true;
+		pf.unary_op = expr.GetExpressionType() == ExpressionType::OPERATOR_IS_NULL ? "IS_NULL" : "IS_NOT_NULL";
+		pf.is_equality = true;
+		out.push_back(std::move(pf));
+		return;
+	}
+	case ExpressionType::COMPARE_IN:
+	case ExpressionType::COMPARE_NOT_IN: {
+		auto &op_expr = expr.Cast<OperatorExpression>();
+		FirestorePushdownFilter pf;
+		pf.field_path = PredicateFieldName(*op_expr.children[0], predicate);
+		pf.firestore_op = expr.GetExpressionType() == ExpressionType::COMPARE_IN ? "IN" : "NOT_IN";
+		pf.is_in_filter = true;
+		pf.is_equality = true;
+		for (idx_t i = 1; i < op_expr.children.size(); i++) {
+			pf.in_values.push_back(PredicateLiteralToFirestore(*op_expr.children[i], predicate));
+		}
+		DedupeInValues(pf.in_values);
+		if (pf.in_values.size() > kMaxFirestoreDisjunctions) {
+			throw BinderException("Firestore filter '%s': Firestore accepts at most %llu values per IN", predicate,
+			                      kMaxFirestoreDisjunctions);
+		}
+		out.push_back(std::move(pf));
+		return;
+	}
+	case ExpressionType::COMPARE_BETWEEN: {
+		auto &between = expr.Cast<BetweenExpression>();
+		FirestorePushdownFilter lower;
+		lower.field_path = PredicateFieldName(*between.input, predicate);
+		lower.firestore_op = "GREATER_THAN_OR_EQUAL";
+		lower.firestore_value = PredicateLiteralToFirestore(*between.lower, predicate);
+		FirestorePushdownFilter upper;
+		upper.field_path = lower.field_path;
+		upper.firestore_op = "LESS_THAN_OR_EQUAL";
+		upper.firestore_value = PredicateLiteralToFirestore(*between.upper, predicate);
+		out.push_back(std::move(lower));
+		out.push_back(std::move(upper));
+		return;
+	}
+	case ExpressionType::COMPARE_EQUAL:
+	case ExpressionType::COMPARE_NOTEQUAL:
+	case ExpressionType::COMPARE_LESSTHAN:
+	case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+	case ExpressionType::COMPARE_GREATERTHAN:
+	case ExpressionType::COMPARE_GREATERTHANOREQUALTO: {
+		auto &cmp = expr.Cast<ComparisonExpression>();
+		auto cmp_type = expr.GetExpressionType();
+		const ParsedExpression *field = cmp.left.get();
+		const ParsedExpression *literal = cmp.right.get();
+		if (field->GetExpressionClass() != ExpressionClass::COLUMN_REF) {
+			// 5 < x is x > 5
+			std::swap(field, literal);
+			cmp_type = FlipComparisonExpression(cmp_type);
+		}
+		FirestorePushdownFilter pf;
+		pf.field_path = PredicateFieldName(*field, predicate);
+		pf.firestore_value = PredicateLiteralToFirestore(*literal, predicate);
+		switch (cmp_type) {
+		case ExpressionType::COMPARE_EQUAL:
+			pf.firestore_op = "EQUAL";
+			pf.is_equality = true;
+			break;
+		case ExpressionType::COMPARE_NOTEQUAL:
+			pf.firestore_op = "NOT_EQUAL";
+			pf.is_equality = true;
+			break;
+		case ExpressionType::COMPARE_LESSTHAN:
+			pf.firestore_op = "LESS_THAN";
+			break;
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+			pf.firestore_op = "LESS_THAN_OR_EQUAL";
+			break;
+		case ExpressionType::COMPARE_GREATERTHAN:
+			pf.firestore_op = "GREATER_THAN";
+			break;
+		default:
+			pf.firestore_op = "GREATER_THAN_OR_EQUAL";
+			break;
+		}
+		out.push_back(std::move(pf));
+		return;
+	}
+	default:
+		throw BinderException("Firestore filter '%s': '%s' cannot be evaluated by Firestore", predicate,
+		                      expr.ToString());
+	}
+}
+
+std::vector<FirestorePushdownFilter> ParseFirestoreFilterPredicate(const std::string &predicate) {
+	auto expressions = Parser::ParseExpressionList(predicate);
+	if (expressions.size() != 1) {
+		throw BinderException("Firestore filter '%s' must be a single predicate", predicate);
+	}
+	std::vector<FirestorePushdownFilter> filters;
+	ConvertPredicate(*expressions[0], predicate, filters);
+	return filters;
+}
+
 } // namespace duckdb
@@ -0,0 +1,280 @@
+#include "firestore_json_decoder.hpp"
+#include "firestore_error.hpp"
+
+namespace duckdb {
+
+namespace {
+
+// SAX handler that turns a page response into FirestoreDocuments.
+//
+// Structural levels (root, result entries, documents, the fields map) are tracked on a frame
+// stack. Inside the fields map, wanted values are captured into small json subtrees and all
+// other values are skipped by depth counting, so unwanted fields never allocate.
+class DocumentPageSax : public nlohmann::json_sax<json> {
+public:
+	DocumentPageSax(FirestoreListResponse &result, const FirestoreFieldSet *wanted_fields)
+	    : result_(result), wanted_fields_(wanted_fields) {
+	}
+
+	bool null() override {
+		if (capturing()) {
+			return CaptureScalar(json(nullptr));
+		}
+		return true;
+	}
+
+	bool boolean(bool val) override {
+		if (capturing()) {
+			return CaptureScalar(json(val));
+		}
+		return true;
+	}
+
+	bool number_integer(number_integer_t val) override {
+		if (capturing()) {
+			return CaptureScalar(json(val));
+		}
+		return true;
+	}
+
+	bool number_unsigned(number_unsigned_t val) override {
+		if (capturing()) {
+			return CaptureScalar(json(val));
+		}
+		return true;
+	}
+
+	bool number_float(number_float_t val, const string_t &) override {
+		if (capturing()) {
+			return CaptureScalar(json(val));
+		}
+		return true;
+	}
+
+	bool string(string_t &val) override {
+		if (capturing()) {
+			return CaptureScalar(json(std::move(val)));
+		}
+		if (skip_depth_ > 0 || frames_.empty()) {
+			return true;
+		}
+		auto &frame = frames_.back();
+		if (frame.kind == FrameKind::DOCUMENT) {
+			if (frame.key == "name") {
+				doc_.name = std::move(val);
+			} else if (frame.key == "createTime") {
+				doc_.create_time = std::move(val);
+			} else if (frame.key == "updateTime") {
+				doc_.update_time = std::move(val);
+			}
+		} else if (frame.kind == FrameKind::ROOT_OBJECT && frame.key == "nextPageToken") {
+			result_.next_page_token = std::move(val);
+		}
+		return true;
+	}
+
+	bool binary(binary_t &) override {
+		return true;
+	}
+
+	bool start_object(std::size_t) override {
+		if (capturing()) {
+			return CaptureOpen(json::object());
+		}
+		if (skip_depth_ > 0) {
+			skip_depth_++;
+			return true;
+		}
+		if (frames_.empty()) {
+			frames_.push_back({FrameKind::ROOT_OBJECT, {}});
+			return true;
+		}
+
+		auto &parent = frames_.back();
+		switch (parent.kind) {
+		case FrameKind::ROOT_ARRAY:
+			frames_.push_back({FrameKind::RESULT, {}});
+			return true;
+		case FrameKind::DOCUMENT_ARRAY:
+			BeginDocument();
+			return true;
+		case FrameKind::RESULT:
+			if (parent.key == "document" || parent.key == "found") {
+				BeginDocument();
+			} else {
+				skip_depth_ = 1;
+			}
+			return true;
+		case FrameKind::DOCUMENT:
+			if (parent.key == "fields") {
+				doc_.fields = json::object();
+				frames_.push_back({FrameKind::FIELDS, {}});
+			} else {
+				skip_depth_ = 1;
+			}
+			return true;
+		case FrameKind::FIELDS:
+			if (!wanted_fields_ || wanted_fields_->count(parent.key)) {
+				capture_key_ = parent.key;
+				capture_root_ = json::object();
+				capture_stack_.push_back(&capture_root_);
+			} else {
+				skip_depth_ = 1;
+			}
+			return true;
+		default:
+			skip_depth_ = 1;
+			return true;
+		}
+	}
+
+	bool end_object() override {
+		if (capturing()) {
+			return CaptureClose();
+		}
+		if (skip_depth_ > 0) {
+			skip_depth_--;
+			return true;
+		}
+		if (frames_.empty()) {
+			return true;
+		}
+		if (frames_.back().kind == FrameKind::DOCUMENT) {
+			EndDocument();
+		}
+		frames_.pop_back();
+		return true;
+	}
+
+	bool start_array(std::size_t) override {
+		if (capturing()) {
+			return CaptureOpen(json::array());
+		}
+		if (skip_depth_ > 0) {
+			skip_depth_++;
+			return true;
+		}
+		if (frames_.empty()) {
+			frames_.push_back({FrameKind::ROOT_ARRAY, {}});
+			return true;
+		}
+		auto &parent = frames_.back();
+		if (parent.kind == FrameKind::ROOT_OBJECT && parent.key == "documents") {
+			frames_.push_back({FrameKind::DOCUMENT_ARRAY, {}});
+		} else {
+			skip_depth_ = 1;
+		}
+		return true;
+	}
+
+	bool end_array() override {
+		if (capturing()) {
+			return CaptureClose();
+		}
+		if (skip_depth_ > 0) {
+			skip_depth_--;
+			return true;
+		}
+		if (!frames_.empty()) {
+			frames_.pop_back();
+		}
+		return true;
+	}
+
+	bool key(string_t &val) override {
+		if (capturing()) {
+			pending_key_ = std::move(val);
+			return true;
+		}
+		if (skip_depth_ == 0 && !frames_.empty()) {
+			frames_.back().key = std::move(val);
+		}
+		return true;
+	}
+
+	bool parse_error(std::size_t position, const std::string &last_token,
+	                 const nlohmann::detail::exception &ex) override {
+		throw FirestoreError(FirestoreErrorCode::REQUEST_RESPONSE_PARSE,
+		                     "Failed to parse response at byte " + std::to_string(position) + ": " + ex.what());
+	}
+
+private:
+	enum class FrameKind : uint8_t { ROOT_OBJECT, ROOT_ARRAY, RESULT, DOCUMENT_ARRAY, DOCUMENT, FIELDS };
+
+	struct Frame {
+		FrameKind kind;
+		std::string key; // Most recent key seen in this object
+	};
+
+	bool capturing() const {
+		return !capture_stack_.empty();
+	}
+
+	void BeginDocument() {
+		doc_ = FirestoreDocument {};
+		frames_.push_back({FrameKind::DOCUMENT, {}});
+	}
+
+	void EndDocument() {
+		auto last_slash = doc_.name.rfind('/');
+		doc_.document_id = last_slash == std::string::npos ? doc_.name : doc_.name.substr(last_slash + 1);
+		result_.documents.push_back(std::move(doc_));
+	}
+
+	// Insert a value into the innermost open capture container and return a pointer to it
+	json *CaptureInsert(json &&value) {
+		auto &parent = *capture_stack_.back();
+		if (parent.is_array()) {
+			parent.push_back(std::move(value));
+			return &parent.back();
+		}
+		auto &slot = parent[pending_key_];
+		slot = std::move(value);
+		return &slot;
+	}
+
+	bool CaptureScalar(json &&value) {
+		CaptureInsert(std::move(value));
+		return true;
+	}
+
+	bool CaptureOpen(json &&container) {
+		capture_stack_.push_back(CaptureInsert(std::move(container)));
+		return true;
+	}
+
+	bool CaptureClose() {
+		capture_stack_.pop_back();
+		if (capture_stack_.empty()) {
+			// The field value is complete
+			doc_.fields[capture_key_] = std::move(capture_root_);
+		}
+		return true;
+	}
+
+	FirestoreListResponse &result_;
+	const FirestoreFieldSet *wanted_fields_;
+
+	std::vector<Frame> frames_;
+	idx_t skip_depth_ = 0;
+	FirestoreDocument doc_;
+
+	json capture_root_;
+	std::vector<json *> capture_stack_;
+	std::string capture_key_;
+	std::string pending_key_;
+};
+
+} // namespace
+
+FirestoreListResponse DecodeDocumentPage(const std::string &body, const FirestoreFieldSet *wanted_fields) {
+	FirestoreListResponse result;
+	if (body.empty()) {
+		return result;
+	}
+	DocumentPageSax handler(result, wanted_fields);
+	json::sax_parse(body, &handler);
+	return result;
+}
+
+} // namespace duckdb
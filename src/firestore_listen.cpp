@@ -0,0 +1,504 @@
+#include "firestore_listen.hpp"
+#include "firestore_scanner.hpp"
+#include "firestore_path_utils.hpp"
+#include "firestore_logger.hpp"
+#include "duckdb/main/extension/extension_loader.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/planner/expression_iterator.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace duckdb {
+
+// Firestore's Listen RPC is only served over gRPC/WebChannel, not the REST API this extension
+// speaks. firestore_listen therefore re-runs the watched query on an interval, selecting only
+// document names, and diffs the result against the previous snapshot by name and updateTime.
+// Only the documents that were added or modified since are then fetched in full (batchGet),
+// producing the same added / modified / removed events a listener would see. WHERE filters on
+// document columns are evaluated here rather than by DuckDB, so a document that stops matching
+// them is reported as removed instead of silently dropped.
+
+struct FirestoreListenBindData : public TableFunctionData {
+	// Schema, credentials, index cache and candidate pushdown filters, as bound by firestore_scan
+	unique_ptr<FirestoreScanBindData> scan;
+	// Conjunction of the WHERE filters that only read document columns, taken out of the plan by
+	// the filter pushdown callback. Column references are BoundReferenceExpressions into a chunk
+	// laid out like the function's output.
+	unique_ptr<Expression> document_filter;
+	int64_t poll_interval_ms = 5000;
+	int64_t duration_seconds = 0; // 0 = until interrupted or max_events is reached
+	std::optional<int64_t> max_events;
+	bool include_initial = true; // Report the documents present at the first poll as 'added'
+	// Keep the last matching values of every watched document, so removed rows carry them;
+	// otherwise removed rows only have __document_id and __update_time
+	bool removed_values = false;
+};
+
+struct FirestoreChangeEvent {
+	const char *change_type;
+	FirestoreDocument doc;
+};
+
+struct FirestoreListenGlobalState : public GlobalTableFunctionState {
+	using Clock = std::chrono::steady_clock;
+
+	std::unique_ptr<FirestoreClient> client;
+	json structured_query;
+	bool has_filters = false;
+
+	struct KnownDocument {
+		std::string update_time;
+		bool matches = false;     // Passed document_filter at that version
+		FirestoreDocument values; // Only kept with removed_values, while the document matches
+	};
+	// Document name -> version of every document the watched query returned at the last poll
+	std::unordered_map<std::string, KnownDocument> known;
+	bool initialized = false;
+	std::deque<FirestoreChangeEvent> pending;
+
+	Clock::time_point next_poll;
+	std::optional<Clock::time_point> deadline;
+	idx_t emitted = 0;
+	bool finished = false;
+
+	// Value writer per document column (index 0 = first field after __document_id)
+	std::vector<FirestoreColumnWriter> column_writers;
+	FirestoreColumnWriter update_time_writer = nullptr;
+	// Output column types, for the chunks document_filter is evaluated on
+	std::vector<LogicalType> row_types;
+
+	idx_t MaxThreads() const override {
+		return 1;
+	}
+};
+
+static std::string ListenDocumentId(const FirestoreScanBindData &scan, const std::string &name) {
+	if (scan.is_collection_group) {
+		// Collection groups return the path below /documents/, as firestore_scan does
+		const std::string marker = "/documents/";
+		size_t pos = name.find(marker);
+		return pos == std::string::npos ? name : name.substr(pos + marker.length());
+	}
+	size_t slash = name.rfind('/');
+	return slash == std::string::npos ? name : name.substr(slash + 1);
+}
+
+// Replace the column references of `expr` by references into an output-shaped chunk. False when
+// it reads anything but the document columns (__change_type, __update_time, other tables).
+static bool BindToDocumentColumns(unique_ptr<Expression> &expr, idx_t table_index,
+                                  const std::vector<idx_t> &column_id_map, idx_t document_columns) {
+	if (expr->expression_class == ExpressionClass::BOUND_COLUMN_REF) {
+		auto &colref = expr->Cast<BoundColumnRefExpression>();
+		if (colref.depth != 0 || colref.binding.table_index != table_index ||
+		    colref.binding.column_index >= column_id_map.size()) {
+			return false;
+		}
+		auto column = column_id_map[colref.binding.column_index];
+		if (column >= document_columns) {
+			return false;
+		}
+		expr = make_uniq<BoundReferenceExpression>(colref.alias, colref.return_type, column);
+		return true;
+	}
+	bool bound = true;
+	ExpressionIterator::EnumerateChildren(*expr, [&](unique_ptr<Expression> &child) {
+		bound = bound && BindToDocumentColumns(child, table_index, column_id_map, document_columns);
+	});
+	return bound;
+}
+
+// Filters that only read document columns are taken out of the plan and evaluated by Poll (see
+// above); pushable ones also narrow the watched query. Filters on __change_type / __update_time
+// stay in DuckDB.
+static void FirestoreListenFilterPushdown(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                          vector<unique_ptr<Expression>> &filters) {
+	auto &bind_data = bind_data_p->Cast<FirestoreListenBindData>();
+	auto &scan = *bind_data.scan;
+
+	idx_t document_columns = scan.column_names.size() + 1;
+	std::vector<std::string> names(get.names.begin(), get.names.begin() + document_columns);
+	std::vector<LogicalType> types(get.returned_types.begin(), get.returned_types.begin() + document_columns);
+	std::vector<idx_t> column_id_map;
+	for (auto &cid : get.GetColumnIds()) {
+		column_id_map.push_back(cid.GetPrimaryIndex());
+	}
+	bool can_push = scan.index_cache && scan.index_cache->fetch_succeeded;
+
+	for (idx_t i = 0; i < filters.size();) {
+		auto bound = filters[i]->Copy();
+		if (filters[i]->IsVolatile() || !BindToDocumentColumns(bound, get.table_index, column_id_map, document_columns)) {
+			i++;
+			continue;
+		}
+		if (can_push) {
+			auto converted = ConvertExpressionToFilters(*filters[i], get.table_index, names, types, column_id_map);
+			scan.candidate_pushdown_filters.insert(scan.candidate_pushdown_filters.end(),
+			                                       std::make_move_iterator(converted.begin()),
+			                                       std::make_move_iterator(converted.end()));
+		}
+		if (!bind_data.document_filter) {
+			bind_data.document_filter = std::move(bound);
+		} else {
+			bind_data.document_filter = make_uniq<BoundConjunctionExpression>(
+			    ExpressionType::CONJUNCTION_AND, std::move(bind_data.document_filter), std::move(bound));
+		}
+		filters.erase_at(i);
+	}
+}
+
+static unique_ptr<FunctionData> FirestoreListenBind(ClientContext &context, TableFunctionBindInput &input,
+                                                    vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<FirestoreListenBindData>();
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "poll_interval_ms") {
+			result->poll_interval_ms = kv.second.GetValue<int64_t>();
+		} else if (kv.first == "duration_seconds") {
+			result->duration_seconds = kv.second.GetValue<int64_t>();
+		} else if (kv.first == "max_events") {
+			result->max_events = kv.second.GetValue<int64_t>();
+		} else if (kv.first == "include_initial") {
+			result->include_initial = kv.second.GetValue<bool>();
+		} else if (kv.first == "removed_values") {
+			result->removed_values = kv.second.GetValue<bool>();
+		}
+	}
+	if (result->poll_interval_ms < 100) {
+		throw BinderException("firestore_listen: poll_interval_ms must be at least 100");
+	}
+	if (result->duration_seconds < 0) {
+		throw BinderException("firestore_listen: duration_seconds must not be negative");
+	}
+	if (result->max_events.has_value() && result->max_events.value() < 0) {
+		throw BinderException("firestore_listen: max_events must not be negative");
+	}
+	if (IsFirestoreDocumentPathCollection(input.inputs[0].GetValue<string>())) {
+		throw BinderException("firestore_listen: '%s' is a document path, expected a collection",
+		                      input.inputs[0].GetValue<string>());
+	}
+
+	// Same credentials, schema inference and schema cache as firestore_scan
+	result->scan = unique_ptr_cast<FunctionData, FirestoreScanBindData>(
+	    FirestoreScanBind(context, input, return_types, names));
+	result->scan->is_collection_group = !result->scan->collection.empty() && result->scan->collection[0] == '~';
+
+	names.push_back("__change_type");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("__update_time");
+	return_types.push_back(LogicalType::TIMESTAMP);
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> FirestoreListenInitGlobal(ClientContext &context,
+                                                                      TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<FirestoreListenBindData>();
+	auto &scan = *bind_data.scan;
+	auto state = make_uniq<FirestoreListenGlobalState>();
+	state->client = make_uniq<FirestoreClient>(scan.credentials);
+	state->client->SetStats(GetFirestoreQueryStats(context));
+
+	FirestoreFilterResult pushdown;
+	if (!scan.candidate_pushdown_filters.empty() && scan.index_cache && scan.index_cache->fetch_succeeded) {
+		pushdown = MatchFiltersToIndexes(scan.candidate_pushdown_filters, *scan.index_cache, scan.is_collection_group);
+		// Each poll is a single query, so filters that need several are left to DuckDB
+		auto &pushed = pushdown.pushed_filters;
+		pushed.erase(std::remove_if(pushed.begin(), pushed.end(), RequiresSplitting), pushed.end());
+	}
+	state->structured_query =
+	    BuildFilteredStructuredQuery(scan.collection, scan.is_collection_group, pushdown.pushed_filters);
+	state->has_filters = pushdown.has_pushdown();
+
+	for (auto &type : scan.column_types) {
+		state->column_writers.push_back(GetFirestoreColumnWriter(type));
+	}
+	state->update_time_writer = GetFirestoreColumnWriter(LogicalType::TIMESTAMP);
+	state->row_types.push_back(LogicalType::VARCHAR);
+	state->row_types.insert(state->row_types.end(), scan.column_types.begin(), scan.column_types.end());
+	state->row_types.push_back(LogicalType::VARCHAR);
+	state->row_types.push_back(LogicalType::TIMESTAMP);
+
+	state->next_poll = FirestoreListenGlobalState::Clock::now();
+	if (bind_data.duration_seconds > 0) {
+		state->deadline = state->next_poll + std::chrono::seconds(bind_data.duration_seconds);
+	}
+	return std::move(state);
+}
+
+// Read every page of the watched query. Only the document names (plus the fields the cursor
+// resumes on) are selected; each document still carries its updateTime.
+static std::vector<FirestoreDocument> FetchSnapshot(const FirestoreScanBindData &scan,
+                                                    FirestoreListenGlobalState &state) {
+	FirestorePageCursor cursor;
+	cursor.mode = FirestorePageCursor::Mode::RUN_QUERY;
+	cursor.collection = scan.collection;
+	cursor.is_collection_group = scan.is_collection_group;
+	cursor.structured_query = state.structured_query;
+	cursor.structured_query["limit"] = cursor.page_size;
+	json select_fields = json::array({{{"fieldPath", "__name__"}}});
+	for (auto &order : state.structured_query["orderBy"]) {
+		if (order["field"]["fieldPath"] != "__name__") {
+			select_fields.push_back({{"fieldPath", order["field"]["fieldPath"]}});
+		}
+	}
+	cursor.structured_query["select"] = {{"fields", select_fields}};
+
+	std::vector<FirestoreDocument> documents;
+	std::vector<FirestoreDocument> page;
+	while (cursor.NextPage(*state.client, page)) {
+		documents.insert(documents.end(), std::make_move_iterator(page.begin()), std::make_move_iterator(page.end()));
+	}
+	return documents;
+}
+
+// Documents per batchGet request
+static constexpr idx_t kListenBatchGetSize = 100;
+
+// Read the full version of the documents named in `names`. Documents deleted since the snapshot
+// are left out; the next poll reports them.
+static std::vector<FirestoreDocument> FetchDocuments(FirestoreListenGlobalState &state,
+                                                     const std::vector<std::string> &names) {
+	const std::string marker = "/documents/";
+	std::vector<FirestoreDocument> documents;
+	for (idx_t start = 0; start < names.size(); start += kListenBatchGetSize) {
+		std::vector<std::string> paths;
+		for (idx_t i = start; i < MinValue<idx_t>(names.size(), start + kListenBatchGetSize); i++) {
+			auto pos = names[i].find(marker);
+			paths.push_back(pos == std::string::npos ? names[i] : names[i].substr(pos + marker.length()));
+		}
+		auto response = state.client->BatchGetDocuments(paths);
+		documents.insert(documents.end(), std::make_move_iterator(response.documents.begin()),
+		                 std::make_move_iterator(response.documents.end()));
+	}
+	return documents;
+}
+
+// Write __document_id and the document columns of `doc` into `row` of an output-shaped chunk
+static void WriteDocumentRow(const FirestoreScanBindData &scan, const FirestoreListenGlobalState &state,
+                             const FirestoreDocument &doc, DataChunk &chunk, idx_t row) {
+	FlatVector::GetData<string_t>(chunk.data[0])[row] =
+	    StringVector::AddString(chunk.data[0], ListenDocumentId(scan, doc.name));
+	for (idx_t col = 0; col < scan.column_names.size(); col++) {
+		auto field = doc.fields.is_object() ? doc.fields.find(scan.column_names[col]) : doc.fields.end();
+		if (field != doc.fields.end()) {
+			state.column_writers[col](chunk.data[col + 1], row, *field);
+		} else {
+			FlatVector::SetNull(chunk.data[col + 1], row, true);
+		}
+	}
+}
+
+// Whether each of `documents` passes the document filters
+static std::vector<bool> MatchDocuments(ClientContext &context, const FirestoreListenBindData &bind_data,
+                                        const FirestoreListenGlobalState &state,
+                                        const std::vector<FirestoreDocument> &documents) {
+	std::vector<bool> matches(documents.size(), !bind_data.document_filter);
+	if (!bind_data.document_filter) {
+		return matches;
+	}
+	auto &scan = *bind_data.scan;
+	DataChunk chunk;
+	chunk.Initialize(Allocator::Get(context), state.row_types);
+	ExpressionExecutor executor(context, *bind_data.document_filter);
+	SelectionVector sel(STANDARD_VECTOR_SIZE);
+
+	for (idx_t start = 0; start < documents.size(); start += STANDARD_VECTOR_SIZE) {
+		auto count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, documents.size() - start);
+		chunk.Reset();
+		for (idx_t row = 0; row < count; row++) {
+			WriteDocumentRow(scan, state, documents[start + row], chunk, row);
+		}
+		for (idx_t col = scan.column_names.size() + 1; col < chunk.ColumnCount(); col++) {
+			chunk.data[col].SetVectorType(VectorType::CONSTANT_VECTOR);
+			ConstantVector::SetNull(chunk.data[col], true);
+		}
+		chunk.SetCardinality(count);
+		auto matched = executor.SelectExpression(chunk, sel);
+		for (idx_t i = 0; i < matched; i++) {
+			matches[start + sel.get_index(i)] = true;
+		}
+	}
+	return matches;
+}
+
+// A removed event for a document last seen as `known`
+static FirestoreChangeEvent RemovedEvent(const std::string &name,
+                                         FirestoreListenGlobalState::KnownDocument &known) {
+	FirestoreChangeEvent event {"removed", std::move(known.values)};
+	event.doc.name = name;
+	event.doc.update_time = known.update_time;
+	return event;
+}
+
+static void Poll(ClientContext &context, const FirestoreListenBindData &bind_data, FirestoreListenGlobalState &state) {
+	auto &scan = *bind_data.scan;
+	std::vector<FirestoreDocument> snapshot;
+	try {
+		snapshot = FetchSnapshot(scan, state);
+	} catch (const std::exception &e) {
+		if (state.initialized || !state.has_filters) {
+			throw;
+		}
+		// Filters need an index Firestore does not have: watch the whole collection instead,
+		// DuckDB still applies the WHERE clause
+		FS_LOG_WARN("firestore_listen: filtered query failed, watching the whole collection: " +
+		            std::string(e.what()));
+		state.structured_query = BuildFilteredStructuredQuery(scan.collection, scan.is_collection_group, {});
+		state.has_filters = false;
+		snapshot = FetchSnapshot(scan, state);
+	}
+
+	// Documents that are new to the watched query or have a new version since the last poll
+	std::unordered_set<std::string> seen;
+	std::vector<std::string> changed;
+	for (auto &doc : snapshot) {
+		seen.insert(doc.name);
+		auto it = state.known.find(doc.name);
+		if (it == state.known.end() || it->second.update_time != doc.update_time) {
+			changed.push_back(doc.name);
+		}
+	}
+	// Without filters to evaluate or values to keep, a first poll that reports nothing only
+	// needs the versions
+	bool need_values = state.initialized || bind_data.include_initial || bind_data.document_filter ||
+	                   bind_data.removed_values;
+	idx_t fetched = 0;
+	if (!need_values) {
+		for (auto &doc : snapshot) {
+			auto &known = state.known[doc.name];
+			known.update_time = doc.update_time;
+			known.matches = true;
+		}
+	} else {
+		auto documents = FetchDocuments(state, changed);
+		fetched = documents.size();
+		auto matches = MatchDocuments(context, bind_data, state, documents);
+		for (idx_t i = 0; i < documents.size(); i++) {
+			auto &doc = documents[i];
+			auto it = state.known.find(doc.name);
+			bool matched_before = it != state.known.end() && it->second.matches;
+			if (matches[i] && !matched_before && (state.initialized || bind_data.include_initial)) {
+				state.pending.push_back({"added", doc});
+			} else if (matches[i] && matched_before) {
+				state.pending.push_back({"modified", doc});
+			} else if (!matches[i] && matched_before) {
+				// Changed so it no longer matches the filters
+				state.pending.push_back(RemovedEvent(doc.name, it->second));
+			}
+			auto &known = state.known[doc.name];
+			known.update_time = doc.update_time;
+			known.matches = matches[i];
+			known.values = bind_data.removed_values && matches[i] ? std::move(doc) : FirestoreDocument {};
+		}
+	}
+	// Documents deleted, or no longer returned by the pushed filters
+	for (auto it = state.known.begin(); it != state.known.end();) {
+		if (seen.find(it->first) == seen.end()) {
+			if (it->second.matches) {
+				state.pending.push_back(RemovedEvent(it->first, it->second));
+			}
+			it = state.known.erase(it);
+		} else {
+			++it;
+		}
+	}
+	state.initialized = true;
+	FS_LOG_DEBUG("firestore_listen: snapshot of " + std::to_string(snapshot.size()) + " documents, " +
+	             std::to_string(changed.size()) + " changed, " + std::to_string(fetched) + " fetched, " +
+	             std::to_string(state.pending.size()) + " pending events");
+}
+
+// Sleep until the next poll is due. Returns false once the stream should end.
+static bool WaitForNextPoll(ClientContext &context, FirestoreListenGlobalState &state) {
+	while (true) {
+		if (context.interrupted) {
+			return false;
+		}
+		auto now = FirestoreListenGlobalState::Clock::now();
+		if (state.deadline.has_value() && now >= state.deadline.value()) {
+			return false;
+		}
+		if (now >= state.next_poll) {
+			return true;
+		}
+		// Wake up regularly so an interrupt or the deadline is noticed quickly
+		auto wake = MinValue(state.next_poll, now + std::chrono::milliseconds(100));
+		if (state.deadline.has_value()) {
+			wake = MinValue(wake, state.deadline.value());
+		}
+		std::this_thread::sleep_until(wake);
+	}
+}
+
+static void FirestoreListenFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<FirestoreListenBindData>();
+	auto &state = data.global_state->Cast<FirestoreListenGlobalState>();
+	auto &scan = *bind_data.scan;
+
+	// An empty chunk ends the stream, so block until there is something to emit
+	while (!state.finished && state.pending.empty()) {
+		if (bind_data.max_events.has_value() && state.emitted >= static_cast<idx_t>(bind_data.max_events.value())) {
+			state.finished = true;
+			break;
+		}
+		if (!WaitForNextPoll(context, state)) {
+			state.finished = true;
+			break;
+		}
+		Poll(context, bind_data, state);
+		state.next_poll =
+		    FirestoreListenGlobalState::Clock::now() + std::chrono::milliseconds(bind_data.poll_interval_ms);
+	}
+
+	idx_t max_count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, state.pending.size());
+	if (bind_data.max_events.has_value()) {
+		auto limit = static_cast<idx_t>(bind_data.max_events.value());
+		max_count = MinValue(max_count, limit - MinValue(state.emitted, limit));
+	}
+	if (state.finished || max_count == 0) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	idx_t field_count = scan.column_names.size();
+	auto &change_vector = output.data[field_count + 1];
+	auto &update_time_vector = output.data[field_count + 2];
+	for (idx_t row = 0; row < max_count; row++) {
+		auto event = std::move(state.pending.front());
+		state.pending.pop_front();
+		auto &doc = event.doc;
+
+		WriteDocumentRow(scan, state, doc, output, row);
+		FlatVector::GetData<string_t>(change_vector)[row] = StringVector::AddString(change_vector, event.change_type);
+		if (doc.update_time.empty()) {
+			FlatVector::SetNull(update_time_vector, row, true);
+		} else {
+			state.update_time_writer(update_time_vector, row, json {{"timestampValue", doc.update_time}});
+		}
+	}
+	state.emitted += max_count;
+	output.SetCardinality(max_count);
+}
+
+void RegisterFirestoreListenFunction(ExtensionLoader &loader) {
+	TableFunction listen_func("firestore_listen", {LogicalType::VARCHAR}, FirestoreListenFunction,
+	                          FirestoreListenBind, FirestoreListenInitGlobal);
+	listen_func.named_parameters["project_id"] = LogicalType::VARCHAR;
+	listen_func.named_parameters["credentials"] = LogicalType::VARCHAR;
+	listen_func.named_parameters["api_key"] = LogicalType::VARCHAR;
+	listen_func.named_parameters["database"] = LogicalType::VARCHAR;
+	listen_func.named_parameters["poll_interval_ms"] = LogicalType::BIGINT;
+	listen_func.named_parameters["duration_seconds"] = LogicalType::BIGINT;
+	listen_func.named_parameters["max_events"] = LogicalType::BIGINT;
+	listen_func.named_parameters["include_initial"] = LogicalType::BOOLEAN;
+	listen_func.named_parameters["removed_values"] = LogicalType::BOOLEAN;
+	listen_func.pushdown_complex_filter = FirestoreListenFilterPushdown;
+	loader.RegisterFunction(listen_func);
+}
+
+} // namespace duckdb
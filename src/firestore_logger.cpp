@@ -113,9 +113,142 @@ void FileLogSink::Log(const FirestoreLogEntry &entry) {
 	if (!file_.is_open())
 		return;
 
+	auto line = entry.Format();
 	std::lock_guard<std::mutex> lock(mutex_);
-	file_ << entry.Format() << std::endl;
-	file_.flush();
+	file_ << line << '\n';
+	// Warnings and errors are kept even if the process dies before the next Flush()
+	if (entry.level >= FirestoreLogLevel::WARN) {
+		file_.flush();
+	}
+}
+
+void FileLogSink::Flush() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (file_.is_open()) {
+		file_.flush();
+	}
+}
+
+// ============================================================================
+// AsyncLogSink Implementation
+// ============================================================================
+
+// How long the writer sleeps when no producer wakes it
+static constexpr auto kAsyncLogWriterPoll = std::chrono::milliseconds(50);
+
+AsyncLogSink::AsyncLogSink(std::shared_ptr<FirestoreLogSink> inner, size_t capacity) : inner_(std::move(inner)) {
+	// The ring buffer indexes with a mask, so its size is a power of two
+	size_t size = 2;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	slots_ = std::vector<Slot>(size);
+	mask_ = size - 1;
+	for (size_t i = 0; i < size; i++) {
+		slots_[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	writer_ = std::thread(&AsyncLogSink::RunWriter, this);
+}
+
+AsyncLogSink::~AsyncLogSink() {
+	stop_.store(true);
+	wake_cv_.notify_one();
+	if (writer_.joinable()) {
+		writer_.join();
+	}
+}
+
+bool AsyncLogSink::TryPush(const FirestoreLogEntry &entry) {
+	size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+	while (true) {
+		auto &slot = slots_[pos & mask_];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+		if (diff == 0) {
+			// The slot is free; claim it by advancing the enqueue position
+			if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				slot.entry = entry;
+				slot.sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			// The writer has not consumed this slot from the previous lap: the buffer is full
+			return false;
+		} else {
+			pos = enqueue_pos_.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool AsyncLogSink::TryPop(FirestoreLogEntry &out) {
+	auto &slot = slots_[dequeue_pos_ & mask_];
+	size_t sequence = slot.sequence.load(std::memory_order_acquire);
+	if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeue_pos_ + 1) < 0) {
+		return false;
+	}
+	out = std::move(slot.entry);
+	slot.sequence.store(dequeue_pos_ + slots_.size(), std::memory_order_release);
+	dequeue_pos_++;
+	return true;
+}
+
+void AsyncLogSink::Log(const FirestoreLogEntry &entry) {
+	if (!TryPush(entry)) {
+		dropped_.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	if (writer_idle_.load(std::memory_order_relaxed)) {
+		wake_cv_.notify_one();
+	}
+}
+
+void AsyncLogSink::Flush() {
+	// Entries are written by the writer thread; waking it is as much as a producer can do
+	wake_cv_.notify_one();
+}
+
+size_t AsyncLogSink::Drain() {
+	size_t written = 0;
+	FirestoreLogEntry entry;
+	while (TryPop(entry)) {
+		inner_->Log(entry);
+		written++;
+	}
+
+	auto dropped = dropped_.load(std::memory_order_relaxed);
+	if (dropped != reported_dropped_) {
+		FirestoreLogEntry notice;
+		notice.level = FirestoreLogLevel::WARN;
+		notice.message = std::to_string(dropped - reported_dropped_) + " log entries dropped (log buffer full)";
+		notice.timestamp = std::chrono::system_clock::now();
+		notice.file = nullptr;
+		notice.line = 0;
+		notice.function = nullptr;
+		inner_->Log(notice);
+		reported_dropped_ = dropped;
+		written++;
+	}
+	if (written > 0) {
+		inner_->Flush();
+	}
+	return written;
+}
+
+void AsyncLogSink::RunWriter() {
+	while (true) {
+		if (Drain() > 0) {
+			continue;
+		}
+		if (stop_.load()) {
+			// Producers may still have been filling slots when stop was requested
+			Drain();
+			return;
+		}
+		std::unique_lock<std::mutex> lock(wake_mutex_);
+		writer_idle_.store(true);
+		wake_cv_.wait_for(lock, kAsyncLogWriterPoll);
+		writer_idle_.store(false);
+	}
 }
 
 // ============================================================================
@@ -134,9 +267,11 @@ void FirestoreLogger::SetLogLevel(FirestoreLogLevel level) {
 	std::lock_guard<std::mutex> lock(mutex_);
 	level_ = level;
 
-	// If enabling logging and still using NullLogSink, switch to stderr
-	if (level != FirestoreLogLevel::NONE && std::dynamic_pointer_cast<NullLogSink>(sink_)) {
-		sink_ = std::make_shared<StderrLogSink>();
+	// If enabling logging and still using NullLogSink, switch to stderr, written off the
+	// logging threads
+	if (level != FirestoreLogLevel::NONE && std::dynamic_pointer_cast<NullLogSink>(std::atomic_load(&sink_))) {
+		std::atomic_store(&sink_, std::shared_ptr<FirestoreLogSink>(
+		                              std::make_shared<AsyncLogSink>(std::make_shared<StderrLogSink>())));
 	}
 }
 
@@ -147,24 +282,23 @@ FirestoreLogLevel FirestoreLogger::GetLogLevel() const {
 
 void FirestoreLogger::SetSink(std::shared_ptr<FirestoreLogSink> sink) {
 	std::lock_guard<std::mutex> lock(mutex_);
-	sink_ = sink ? sink : std::make_shared<NullLogSink>();
+	std::atomic_store(&sink_, sink ? sink : std::make_shared<NullLogSink>());
 }
 
 std::shared_ptr<FirestoreLogSink> FirestoreLogger::GetSink() const {
-	std::lock_guard<std::mutex> lock(mutex_);
-	return sink_;
+	return std::atomic_load(&sink_);
 }
 
 void FirestoreLogger::ResetToDefault() {
 	std::lock_guard<std::mutex> lock(mutex_);
 	level_ = FirestoreLogLevel::NONE;
-	sink_ = std::make_shared<NullLogSink>();
+	std::atomic_store(&sink_, std::shared_ptr<FirestoreLogSink>(std::make_shared<NullLogSink>()));
 }
 
 void FirestoreLogger::Log(FirestoreLogLevel level, const std::string &message, const char *file, int line,
                           const char *function) {
 	// Quick check without lock
-	if (level < level_ || level_ == FirestoreLogLevel::NONE) {
+	if (!ShouldLog(level)) {
 		return;
 	}
 
@@ -176,12 +310,8 @@ void FirestoreLogger::Log(FirestoreLogLevel level, const std::string &message, c
 	entry.line = line;
 	entry.function = function;
 
-	std::shared_ptr<FirestoreLogSink> sink;
-	{
-		std::lock_guard<std::mutex> lock(mutex_);
-		sink = sink_;
-	}
-
+	// Concurrent loggers do not serialize on mutex_, which only orders the setters
+	auto sink = std::atomic_load(&sink_);
 	if (sink) {
 		sink->Log(entry);
 	}
@@ -1,13 +1,21 @@
 #include "firestore_optimizer.hpp"
+#include "firestore_aggregate.hpp"
 #include "firestore_path_utils.hpp"
 #include "firestore_scanner.hpp"
+#include "firestore_settings.hpp"
+#include "firestore_types.hpp"
 #include "firestore_logger.hpp"
 #include "duckdb/planner/operator/logical_get.hpp"
 #include "duckdb/planner/operator/logical_order.hpp"
 #include "duckdb/planner/operator/logical_limit.hpp"
 #include "duckdb/planner/operator/logical_top_n.hpp"
 #include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_comparison_join.hpp"
+#include "duckdb/planner/operator/logical_expression_get.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/execution/expression_executor.hpp"
 #include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
 #include "duckdb/common/enums/logical_operator_type.hpp"
 
 namespace duckdb {
@@ -231,6 +239,13 @@ static void WalkPlanTree(LogicalOperator &op, LogicalOrder *current_order, Logic
 			auto &bind_data = get.bind_data->CastNoConst<FirestoreScanBindData>();
 			bind_data.sql_pushed_order_by.clear();
 			bind_data.sql_pushed_limit.reset();
+			bind_data.join_document_ids.reset();
+			bind_data.find_nearest.reset();
+
+			// Recursive scans read many collections at once, so ORDER BY / LIMIT stay in DuckDB
+			if (bind_data.recursive) {
+				return;
+			}
 
 			// Document-path scans return virtual rows derived from listCollectionIds,
 			// not Firestore documents. Extract ORDER BY / LIMIT into docpath-specific fields.
@@ -338,9 +353,370 @@ static void WalkPlanTree(LogicalOperator &op, LogicalOrder *current_order, Logic
 	projections.resize(saved_projection_size);
 }
 
+// Follow projections and filters down to a firestore_scan, collecting the projections (and,
+// when `filters` is set, the filters) passed
+static LogicalGet *FindFirestoreScan(LogicalOperator &op, std::vector<LogicalProjection *> &projections,
+                                     std::vector<LogicalFilter *> *filters = nullptr) {
+	LogicalOperator *current = &op;
+	while (true) {
+		if (current->type == LogicalOperatorType::LOGICAL_GET) {
+			auto &get = current->Cast<LogicalGet>();
+			return get.function.name == "firestore_scan" && get.bind_data ? &get : nullptr;
+		}
+		if (current->type == LogicalOperatorType::LOGICAL_PROJECTION) {
+			projections.push_back(&current->Cast<LogicalProjection>());
+		} else if (current->type == LogicalOperatorType::LOGICAL_FILTER) {
+			if (filters) {
+				filters->push_back(&current->Cast<LogicalFilter>());
+			}
+		} else {
+			return nullptr;
+		}
+		if (current->children.size() != 1) {
+			return nullptr;
+		}
+		current = current->children[0].get();
+	}
+}
+
+// Collect the values of `colref` when it comes from a VALUES list of constants (possibly under
+// projections). Returns false for any other relation, whose values are unknown until execution.
+static bool TryGetConstantColumnValues(ClientContext &context, LogicalOperator &op,
+                                       const BoundColumnRefExpression &colref, std::vector<std::string> &out) {
+	LogicalOperator *current = &op;
+	ColumnBinding binding = colref.binding;
+	while (current->type == LogicalOperatorType::LOGICAL_PROJECTION) {
+		auto &proj = current->Cast<LogicalProjection>();
+		if (binding.table_index != proj.table_index || binding.column_index >= proj.expressions.size()) {
+			return false;
+		}
+		auto &expr = *proj.expressions[binding.column_index];
+		if (expr.expression_class != ExpressionClass::BOUND_COLUMN_REF || current->children.size() != 1) {
+			return false;
+		}
+		binding = expr.Cast<BoundColumnRefExpression>().binding;
+		current = current->children[0].get();
+	}
+	if (current->type != LogicalOperatorType::LOGICAL_EXPRESSION_GET) {
+		return false;
+	}
+	auto &values = current->Cast<LogicalExpressionGet>();
+	if (binding.table_index != values.table_index) {
+		return false;
+	}
+	for (auto &row : values.expressions) {
+		if (binding.column_index >= row.size() || !row[binding.column_index]->IsFoldable()) {
+			return false;
+		}
+		auto value = ExpressionExecutor::EvaluateScalar(context, *row[binding.column_index]);
+		if (value.IsNull()) {
+			continue; // NULL keys never match
+		}
+		if (value.type().id() != LogicalTypeId::VARCHAR) {
+			return false;
+		}
+		out.push_back(StringValue::Get(value));
+	}
+	return true;
+}
+
+// Whether a join drops the rows of one side that have no partner on the other, so that side
+// can be narrowed to the partner keys without changing the result
+static bool JoinDropsUnmatchedRows(JoinType type, bool is_left_side) {
+	switch (type) {
+	case JoinType::INNER:
+	case JoinType::SEMI:
+	case JoinType::RIGHT_SEMI:
+		return true;
+	case JoinType::RIGHT:
+	case JoinType::RIGHT_ANTI:
+		return is_left_side;
+	case JoinType::LEFT:
+	case JoinType::ANTI:
+	case JoinType::MARK:
+		return !is_left_side;
+	default:
+		return false;
+	}
+}
+
+// Equality joins between firestore_scan.__document_id and a VALUES list restrict the scan to
+// those keys, which it then fetches with batchGet instead of reading the whole collection.
+// The join itself is left in place.
+static void PushDownDocumentIdJoins(ClientContext &context, LogicalOperator &op) {
+	for (auto &child : op.children) {
+		PushDownDocumentIdJoins(context, *child);
+	}
+	if (op.type != LogicalOperatorType::LOGICAL_COMPARISON_JOIN || op.children.size() != 2) {
+		return;
+	}
+	auto &join = op.Cast<LogicalComparisonJoin>();
+	for (idx_t side = 0; side < 2; side++) {
+		if (!JoinDropsUnmatchedRows(join.join_type, side == 0)) {
+			continue;
+		}
+		std::vector<LogicalProjection *> projections;
+		auto *get = FindFirestoreScan(*op.children[side], projections);
+		if (!get) {
+			continue;
+		}
+		auto &bind_data = get->bind_data->CastNoConst<FirestoreScanBindData>();
+		if (bind_data.is_document_path || bind_data.recursive) {
+			continue;
+		}
+		for (auto &cond : join.conditions) {
+			auto &scan_expr = side == 0 ? cond.left : cond.right;
+			auto &key_expr = side == 0 ? cond.right : cond.left;
+			if (cond.comparison != ExpressionType::COMPARE_EQUAL ||
+			    scan_expr->expression_class != ExpressionClass::BOUND_COLUMN_REF ||
+			    key_expr->expression_class != ExpressionClass::BOUND_COLUMN_REF) {
+				continue;
+			}
+			idx_t col_idx;
+			if (!ResolveColumnThroughProjections(scan_expr->Cast<BoundColumnRefExpression>(), *get, projections,
+			                                     col_idx) ||
+			    col_idx >= get->names.size() || get->names[col_idx] != "__document_id") {
+				continue;
+			}
+			std::vector<std::string> keys;
+			if (!TryGetConstantColumnValues(context, *op.children[1 - side], key_expr->Cast<BoundColumnRefExpression>(),
+			                                keys)) {
+				continue;
+			}
+			if (bind_data.join_document_ids) {
+				IntersectDocumentIds(*bind_data.join_document_ids, keys);
+			} else {
+				bind_data.join_document_ids = std::move(keys);
+			}
+			FS_LOG_DEBUG("Join on __document_id pushed down as a lookup of " +
+			             std::to_string(bind_data.join_document_ids->size()) + " ids");
+
+			auto &existing = get->extra_info.file_filters;
+			if (!existing.empty()) {
+				existing += " | ";
+			}
+			existing += "Firestore Document Lookup: " + std::to_string(bind_data.join_document_ids->size()) +
+			            " ids (batchGet)";
+		}
+	}
+}
+
+// Distance functions whose ORDER BY findNearest can answer: the Firestore distance measure and
+// the direction that lists the nearest documents first
+static bool GetNearestDistanceMeasure(const std::string &function_name, std::string &measure,
+                                      OrderType &nearest_first) {
+	if (function_name == "array_distance") {
+		measure = "EUCLIDEAN";
+		nearest_first = OrderType::ASCENDING;
+	} else if (function_name == "array_cosine_distance") {
+		measure = "COSINE";
+		nearest_first = OrderType::ASCENDING;
+	} else if (function_name == "array_cosine_similarity") {
+		measure = "COSINE";
+		nearest_first = OrderType::DESCENDING;
+	} else if (function_name == "array_negative_inner_product" || function_name == "array_negative_dot_product") {
+		measure = "DOT_PRODUCT";
+		nearest_first = OrderType::ASCENDING;
+	} else if (function_name == "array_inner_product" || function_name == "array_dot_product") {
+		measure = "DOT_PRODUCT";
+		nearest_first = OrderType::DESCENDING;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+// Follow a column reference through the tracked projections to the expression it names
+static const Expression &ResolveProjectedExpression(const Expression &expr,
+                                                    const std::vector<LogicalProjection *> &projections) {
+	const Expression *current = &expr;
+	while (current->expression_class == ExpressionClass::BOUND_COLUMN_REF) {
+		auto &colref = current->Cast<BoundColumnRefExpression>();
+		LogicalProjection *source = nullptr;
+		for (auto *proj : projections) {
+			if (proj->table_index == colref.binding.table_index) {
+				source = proj;
+				break;
+			}
+		}
+		if (!source || colref.binding.column_index >= source->expressions.size()) {
+			break;
+		}
+		current = source->expressions[colref.binding.column_index].get();
+	}
+	return *current;
+}
+
+// Try to turn ORDER BY <distance>(embedding, <constant vector>) LIMIT `limit` over a
+// firestore_scan into a findNearest search. Every WHERE conjunct has to become a Firestore
+// equality pre-filter: a filter applied only by DuckDB would drop some of the k documents.
+static bool TryExtractNearestSearch(ClientContext &context, LogicalGet &get, const vector<BoundOrderByNode> &orders,
+                                    int64_t limit, const std::vector<LogicalProjection *> &projections,
+                                    const std::vector<LogicalFilter *> &filters) {
+	auto &scan = get.bind_data->CastNoConst<FirestoreScanBindData>();
+	// scan_limit, order_by and document_ids decide the rows the ORDER BY sees; document paths
+	// are not document queries, and recursive scans are one query per collection
+	if (scan.limit.has_value() || !scan.parsed_order_by.empty() || scan.document_ids.has_value() ||
+	    scan.is_document_path || scan.recursive || IsFirestoreDocumentPathCollection(scan.collection) ||
+	    !get.table_filters.filters.empty()) {
+		return false;
+	}
+	if (orders.size() != 1 || limit <= 0 || limit > kMaxFirestoreNearestLimit) {
+		return false;
+	}
+	auto &order = orders[0];
+	// Documents without a vector sort first with NULLS FIRST, and findNearest never returns them
+	if (order.null_order == OrderByNullType::NULLS_FIRST) {
+		return false;
+	}
+
+	auto &distance = ResolveProjectedExpression(*order.expression, projections);
+	if (distance.expression_class != ExpressionClass::BOUND_FUNCTION) {
+		return false;
+	}
+	auto &function = distance.Cast<BoundFunctionExpression>();
+	FirestoreNearestSearch nearest;
+	OrderType nearest_first;
+	if (function.children.size() != 2 ||
+	    !GetNearestDistanceMeasure(function.function.name, nearest.distance_measure, nearest_first)) {
+		return false;
+	}
+	auto direction = order.type == OrderType::DESCENDING ? OrderType::DESCENDING : OrderType::ASCENDING;
+	if (direction != nearest_first) {
+		FS_LOG_DEBUG("Vector search pushdown: ORDER BY lists the farthest documents first");
+		return false;
+	}
+
+	// One argument is the embedding column, the other a constant query vector
+	for (idx_t column_arg = 0; column_arg < 2; column_arg++) {
+		auto &column_expr = *function.children[column_arg];
+		auto &vector_expr = *function.children[1 - column_arg];
+		if (column_expr.expression_class != ExpressionClass::BOUND_COLUMN_REF || !vector_expr.IsFoldable()) {
+			continue;
+		}
+		idx_t col_idx;
+		if (!ResolveColumnThroughProjections(column_expr.Cast<BoundColumnRefExpression>(), get, projections,
+		                                     col_idx) ||
+		    col_idx == 0 || col_idx >= get.names.size()) {
+			continue;
+		}
+		// Firestore vectors are read as ARRAY(DOUBLE, N)
+		auto &column_type = get.returned_types[col_idx];
+		if (column_type.id() != LogicalTypeId::ARRAY ||
+		    ArrayType::GetChildType(column_type).id() != LogicalTypeId::DOUBLE) {
+			continue;
+		}
+		Value query_vector;
+		if (!ExpressionExecutor::EvaluateScalar(context, vector_expr).DefaultTryCastAs(column_type, query_vector) ||
+		    query_vector.IsNull()) {
+			continue;
+		}
+		auto &elements = ArrayValue::GetChildren(query_vector);
+		if (std::any_of(elements.begin(), elements.end(), [](const Value &v) { return v.IsNull(); })) {
+			continue;
+		}
+		nearest.vector_field = get.names[col_idx];
+		nearest.query_vector = DuckDBValueToFirestore(query_vector, column_type);
+		break;
+	}
+	if (nearest.vector_field.empty()) {
+		FS_LOG_DEBUG("Vector search pushdown: distance is not between an embedding column and a constant vector");
+		return false;
+	}
+
+	std::vector<idx_t> column_id_map;
+	for (auto &cid : get.GetColumnIds()) {
+		column_id_map.push_back(cid.GetPrimaryIndex());
+	}
+	std::vector<const Expression *> conjuncts;
+	for (auto *filter : filters) {
+		for (auto &expr : filter->expressions) {
+			CollectConjuncts(*expr, conjuncts);
+		}
+	}
+	for (auto *conjunct : conjuncts) {
+		auto converted =
+		    ConvertExpressionToFilters(*conjunct, get.table_index, get.names, get.returned_types, column_id_map);
+		if (converted.size() != 1) {
+			FS_LOG_DEBUG("Vector search pushdown: WHERE clause has a filter Firestore cannot apply");
+			return false;
+		}
+		auto &f = converted[0];
+		bool is_pre_filter = !f.is_disjunction && !RequiresSplitting(f) &&
+		                     (f.is_unary ? f.unary_op == "IS_NULL" : f.firestore_op == "EQUAL" || f.firestore_op == "IN");
+		if (!is_pre_filter) {
+			FS_LOG_DEBUG("Vector search pushdown: only equality filters can pre-filter findNearest");
+			return false;
+		}
+		nearest.pre_filters.push_back(std::move(f));
+	}
+
+	nearest.limit = limit;
+	FS_LOG_DEBUG("Vector search pushdown: findNearest " + nearest.distance_measure + " on " + nearest.vector_field +
+	             ", limit " + std::to_string(limit));
+
+	auto &existing = get.extra_info.file_filters;
+	if (!existing.empty()) {
+		existing += " | ";
+	}
+	existing += "Firestore Find Nearest: " + nearest.distance_measure + "(" + nearest.vector_field + ") LIMIT " +
+	            std::to_string(limit);
+	scan.find_nearest = std::move(nearest);
+	return true;
+}
+
+// ORDER BY a vector distance + LIMIT over firestore_scan becomes one findNearest query that reads
+// k documents instead of the whole collection. The ORDER BY and LIMIT stay in place.
+static void PushDownNearestSearches(ClientContext &context, LogicalOperator &op) {
+	for (auto &child : op.children) {
+		PushDownNearestSearches(context, *child);
+	}
+	const vector<BoundOrderByNode> *orders = nullptr;
+	LogicalOperator *below = nullptr;
+	int64_t limit = 0;
+	if (op.type == LogicalOperatorType::LOGICAL_TOP_N) {
+		auto &topn = op.Cast<LogicalTopN>();
+		orders = &topn.orders;
+		limit = static_cast<int64_t>(topn.limit + topn.offset);
+		below = op.children[0].get();
+	} else if (op.type == LogicalOperatorType::LOGICAL_LIMIT &&
+	           op.children[0]->type == LogicalOperatorType::LOGICAL_ORDER_BY) {
+		auto &limit_op = op.Cast<LogicalLimit>();
+		if (limit_op.limit_val.Type() != LimitNodeType::CONSTANT_VALUE) {
+			return;
+		}
+		limit = static_cast<int64_t>(limit_op.limit_val.GetConstantValue());
+		if (limit_op.offset_val.Type() == LimitNodeType::CONSTANT_VALUE) {
+			limit += static_cast<int64_t>(limit_op.offset_val.GetConstantValue());
+		} else if (limit_op.offset_val.Type() != LimitNodeType::UNSET) {
+			return;
+		}
+		auto &order = op.children[0]->Cast<LogicalOrder>();
+		orders = &order.orders;
+		below = order.children[0].get();
+	} else {
+		return;
+	}
+
+	std::vector<LogicalProjection *> projections;
+	std::vector<LogicalFilter *> filters;
+	auto *get = FindFirestoreScan(*below, projections, &filters);
+	if (get) {
+		TryExtractNearestSearch(context, *get, *orders, limit, projections, filters);
+	}
+}
+
 void FirestorePreOptimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	if (FirestoreSettings::AggregatePushdown(input.context)) {
+		PushDownFirestoreAggregates(input.context, plan);
+	}
+
 	std::vector<LogicalProjection *> projections;
 	WalkPlanTree(*plan, nullptr, nullptr, nullptr, projections);
+	PushDownDocumentIdJoins(input.context, *plan);
+	if (FirestoreSettings::VectorSearchPushdown(input.context)) {
+		PushDownNearestSearches(input.context, *plan);
+	}
 }
 
 } // namespace duckdb
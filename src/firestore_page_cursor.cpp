@@ -0,0 +1,189 @@
+#include "firestore_page_cursor.hpp"
+#include "firestore_logger.hpp"
+
+namespace duckdb {
+
+json BuildResumeCursor(const json &structured_query, const FirestoreDocument &last_doc) {
+	json cursor_values = json::array();
+
+	if (structured_query.contains("orderBy")) {
+		for (auto &ob_entry : structured_query["orderBy"]) {
+			std::string fp = ob_entry["field"]["fieldPath"].get<std::string>();
+			if (fp == "__name__") {
+				cursor_values.push_back({{"referenceValue", last_doc.name}});
+			} else if (last_doc.fields.contains(fp)) {
+				cursor_values.push_back(last_doc.fields[fp]);
+			} else {
+				cursor_values.push_back({{"nullValue", nullptr}});
+			}
+		}
+	} else {
+		cursor_values.push_back({{"referenceValue", last_doc.name}});
+	}
+
+	return {{"values", cursor_values}, {"before", false}};
+}
+
+std::vector<FirestoreDocument> FirestorePageCursor::FetchPage(FirestoreClient &client) {
+	switch (mode) {
+	case Mode::RUN_QUERY: {
+		json query = structured_query;
+		if (!next_start_at.is_null()) {
+			query["startAt"] = next_start_at;
+		}
+		auto response = client.RunQuery(collection, query, is_collection_group, field_mask);
+		// A short page means the range is drained - no need for a confirming empty fetch.
+		// findNearest returns all of its results at once and cannot be resumed.
+		if (static_cast<int64_t>(response.documents.size()) < page_size || structured_query.contains("findNearest")) {
+			exhausted = true;
+		} else {
+			next_start_at = BuildResumeCursor(structured_query, response.documents.back());
+		}
+		return std::move(response.documents);
+	}
+	case Mode::BATCH_GET: {
+		auto response = client.BatchGetDocuments(document_paths, field_mask);
+		exhausted = true;
+		return std::move(response.documents);
+	}
+	case Mode::LIST_DOCUMENTS:
+	default: {
+		FirestoreQuery query = list_query;
+		query.field_mask = field_mask;
+		if (!next_page_token.empty()) {
+			query.page_token = next_page_token;
+		}
+		auto response = client.ListDocuments(collection, query);
+		next_page_token = response.next_page_token;
+		if (next_page_token.empty()) {
+			exhausted = true;
+		}
+		return std::move(response.documents);
+	}
+	}
+}
+
+void FirestorePageCursor::FetchIntoBuffer(FirestoreClient &client) {
+	if (exhausted) {
+		return;
+	}
+	auto page = FetchPage(client);
+	if (!page.empty()) {
+		buffered_pages.push_back(std::move(page));
+	}
+}
+
+void FirestorePageCursor::StartPrefetch(std::shared_ptr<FirestoreCredentials> credentials,
+                                        std::shared_ptr<FirestoreIOStats> stats, idx_t depth) {
+	if (prefetcher || exhausted || depth == 0) {
+		return;
+	}
+	prefetcher = std::make_unique<FirestorePagePrefetcher>(*this, std::move(credentials), std::move(stats), depth);
+}
+
+bool FirestorePageCursor::NextPage(FirestoreClient &client, std::vector<FirestoreDocument> &out) {
+	while (true) {
+		if (!buffered_pages.empty()) {
+			out = std::move(buffered_pages.front());
+			buffered_pages.pop_front();
+			return true;
+		}
+		if (prefetcher) {
+			return prefetcher->Pop(out);
+		}
+		if (exhausted) {
+			return false;
+		}
+		auto page = FetchPage(client);
+		if (!page.empty()) {
+			out = std::move(page);
+			return true;
+		}
+		// Empty page: ListDocuments may still hand out a next token, so loop until exhausted
+		if (mode != Mode::LIST_DOCUMENTS) {
+			exhausted = true;
+		}
+	}
+}
+
+// ============================================================================
+// FirestorePagePrefetcher
+// ============================================================================
+
+FirestorePagePrefetcher::FirestorePagePrefetcher(FirestorePageCursor &cursor,
+                                                 std::shared_ptr<FirestoreCredentials> credentials,
+                                                 std::shared_ptr<FirestoreIOStats> stats, idx_t depth)
+    : cursor_(cursor), client_(std::move(credentials)), depth_(depth) {
+	client_.SetStats(std::move(stats));
+	worker_ = std::thread(&FirestorePagePrefetcher::Run, this);
+}
+
+FirestorePagePrefetcher::~FirestorePagePrefetcher() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cv_.notify_all();
+	// An in-flight request is allowed to finish; its page is discarded
+	if (worker_.joinable()) {
+		worker_.join();
+	}
+}
+
+void FirestorePagePrefetcher::Run() {
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cv_.wait(lock, [&] { return stop_ || ready_.size() < depth_; });
+			if (stop_) {
+				return;
+			}
+		}
+
+		std::vector<FirestoreDocument> page;
+		bool exhausted;
+		try {
+			page = cursor_.FetchPage(client_);
+			exhausted = cursor_.exhausted;
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			error_ = std::current_exception();
+			done_ = true;
+			cv_.notify_all();
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!page.empty()) {
+			ready_.push_back(std::move(page));
+		}
+		if (exhausted) {
+			done_ = true;
+		}
+		cv_.notify_all();
+		if (done_) {
+			return;
+		}
+	}
+}
+
+bool FirestorePagePrefetcher::Pop(std::vector<FirestoreDocument> &out) {
+	std::unique_lock<std::mutex> lock(mutex_);
+	cv_.wait(lock, [&] { return !ready_.empty() || done_; });
+	if (!ready_.empty()) {
+		out = std::move(ready_.front());
+		ready_.pop_front();
+		lock.unlock();
+		// Room in the queue: let the worker fetch the next page
+		cv_.notify_all();
+		return true;
+	}
+	if (error_) {
+		auto error = error_;
+		error_ = nullptr;
+		std::rethrow_exception(error);
+	}
+	return false;
+}
+
+} // namespace duckdb
@@ -1,4 +1,5 @@
 #include "firestore_path_utils.hpp"
+#include <cctype>
 
 namespace duckdb {
 
@@ -28,4 +29,74 @@ bool IsFirestoreDocumentPathCollection(const std::string &collection) {
 	return IsFirestoreDocumentPath(collection);
 }
 
+int CompareFirestoreDocumentNames(const std::string &left, const std::string &right) {
+	size_t l = 0;
+	size_t r = 0;
+	while (l < left.size() && r < right.size()) {
+		size_t l_end = left.find('/', l);
+		size_t r_end = right.find('/', r);
+		if (l_end == std::string::npos) {
+			l_end = left.size();
+		}
+		if (r_end == std::string::npos) {
+			r_end = right.size();
+		}
+		int cmp = left.compare(l, l_end - l, right, r, r_end - r);
+		if (cmp != 0) {
+			return cmp;
+		}
+		l = l_end + 1;
+		r = r_end + 1;
+	}
+	// The name with fewer segments (an ancestor) sorts first
+	bool left_done = l >= left.size();
+	bool right_done = r >= right.size();
+	if (left_done && right_done) {
+		return 0;
+	}
+	return left_done ? -1 : 1;
+}
+
+std::string GetFirestoreCollectionId(const std::string &collection) {
+	std::string collection_id = collection;
+	if (!collection_id.empty() && collection_id[0] == '~') {
+		collection_id = collection_id.substr(1);
+	}
+	size_t last_slash = collection_id.rfind('/');
+	if (last_slash != std::string::npos) {
+		collection_id = collection_id.substr(last_slash + 1);
+	}
+	return collection_id;
+}
+
+std::string QuoteFirestoreFieldPath(const std::string &field_name) {
+	bool simple = !field_name.empty() && !std::isdigit(static_cast<unsigned char>(field_name[0]));
+	for (char c : field_name) {
+		if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+			simple = false;
+			break;
+		}
+	}
+	if (simple) {
+		return field_name;
+	}
+	std::string quoted = "`";
+	for (char c : field_name) {
+		if (c == '`' || c == '\\') {
+			quoted += '\\';
+		}
+		quoted += c;
+	}
+	quoted += '`';
+	return quoted;
+}
+
+std::string GetFirestoreParentPath(const std::string &document_name) {
+	size_t last_slash = document_name.rfind('/');
+	if (last_slash == std::string::npos) {
+		return "";
+	}
+	return document_name.substr(0, last_slash);
+}
+
 } // namespace duckdb
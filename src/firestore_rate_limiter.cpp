@@ -0,0 +1,134 @@
+#include "firestore_rate_limiter.hpp"
+#include "firestore_logger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace duckdb {
+
+// Responses to one burst arrive together; only the first of them lowers the rate
+static constexpr int64_t kDecreaseCooldownMs = 1000;
+// Stop growing the ceiling after this many ramp-up steps (500 * 1.5^40 is effectively unlimited)
+static constexpr int64_t kMaxRampUpSteps = 40;
+
+FirestoreRateLimiter &FirestoreRateLimiter::Instance() {
+	static FirestoreRateLimiter instance;
+	return instance;
+}
+
+double FirestoreRateLimiter::RampCeiling(const Bucket &bucket, Clock::time_point now) {
+	auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - bucket.ramp_start).count();
+	auto steps = std::min(elapsed / kRampUpIntervalSeconds, kMaxRampUpSteps);
+	return kInitialOpsPerSecond * std::pow(kRampUpFactor, static_cast<double>(steps));
+}
+
+FirestoreRateLimiter::Bucket &FirestoreRateLimiter::GetBucketLocked(const std::string &database,
+                                                                    Clock::time_point now) {
+	auto it = buckets_.find(database);
+	if (it == buckets_.end()) {
+		it = buckets_.emplace(database, Bucket {}).first;
+		auto &bucket = it->second;
+		bucket.ramp_start = now;
+		bucket.last_refill = now;
+		bucket.tokens = kInitialOpsPerSecond;
+		bucket.stats.database = database;
+		return bucket;
+	}
+
+	// Ramp-up only holds for sustained traffic; after an idle interval start over at 500
+	auto &bucket = it->second;
+	if (now - bucket.last_refill > std::chrono::seconds(kRampUpIntervalSeconds)) {
+		bucket.ramp_start = now;
+		bucket.last_refill = now;
+		bucket.current_rate = kInitialOpsPerSecond;
+		bucket.tokens = kInitialOpsPerSecond;
+	}
+	return bucket;
+}
+
+void FirestoreRateLimiter::RefillLocked(Bucket &bucket, Clock::time_point now) {
+	double dt = std::chrono::duration<double>(now - bucket.last_refill).count();
+	double ceiling = RampCeiling(bucket, now);
+	bucket.current_rate = std::min(ceiling, bucket.current_rate + kAdditiveIncreasePerSecond * dt);
+	// At most one second of burst
+	bucket.tokens = std::min(bucket.current_rate, bucket.tokens + bucket.current_rate * dt);
+	bucket.last_refill = now;
+}
+
+void FirestoreRateLimiter::Acquire(const std::string &database, uint64_t ops) {
+	double wait_seconds = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!enabled_ || ops == 0) {
+			return;
+		}
+		auto now = Clock::now();
+		auto &bucket = GetBucketLocked(database, now);
+		RefillLocked(bucket, now);
+
+		// Take the tokens up front (a batch may exceed the burst size) and wait off the debt
+		bucket.tokens -= static_cast<double>(ops);
+		if (bucket.tokens < 0) {
+			wait_seconds = -bucket.tokens / bucket.current_rate;
+		}
+		bucket.stats.granted_ops += ops;
+		bucket.stats.waited_seconds += wait_seconds;
+	}
+	if (wait_seconds > 0) {
+		std::this_thread::sleep_for(std::chrono::duration<double>(wait_seconds));
+	}
+}
+
+void FirestoreRateLimiter::OnThrottled(const std::string &database) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!enabled_) {
+		return;
+	}
+	auto now = Clock::now();
+	auto &bucket = GetBucketLocked(database, now);
+	RefillLocked(bucket, now);
+	bucket.stats.throttled++;
+
+	if (now - bucket.last_decrease < std::chrono::milliseconds(kDecreaseCooldownMs)) {
+		return;
+	}
+	bucket.last_decrease = now;
+	bucket.current_rate = std::max(kMinOpsPerSecond, bucket.current_rate / 2);
+	bucket.tokens = std::min(bucket.tokens, bucket.current_rate);
+	FS_LOG_WARN("Firestore throttled writes to " + database + ", lowering write rate to " +
+	            std::to_string(static_cast<int64_t>(bucket.current_rate)) + " ops/sec");
+}
+
+void FirestoreRateLimiter::SetEnabled(bool enabled) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	enabled_ = enabled;
+}
+
+bool FirestoreRateLimiter::IsEnabled() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return enabled_;
+}
+
+std::vector<FirestoreWriteRateStats> FirestoreRateLimiter::GetStats() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto now = Clock::now();
+	std::vector<FirestoreWriteRateStats> result;
+	for (auto &entry : buckets_) {
+		auto &bucket = entry.second;
+		RefillLocked(bucket, now);
+		auto stats = bucket.stats;
+		stats.ramp_ceiling = RampCeiling(bucket, now);
+		stats.current_rate = bucket.current_rate;
+		result.push_back(std::move(stats));
+	}
+	std::sort(result.begin(), result.end(),
+	          [](const FirestoreWriteRateStats &a, const FirestoreWriteRateStats &b) { return a.database < b.database; });
+	return result;
+}
+
+void FirestoreRateLimiter::Reset() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	buckets_.clear();
+}
+
+} // namespace duckdb
@@ -0,0 +1,77 @@
+#include "firestore_retry.hpp"
+#include <algorithm>
+#include <mutex>
+#include <random>
+
+namespace duckdb {
+
+static std::mutex policy_mutex;
+static FirestoreRetryPolicy policy;
+
+static std::atomic<uint64_t> retries_counter {0};
+static std::atomic<uint64_t> recovered_counter {0};
+static std::atomic<uint64_t> exhausted_counter {0};
+static std::atomic<uint64_t> write_retries_counter {0};
+
+FirestoreRetryPolicy FirestoreRetry::GetPolicy() {
+	std::lock_guard<std::mutex> lock(policy_mutex);
+	return policy;
+}
+
+void FirestoreRetry::SetMaxAttempts(int64_t max_attempts) {
+	std::lock_guard<std::mutex> lock(policy_mutex);
+	policy.max_attempts = std::max<int64_t>(1, max_attempts);
+}
+
+void FirestoreRetry::SetBaseDelayMs(int64_t base_delay_ms) {
+	std::lock_guard<std::mutex> lock(policy_mutex);
+	policy.base_delay_ms = std::max<int64_t>(0, base_delay_ms);
+}
+
+void FirestoreRetry::SetDeadlineMs(int64_t deadline_ms) {
+	std::lock_guard<std::mutex> lock(policy_mutex);
+	policy.deadline_ms = std::max<int64_t>(0, deadline_ms);
+}
+
+bool FirestoreRetry::IsRetryableError(FirestoreErrorCode code) {
+	return IsTransientError(code) || code == FirestoreErrorCode::NETWORK_CURL_PERFORM;
+}
+
+std::chrono::milliseconds FirestoreRetry::BackoffDelay(const FirestoreRetryPolicy &retry_policy, int64_t retry) {
+	if (retry_policy.base_delay_ms <= 0) {
+		return std::chrono::milliseconds(0);
+	}
+	// base * 2^(retry-1), capped, with "equal jitter": half fixed, half random
+	int64_t shift = std::min<int64_t>(retry - 1, 20);
+	int64_t cap = std::min(FirestoreRetryPolicy::kMaxDelayMs, retry_policy.base_delay_ms << shift);
+	thread_local std::mt19937 rng(std::random_device {}());
+	std::uniform_int_distribution<int64_t> dist(cap / 2, cap);
+	return std::chrono::milliseconds(dist(rng));
+}
+
+void FirestoreRetry::RecordRetry() {
+	retries_counter++;
+}
+
+void FirestoreRetry::RecordWriteRetries(uint64_t writes) {
+	write_retries_counter += writes;
+}
+
+void FirestoreRetry::RecordOutcome(bool recovered) {
+	if (recovered) {
+		recovered_counter++;
+	} else {
+		exhausted_counter++;
+	}
+}
+
+FirestoreRetryStats FirestoreRetry::GetStats() {
+	FirestoreRetryStats stats;
+	stats.retries = retries_counter.load();
+	stats.recovered = recovered_counter.load();
+	stats.exhausted = exhausted_counter.load();
+	stats.write_retries = write_retries_counter.load();
+	return stats;
+}
+
+} // namespace duckdb
@@ -5,76 +5,68 @@
 #include "firestore_logger.hpp"
 #include "firestore_error.hpp"
 #include "firestore_path_utils.hpp"
+#include "firestore_schema_cache.hpp"
+#include "firestore_collection_tree.hpp"
 #include "duckdb/main/extension/extension_loader.hpp"
+#include "duckdb/common/limits.hpp"
+#include "duckdb/common/string_util.hpp"
 #include "duckdb/common/types/data_chunk.hpp"
 #include "duckdb/planner/operator/logical_get.hpp"
 #include <algorithm>
 #include <chrono>
+#include <unordered_set>
 
 namespace duckdb {
 
-// Cached schema entry with timestamp
-struct CachedSchemaEntry {
-	std::vector<std::pair<std::string, LogicalType>> schema;
-	std::shared_ptr<FirestoreIndexCache> index_cache;
-	std::chrono::steady_clock::time_point cached_at;
-
-	bool IsExpired(int64_t ttl_seconds) const {
-		if (ttl_seconds == 0) {
-			return true; // Cache disabled
-		}
-		auto age = std::chrono::steady_clock::now() - cached_at;
-		return age > std::chrono::seconds(ttl_seconds);
-	}
-};
-
-static std::unordered_map<std::string, CachedSchemaEntry> &GetSchemaCache() {
-	static std::unordered_map<std::string, CachedSchemaEntry> schema_cache;
-	return schema_cache;
-}
-
-static std::mutex &GetSchemaCacheMutex() {
-	static std::mutex schema_cache_mutex;
-	return schema_cache_mutex;
-}
-
 // Function to clear the schema cache (exposed for testing/manual refresh)
 // If collection is empty, clears entire cache. Otherwise clears entries matching the collection.
-void ClearFirestoreSchemaCache(const std::string &collection) {
-	auto &schema_cache = GetSchemaCache();
-	auto &schema_cache_mutex = GetSchemaCacheMutex();
-	std::lock_guard<std::mutex> lock(schema_cache_mutex);
-	if (collection.empty()) {
-		schema_cache.clear();
-		FS_LOG_DEBUG("Schema cache cleared (all entries)");
-	} else {
-		// Clear entries that match the collection (cache key format is "project_id:database_id:collection")
-		auto it = schema_cache.begin();
-		int cleared = 0;
-		while (it != schema_cache.end()) {
-			// Check if the cache key ends with ":collection"
-			const std::string &key = it->first;
-			size_t colon_pos = key.rfind(':'); // Find LAST colon to extract collection
-			if (colon_pos != std::string::npos) {
-				std::string cached_collection = key.substr(colon_pos + 1);
-				if (cached_collection == collection) {
-					it = schema_cache.erase(it);
-					cleared++;
-					continue;
-				}
-			}
-			++it;
+void ClearFirestoreSchemaCache(const std::string &collection, const std::string &cache_dir) {
+	FirestoreSchemaCache::Instance().Clear(collection, cache_dir);
+}
+
+// Fetch index metadata for filter pushdown on `collection`
+static std::shared_ptr<FirestoreIndexCache> FetchIndexCache(FirestoreClient &client, const std::string &collection) {
+	auto index_cache = std::make_shared<FirestoreIndexCache>();
+	try {
+		// Determine collection ID for index lookup
+		std::string collection_id = collection;
+		if (!collection_id.empty() && collection_id[0] == '~') {
+			collection_id = collection_id.substr(1);
 		}
-		FS_LOG_DEBUG("Schema cache cleared for collection '" + collection + "': " + std::to_string(cleared) +
-		             " entries removed");
-		if (cleared == 0) {
-			FS_LOG_WARN("No cache entries found for collection: " + collection);
+		// For nested paths like "users/user1/orders", use the last segment
+		size_t last_slash = collection_id.rfind('/');
+		if (last_slash != std::string::npos) {
+			collection_id = collection_id.substr(last_slash + 1);
 		}
+
+		index_cache->composite_indexes = client.FetchCompositeIndexes(collection_id);
+		index_cache->default_single_field_enabled = client.CheckDefaultSingleFieldIndexes();
+		index_cache->fetch_succeeded = true;
+		FS_LOG_DEBUG("Index cache populated: " + std::to_string(index_cache->composite_indexes.size()) +
+		             " composite indexes, default_single_field=" +
+		             (index_cache->default_single_field_enabled ? "true" : "false"));
+	} catch (const std::exception &e) {
+		// Admin API unavailable (e.g. emulator, insufficient permissions).
+		// Assume Firestore's default single-field indexes exist for every field.
+		// Composite index queries may fail at RunQuery time, but the existing
+		// fallback (catch in InitGlobal) handles that gracefully.
+		FS_LOG_WARN("Failed to fetch indexes (Admin API unavailable): " + std::string(e.what()) +
+		            ". Assuming default single-field indexes.");
+		index_cache->fetch_succeeded = true;
+		index_cache->default_single_field_enabled = true;
 	}
+	return index_cache;
 }
 
 // Format a pushdown filter for EXPLAIN output
 static string FormatPushdownFilter(const FirestorePushdownFilter &f) {
+	if (f.is_disjunction) {
+		string branches;
+		for (auto &branch : f.disjuncts) {
+			branches += (branches.empty() ? "" : " OR ") + FormatPushdownFilter(branch);
+		}
+		return "(" + branches + ")";
+	}
 	if (f.is_unary) {
 		return f.field_path + " " + f.unary_op;
 	}
@@ -131,13 +123,12 @@ static bool CanOrderByOnServer(const std::vector<OrderByField> &order_by_fields,
 static void FirestoreComplexFilterPushdown(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
                                            vector<unique_ptr<Expression>> &filters) {
 	auto &bind_data = bind_data_p->Cast<FirestoreScanBindData>();
-
-	if (!bind_data.index_cache || !bind_data.index_cache->fetch_succeeded) {
+	// The indexes of the root collection say nothing about its subcollections, and __document_id
+	// names full paths, so recursive scans leave every filter to DuckDB
+	if (bind_data.recursive) {
 		return;
 	}
 
-	bind_data.candidate_pushdown_filters.clear();
-
 	// Build column_id_map: maps binding.column_index -> original column index in get.names
 	// binding.column_index is the position in LogicalGet's column_ids array
 	std::vector<idx_t> column_id_map;
@@ -147,6 +138,33 @@ static void FirestoreComplexFilterPushdown(ClientContext &context, LogicalGet &g
 		column_id_map.push_back(cid.GetPrimaryIndex());
 	}
 
+	// __document_id = / IN (...) turns the scan into batchGet lookups; it needs no index.
+	// The filters vector is a conjunction, so lookups from several filters are intersected.
+	bind_data.filter_document_ids.reset();
+	for (auto &filter : filters) {
+		auto ids = ExtractDocumentIdLookup(*filter, get.table_index, column_id_map);
+		if (!ids) {
+			continue;
+		}
+		if (!bind_data.filter_document_ids) {
+			bind_data.filter_document_ids = std::move(ids);
+		} else {
+			IntersectDocumentIds(*bind_data.filter_document_ids, *ids);
+		}
+	}
+	if (bind_data.filter_document_ids) {
+		auto &existing = get.extra_info.file_filters;
+		std::string info = "Firestore Document Lookup: " +
+		                   std::to_string(bind_data.filter_document_ids->size()) + " ids (batchGet)";
+		existing = existing.empty() ? info : info + " | " + existing;
+	}
+
+	if (!bind_data.index_cache || !bind_data.index_cache->fetch_succeeded) {
+		return;
+	}
+
+	bind_data.candidate_pushdown_filters.clear();
+
 	for (auto &filter : filters) {
 		auto converted =
 		    ConvertExpressionToFilters(*filter, get.table_index, get.names, get.returned_types, column_id_map);
@@ -155,8 +173,9 @@ static void FirestoreComplexFilterPushdown(ClientContext &context, LogicalGet &g
 		                                            std::make_move_iterator(converted.end()));
 	}
 
-	// Match against indexes now to populate EXPLAIN output
-	if (!bind_data.candidate_pushdown_filters.empty()) {
+	// Match against indexes now to populate EXPLAIN output. Lookups do not send filters.
+	if (!bind_data.candidate_pushdown_filters.empty() && !bind_data.filter_document_ids &&
+	    !bind_data.document_ids && !bind_data.join_document_ids) {
 		bool is_collection_group = !bind_data.collection.empty() && bind_data.collection[0] == '~';
 		auto result =
 		    MatchFiltersToIndexes(bind_data.candidate_pushdown_filters, *bind_data.index_cache, is_collection_group);
@@ -169,6 +188,14 @@ static void FirestoreComplexFilterPushdown(ClientContext &context, LogicalGet &g
 				}
 				info += FormatPushdownFilter(f);
 			}
+			bool may_overlap;
+			auto sub_queries = SplitDisjunctiveFilters(result.pushed_filters, may_overlap).size();
+			if (sub_queries > 1) {
+				info += " as " + std::to_string(sub_queries) + " concurrent sub-queries";
+			}
+			if (!result.plan.empty()) {
+				info += " | Firestore Filter Plan: " + result.plan;
+			}
 			// Prepend filter info, preserving any ORDER BY/LIMIT pushdown info
 			// already set by the optimizer extension
 			auto &existing = get.extra_info.file_filters;
@@ -260,6 +287,364 @@ static std::vector<std::string> FetchDocPathIds(FirestoreClient &client, const s
 	return ids;
 }
 
+// Unfiltered page streams: ListDocuments with page tokens for collections. Collection groups
+// have no list endpoint, so they page through runQuery with startAt cursors; __name__ is
+// appended to the order so every resume cursor is unique.
+static void ConfigureListCursor(FirestorePageCursor &cursor, const FirestoreScanBindData &bind_data,
+                                const FirestoreQuery &query) {
+	if (!bind_data.is_collection_group) {
+		cursor.list_query = query;
+		cursor.mode = FirestorePageCursor::Mode::LIST_DOCUMENTS;
+		return;
+	}
+
+	json order_by_arr = json::array();
+	std::string name_direction = "ASCENDING";
+	bool has_name = false;
+	if (query.order_by.has_value()) {
+		for (auto &ob : ParseOrderByString(query.order_by.value())) {
+			order_by_arr.push_back({{"field", {{"fieldPath", ob.field_path}}}, {"direction", ob.direction}});
+			name_direction = ob.direction;
+			has_name = has_name || ob.field_path == "__name__";
+		}
+	}
+	if (!has_name) {
+		order_by_arr.push_back({{"field", {{"fieldPath", "__name__"}}}, {"direction", name_direction}});
+	}
+
+	json sq;
+	sq["from"] = {{{"collectionId", GetFirestoreCollectionId(bind_data.collection)}, {"allDescendants", true}}};
+	sq["orderBy"] = order_by_arr;
+	sq["limit"] = query.page_size;
+
+	cursor.mode = FirestorePageCursor::Mode::RUN_QUERY;
+	cursor.structured_query = sq;
+	cursor.page_size = query.page_size;
+}
+
+// Top-level field names the scan needs from each document: the projected columns, plus the
+// order and filter fields whose values build runQuery resume cursors. Firestore only returns
+// these fields; an empty set (count(*), __document_id-only scans) returns just document names.
+static std::shared_ptr<const FirestoreFieldSet> BuildFieldMask(const FirestoreScanBindData &bind_data,
+                                                               const std::vector<OrderByField> &order_by,
+                                                               const FirestoreFilterResult &pushdown) {
+	auto fields = std::make_shared<FirestoreFieldSet>();
+	for (auto col : bind_data.projected_columns) {
+		if (col != COLUMN_IDENTIFIER_ROW_ID && col < bind_data.column_names.size()) {
+			fields->insert(bind_data.column_names[col]);
+		}
+	}
+	// Nested paths (a.b) resume from the value under their top-level field
+	auto add_path = [&](const std::string &path) {
+		if (path != "__name__" && path != "__document_id") {
+			fields->insert(path.substr(0, path.find('.')));
+		}
+	};
+	for (auto &ob : order_by) {
+		add_path(ob.field_path);
+	}
+	for (auto &f : pushdown.pushed_filters) {
+		// OR branches are equality filters, which never appear in a resume cursor
+		if (!f.is_disjunction) {
+			add_path(f.field_path);
+		}
+	}
+	return fields;
+}
+
+static bool IsOrderedByNameOnly(const json &structured_query) {
+	if (!structured_query.contains("orderBy") || structured_query["orderBy"].size() != 1) {
+		return false;
+	}
+	auto &ob = structured_query["orderBy"][0];
+	return ob["field"]["fieldPath"] == "__name__" && ob["direction"] == "ASCENDING";
+}
+
+static json NameCursor(const std::string &document_name) {
+	return {{"values", {{{"referenceValue", document_name}}}}, {"before", true}};
+}
+
+// Split a name-ordered runQuery into partitionQuery ranges. `probe` has already fetched the
+// first page of the whole scan; the part of it inside the first range is handed to that range.
+// Returns an empty vector when Firestore offers no usable split points.
+static std::vector<FirestorePageCursor> SplitIntoPartitions(FirestoreClient &client, FirestorePageCursor &probe,
+                                                            int64_t partition_count,
+                                                            const FirestoreScanBindData &bind_data) {
+	std::vector<FirestorePageCursor> partitions;
+
+	auto boundaries = client.PartitionQuery(GetFirestoreCollectionId(bind_data.collection), partition_count);
+	if (!bind_data.is_collection_group) {
+		// partitionQuery splits the whole collection group; keep the split points that fall
+		// inside this collection so every range is a valid cursor for the query.
+		std::string collection_path = bind_data.collection;
+		if (!collection_path.empty() && collection_path[0] == '/') {
+			collection_path = collection_path.substr(1);
+		}
+		std::string expected_parent = "projects/" + bind_data.credentials->project_id + "/databases/" +
+		                              bind_data.credentials->database_id + "/documents/" + collection_path;
+		boundaries.erase(std::remove_if(boundaries.begin(), boundaries.end(),
+		                                [&](const std::string &name) {
+			                                return GetFirestoreParentPath(name) != expected_parent;
+		                                }),
+		                 boundaries.end());
+	}
+	if (boundaries.empty()) {
+		return partitions;
+	}
+
+	for (idx_t i = 0; i <= boundaries.size(); i++) {
+		FirestorePageCursor partition;
+		partition.mode = FirestorePageCursor::Mode::RUN_QUERY;
+		partition.collection = probe.collection;
+		partition.is_collection_group = probe.is_collection_group;
+		partition.page_size = probe.page_size;
+		partition.field_mask = probe.field_mask;
+		partition.structured_query = probe.structured_query;
+		if (i > 0) {
+			partition.structured_query["startAt"] = NameCursor(boundaries[i - 1]);
+		}
+		if (i < boundaries.size()) {
+			partition.structured_query["endAt"] = NameCursor(boundaries[i]);
+		}
+		partitions.push_back(std::move(partition));
+	}
+
+	// Reuse the probe page for the first range instead of fetching it again
+	if (!probe.buffered_pages.empty()) {
+		auto &first = partitions[0];
+		auto page = std::move(probe.buffered_pages.front());
+		const auto &first_end = boundaries[0];
+		if (CompareFirestoreDocumentNames(page.back().name, first_end) < 0) {
+			// Whole page lies inside the first range: continue after its last document
+			first.next_start_at = probe.next_start_at;
+			first.exhausted = probe.exhausted;
+		} else {
+			// The page already covers the entire first range
+			page.erase(std::remove_if(page.begin(), page.end(),
+			                          [&](const FirestoreDocument &doc) {
+				                          return CompareFirestoreDocumentNames(doc.name, first_end) >= 0;
+			                          }),
+			           page.end());
+			first.exhausted = true;
+		}
+		if (!page.empty()) {
+			first.buffered_pages.push_back(std::move(page));
+		}
+	}
+
+	FS_LOG_DEBUG("Scan of '" + bind_data.collection + "' split into " + std::to_string(partitions.size()) +
+	             " partitions");
+	return partitions;
+}
+
+// Documents requested per batchGet call; each chunk is a cursor that a scan thread can claim
+static constexpr idx_t kBatchGetChunkSize = 100;
+
+// The document IDs the scan is restricted to, intersecting every lookup source, or nullopt
+// when the scan is not a lookup
+static std::optional<std::vector<std::string>> GetLookupDocumentIds(const FirestoreScanBindData &bind_data) {
+	std::optional<std::vector<std::string>> ids;
+	if (bind_data.recursive) {
+		return ids; // Lookups name documents of the root collection only
+	}
+	for (auto *source : {&bind_data.document_ids, &bind_data.filter_document_ids, &bind_data.join_document_ids}) {
+		if (!source->has_value()) {
+			continue;
+		}
+		if (!ids) {
+			ids = source->value();
+		} else {
+			IntersectDocumentIds(*ids, source->value());
+		}
+	}
+	return ids;
+}
+
+// Document paths to fetch for the lookup IDs, without duplicates. Plain collections match
+// __document_id against the last path segment, so IDs containing '/' can never match there;
+// collection groups match the full path, which must name a document of the group.
+static std::vector<std::string> ResolveLookupPaths(const FirestoreScanBindData &bind_data,
+                                                   const std::vector<std::string> &ids) {
+	std::vector<std::string> paths;
+	std::unordered_set<std::string> seen;
+	auto group_id = GetFirestoreCollectionId(bind_data.collection);
+	for (auto &id : ids) {
+		if (id.empty() || !seen.insert(id).second) {
+			continue;
+		}
+		if (bind_data.is_collection_group) {
+			if (!IsFirestoreDocumentPath(id) || GetFirestoreCollectionId(GetFirestoreParentPath(id)) != group_id) {
+				continue;
+			}
+		} else if (id.find('/') != std::string::npos) {
+			continue;
+		}
+		paths.push_back(ResolveDocumentPath(bind_data.collection, id).document_path);
+	}
+	return paths;
+}
+
+// EXPLAIN: how the scan will query Firestore, decided from the bind data. The query shown is the
+// filtered StructuredQuery before InitGlobal adds the page size, the pushed order and cursors.
+static InsertionOrderPreservingMap<string> FirestoreScanToString(TableFunctionToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	result["Function"] = "FIRESTORE_SCAN";
+	auto &bind_data = input.bind_data->Cast<FirestoreScanBindData>();
+	result["Collection"] = bind_data.collection;
+
+	if (bind_data.is_document_path) {
+		result["Firestore Request"] = "listCollectionIds";
+		return result;
+	}
+	if (bind_data.recursive) {
+		string request = "listCollectionIds walk, then documents.list of every collection";
+		if (bind_data.max_depth > 0) {
+			request += " (max depth " + std::to_string(bind_data.max_depth) + ")";
+		}
+		result["Firestore Request"] = request;
+		return result;
+	}
+	auto lookup_ids = GetLookupDocumentIds(bind_data);
+	if (lookup_ids) {
+		result["Firestore Request"] = "batchGet of " + std::to_string(lookup_ids->size()) + " documents";
+		return result;
+	}
+	if (bind_data.find_nearest) {
+		auto &nearest = bind_data.find_nearest.value();
+		result["Firestore Request"] = "runQuery with findNearest";
+		result["Firestore Find Nearest"] = nearest.distance_measure + " distance to " + nearest.vector_field +
+		                                   ", limit " + std::to_string(nearest.limit);
+		if (!nearest.pre_filters.empty()) {
+			string info;
+			for (auto &f : nearest.pre_filters) {
+				info += (info.empty() ? "" : ", ") + FormatPushdownFilter(f);
+			}
+			result["Firestore Pre-Filters"] = info;
+		}
+		return result;
+	}
+
+	bool is_collection_group = !bind_data.collection.empty() && bind_data.collection[0] == '~';
+	// Candidates are only collected when the index metadata could be fetched
+	auto &candidates = bind_data.candidate_pushdown_filters;
+	FirestoreFilterResult pushdown;
+	if (!candidates.empty() && bind_data.index_cache && bind_data.index_cache->fetch_succeeded) {
+		pushdown = MatchFiltersToIndexes(candidates, *bind_data.index_cache, is_collection_group);
+	}
+
+	idx_t sub_queries = 0;
+	if (pushdown.has_pushdown()) {
+		bool may_overlap;
+		sub_queries = SplitDisjunctiveFilters(pushdown.pushed_filters, may_overlap).size();
+	}
+	if (sub_queries > 1) {
+		result["Firestore Request"] = "runQuery as " + std::to_string(sub_queries) + " concurrent sub-queries";
+	} else if (sub_queries == 1 || is_collection_group) {
+		result["Firestore Request"] = "runQuery";
+		result["Firestore Query"] =
+		    BuildFilteredStructuredQuery(bind_data.collection, is_collection_group, pushdown.pushed_filters).dump();
+	} else {
+		result["Firestore Request"] = "documents.list";
+	}
+
+	if (!candidates.empty()) {
+		std::unordered_set<std::string> pushed;
+		for (auto &f : pushdown.pushed_filters) {
+			pushed.insert(FormatPushdownFilter(f));
+		}
+		string left;
+		for (auto &f : candidates) {
+			auto formatted = FormatPushdownFilter(f);
+			if (!pushed.count(formatted)) {
+				left += (left.empty() ? "" : ", ") + formatted;
+			}
+		}
+		result["Firestore Left to DuckDB"] = left.empty() ? "none (DuckDB re-checks every row)" : left;
+		if (!pushdown.plan.empty()) {
+			result["Firestore Index"] = pushdown.plan;
+		} else if (pushdown.has_pushdown()) {
+			result["Firestore Index"] = "single-field indexes";
+		} else {
+			result["Firestore Index"] = "no index supports the filters";
+		}
+	}
+
+	auto &order_by = !bind_data.parsed_order_by.empty() ? bind_data.parsed_order_by : bind_data.sql_pushed_order_by;
+	if (!order_by.empty()) {
+		string order;
+		for (auto &ob : order_by) {
+			order += (order.empty() ? "" : ", ") + ob.field_path + " " + ob.direction;
+		}
+		result["Firestore Order By"] = order;
+	}
+	auto limit = bind_data.limit.has_value() ? bind_data.limit : bind_data.sql_pushed_limit;
+	if (limit.has_value()) {
+		result["Firestore Limit"] = std::to_string(limit.value());
+	}
+	return result;
+}
+
+// EXPLAIN ANALYZE: what the scan actually sent to Firestore and what it cost
+static InsertionOrderPreservingMap<string> FirestoreScanDynamicToString(TableFunctionDynamicToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	if (!input.global_state) {
+		return result;
+	}
+	auto &global_state = input.global_state->Cast<FirestoreScanGlobalState>();
+
+	if (global_state.pushdown_failed) {
+		result["Firestore Pushdown"] = "rejected by Firestore, all filters applied by DuckDB";
+	}
+	if (global_state.find_nearest_failed) {
+		result["Firestore Find Nearest"] = "not used, DuckDB ranked every document";
+	}
+	if (!global_state.structured_query.is_null()) {
+		result["Firestore Query"] = global_state.structured_query.dump();
+	}
+	if (global_state.cursors.size() > 1) {
+		string kind;
+		switch (global_state.cursors[0].mode) {
+		case FirestorePageCursor::Mode::BATCH_GET:
+			kind = " batchGet chunks";
+			break;
+		case FirestorePageCursor::Mode::RUN_QUERY:
+			kind = global_state.uses_run_query ? " runQuery sub-queries" : " partitions";
+			break;
+		default:
+			kind = " cursors";
+			break;
+		}
+		result["Firestore Streams"] = std::to_string(global_state.cursors.size()) + kind;
+	}
+	if (!global_state.stats) {
+		return result;
+	}
+
+	auto snapshot = global_state.stats->Snapshot();
+	uint64_t requests = 0;
+	string by_endpoint;
+	for (size_t i = 0; i < snapshot.requests.size(); i++) {
+		if (snapshot.requests[i] == 0) {
+			continue;
+		}
+		requests += snapshot.requests[i];
+		by_endpoint += (by_endpoint.empty() ? "" : ", ") +
+		               string(FirestoreEndpointToString(static_cast<FirestoreEndpoint>(i))) + " " +
+		               std::to_string(snapshot.requests[i]);
+	}
+	result["Firestore Requests"] = std::to_string(requests) + (by_endpoint.empty() ? "" : " (" + by_endpoint + ")");
+	if (snapshot.retries > 0) {
+		result["Firestore Retries"] = std::to_string(snapshot.retries);
+	}
+	result["Firestore Pages"] =
+	    std::to_string(snapshot.pages) + " (" + std::to_string(snapshot.documents_read) + " documents)";
+	result["Firestore Round Trips"] = StringUtil::Format("%.1f ms total, p50 %.1f ms, p99 %.1f ms", snapshot.request_ms,
+	                                                     snapshot.latency_p50_ms, snapshot.latency_p99_ms);
+	result["Firestore Bytes"] = StringUtil::BytesToHumanReadableString(snapshot.response_bytes) + " received, " +
+	                            StringUtil::BytesToHumanReadableString(snapshot.request_bytes) + " sent";
+	return result;
+}
+
 void RegisterFirestoreScanFunction(ExtensionLoader &loader) {
 	TableFunction scan_func("firestore_scan", {LogicalType::VARCHAR}, // collection name (required)
 	                        FirestoreScanFunction, FirestoreScanBind, FirestoreScanInitGlobal, FirestoreScanInitLocal);
@@ -272,6 +657,10 @@ void RegisterFirestoreScanFunction(ExtensionLoader &loader) {
 	scan_func.named_parameters["scan_limit"] = LogicalType::BIGINT;
 	scan_func.named_parameters["order_by"] = LogicalType::VARCHAR;
 	scan_func.named_parameters["show_missing"] = LogicalType::BOOLEAN;
+	scan_func.named_parameters["partitions"] = LogicalType::BIGINT;
+	scan_func.named_parameters["document_ids"] = LogicalType::LIST(LogicalType::VARCHAR);
+	scan_func.named_parameters["recursive"] = LogicalType::BOOLEAN;
+	scan_func.named_parameters["max_depth"] = LogicalType::BIGINT;
 
 	// Enable projection pushdown for efficiency
 	scan_func.projection_pushdown = true;
@@ -280,6 +669,10 @@ void RegisterFirestoreScanFunction(ExtensionLoader &loader) {
 	// while leaving all expressions for DuckDB to re-verify (ensuring correct results)
 	scan_func.pushdown_complex_filter = FirestoreComplexFilterPushdown;
 
+	// Pushdown decisions in EXPLAIN, plus the requests actually made in EXPLAIN ANALYZE
+	scan_func.to_string = FirestoreScanToString;
+	scan_func.dynamic_to_string = FirestoreScanDynamicToString;
+
 	loader.RegisterFunction(scan_func);
 }
 
@@ -313,6 +706,45 @@ unique_ptr<FunctionData> FirestoreScanBind(ClientContext &context, TableFunction
 			result->parsed_order_by = ParseOrderByString(result->order_by.value());
 		} else if (kv.first == "show_missing") {
 			result->show_missing = kv.second.GetValue<bool>();
+		} else if (kv.first == "partitions") {
+			result->partitions = kv.second.GetValue<int64_t>();
+		} else if (kv.first == "document_ids") {
+			std::vector<std::string> ids;
+			if (!kv.second.IsNull()) {
+				for (auto &id : ListValue::GetChildren(kv.second)) {
+					if (!id.IsNull()) {
+						ids.push_back(id.GetValue<string>());
+					}
+				}
+			}
+			result->document_ids = std::move(ids);
+		} else if (kv.first == "recursive") {
+			result->recursive = !kv.second.IsNull() && kv.second.GetValue<bool>();
+		} else if (kv.first == "max_depth") {
+			if (kv.second.IsNull()) {
+				continue;
+			}
+			result->max_depth = kv.second.GetValue<int64_t>();
+			if (result->max_depth < 1) {
+				throw BinderException("max_depth must be at least 1");
+			}
+		}
+	}
+
+	if (result->max_depth > 0 && !result->recursive) {
+		throw BinderException("max_depth requires recursive := true");
+	}
+	if (result->recursive) {
+		// One cursor per collection, so rows arrive interleaved and there is no single query to
+		// order or limit; ORDER BY / LIMIT in SQL still work
+		if (!result->collection.empty() && result->collection[0] == '~') {
+			throw BinderException("recursive is not supported for collection group scans");
+		}
+		if (IsFirestoreDocumentPathCollection(result->collection)) {
+			throw BinderException("recursive is not supported for document-path scans");
+		}
+		if (result->limit || result->order_by || result->document_ids) {
+			throw BinderException("recursive cannot be combined with scan_limit, order_by or document_ids");
 		}
 	}
 
@@ -330,6 +762,9 @@ unique_ptr<FunctionData> FirestoreScanBind(ClientContext &context, TableFunction
 	if (IsFirestoreDocumentPathCollection(result->collection)) {
 		// Return subcollection names as virtual __document_id rows.
 		result->is_document_path = true;
+		if (result->document_ids) {
+			throw BinderException("document_ids is not supported for document-path scans");
+		}
 		DocPathOrderType docpath_order = DocPathOrderType::NONE;
 		bool has_supported_docpath_order = result->order_by.has_value()
 		                                       ? TryGetDocPathOrderType(result->order_by.value(), docpath_order)
@@ -350,53 +785,72 @@ unique_ptr<FunctionData> FirestoreScanBind(ClientContext &context, TableFunction
 	std::string cache_key =
 	    result->credentials->project_id + ":" + result->credentials->database_id + ":" + result->collection;
 	int64_t ttl_seconds = FirestoreSettings::SchemaCacheTTLSeconds(context);
-	{
-		auto &schema_cache = GetSchemaCache();
-		auto &schema_cache_mutex = GetSchemaCacheMutex();
-		std::lock_guard<std::mutex> lock(schema_cache_mutex);
-		auto it = schema_cache.find(cache_key);
-		if (it != schema_cache.end() && !it->second.IsExpired(ttl_seconds)) {
-			// Check if cached schema is empty (collection was empty when cached)
-			// If so, remove stale entry and re-infer to get fresh error
-			if (it->second.schema.empty()) {
-				FS_LOG_DEBUG("Removing empty cached schema for collection: " + result->collection);
-				schema_cache.erase(it);
-				// Fall through to re-infer schema
-			} else {
-				// Schema found in cache and not expired, use it
-				FS_LOG_DEBUG("Schema found in cache for collection: " + result->collection);
-				FS_LOG_DEBUG("Cache key: " + cache_key);
-				FS_LOG_DEBUG("Schema cache hit, columns: " + std::to_string(it->second.schema.size()));
-
-				// Always include __document_id as first column
-				names.push_back("__document_id");
-				return_types.push_back(LogicalType::VARCHAR);
-
-				for (const auto &[col_name, col_type] : it->second.schema) {
-					names.push_back(col_name);
-					return_types.push_back(col_type);
-					result->column_names.push_back(col_name);
-					result->column_types.push_back(col_type);
-				}
+	std::string cache_dir = FirestoreSettings::SchemaCacheDir(context);
+	bool revalidate = FirestoreSettings::SchemaCacheStaleWhileRevalidate(context);
+	auto &schema_cache = FirestoreSchemaCache::Instance();
+	FirestoreCachedSchema cached;
+	// In stale-while-revalidate mode an expired entry is still served for up to another TTL
+	// while it is re-inferred in the background
+	int64_t max_age_seconds = ttl_seconds;
+	if (revalidate && ttl_seconds <= NumericLimits<int64_t>::Maximum() / 2) {
+		max_age_seconds = 2 * ttl_seconds;
+	}
+	if (schema_cache.Get(cache_key, max_age_seconds, cache_dir, cached)) {
+		// Check if cached schema is empty (collection was empty when cached)
+		// If so, remove stale entry and re-infer to get fresh error
+		if (cached.schema.empty()) {
+			FS_LOG_DEBUG("Removing empty cached schema for collection: " + result->collection);
+			schema_cache.Remove(cache_key, cache_dir);
+			// Fall through to re-infer schema
+		} else {
+			// Schema found in cache and not expired, use it
+			FS_LOG_DEBUG("Schema found in cache for collection: " + result->collection);
+			FS_LOG_DEBUG("Cache key: " + cache_key);
+			FS_LOG_DEBUG("Schema cache hit, columns: " + std::to_string(cached.schema.size()));
+
+			// Always include __document_id as first column
+			names.push_back("__document_id");
+			return_types.push_back(LogicalType::VARCHAR);
+
+			for (const auto &[col_name, col_type] : cached.schema) {
+				names.push_back(col_name);
+				return_types.push_back(col_type);
+				result->column_names.push_back(col_name);
+				result->column_types.push_back(col_type);
+			}
 
-				// Also restore index cache if available
-				if (it->second.index_cache) {
-					result->index_cache = it->second.index_cache;
-					FS_LOG_DEBUG("Index cache restored from cache");
-				}
+			// Also restore index cache if available
+			if (cached.index_cache) {
+				result->index_cache = cached.index_cache;
+				FS_LOG_DEBUG("Index cache restored from cache");
+			}
 
-				return std::move(result);
+			if (cached.IsExpired(ttl_seconds)) {
+				FS_LOG_DEBUG("Serving stale schema while it is refreshed: " + cache_key);
+				auto credentials = result->credentials;
+				auto collection = result->collection;
+				bool show_missing = result->show_missing;
+				schema_cache.RefreshInBackground(
+				    cache_key, cache_dir, [credentials, collection, show_missing](FirestoreCachedSchema &entry) {
+					    FirestoreClient client(credentials);
+					    FirestoreSampleStats sample_stats;
+					    entry.schema = client.InferSchema(collection, 100, show_missing, &sample_stats);
+					    entry.index_cache = FetchIndexCache(client, collection);
+					    entry.index_cache->sample_stats = std::move(sample_stats);
+					    entry.cached_at = std::chrono::system_clock::now();
+					    return true;
+				    });
 			}
-		} else if (it != schema_cache.end()) {
-			// Cache entry expired, remove it
-			FS_LOG_DEBUG("Schema cache expired for collection: " + result->collection);
-			schema_cache.erase(it);
+
+			return std::move(result);
 		}
 	}
 
 	// Create client and infer schema from collection
 	FirestoreClient client(result->credentials);
-	auto schema = client.InferSchema(result->collection, 100, result->show_missing);
+	client.SetStats(GetFirestoreQueryStats(context));
+	FirestoreSampleStats sample_stats;
+	auto schema = client.InferSchema(result->collection, 100, result->show_missing, &sample_stats);
 
 	// Check if collection exists (has documents)
 	if (schema.empty()) {
@@ -434,52 +888,69 @@ unique_ptr<FunctionData> FirestoreScanBind(ClientContext &context, TableFunction
 	}
 
 	// Fetch index metadata for filter pushdown
-	result->index_cache = std::make_shared<FirestoreIndexCache>();
-	try {
-		// Determine collection ID for index lookup
-		std::string collection_id = result->collection;
-		if (!collection_id.empty() && collection_id[0] == '~') {
-			collection_id = collection_id.substr(1);
-		}
-		// For nested paths like "users/user1/orders", use the last segment
-		size_t last_slash = collection_id.rfind('/');
-		if (last_slash != std::string::npos) {
-			collection_id = collection_id.substr(last_slash + 1);
-		}
-
-		result->index_cache->composite_indexes = client.FetchCompositeIndexes(collection_id);
-		result->index_cache->default_single_field_enabled = client.CheckDefaultSingleFieldIndexes();
-		result->index_cache->fetch_succeeded = true;
-		FS_LOG_DEBUG("Index cache populated: " + std::to_string(result->index_cache->composite_indexes.size()) +
-		             " composite indexes, default_single_field=" +
-		             (result->index_cache->default_single_field_enabled ? "true" : "false"));
-	} catch (const std::exception &e) {
-		// Admin API unavailable (e.g. emulator, insufficient permissions).
-		// Assume Firestore's default single-field indexes exist for every field.
-		// Composite index queries may fail at RunQuery time, but the existing
-		// fallback (catch in InitGlobal) handles that gracefully.
-		FS_LOG_WARN("Failed to fetch indexes (Admin API unavailable): " + std::string(e.what()) +
-		            ". Assuming default single-field indexes.");
-		result->index_cache->fetch_succeeded = true;
-		result->index_cache->default_single_field_enabled = true;
-	}
+	result->index_cache = FetchIndexCache(client, result->collection);
+	result->index_cache->sample_stats = std::move(sample_stats);
 
 	// Store schema and index cache for future queries
-	{
-		auto &schema_cache = GetSchemaCache();
-		auto &schema_cache_mutex = GetSchemaCacheMutex();
-		std::lock_guard<std::mutex> lock(schema_cache_mutex);
-		CachedSchemaEntry entry;
+	if (ttl_seconds > 0) {
+		FirestoreCachedSchema entry;
 		entry.schema = schema;
 		entry.index_cache = result->index_cache;
-		entry.cached_at = std::chrono::steady_clock::now();
-		schema_cache[cache_key] = std::move(entry);
+		entry.cached_at = std::chrono::system_clock::now();
+		schema_cache.Put(cache_key, entry, cache_dir);
 		FS_LOG_DEBUG("Schema cached for: " + cache_key);
 	}
 
 	return std::move(result);
 }
 
+json BuildFilteredStructuredQuery(const std::string &collection, bool is_collection_group,
+                                  const std::vector<FirestorePushdownFilter> &pushed_filters) {
+	json sq;
+	sq["from"] = {{{"collectionId", GetFirestoreCollectionId(collection)}, {"allDescendants", is_collection_group}}};
+	if (!pushed_filters.empty()) {
+		sq["where"] = BuildWhereClause(pushed_filters);
+	}
+
+	// Build orderBy: inequality/range fields first, then __name__ last.
+	// Firestore requires inequality filter fields (range, NOT_EQUAL, NOT_IN,
+	// IS_NOT_NULL) to appear in orderBy before __name__.
+	json order_by_arr = json::array();
+	std::set<std::string> added_fields;
+
+	for (auto &f : pushed_filters) {
+		// Firestore inequality-like operators that require orderBy on the field:
+		// - Range: LESS_THAN, LESS_THAN_OR_EQUAL, GREATER_THAN, GREATER_THAN_OR_EQUAL
+		// - NOT_EQUAL, NOT_IN
+		// - IS_NOT_NULL (unary)
+		// Equality operators (EQUAL, IN) do NOT require orderBy.
+		bool needs_order = false;
+		if (f.is_unary && f.unary_op == "IS_NOT_NULL") {
+			needs_order = true;
+		} else if (!f.is_unary && !f.is_in_filter) {
+			// Check if it's a range or NOT_EQUAL op
+			if (f.firestore_op == "LESS_THAN" || f.firestore_op == "LESS_THAN_OR_EQUAL" ||
+			    f.firestore_op == "GREATER_THAN" || f.firestore_op == "GREATER_THAN_OR_EQUAL" ||
+			    f.firestore_op == "NOT_EQUAL") {
+				needs_order = true;
+			}
+		} else if (f.is_in_filter && f.firestore_op == "NOT_IN") {
+			needs_order = true;
+		}
+
+		if (needs_order && added_fields.find(f.field_path) == added_fields.end()) {
+			order_by_arr.push_back({{"field", {{"fieldPath", f.field_path}}}, {"direction", "ASCENDING"}});
+			added_fields.insert(f.field_path);
+		}
+	}
+
+	// __name__ always last for cursor-based pagination
+	order_by_arr.push_back({{"field", {{"fieldPath", "__name__"}}}, {"direction", "ASCENDING"}});
+
+	sq["orderBy"] = order_by_arr;
+	return sq;
+}
+
 unique_ptr<GlobalTableFunctionState> FirestoreScanInitGlobal(ClientContext &context, TableFunctionInitInput &input) {
 	auto &bind_data = input.bind_data->CastNoConst<FirestoreScanBindData>();
 
@@ -501,11 +972,13 @@ unique_ptr<GlobalTableFunctionState> FirestoreScanInitGlobal(ClientContext &cont
 	}
 
 	auto global_state = make_uniq<FirestoreScanGlobalState>();
+	global_state->stats = std::make_shared<FirestoreIOStats>(GetFirestoreQueryStats(context));
 
 	// Document path mode: fetch all subcollection IDs, sort, then truncate to limit.
 	if (bind_data.is_document_path) {
 		global_state->is_document_path = true;
 		global_state->client = make_uniq<FirestoreClient>(bind_data.credentials);
+		global_state->client->SetStats(global_state->stats);
 
 		auto order = bind_data.docpath_named_order;
 		// Only apply limit at scan level when we also control ordering.
@@ -544,12 +1017,117 @@ unique_ptr<GlobalTableFunctionState> FirestoreScanInitGlobal(ClientContext &cont
 	}
 
 	global_state->client = make_uniq<FirestoreClient>(bind_data.credentials);
+	global_state->client->SetStats(global_state->stats);
+
+	for (auto src_col : bind_data.projected_columns) {
+		global_state->column_writers.push_back(
+		    src_col == COLUMN_IDENTIFIER_ROW_ID ? nullptr : GetFirestoreColumnWriter(bind_data.column_types[src_col]));
+	}
 
 	// Check if this is a collection group query (starts with ~)
 	if (!bind_data.collection.empty() && bind_data.collection[0] == '~') {
 		bind_data.is_collection_group = true;
 	}
 
+	// Document-ID lookups fetch only the named documents, in batchGet chunks that scan threads
+	// claim like partitions. Other filters and the order are left to DuckDB.
+	auto lookup_ids = GetLookupDocumentIds(bind_data);
+	if (lookup_ids) {
+		bind_data.sql_pushed_order_by.clear();
+		bind_data.sql_pushed_limit.reset();
+
+		auto paths = ResolveLookupPaths(bind_data, *lookup_ids);
+		auto field_mask = BuildFieldMask(bind_data, {}, FirestoreFilterResult {});
+		// scan_limit is enforced by a single thread, so a limited lookup is one batchGet
+		idx_t chunk_size = bind_data.limit.has_value() ? MaxValue<idx_t>(paths.size(), 1) : kBatchGetChunkSize;
+		for (idx_t start = 0; start < paths.size(); start += chunk_size) {
+			FirestorePageCursor chunk;
+			chunk.mode = FirestorePageCursor::Mode::BATCH_GET;
+			chunk.collection = bind_data.collection;
+			chunk.is_collection_group = bind_data.is_collection_group;
+			chunk.field_mask = field_mask;
+			auto end = MinValue<idx_t>(start + chunk_size, paths.size());
+			chunk.document_paths.assign(paths.begin() + start, paths.begin() + end);
+			global_state->cursors.push_back(std::move(chunk));
+		}
+		global_state->finished = global_state->cursors.empty();
+		FS_LOG_DEBUG("Document lookup on '" + bind_data.collection + "': " + std::to_string(paths.size()) +
+		             " documents in " + std::to_string(global_state->cursors.size()) + " batchGet calls");
+		return std::move(global_state);
+	}
+
+	// Recursive scans list the root collection and every collection found below it, one cursor
+	// each, so scan threads read several collections at once. Filters, order and limit stay in
+	// DuckDB.
+	if (bind_data.recursive) {
+		bind_data.sql_pushed_order_by.clear();
+		bind_data.sql_pushed_limit.reset();
+
+		auto tree = WalkFirestoreCollectionTree(bind_data.credentials, bind_data.collection, bind_data.max_depth,
+		                                        static_cast<idx_t>(FirestoreSettings::DiscoveryConcurrency(context)),
+		                                        global_state->stats);
+		FirestoreQuery query;
+		query.show_missing = bind_data.show_missing;
+		auto field_mask = BuildFieldMask(bind_data, {}, FirestoreFilterResult {});
+		std::vector<std::string> collections {bind_data.collection};
+		for (auto &entry : tree) {
+			collections.push_back(std::move(entry.path));
+		}
+		for (auto &collection : collections) {
+			FirestorePageCursor cursor;
+			cursor.collection = collection;
+			cursor.field_mask = field_mask;
+			ConfigureListCursor(cursor, bind_data, query);
+			global_state->cursors.push_back(std::move(cursor));
+		}
+		global_state->prefetch_depth = static_cast<idx_t>(FirestoreSettings::ScanPrefetchPages(context));
+		FS_LOG_DEBUG("Recursive scan of '" + bind_data.collection + "': " +
+		             std::to_string(global_state->cursors.size()) + " collections");
+		return std::move(global_state);
+	}
+
+	// Vector search: one findNearest query returns the nearest documents. Documents Firestore
+	// does not rank (no vector in the field) still get a NULL distance in DuckDB, so when the
+	// query returns fewer documents than the limit, or Firestore rejects it (no vector index for
+	// the field and pre-filters), the collection is read and ranked by DuckDB as before.
+	if (bind_data.find_nearest) {
+		auto &nearest = bind_data.find_nearest.value();
+		json sq = BuildFilteredStructuredQuery(bind_data.collection, bind_data.is_collection_group,
+		                                       nearest.pre_filters);
+		// The results come in distance order, which cannot be combined with orderBy
+		sq.erase("orderBy");
+		sq["findNearest"] = {{"vectorField", {{"fieldPath", nearest.vector_field}}},
+		                     {"queryVector", nearest.query_vector},
+		                     {"distanceMeasure", nearest.distance_measure},
+		                     {"limit", nearest.limit}};
+
+		FirestorePageCursor nearest_cursor;
+		nearest_cursor.mode = FirestorePageCursor::Mode::RUN_QUERY;
+		nearest_cursor.collection = bind_data.collection;
+		nearest_cursor.is_collection_group = bind_data.is_collection_group;
+		nearest_cursor.field_mask = BuildFieldMask(bind_data, {}, FirestoreFilterResult {});
+		nearest_cursor.structured_query = sq;
+		nearest_cursor.page_size = nearest.limit;
+		try {
+			nearest_cursor.FetchIntoBuffer(*global_state->client);
+			auto returned = nearest_cursor.buffered_pages.empty() ? 0 : nearest_cursor.buffered_pages.front().size();
+			if (static_cast<int64_t>(returned) == nearest.limit) {
+				FS_LOG_DEBUG("findNearest on '" + bind_data.collection + "' returned " + std::to_string(returned) +
+				             " documents");
+				global_state->structured_query = sq;
+				global_state->uses_run_query = true;
+				global_state->cursors.push_back(std::move(nearest_cursor));
+				global_state->finished = global_state->cursors[0].IsDone();
+				return std::move(global_state);
+			}
+			FS_LOG_DEBUG("findNearest returned " + std::to_string(returned) + " of " +
+			             std::to_string(nearest.limit) + " documents, reading the collection instead");
+		} catch (const std::exception &e) {
+			FS_LOG_WARN("findNearest query failed, reading the collection instead: " + std::string(e.what()));
+		}
+		global_state->find_nearest_failed = true;
+	}
+
 	// Process filter pushdown using candidate filters from pushdown_complex_filter callback
 	if (!bind_data.candidate_pushdown_filters.empty() && bind_data.index_cache &&
 	    bind_data.index_cache->fetch_succeeded) {
@@ -557,27 +1135,82 @@ unique_ptr<GlobalTableFunctionState> FirestoreScanInitGlobal(ClientContext &cont
 		                                                      *bind_data.index_cache, bind_data.is_collection_group);
 	}
 
+	// Long IN lists and ORs across fields become several sub-queries (see SplitDisjunctiveFilters).
+	// Their rows arrive interleaved, so a named order_by / scan_limit, which promise a single
+	// ordered stream, keep those filters in DuckDB instead; SQL ORDER BY / LIMIT stay in DuckDB.
+	bool sub_queries_overlap = false;
+	std::vector<std::vector<FirestorePushdownFilter>> sub_queries;
+	if (global_state->pushdown_result.has_pushdown()) {
+		sub_queries = SplitDisjunctiveFilters(global_state->pushdown_result.pushed_filters, sub_queries_overlap);
+	}
+	if (sub_queries.size() > 1 && (!bind_data.parsed_order_by.empty() || bind_data.limit.has_value())) {
+		FS_LOG_DEBUG("InitGlobal: order_by/scan_limit set, not splitting filters into sub-queries");
+		auto &pushed = global_state->pushdown_result.pushed_filters;
+		pushed.erase(std::remove_if(pushed.begin(), pushed.end(), RequiresSplitting), pushed.end());
+		sub_queries.clear();
+	}
+	if (sub_queries.size() > 1) {
+		bind_data.sql_pushed_order_by.clear();
+		bind_data.sql_pushed_limit.reset();
+	}
+
 	// Compute effective ORDER BY and LIMIT values.
 	// Named parameters (order_by, scan_limit) take precedence over SQL-pushed values.
 	auto &effective_order_by =
 	    !bind_data.parsed_order_by.empty() ? bind_data.parsed_order_by : bind_data.sql_pushed_order_by;
 	auto effective_limit = bind_data.limit.has_value() ? bind_data.limit : bind_data.sql_pushed_limit;
 
-	// Build query and fetch initial documents
-	FirestoreListResponse response;
-
-	if (global_state->pushdown_result.has_pushdown()) {
-		// Build StructuredQuery with WHERE clause
-		std::string collection_id = bind_data.collection;
-		if (bind_data.is_collection_group && !collection_id.empty() && collection_id[0] == '~') {
-			collection_id = collection_id.substr(1);
+	// Partitioned scans return rows in no particular order, so only split when the query
+	// does not ask Firestore for an order or a limit.
+	int64_t requested_partitions =
+	    bind_data.partitions.has_value() ? bind_data.partitions.value() : FirestoreSettings::ScanPartitions(context);
+	bool want_partitions = requested_partitions > 1 && effective_order_by.empty() && !effective_limit.has_value();
+
+	auto field_mask = BuildFieldMask(bind_data, effective_order_by, global_state->pushdown_result);
+
+	FirestorePageCursor cursor;
+	cursor.collection = bind_data.collection;
+	cursor.is_collection_group = bind_data.is_collection_group;
+	cursor.field_mask = field_mask;
+
+	if (sub_queries.size() > 1) {
+		// One name-ordered runQuery cursor per sub-query; scan threads claim them like partitions
+		for (auto &conjunction : sub_queries) {
+			FirestorePageCursor sub_query;
+			sub_query.mode = FirestorePageCursor::Mode::RUN_QUERY;
+			sub_query.collection = bind_data.collection;
+			sub_query.is_collection_group = bind_data.is_collection_group;
+			sub_query.field_mask = field_mask;
+			sub_query.structured_query =
+			    BuildFilteredStructuredQuery(bind_data.collection, bind_data.is_collection_group, conjunction);
+			sub_query.structured_query["limit"] = 1000;
+			sub_query.page_size = 1000;
+			global_state->cursors.push_back(std::move(sub_query));
 		}
+		global_state->uses_run_query = true;
+		global_state->dedupe_documents = sub_queries_overlap;
+		FS_LOG_DEBUG("Filter pushdown split into " + std::to_string(sub_queries.size()) + " sub-queries");
 
-		json sq;
-		sq["from"] = {{{"collectionId", collection_id}, {"allDescendants", bind_data.is_collection_group}}};
+		try {
+			// The first sub-query tells whether Firestore accepts the filters at all
+			global_state->cursors[0].FetchIntoBuffer(*global_state->client);
+		} catch (const std::exception &e) {
+			FS_LOG_WARN("RunQuery with filters failed, falling back to full scan: " + std::string(e.what()));
+			global_state->cursors.clear();
+			global_state->pushdown_result = FirestoreFilterResult {};
+			global_state->uses_run_query = false;
+			global_state->pushdown_failed = true;
+			global_state->dedupe_documents = false;
 
-		// Add WHERE clause
-		sq["where"] = BuildWhereClause(global_state->pushdown_result.pushed_filters);
+			FirestoreQuery query;
+			query.show_missing = bind_data.show_missing;
+			ConfigureListCursor(cursor, bind_data, query);
+			cursor.FetchIntoBuffer(*global_state->client);
+		}
+	} else if (global_state->pushdown_result.has_pushdown()) {
+		// Build StructuredQuery with WHERE clause
+		json sq = BuildFilteredStructuredQuery(bind_data.collection, bind_data.is_collection_group,
+		                                       global_state->pushdown_result.pushed_filters);
 
 		// Add orderBy - Firestore requires inequality/range filter fields to appear
 		// before __name__ in the orderBy clause
@@ -594,9 +1227,9 @@ unique_ptr<GlobalTableFunctionState> FirestoreScanInitGlobal(ClientContext &cont
 			effective_limit = bind_data.limit.has_value() ? bind_data.limit : bind_data.sql_pushed_limit;
 		}
 
-		// Add limit
+		// Add limit, unless DuckDB still applies some of the filters to the returned rows
 		int64_t page_size = 1000;
-		if (effective_limit.has_value()) {
+		if (effective_limit.has_value() && global_state->AllFiltersPushed(bind_data.candidate_pushdown_filters)) {
 			page_size = std::min(effective_limit.value(), static_cast<int64_t>(1000));
 		}
 		sq["limit"] = page_size;
@@ -625,60 +1258,21 @@ unique_ptr<GlobalTableFunctionState> FirestoreScanInitGlobal(ClientContext &cont
 			FS_LOG_DEBUG("Skipping server-side order_by in pushdown query (no supporting index)");
 		}
 
-		if (!sq.contains("orderBy")) {
-			// Build orderBy: inequality/range fields first, then __name__ last.
-			// Firestore requires inequality filter fields (range, NOT_EQUAL, NOT_IN,
-			// IS_NOT_NULL) to appear in orderBy before __name__.
-			json order_by_arr = json::array();
-			std::set<std::string> added_fields;
-
-			for (auto &f : global_state->pushdown_result.pushed_filters) {
-				// Firestore inequality-like operators that require orderBy on the field:
-				// - Range: LESS_THAN, LESS_THAN_OR_EQUAL, GREATER_THAN, GREATER_THAN_OR_EQUAL
-				// - NOT_EQUAL, NOT_IN
-				// - IS_NOT_NULL (unary)
-				// Equality operators (EQUAL, IN) do NOT require orderBy.
-				bool needs_order = false;
-				if (f.is_unary && f.unary_op == "IS_NOT_NULL") {
-					needs_order = true;
-				} else if (!f.is_unary && !f.is_in_filter) {
-					// Check if it's a range or NOT_EQUAL op
-					if (f.firestore_op == "LESS_THAN" || f.firestore_op == "LESS_THAN_OR_EQUAL" ||
-					    f.firestore_op == "GREATER_THAN" || f.firestore_op == "GREATER_THAN_OR_EQUAL" ||
-					    f.firestore_op == "NOT_EQUAL") {
-						needs_order = true;
-					}
-				} else if (f.is_in_filter && f.firestore_op == "NOT_IN") {
-					needs_order = true;
-				}
-
-				if (needs_order && added_fields.find(f.field_path) == added_fields.end()) {
-					order_by_arr.push_back({{"field", {{"fieldPath", f.field_path}}}, {"direction", "ASCENDING"}});
-					added_fields.insert(f.field_path);
-				}
-			}
-
-			// __name__ always last for cursor-based pagination
-			order_by_arr.push_back({{"field", {{"fieldPath", "__name__"}}}, {"direction", "ASCENDING"}});
-
-			sq["orderBy"] = order_by_arr;
-		}
-
 		global_state->structured_query = sq;
 		global_state->uses_run_query = true;
-		global_state->query_page_size = page_size;
+		cursor.mode = FirestorePageCursor::Mode::RUN_QUERY;
+		cursor.structured_query = sq;
+		cursor.page_size = page_size;
 
 		FS_LOG_DEBUG("Filter pushdown active: " + std::to_string(global_state->pushdown_result.pushed_filters.size()) +
 		             " filters pushed to Firestore");
 		FS_LOG_DEBUG("InitGlobal: structured_query=" + sq.dump());
 
 		try {
-			response = global_state->client->RunQuery(bind_data.collection, sq, bind_data.is_collection_group);
-			global_state->next_page_token = ""; // runQuery uses cursor-based pagination
-			// Check if this page is full (may need pagination) or partial (we're done)
-			global_state->last_page_was_full =
-			    (static_cast<int64_t>(response.documents.size()) >= global_state->query_page_size);
-			FS_LOG_DEBUG("InitGlobal: RunQuery returned " + std::to_string(response.documents.size()) + " documents");
+			cursor.FetchIntoBuffer(*global_state->client);
+			FS_LOG_DEBUG("InitGlobal: RunQuery returned " +
+			             std::to_string(cursor.buffered_pages.empty() ? 0 : cursor.buffered_pages.front().size()) +
+			             " documents");
 		} catch (const std::exception &e) {
 			// Fallback: if runQuery fails, disable pushdown and use ListDocuments
 			FS_LOG_WARN("RunQuery with filters failed, falling back to full scan: " + std::string(e.what()));
@@ -699,15 +1293,28 @@ unique_ptr<GlobalTableFunctionState> FirestoreScanInitGlobal(ClientContext &cont
 				FS_LOG_DEBUG("Skipping server-side order_by in fallback (no supporting index)");
 			}
 
-			if (bind_data.is_collection_group) {
-				std::string coll_id = bind_data.collection.substr(1);
-				response = global_state->client->CollectionGroupQuery(coll_id, query);
-				global_state->next_page_token = "";
-			} else {
-				response = global_state->client->ListDocuments(bind_data.collection, query);
-				global_state->next_page_token = response.next_page_token;
-			}
+			cursor = FirestorePageCursor {};
+			cursor.collection = bind_data.collection;
+			cursor.is_collection_group = bind_data.is_collection_group;
+			cursor.field_mask = field_mask;
+			ConfigureListCursor(cursor, bind_data, query);
+			cursor.FetchIntoBuffer(*global_state->client);
 		}
+	} else if (want_partitions && (bind_data.is_collection_group || !bind_data.show_missing)) {
+		// Partitioned scans run as name-ordered runQuery ranges. runQuery never returns phantom
+		// documents, so plain collections only take this path when show_missing=false.
+		json sq;
+		sq["from"] = {{{"collectionId", GetFirestoreCollectionId(bind_data.collection)},
+		               {"allDescendants", bind_data.is_collection_group}}};
+		sq["orderBy"] = {{{"field", {{"fieldPath", "__name__"}}}, {"direction", "ASCENDING"}}};
+		sq["limit"] = 1000;
+
+		global_state->structured_query = sq;
+		global_state->uses_run_query = true;
+		cursor.mode = FirestorePageCursor::Mode::RUN_QUERY;
+		cursor.structured_query = sq;
+		cursor.page_size = 1000;
+		cursor.FetchIntoBuffer(*global_state->client);
 	} else {
 		// No filter pushdown - use existing query paths
 		FirestoreQuery query;
@@ -735,26 +1342,133 @@ unique_ptr<GlobalTableFunctionState> FirestoreScanInitGlobal(ClientContext &cont
 			FS_LOG_DEBUG("Skipping server-side order_by (no supporting index); DuckDB will sort client-side");
 		}
 
-		if (bind_data.is_collection_group) {
-			std::string collection_id = bind_data.collection.substr(1);
-			response = global_state->client->CollectionGroupQuery(collection_id, query);
-			global_state->next_page_token = "";
-		} else {
-			response = global_state->client->ListDocuments(bind_data.collection, query);
-			global_state->next_page_token = response.next_page_token;
+		ConfigureListCursor(cursor, bind_data, query);
+		cursor.FetchIntoBuffer(*global_state->client);
+	}
+
+	// Only scans ordered purely by __name__ can be split on partitionQuery cursors; a full
+	// first page means the result is large enough to be worth the extra round trip.
+	if (want_partitions && cursor.mode == FirestorePageCursor::Mode::RUN_QUERY && !cursor.exhausted &&
+	    IsOrderedByNameOnly(cursor.structured_query)) {
+		try {
+			global_state->cursors = SplitIntoPartitions(*global_state->client, cursor, requested_partitions, bind_data);
+		} catch (const std::exception &e) {
+			FS_LOG_WARN("partitionQuery failed, scanning sequentially: " + std::string(e.what()));
+			global_state->cursors.clear();
 		}
 	}
+	if (global_state->cursors.empty()) {
+		global_state->cursors.push_back(std::move(cursor));
+	}
 
-	global_state->documents = std::move(response.documents);
-	global_state->current_index = 0;
-	global_state->finished = global_state->documents.empty();
+	global_state->finished = global_state->cursors.size() == 1 && global_state->cursors[0].IsDone();
+
+	// Prefetch the next page while the current one is converted. Skip it when the scan stops
+	// at a limit, so we never pay for reads past the last requested row.
+	bool limit_enforced =
+	    effective_limit.has_value() && global_state->AllFiltersPushed(bind_data.candidate_pushdown_filters);
+	if (!limit_enforced) {
+		global_state->prefetch_depth = static_cast<idx_t>(FirestoreSettings::ScanPrefetchPages(context));
+	}
 
 	return std::move(global_state);
 }
 
 unique_ptr<LocalTableFunctionState> FirestoreScanInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
                                                            GlobalTableFunctionState *global_state) {
-	return make_uniq<FirestoreScanLocalState>();
+	auto &bind_data = input.bind_data->Cast<FirestoreScanBindData>();
+	auto local_state = make_uniq<FirestoreScanLocalState>();
+	local_state->client = make_uniq<FirestoreClient>(bind_data.credentials);
+	local_state->client->SetStats(global_state->Cast<FirestoreScanGlobalState>().stats);
+	local_state->page_memory =
+	    make_uniq<FirestorePageMemoryReservation>(BufferManager::GetBufferManager(context.client));
+	return std::move(local_state);
+}
+
+void FirestorePageMemoryReservation::Resize(idx_t bytes) {
+	if (bytes > size_) {
+		buffer_manager_.ReserveMemory(bytes - size_);
+	} else if (bytes < size_) {
+		buffer_manager_.FreeReservedMemory(size_ - bytes);
+	}
+	size_ = bytes;
+}
+
+// Approximate heap footprint of a decoded json value
+static idx_t EstimateJsonBytes(const json &value) {
+	idx_t bytes = sizeof(json);
+	switch (value.type()) {
+	case json::value_t::object:
+		for (auto &item : value.items()) {
+			// std::map node: key, value and tree links
+			bytes += 4 * sizeof(void *) + sizeof(std::string) + item.key().size() + EstimateJsonBytes(item.value());
+		}
+		break;
+	case json::value_t::array:
+		for (auto &element : value) {
+			bytes += EstimateJsonBytes(element);
+		}
+		break;
+	case json::value_t::string:
+		bytes += sizeof(std::string) + value.get_ref<const std::string &>().size();
+		break;
+	default:
+		break;
+	}
+	return bytes;
+}
+
+// Approximate memory of a decoded page, extrapolated from a few of its documents
+static idx_t EstimatePageBytes(const std::vector<FirestoreDocument> &page) {
+	static constexpr idx_t kSampledDocuments = 8;
+	if (page.empty()) {
+		return 0;
+	}
+	idx_t step = MaxValue<idx_t>(page.size() / kSampledDocuments, 1);
+	idx_t sampled = 0;
+	idx_t sampled_bytes = 0;
+	for (idx_t i = 0; i < page.size(); i += step) {
+		auto &doc = page[i];
+		sampled_bytes += sizeof(FirestoreDocument) + doc.name.size() + doc.document_id.size() +
+		                 doc.create_time.size() + doc.update_time.size() + EstimateJsonBytes(doc.fields);
+		sampled++;
+	}
+	return sampled_bytes / sampled * page.size();
+}
+
+// Load the next non-empty page into the local state, claiming a new cursor when the
+// current one is drained. Returns false when no cursors are left.
+static bool FetchNextScanPage(const FirestoreScanBindData &bind_data, FirestoreScanGlobalState &global_state,
+                              FirestoreScanLocalState &local_state) {
+	while (true) {
+		if (!local_state.cursor) {
+			local_state.cursor = global_state.ClaimCursor();
+			if (!local_state.cursor) {
+				return false;
+			}
+			local_state.cursor->StartPrefetch(bind_data.credentials, local_state.client->GetStats(),
+			                                  global_state.prefetch_depth);
+		}
+		// Free the consumed page before the next one is decoded on this thread
+		local_state.documents.clear();
+		if (local_state.cursor->NextPage(*local_state.client, local_state.documents)) {
+			local_state.current_index = 0;
+			if (global_state.dedupe_documents) {
+				global_state.RemoveSeenDocuments(local_state.documents);
+			}
+			if (local_state.documents.empty()) {
+				continue;
+			}
+			// The prefetched pages are about as large as this one
+			auto page_bytes = EstimatePageBytes(local_state.documents);
+			if (page_bytes > local_state.max_page_bytes) {
+				local_state.max_page_bytes = page_bytes;
+				local_state.page_memory->Resize(page_bytes * (global_state.prefetch_depth + 1));
+			}
+			return true;
+		}
+		local_state.cursor = nullptr;
+	}
 }
 
 void FirestoreScanFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
@@ -793,6 +1507,12 @@ void FirestoreScanFunction(ClientContext &context, TableFunctionInput &data, Dat
 		return;
 	}
 
+	auto &local_state = data.local_state->Cast<FirestoreScanLocalState>();
+	if (local_state.finished) {
+		output.SetCardinality(0);
+		return;
+	}
+
 	idx_t count = 0;
 	idx_t max_count = STANDARD_VECTOR_SIZE;
 
@@ -800,97 +1520,39 @@ void FirestoreScanFunction(ClientContext &context, TableFunctionInput &data, Dat
 	// Skip when DuckDB will filter client-side: the scan emits rows before DuckDB's FILTER
 	// node, so cutting off here would drop rows that might match the WHERE clause.
 	// This happens when: (a) pushdown was attempted but failed at runtime, or
-	// (b) candidate filters exist but none were pushed (e.g. collection group without indexes).
+	// (b) some candidate filters were not pushed (no index supports them, or the plan pushed
+	// only the cheaper part of the WHERE clause).
+	// Limited scans are never partitioned, so only one thread updates rows_emitted here.
 	auto effective_limit = bind_data.limit;
-	if (!effective_limit.has_value() && !is_document_path_mode) {
+	if (!effective_limit.has_value()) {
 		effective_limit = bind_data.sql_pushed_limit;
 	}
-	bool has_unpushed_filters =
-	    !bind_data.candidate_pushdown_filters.empty() && !global_state.pushdown_result.has_pushdown();
-	if (effective_limit.has_value() && !global_state.pushdown_failed && !has_unpushed_filters) {
-		idx_t total_returned = global_state.current_index;
+	if (effective_limit.has_value() && global_state.AllFiltersPushed(bind_data.candidate_pushdown_filters)) {
+		idx_t total_returned = global_state.rows_emitted.load();
 		if (total_returned >= static_cast<idx_t>(effective_limit.value())) {
-			global_state.finished = true;
+			local_state.finished = true;
 			output.SetCardinality(0);
 			return;
 		}
 		max_count = std::min(max_count, static_cast<idx_t>(effective_limit.value()) - total_returned);
 	}
 
+	// Conversion time is the time spent here minus the time spent waiting for pages
+	auto conversion_start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::duration fetch_time {0};
 	while (count < max_count) {
 		// Check if we need to fetch more documents
-		if (global_state.current_index >= global_state.documents.size()) {
-			if (global_state.uses_run_query) {
-				// Cursor-based pagination for :runQuery
-				// If the last page wasn't full, we've reached the end - no need to fetch more
-				if (!global_state.last_page_was_full || global_state.documents.empty()) {
-					break;
-				}
-
-				// Build cursor values from last document for all orderBy fields
-				auto &last_doc = global_state.documents.back();
-				json cursor_values = json::array();
-
-				if (global_state.structured_query.contains("orderBy")) {
-					for (auto &ob_entry : global_state.structured_query["orderBy"]) {
-						std::string fp = ob_entry["field"]["fieldPath"].get<std::string>();
-						if (fp == "__name__") {
-							cursor_values.push_back({{"referenceValue", last_doc.name}});
-						} else if (last_doc.fields.contains(fp)) {
-							cursor_values.push_back(last_doc.fields[fp]);
-						} else {
-							cursor_values.push_back({{"nullValue", nullptr}});
-						}
-					}
-				} else {
-					cursor_values.push_back({{"referenceValue", last_doc.name}});
-				}
-
-				// Update the structured query with startAt cursor
-				json paginated_query = global_state.structured_query;
-				paginated_query["startAt"] = {{"values", cursor_values}, {"before", false}};
-
-				auto response =
-				    global_state.client->RunQuery(bind_data.collection, paginated_query, bind_data.is_collection_group);
-
-				// Track if this page is full for next iteration
-				global_state.last_page_was_full =
-				    (static_cast<int64_t>(response.documents.size()) >= global_state.query_page_size);
-
-				if (response.documents.empty()) {
-					break;
-				}
-
-				global_state.documents = std::move(response.documents);
-				global_state.current_index = 0;
-			} else {
-				// Page token-based pagination for ListDocuments
-				if (global_state.next_page_token.empty()) {
-					break;
-				}
-
-				FirestoreQuery query;
-				query.show_missing = bind_data.show_missing;
-				query.page_token = global_state.next_page_token;
-				bool can_order_named =
-				    !bind_data.parsed_order_by.empty() && CanOrderByOnServer(bind_data.parsed_order_by, bind_data);
-				if (can_order_named) {
-					query.order_by = FormatOrderByForREST(bind_data.parsed_order_by);
-				}
-
-				auto response = global_state.client->ListDocuments(bind_data.collection, query);
-
-				if (response.documents.empty()) {
-					break;
-				}
-
-				global_state.documents = std::move(response.documents);
-				global_state.next_page_token = response.next_page_token;
-				global_state.current_index = 0;
+		if (local_state.current_index >= local_state.documents.size()) {
+			auto fetch_start = std::chrono::steady_clock::now();
+			bool fetched = FetchNextScanPage(bind_data, global_state, local_state);
+			fetch_time += std::chrono::steady_clock::now() - fetch_start;
+			if (!fetched) {
+				local_state.finished = true;
+				break;
 			}
 		}
 
-		auto &doc = global_state.documents[global_state.current_index];
+		auto &doc = local_state.documents[local_state.current_index];
 
 		// Set values for each projected column
 		for (idx_t out_col = 0; out_col < bind_data.projected_columns.size(); out_col++) {
@@ -898,32 +1560,24 @@ void FirestoreScanFunction(ClientContext &context, TableFunctionInput &data, Dat
 
 			if (src_col == COLUMN_IDENTIFIER_ROW_ID) {
 				// __document_id column
-				std::string doc_id;
-				if (bind_data.is_collection_group) {
-					// For collection group queries, use the full document path
+				string_t doc_id(doc.document_id.data(), static_cast<uint32_t>(doc.document_id.size()));
+				if (bind_data.is_collection_group || bind_data.recursive) {
+					// For collection group and recursive queries, use the full document path
 					// to uniquely identify documents across different parent collections
 					// doc.name is like: projects/{PROJECT}/databases/{DB}/documents/{PATH}
-					// We extract just the {PATH} part
-					const std::string marker = "/documents/";
-					size_t pos = doc.name.find(marker);
-					if (pos != std::string::npos) {
-						doc_id = doc.name.substr(pos + marker.length());
-					} else {
-						// Fallback to full name if marker not found
-						doc_id = doc.name;
-					}
-				} else {
-					// For regular queries, use just the document ID
-					doc_id = doc.document_id;
+					// We reference just the {PATH} part, copied once into the vector below
+					static constexpr char kMarker[] = "/documents/";
+					size_t pos = doc.name.find(kMarker);
+					size_t start = pos == std::string::npos ? 0 : pos + sizeof(kMarker) - 1;
+					doc_id = string_t(doc.name.data() + start, static_cast<uint32_t>(doc.name.size() - start));
 				}
 				FlatVector::GetData<string_t>(output.data[out_col])[count] =
 				    StringVector::AddString(output.data[out_col], doc_id);
 			} else {
 				// Regular field column
-				const auto &col_name = bind_data.column_names[src_col];
-
-				if (doc.fields.contains(col_name)) {
-					SetDuckDBValue(output.data[out_col], count, doc.fields[col_name], bind_data.column_types[src_col]);
+				auto field = doc.fields.find(bind_data.column_names[src_col]);
+				if (field != doc.fields.end()) {
+					global_state.column_writers[out_col](output.data[out_col], count, *field);
 				} else {
 					FlatVector::SetNull(output.data[out_col], count, true);
 				}
@@ -931,21 +1585,11 @@ void FirestoreScanFunction(ClientContext &context, TableFunctionInput &data, Dat
 		}
 
 		count++;
-		global_state.current_index++;
-	}
-
-	if (count == 0) {
-		global_state.finished = true;
-	} else if (global_state.current_index >= global_state.documents.size()) {
-		if (global_state.uses_run_query) {
-			// For runQuery, we know we're done when a fetch returns fewer docs than the limit
-			// The next pagination attempt in the loop above will confirm with an empty response
-			// Don't mark finished yet - let the next iteration's fetch determine it
-		} else if (global_state.next_page_token.empty()) {
-			global_state.finished = true;
-		}
+		local_state.current_index++;
 	}
 
+	global_state.stats->RecordConversion(std::chrono::steady_clock::now() - conversion_start - fetch_time);
+	global_state.rows_emitted += count;
 	output.SetCardinality(count);
 }
 
@@ -0,0 +1,435 @@
+#include "firestore_schema_cache.hpp"
+#include "firestore_logger.hpp"
+#include "firestore_connection_pool.hpp"
+#include "firestore_stats.hpp"
+#include "firestore_transport.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace duckdb {
+
+static constexpr int kSchemaCacheFileVersion = 1;
+
+// Entries of the same key from different processes must map to the same file, so the name
+// comes from a fixed hash (FNV-1a) rather than std::hash
+static std::string GetCacheFilePath(const std::string &cache_dir, const std::string &key) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (unsigned char c : key) {
+		hash ^= c;
+		hash *= 1099511628211ULL;
+	}
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.json", static_cast<unsigned long long>(hash));
+	return (std::filesystem::path(cache_dir) / name).string();
+}
+
+// Cache keys are "project_id:database_id:collection"
+static bool KeyMatchesCollection(const std::string &key, const std::string &collection) {
+	size_t colon_pos = key.rfind(':');
+	return colon_pos != std::string::npos && key.substr(colon_pos + 1) == collection;
+}
+
+static const char *IndexFieldModeToString(FirestoreIndexField::Mode mode) {
+	switch (mode) {
+	case FirestoreIndexField::Mode::DESCENDING:
+		return "DESCENDING";
+	case FirestoreIndexField::Mode::ARRAY_CONTAINS:
+		return "ARRAY_CONTAINS";
+	case FirestoreIndexField::Mode::ASCENDING:
+	default:
+		return "ASCENDING";
+	}
+}
+
+static FirestoreIndexField::Mode IndexFieldModeFromString(const std::string &mode) {
+	if (mode == "DESCENDING") {
+		return FirestoreIndexField::Mode::DESCENDING;
+	}
+	if (mode == "ARRAY_CONTAINS") {
+		return FirestoreIndexField::Mode::ARRAY_CONTAINS;
+	}
+	return FirestoreIndexField::Mode::ASCENDING;
+}
+
+static const char *IndexStateToString(FirestoreIndex::State state) {
+	switch (state) {
+	case FirestoreIndex::State::CREATING:
+		return "CREATING";
+	case FirestoreIndex::State::NEEDS_REPAIR:
+		return "NEEDS_REPAIR";
+	case FirestoreIndex::State::READY:
+	default:
+		return "READY";
+	}
+}
+
+static FirestoreIndex::State IndexStateFromString(const std::string &state) {
+	if (state == "CREATING") {
+		return FirestoreIndex::State::CREATING;
+	}
+	if (state == "NEEDS_REPAIR") {
+		return FirestoreIndex::State::NEEDS_REPAIR;
+	}
+	return FirestoreIndex::State::READY;
+}
+
+static json SerializeIndexes(const std::vector<FirestoreIndex> &indexes) {
+	json result = json::array();
+	for (auto &index : indexes) {
+		json fields = json::array();
+		for (auto &field : index.fields) {
+			fields.push_back({field.field_path, IndexFieldModeToString(field.mode)});
+		}
+		result.push_back({{"name", index.name},
+		                  {"fields", fields},
+		                  {"collection_group", index.query_scope == FirestoreIndex::QueryScope::COLLECTION_GROUP},
+		                  {"state", IndexStateToString(index.state)},
+		                  {"single_field", index.is_single_field}});
+	}
+	return result;
+}
+
+static std::vector<FirestoreIndex> DeserializeIndexes(const json &indexes) {
+	std::vector<FirestoreIndex> result;
+	for (auto &entry : indexes) {
+		FirestoreIndex index;
+		index.name = entry.at("name").get<std::string>();
+		for (auto &field : entry.at("fields")) {
+			index.fields.push_back({field.at(0).get<std::string>(), IndexFieldModeFromString(field.at(1))});
+		}
+		index.query_scope = entry.at("collection_group").get<bool>() ? FirestoreIndex::QueryScope::COLLECTION_GROUP
+		                                                             : FirestoreIndex::QueryScope::COLLECTION;
+		index.state = IndexStateFromString(entry.at("state").get<std::string>());
+		index.is_single_field = entry.at("single_field").get<bool>();
+		result.push_back(std::move(index));
+	}
+	return result;
+}
+
+static json SerializeSampleStats(const FirestoreSampleStats &stats) {
+	json fields = json::object();
+	for (auto &[name, field] : stats.fields) {
+		json entry = {{"present", field.present}, {"distinct", field.distinct}};
+		if (field.has_range) {
+			entry["min"] = field.min;
+			entry["max"] = field.max;
+		}
+		fields[name] = entry;
+	}
+	return {{"documents", stats.documents}, {"fields", fields}};
+}
+
+static FirestoreSampleStats DeserializeSampleStats(const json &data) {
+	FirestoreSampleStats stats;
+	stats.documents = data.at("documents").get<idx_t>();
+	for (auto it = data.at("fields").begin(); it != data.at("fields").end(); ++it) {
+		auto &field = stats.fields[it.key()];
+		field.present = it.value().at("present").get<idx_t>();
+		field.distinct = it.value().at("distinct").get<idx_t>();
+		if (it.value().contains("min") && it.value().contains("max")) {
+			field.has_range = true;
+			field.min = it.value()["min"].get<double>();
+			field.max = it.value()["max"].get<double>();
+		}
+	}
+	return stats;
+}
+
+static json SerializeEntry(const std::string &key, const FirestoreCachedSchema &entry) {
+	json schema = json::array();
+	for (auto &column : entry.schema) {
+		schema.push_back({column.first, column.second.ToString()});
+	}
+	json result = {{"version", kSchemaCacheFileVersion},
+	               {"key", key},
+	               {"cached_at", std::chrono::duration_cast<std::chrono::seconds>(entry.cached_at.time_since_epoch())
+	                                 .count()},
+	               {"schema", schema}};
+	if (entry.index_cache) {
+		auto &index_cache = *entry.index_cache;
+		result["index_cache"] = {{"composite_indexes", SerializeIndexes(index_cache.composite_indexes)},
+		                         {"single_field_indexes", SerializeIndexes(index_cache.single_field_indexes)},
+		                         {"default_single_field_enabled", index_cache.default_single_field_enabled},
+		                         {"fetch_succeeded", index_cache.fetch_succeeded},
+		                         {"sample_stats", SerializeSampleStats(index_cache.sample_stats)}};
+	}
+	return result;
+}
+
+// Returns false for files of another version or another key (hash collision)
+static bool DeserializeEntry(const json &data, const std::string &key, FirestoreCachedSchema &out) {
+	if (data.value("version", 0) != kSchemaCacheFileVersion || data.value("key", "") != key) {
+		return false;
+	}
+	FirestoreCachedSchema entry;
+	for (auto &column : data.at("schema")) {
+		entry.schema.emplace_back(column.at(0).get<std::string>(),
+		                          TransformStringToLogicalType(column.at(1).get<std::string>()));
+	}
+	entry.cached_at = std::chrono::system_clock::time_point(std::chrono::seconds(data.at("cached_at").get<int64_t>()));
+	if (data.contains("index_cache")) {
+		auto &index_data = data["index_cache"];
+		entry.index_cache = std::make_shared<FirestoreIndexCache>();
+		entry.index_cache->composite_indexes = DeserializeIndexes(index_data.at("composite_indexes"));
+		entry.index_cache->single_field_indexes = DeserializeIndexes(index_data.at("single_field_indexes"));
+		entry.index_cache->default_single_field_enabled = index_data.at("default_single_field_enabled").get<bool>();
+		entry.index_cache->fetch_succeeded = index_data.at("fetch_succeeded").get<bool>();
+		// Absent from files written before statistics were sampled
+		if (index_data.contains("sample_stats")) {
+			entry.index_cache->sample_stats = DeserializeSampleStats(index_data["sample_stats"]);
+		}
+	}
+	out = std::move(entry);
+	return true;
+}
+
+static bool ReadCacheFile(const std::string &path, json &out) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		return false;
+	}
+	out = json::parse(file, nullptr, false);
+	return !out.is_discarded();
+}
+
+// True for files this cache wrote: a 16-hex-digit name ending in .json, holding an entry of a
+// known version whose key hashes to that very name. Anything else in the directory is not ours.
+static bool ReadCacheEntryFile(const std::filesystem::path &path, json &out) {
+	auto stem = path.stem().string();
+	if (path.extension() != ".json" || stem.size() != 16 ||
+	    stem.find_first_not_of("0123456789abcdef") != std::string::npos) {
+		return false;
+	}
+	if (!ReadCacheFile(path.string(), out) || !out.is_object()) {
+		return false;
+	}
+	auto version = out.find("version");
+	auto key = out.find("key");
+	if (version == out.end() || !version->is_number_integer() || version->get<int64_t>() < 1 ||
+	    version->get<int64_t>() > kSchemaCacheFileVersion || key == out.end() || !key->is_string()) {
+		return false;
+	}
+	return std::filesystem::path(GetCacheFilePath("", key->get<std::string>())).filename() == path.filename();
+}
+
+static bool LoadFromDisk(const std::string &cache_dir, const std::string &key, FirestoreCachedSchema &out) {
+	json data;
+	if (!ReadCacheFile(GetCacheFilePath(cache_dir, key), data)) {
+		return false;
+	}
+	try {
+		return DeserializeEntry(data, key, out);
+	} catch (const std::exception &e) {
+		// A file from an incompatible build is treated as a miss and overwritten later
+		FS_LOG_WARN("Ignoring unreadable schema cache file for " + key + ": " + std::string(e.what()));
+		return false;
+	}
+}
+
+static void StoreOnDisk(const std::string &cache_dir, const std::string &key, const FirestoreCachedSchema &entry) {
+	auto path = GetCacheFilePath(cache_dir, key);
+
+	// Write a private temp file, then rename it over the entry: rename is atomic, so other
+	// processes read either the old or the new entry, never a partial one
+	thread_local std::mt19937_64 rng(std::random_device {}());
+	std::ostringstream tmp_path;
+	tmp_path << path << ".tmp." << std::hex << rng();
+
+	std::error_code ec;
+	std::filesystem::create_directories(cache_dir, ec);
+	{
+		std::ofstream file(tmp_path.str(), std::ios::trunc);
+		if (!file.is_open()) {
+			FS_LOG_WARN("Cannot write schema cache file in " + cache_dir);
+			return;
+		}
+		file << SerializeEntry(key, entry).dump();
+		if (!file.good()) {
+			file.close();
+			std::remove(tmp_path.str().c_str());
+			FS_LOG_WARN("Failed to write schema cache file for " + key);
+			return;
+		}
+	}
+	std::filesystem::rename(tmp_path.str(), path, ec);
+	if (ec) {
+		std::remove(tmp_path.str().c_str());
+		FS_LOG_WARN("Failed to store schema cache file for " + key + ": " + ec.message());
+	}
+}
+
+FirestoreSchemaCache &FirestoreSchemaCache::Instance() {
+	static FirestoreSchemaCache instance;
+	return instance;
+}
+
+FirestoreSchemaCache::FirestoreSchemaCache() {
+	// A refresh still running at exit is joined in the destructor and may log, send requests
+	// over the pool and record stats. Statics are destroyed in reverse order of construction,
+	// so constructing those first keeps them alive until the worker has stopped.
+	FirestoreLogger::Instance();
+	FirestoreConnectionPool::Instance();
+	FirestoreTransport::Get();
+	FirestoreIOStats::Global();
+}
+
+FirestoreSchemaCache::~FirestoreSchemaCache() {
+	std::thread worker;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+		refresh_queue_.clear();
+		worker = std::move(refresh_worker_);
+	}
+	refresh_cv_.notify_all();
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+bool FirestoreSchemaCache::Get(const std::string &key, int64_t max_age_seconds, const std::string &cache_dir,
+                               FirestoreCachedSchema &out) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = entries_.find(key);
+		if (it != entries_.end()) {
+			if (!it->second.IsExpired(max_age_seconds)) {
+				out = it->second;
+				return true;
+			}
+			FS_LOG_DEBUG("Schema cache expired for: " + key);
+			entries_.erase(it);
+		}
+	}
+
+	if (cache_dir.empty() || max_age_seconds == 0) {
+		return false;
+	}
+	FirestoreCachedSchema entry;
+	if (!LoadFromDisk(cache_dir, key, entry) || entry.IsExpired(max_age_seconds)) {
+		return false;
+	}
+	FS_LOG_DEBUG("Schema loaded from cache directory for: " + key);
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_[key] = entry;
+	out = std::move(entry);
+	return true;
+}
+
+void FirestoreSchemaCache::Put(const std::string &key, const FirestoreCachedSchema &entry,
+                               const std::string &cache_dir) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		entries_[key] = entry;
+	}
+	if (!cache_dir.empty()) {
+		StoreOnDisk(cache_dir, key, entry);
+	}
+}
+
+void FirestoreSchemaCache::Remove(const std::string &key, const std::string &cache_dir) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		entries_.erase(key);
+	}
+	if (!cache_dir.empty()) {
+		std::error_code ec;
+		std::filesystem::remove(GetCacheFilePath(cache_dir, key), ec);
+	}
+}
+
+void FirestoreSchemaCache::Clear(const std::string &collection, const std::string &cache_dir) {
+	int cleared = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (collection.empty()) {
+			cleared = static_cast<int>(entries_.size());
+			entries_.clear();
+		} else {
+			for (auto it = entries_.begin(); it != entries_.end();) {
+				if (KeyMatchesCollection(it->first, collection)) {
+					it = entries_.erase(it);
+					cleared++;
+				} else {
+					++it;
+				}
+			}
+		}
+	}
+
+	// File names are hashes, so matching entries are found by reading their keys. The directory
+	// may be shared with other files, so only files that are cache entries are removed.
+	std::error_code ec;
+	if (!cache_dir.empty() && std::filesystem::is_directory(cache_dir, ec)) {
+		for (auto &file : std::filesystem::directory_iterator(cache_dir, ec)) {
+			json data;
+			if (!ReadCacheEntryFile(file.path(), data) ||
+			    (!collection.empty() && !KeyMatchesCollection(data["key"].get<std::string>(), collection))) {
+				continue;
+			}
+			std::error_code remove_ec;
+			std::filesystem::remove(file.path(), remove_ec);
+		}
+	}
+
+	if (collection.empty()) {
+		FS_LOG_DEBUG("Schema cache cleared (all entries)");
+	} else {
+		FS_LOG_DEBUG("Schema cache cleared for collection '" + collection + "': " + std::to_string(cleared) +
+		             " entries removed");
+		if (cleared == 0) {
+			FS_LOG_WARN("No cache entries found for collection: " + collection);
+		}
+	}
+}
+
+void FirestoreSchemaCache::RefreshInBackground(const std::string &key, const std::string &cache_dir, Loader loader) {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (stopping_ || !refreshing_.insert(key).second) {
+			return;
+		}
+		refresh_queue_.push_back({key, cache_dir, std::move(loader)});
+		if (!refresh_worker_.joinable()) {
+			refresh_worker_ = std::thread(&FirestoreSchemaCache::RunRefreshes, this);
+		}
+	}
+	refresh_cv_.notify_one();
+	FS_LOG_DEBUG("Schema cache refresh queued for: " + key);
+}
+
+void FirestoreSchemaCache::RunRefreshes() {
+	while (true) {
+		RefreshTask task;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			refresh_cv_.wait(lock, [&] { return stopping_ || !refresh_queue_.empty(); });
+			if (stopping_) {
+				return;
+			}
+			task = std::move(refresh_queue_.front());
+			refresh_queue_.pop_front();
+		}
+
+		FirestoreCachedSchema entry;
+		bool refreshed = false;
+		try {
+			refreshed = task.loader(entry);
+		} catch (const std::exception &e) {
+			FS_LOG_WARN("Background schema refresh failed for " + task.key + ": " + std::string(e.what()));
+		}
+		if (refreshed) {
+			// Put locks mutex_ itself; a refresh finishing during shutdown is still stored
+			Put(task.key, entry, task.cache_dir);
+			FS_LOG_DEBUG("Schema cache refreshed in background for: " + task.key);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		refreshing_.erase(task.key);
+	}
+}
+
+} // namespace duckdb
@@ -0,0 +1,307 @@
+#include "firestore_stats.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/extension/extension_loader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <mutex>
+
+namespace duckdb {
+
+// Queries whose statistics firestore_stats() still reports
+static constexpr size_t kMaxTrackedQueries = 64;
+
+FirestoreEndpoint GetFirestoreEndpoint(const std::string &operation) {
+	if (operation == "list" || operation == "list_collection_ids") {
+		return FirestoreEndpoint::LIST;
+	}
+	if (operation == "run_query" || operation == "collection_group_query") {
+		return FirestoreEndpoint::RUN_QUERY;
+	}
+	if (operation == "batch_get") {
+		return FirestoreEndpoint::BATCH_GET;
+	}
+	if (operation == "run_aggregation_query") {
+		return FirestoreEndpoint::AGGREGATION;
+	}
+	if (operation == "partition_query") {
+		return FirestoreEndpoint::PARTITION_QUERY;
+	}
+	if (operation == "get") {
+		return FirestoreEndpoint::GET;
+	}
+	if (operation == "create" || operation == "update" || operation == "delete" || operation == "array_transform") {
+		return FirestoreEndpoint::WRITE;
+	}
+	if (operation == "batch_write") {
+		return FirestoreEndpoint::BATCH_WRITE;
+	}
+	if (operation == "fetch_indexes" || operation == "check_default_indexes") {
+		return FirestoreEndpoint::ADMIN;
+	}
+	return FirestoreEndpoint::OTHER;
+}
+
+const char *FirestoreEndpointToString(FirestoreEndpoint endpoint) {
+	switch (endpoint) {
+	case FirestoreEndpoint::LIST:
+		return "list";
+	case FirestoreEndpoint::RUN_QUERY:
+		return "run_query";
+	case FirestoreEndpoint::BATCH_GET:
+		return "batch_get";
+	case FirestoreEndpoint::AGGREGATION:
+		return "aggregation";
+	case FirestoreEndpoint::PARTITION_QUERY:
+		return "partition_query";
+	case FirestoreEndpoint::GET:
+		return "get";
+	case FirestoreEndpoint::WRITE:
+		return "write";
+	case FirestoreEndpoint::BATCH_WRITE:
+		return "batch_write";
+	case FirestoreEndpoint::ADMIN:
+		return "admin";
+	default:
+		return "other";
+	}
+}
+
+// ============================================================================
+// FirestoreIOStats
+// ============================================================================
+
+const std::shared_ptr<FirestoreIOStats> &FirestoreIOStats::Global() {
+	static const std::shared_ptr<FirestoreIOStats> global = std::make_shared<FirestoreIOStats>();
+	return global;
+}
+
+void FirestoreIOStats::RecordRequest(FirestoreEndpoint endpoint, uint64_t request_bytes, uint64_t response_bytes,
+                                     std::chrono::microseconds latency) {
+	requests_[static_cast<size_t>(endpoint)].fetch_add(1, std::memory_order_relaxed);
+	request_bytes_.fetch_add(request_bytes, std::memory_order_relaxed);
+	response_bytes_.fetch_add(response_bytes, std::memory_order_relaxed);
+	request_us_.fetch_add(latency.count(), std::memory_order_relaxed);
+	double us = std::max<double>(static_cast<double>(latency.count()), 1.0);
+	auto bucket = std::min<size_t>(static_cast<size_t>(std::log2(us) * 4), kLatencyBuckets - 1);
+	latency_buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+	if (parent_) {
+		parent_->RecordRequest(endpoint, request_bytes, response_bytes, latency);
+	}
+}
+
+void FirestoreIOStats::RecordPage(uint64_t documents, std::chrono::nanoseconds parse_time) {
+	pages_.fetch_add(1, std::memory_order_relaxed);
+	documents_read_.fetch_add(documents, std::memory_order_relaxed);
+	json_parse_ns_.fetch_add(parse_time.count(), std::memory_order_relaxed);
+	if (parent_) {
+		parent_->RecordPage(documents, parse_time);
+	}
+}
+
+void FirestoreIOStats::RecordDocumentsWritten(uint64_t documents) {
+	documents_written_.fetch_add(documents, std::memory_order_relaxed);
+	if (parent_) {
+		parent_->RecordDocumentsWritten(documents);
+	}
+}
+
+void FirestoreIOStats::RecordRetry() {
+	retries_.fetch_add(1, std::memory_order_relaxed);
+	if (parent_) {
+		parent_->RecordRetry();
+	}
+}
+
+void FirestoreIOStats::RecordJsonParse(std::chrono::nanoseconds parse_time) {
+	json_parse_ns_.fetch_add(parse_time.count(), std::memory_order_relaxed);
+	if (parent_) {
+		parent_->RecordJsonParse(parse_time);
+	}
+}
+
+void FirestoreIOStats::RecordConversion(std::chrono::nanoseconds conversion_time) {
+	conversion_ns_.fetch_add(conversion_time.count(), std::memory_order_relaxed);
+	if (parent_) {
+		parent_->RecordConversion(conversion_time);
+	}
+}
+
+FirestoreIOStatsSnapshot FirestoreIOStats::Snapshot() const {
+	FirestoreIOStatsSnapshot snapshot;
+	for (size_t i = 0; i < requests_.size(); i++) {
+		snapshot.requests[i] = requests_[i].load(std::memory_order_relaxed);
+	}
+	snapshot.request_bytes = request_bytes_.load(std::memory_order_relaxed);
+	snapshot.response_bytes = response_bytes_.load(std::memory_order_relaxed);
+	snapshot.documents_read = documents_read_.load(std::memory_order_relaxed);
+	snapshot.documents_written = documents_written_.load(std::memory_order_relaxed);
+	snapshot.pages = pages_.load(std::memory_order_relaxed);
+	snapshot.retries = retries_.load(std::memory_order_relaxed);
+	snapshot.request_ms = static_cast<double>(request_us_.load(std::memory_order_relaxed)) / 1e3;
+	snapshot.json_parse_ms = static_cast<double>(json_parse_ns_.load(std::memory_order_relaxed)) / 1e6;
+	snapshot.conversion_ms = static_cast<double>(conversion_ns_.load(std::memory_order_relaxed)) / 1e6;
+
+	std::array<uint64_t, kLatencyBuckets> buckets;
+	uint64_t total = 0;
+	for (size_t i = 0; i < kLatencyBuckets; i++) {
+		buckets[i] = latency_buckets_[i].load(std::memory_order_relaxed);
+		total += buckets[i];
+	}
+	// Each percentile is reported as the geometric middle of the bucket it falls in
+	auto percentile = [&](double fraction) -> double {
+		if (total == 0) {
+			return 0;
+		}
+		auto rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < kLatencyBuckets; i++) {
+			seen += buckets[i];
+			if (seen >= rank) {
+				return std::pow(2.0, (static_cast<double>(i) + 0.5) / 4) / 1000;
+			}
+		}
+		return 0;
+	};
+	snapshot.latency_p50_ms = percentile(0.50);
+	snapshot.latency_p95_ms = percentile(0.95);
+	snapshot.latency_p99_ms = percentile(0.99);
+	return snapshot;
+}
+
+// ============================================================================
+// Per-query statistics
+// ============================================================================
+
+struct FirestoreTrackedQuery {
+	const ClientContext *context;
+	transaction_t query_id;
+	std::string query;
+	std::shared_ptr<FirestoreIOStats> stats;
+};
+
+static std::mutex tracked_queries_mutex;
+static std::deque<FirestoreTrackedQuery> tracked_queries; // newest first
+
+std::shared_ptr<FirestoreIOStats> GetFirestoreQueryStats(ClientContext &context) {
+	auto query_id = context.transaction.GetActiveQuery();
+	std::lock_guard<std::mutex> lock(tracked_queries_mutex);
+	for (auto &tracked : tracked_queries) {
+		if (tracked.context == &context && tracked.query_id == query_id) {
+			return tracked.stats;
+		}
+	}
+	FirestoreTrackedQuery tracked;
+	tracked.context = &context;
+	tracked.query_id = query_id;
+	tracked.query = context.GetCurrentQuery();
+	tracked.stats = std::make_shared<FirestoreIOStats>(FirestoreIOStats::Global());
+	tracked_queries.push_front(tracked);
+	if (tracked_queries.size() > kMaxTrackedQueries) {
+		tracked_queries.pop_back();
+	}
+	return tracked.stats;
+}
+
+// ============================================================================
+// firestore_stats()
+// ============================================================================
+
+struct FirestoreStatsRow {
+	std::string scope;
+	Value query_id;
+	Value query;
+	FirestoreIOStatsSnapshot stats;
+};
+
+struct FirestoreStatsGlobalState : public GlobalTableFunctionState {
+	std::vector<FirestoreStatsRow> rows;
+	idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> FirestoreStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                   vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"scope",          "query_id",       "query",         "requests",         "requests_by_endpoint",
+	         "request_bytes",  "response_bytes", "documents_read", "documents_written", "pages",
+	         "retries",        "latency_p50_ms", "latency_p95_ms", "latency_p99_ms",   "json_parse_ms",
+	         "conversion_ms"};
+	return_types = {LogicalType::VARCHAR,
+	                LogicalType::UBIGINT,
+	                LogicalType::VARCHAR,
+	                LogicalType::UBIGINT,
+	                LogicalType::MAP(LogicalType::VARCHAR, LogicalType::UBIGINT),
+	                LogicalType::UBIGINT,
+	                LogicalType::UBIGINT,
+	                LogicalType::UBIGINT,
+	                LogicalType::UBIGINT,
+	                LogicalType::UBIGINT,
+	                LogicalType::UBIGINT,
+	                LogicalType::DOUBLE,
+	                LogicalType::DOUBLE,
+	                LogicalType::DOUBLE,
+	                LogicalType::DOUBLE,
+	                LogicalType::DOUBLE};
+	return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> FirestoreStatsInitGlobal(ClientContext &context,
+                                                                     TableFunctionInitInput &input) {
+	auto state = make_uniq<FirestoreStatsGlobalState>();
+	state->rows.push_back(
+	    {"total", Value(LogicalType::UBIGINT), Value(LogicalType::VARCHAR), FirestoreIOStats::Global()->Snapshot()});
+	std::lock_guard<std::mutex> lock(tracked_queries_mutex);
+	for (auto &tracked : tracked_queries) {
+		state->rows.push_back(
+		    {"query", Value::UBIGINT(tracked.query_id), Value(tracked.query), tracked.stats->Snapshot()});
+	}
+	return std::move(state);
+}
+
+static void FirestoreStatsFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<FirestoreStatsGlobalState>();
+	idx_t count = 0;
+	while (state.offset < state.rows.size() && count < STANDARD_VECTOR_SIZE) {
+		auto &row = state.rows[state.offset++];
+		auto &stats = row.stats;
+
+		uint64_t requests = 0;
+		vector<Value> endpoints;
+		vector<Value> endpoint_requests;
+		for (size_t i = 0; i < stats.requests.size(); i++) {
+			requests += stats.requests[i];
+			if (stats.requests[i] > 0) {
+				endpoints.push_back(Value(FirestoreEndpointToString(static_cast<FirestoreEndpoint>(i))));
+				endpoint_requests.push_back(Value::UBIGINT(stats.requests[i]));
+			}
+		}
+
+		output.SetValue(0, count, Value(row.scope));
+		output.SetValue(1, count, row.query_id);
+		output.SetValue(2, count, row.query);
+		output.SetValue(3, count, Value::UBIGINT(requests));
+		output.SetValue(4, count,
+		                Value::MAP(LogicalType::VARCHAR, LogicalType::UBIGINT, endpoints, endpoint_requests));
+		output.SetValue(5, count, Value::UBIGINT(stats.request_bytes));
+		output.SetValue(6, count, Value::UBIGINT(stats.response_bytes));
+		output.SetValue(7, count, Value::UBIGINT(stats.documents_read));
+		output.SetValue(8, count, Value::UBIGINT(stats.documents_written));
+		output.SetValue(9, count, Value::UBIGINT(stats.pages));
+		output.SetValue(10, count, Value::UBIGINT(stats.retries));
+		output.SetValue(11, count, Value::DOUBLE(stats.latency_p50_ms));
+		output.SetValue(12, count, Value::DOUBLE(stats.latency_p95_ms));
+		output.SetValue(13, count, Value::DOUBLE(stats.latency_p99_ms));
+		output.SetValue(14, count, Value::DOUBLE(stats.json_parse_ms));
+		output.SetValue(15, count, Value::DOUBLE(stats.conversion_ms));
+		count++;
+	}
+	output.SetCardinality(count);
+}
+
+void RegisterFirestoreStatsFunction(ExtensionLoader &loader) {
+	TableFunction stats_func("firestore_stats", {}, FirestoreStatsFunction, FirestoreStatsBind,
+	                         FirestoreStatsInitGlobal);
+	loader.RegisterFunction(stats_func);
+}
+
+} // namespace duckdb
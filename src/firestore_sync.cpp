@@ -0,0 +1,299 @@
+#include "firestore_sync.hpp"
+#include "firestore_secrets.hpp"
+#include "firestore_logger.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_search_path.hpp"
+#include "duckdb/common/case_insensitive_map.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_data.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/main/database_manager.hpp"
+#include "duckdb/main/extension/extension_loader.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+
+namespace duckdb {
+
+// Temp table holding the documents fetched by one sync
+static constexpr const char *kSyncDeltaTable = "__firestore_sync_delta";
+
+struct FirestoreSyncBindData : public TableFunctionData {
+	std::string collection;
+	std::string target_table;
+	std::string watermark_field = "updated_at";
+	// Fully qualified, resolved against the caller's USE at bind time: the sync runs on its own
+	// connection, whose default database is not the caller's
+	QualifiedName target;
+	QualifiedName state_table;
+	// Credential overrides forwarded to firestore_scan (name, value)
+	std::vector<std::pair<std::string, std::string>> scan_parameters;
+};
+
+struct FirestoreSyncGlobalState : public GlobalTableFunctionState {
+	bool done = false;
+
+	idx_t MaxThreads() const override {
+		return 1;
+	}
+};
+
+struct FirestoreSyncResult {
+	int64_t documents = 0;
+	Value watermark;
+};
+
+static std::string QuoteLiteral(const std::string &value) {
+	return KeywordHelper::WriteQuoted(value, '\'');
+}
+
+static std::string QuoteTableName(const QualifiedName &name) {
+	std::string result;
+	if (!name.catalog.empty()) {
+		result += KeywordHelper::WriteOptionallyQuoted(name.catalog) + ".";
+	}
+	if (!name.schema.empty()) {
+		result += KeywordHelper::WriteOptionallyQuoted(name.schema) + ".";
+	}
+	return result + KeywordHelper::WriteOptionallyQuoted(name.name);
+}
+
+static unique_ptr<MaterializedQueryResult> RunSyncQuery(Connection &con, const std::string &sql) {
+	FS_LOG_DEBUG("firestore_sync: " + sql);
+	auto result = con.Query(sql);
+	if (result->HasError()) {
+		throw InvalidInputException("Firestore sync failed: %s", result->GetError());
+	}
+	return result;
+}
+
+static bool TargetTableExists(Connection &con, const QualifiedName &name) {
+	auto result = RunSyncQuery(con, "SELECT count(*) FROM duckdb_tables() WHERE database_name = " +
+	                                    QuoteLiteral(name.catalog) + " AND schema_name = " + QuoteLiteral(name.schema) +
+	                                    " AND lower(table_name) = lower(" + QuoteLiteral(name.name) + ")");
+	return result->GetValue(0, 0).GetValue<int64_t>() > 0;
+}
+
+// Fill in the catalog and schema of `name` the way the caller's session would: "t" and "s.t"
+// live in the default database, and "db.t" names a table in the default schema of database db
+static QualifiedName QualifySyncTableName(ClientContext &context, QualifiedName name, const std::string &catalog,
+                                          const std::string &schema) {
+	if (!name.catalog.empty()) {
+		return name;
+	}
+	if (name.schema.empty()) {
+		name.schema = schema;
+	} else if (!Catalog::GetSchema(context, catalog, name.schema, OnEntryNotFound::RETURN_NULL) &&
+	           Catalog::GetCatalogEntry(context, name.schema)) {
+		name.catalog = name.schema;
+		name.schema = DEFAULT_SCHEMA;
+		return name;
+	}
+	name.catalog = catalog;
+	return name;
+}
+
+// A new connection starts from the global settings: carry over the caller's session values of
+// the extension's settings (scan partitions, schema cache, retries, ...). Settings whose value
+// already matches are left alone, so process-wide ones are never re-applied.
+static void CopyFirestoreSettings(ClientContext &context, Connection &con) {
+	auto &config = DBConfig::GetConfig(context);
+	for (auto &entry : config.extension_parameters) {
+		if (!StringUtil::StartsWith(entry.first, "firestore_")) {
+			continue;
+		}
+		Value caller_value;
+		Value sync_value;
+		if (!context.TryGetCurrentSetting(entry.first, caller_value)) {
+			continue;
+		}
+		if (con.context->TryGetCurrentSetting(entry.first, sync_value) &&
+		    Value::NotDistinctFrom(caller_value, sync_value)) {
+			continue;
+		}
+		RunSyncQuery(con, "SET " + KeywordHelper::WriteOptionallyQuoted(entry.first) + " = " +
+		                      caller_value.ToSQLString());
+	}
+}
+
+// Runs inside the transaction FirestoreSyncFunction opened on its own connection `con`, which
+// it commits or rolls back independently of the calling session's transaction
+static FirestoreSyncResult SyncCollection(Connection &con, const FirestoreSyncBindData &bind_data) {
+	auto state_table = QuoteTableName(bind_data.state_table);
+	RunSyncQuery(con, "CREATE TABLE IF NOT EXISTS " + state_table +
+	                      " (collection VARCHAR, target_table VARCHAR, watermark_field VARCHAR, watermark VARCHAR, "
+	                      "watermark_type VARCHAR, documents BIGINT, synced_at TIMESTAMP)");
+
+	std::string state_key = " WHERE collection = " + QuoteLiteral(bind_data.collection) +
+	                        " AND target_table = " + QuoteLiteral(bind_data.target_table) +
+	                        " AND watermark_field = " + QuoteLiteral(bind_data.watermark_field);
+	auto prior = RunSyncQuery(con, "SELECT watermark, watermark_type FROM " + state_table + state_key);
+	Value prior_watermark;
+	std::string watermark_type;
+	if (prior->RowCount() > 0) {
+		prior_watermark = prior->GetValue(0, 0);
+		watermark_type = prior->GetValue(1, 0).IsNull() ? "" : prior->GetValue(1, 0).ToString();
+	}
+
+	// The watermark filter is pushed down to runQuery, so only changed documents are read.
+	// >= rather than > re-reads the boundary documents, which is harmless for an upsert and
+	// keeps documents written in the same instant as the previous maximum.
+	auto field = KeywordHelper::WriteOptionallyQuoted(bind_data.watermark_field);
+	std::string scan = "SELECT * FROM firestore_scan(" + QuoteLiteral(bind_data.collection);
+	for (auto &param : bind_data.scan_parameters) {
+		scan += ", " + param.first + " := " + QuoteLiteral(param.second);
+	}
+	scan += ")";
+	if (!prior_watermark.IsNull() && !watermark_type.empty()) {
+		scan += " WHERE " + field + " >= CAST(" + QuoteLiteral(prior_watermark.ToString()) + " AS " +
+		        watermark_type + ")";
+	}
+	RunSyncQuery(con, "CREATE OR REPLACE TEMP TABLE " + std::string(kSyncDeltaTable) + " AS " + scan);
+
+	auto delta_columns = RunSyncQuery(con, "SELECT * FROM " + std::string(kSyncDeltaTable) + " LIMIT 0")->names;
+	case_insensitive_set_t delta_column_set(delta_columns.begin(), delta_columns.end());
+	if (delta_column_set.find(bind_data.watermark_field) == delta_column_set.end()) {
+		throw InvalidInputException("Firestore sync failed: watermark field '%s' not found in collection '%s'",
+		                            bind_data.watermark_field, bind_data.collection);
+	}
+
+	auto summary = RunSyncQuery(con, "SELECT count(*), max(" + field + ")::VARCHAR, typeof(max(" + field +
+	                                     ")) FROM " + std::string(kSyncDeltaTable));
+	FirestoreSyncResult result;
+	result.documents = summary->GetValue(0, 0).GetValue<int64_t>();
+	result.watermark = summary->GetValue(1, 0);
+	if (result.watermark.IsNull()) {
+		// Nothing changed (or no document has the field yet): keep the previous watermark
+		result.watermark = prior_watermark;
+	} else {
+		watermark_type = summary->GetValue(2, 0).ToString();
+	}
+
+	auto target = QuoteTableName(bind_data.target);
+	if (!TargetTableExists(con, bind_data.target)) {
+		RunSyncQuery(con, "CREATE TABLE " + target + " AS SELECT * FROM " + std::string(kSyncDeltaTable));
+	} else if (result.documents > 0) {
+		// Copy only the columns the target has; fields added in Firestore later are ignored
+		// and target columns missing from the delta are left NULL
+		auto target_columns = RunSyncQuery(con, "SELECT * FROM " + target + " LIMIT 0")->names;
+		case_insensitive_set_t target_column_set(target_columns.begin(), target_columns.end());
+		if (target_column_set.find("__document_id") == target_column_set.end()) {
+			throw InvalidInputException("Firestore sync failed: target table '%s' has no __document_id column",
+			                            bind_data.target_table);
+		}
+		std::string columns;
+		for (auto &column : delta_columns) {
+			if (target_column_set.find(column) != target_column_set.end()) {
+				columns += (columns.empty() ? "" : ", ") + KeywordHelper::WriteOptionallyQuoted(column);
+			}
+		}
+		RunSyncQuery(con, "DELETE FROM " + target + " WHERE __document_id IN (SELECT __document_id FROM " +
+		                      std::string(kSyncDeltaTable) + ")");
+		RunSyncQuery(con, "INSERT INTO " + target + " BY NAME SELECT " + columns + " FROM " +
+		                      std::string(kSyncDeltaTable));
+	}
+
+	RunSyncQuery(con, "DELETE FROM " + state_table + state_key);
+	RunSyncQuery(con, "INSERT INTO " + state_table + " VALUES (" + QuoteLiteral(bind_data.collection) + ", " +
+	                      QuoteLiteral(bind_data.target_table) + ", " + QuoteLiteral(bind_data.watermark_field) +
+	                      ", " + (result.watermark.IsNull() ? "NULL" : QuoteLiteral(result.watermark.ToString())) +
+	                      ", " + (watermark_type.empty() ? "NULL" : QuoteLiteral(watermark_type)) + ", " +
+	                      std::to_string(result.documents) + ", now()::TIMESTAMP)");
+	RunSyncQuery(con, "DROP TABLE " + std::string(kSyncDeltaTable));
+	return result;
+}
+
+static unique_ptr<FunctionData> FirestoreSyncBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<FirestoreSyncBindData>();
+	result->collection = input.inputs[0].GetValue<string>();
+	result->target_table = input.inputs[1].GetValue<string>();
+
+	std::optional<std::string> database_id;
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "watermark_field") {
+			result->watermark_field = kv.second.GetValue<string>();
+		} else if (kv.first == "database") {
+			database_id = kv.second.GetValue<string>();
+		} else if (kv.first == "project_id" || kv.first == "credentials" || kv.first == "api_key") {
+			result->scan_parameters.emplace_back(kv.first, kv.second.GetValue<string>());
+		}
+	}
+	if (result->watermark_field.empty()) {
+		throw BinderException("firestore_sync: watermark_field must not be empty");
+	}
+	if (result->target_table.empty()) {
+		throw BinderException("firestore_sync: target table name must not be empty");
+	}
+
+	auto default_entry = ClientData::Get(context).catalog_search_path->GetDefault();
+	auto catalog = default_entry.catalog.empty() ? DatabaseManager::GetDefaultDatabase(context) : default_entry.catalog;
+	auto schema = default_entry.schema.empty() ? std::string(DEFAULT_SCHEMA) : default_entry.schema;
+	result->target = QualifySyncTableName(context, QualifiedName::Parse(result->target_table), catalog, schema);
+	result->state_table.catalog = catalog;
+	result->state_table.schema = schema;
+	result->state_table.name = kFirestoreSyncStateTable;
+
+	// The scan runs on its own connection, which does not see this session's firestore_connect()
+	if (!database_id.has_value()) {
+		database_id = GetConnectedDatabase(context);
+	}
+	if (database_id.has_value()) {
+		result->scan_parameters.emplace_back("database", *database_id);
+	}
+
+	names = {"collection", "target_table", "documents", "watermark"};
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::VARCHAR};
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> FirestoreSyncInitGlobal(ClientContext &context,
+                                                                    TableFunctionInitInput &input) {
+	return make_uniq<FirestoreSyncGlobalState>();
+}
+
+static void FirestoreSyncFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<FirestoreSyncGlobalState>();
+	if (state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	auto &bind_data = data.bind_data->Cast<FirestoreSyncBindData>();
+
+	// The delta, the upsert and the new watermark are committed together on a separate
+	// connection, so a failed sync leaves both the target table and the watermark untouched
+	Connection con(*context.db);
+	CopyFirestoreSettings(context, con);
+	RunSyncQuery(con, "BEGIN TRANSACTION");
+	FirestoreSyncResult result;
+	try {
+		result = SyncCollection(con, bind_data);
+		RunSyncQuery(con, "COMMIT");
+	} catch (...) {
+		con.Query("ROLLBACK");
+		throw;
+	}
+	FS_LOG_DEBUG("firestore_sync: " + std::to_string(result.documents) + " documents from '" + bind_data.collection +
+	             "' into '" + bind_data.target_table + "'");
+
+	output.SetValue(0, 0, Value(bind_data.collection));
+	output.SetValue(1, 0, Value(bind_data.target_table));
+	output.SetValue(2, 0, Value::BIGINT(result.documents));
+	output.SetValue(3, 0, result.watermark.IsNull() ? Value(LogicalType::VARCHAR) : Value(result.watermark.ToString()));
+	output.SetCardinality(1);
+	state.done = true;
+}
+
+void RegisterFirestoreSyncFunction(ExtensionLoader &loader) {
+	TableFunction sync_func("firestore_sync", {LogicalType::VARCHAR, LogicalType::VARCHAR}, FirestoreSyncFunction,
+	                        FirestoreSyncBind, FirestoreSyncInitGlobal);
+	sync_func.named_parameters["watermark_field"] = LogicalType::VARCHAR;
+	sync_func.named_parameters["project_id"] = LogicalType::VARCHAR;
+	sync_func.named_parameters["credentials"] = LogicalType::VARCHAR;
+	sync_func.named_parameters["api_key"] = LogicalType::VARCHAR;
+	sync_func.named_parameters["database"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(sync_func);
+}
+
+} // namespace duckdb
@@ -0,0 +1,214 @@
+#include "firestore_transport.hpp"
+#include "firestore_connection_pool.hpp"
+#include "firestore_logger.hpp"
+#include "duckdb/common/exception.hpp"
+#include <nlohmann/json.hpp>
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.h"
+#include <chrono>
+#include <thread>
+
+using json = nlohmann::json;
+
+namespace duckdb {
+
+// ============================================================================
+// Process-wide transport
+// ============================================================================
+
+static std::mutex transport_mutex;
+
+static std::shared_ptr<FirestoreTransport> &CurrentTransport() {
+	static std::shared_ptr<FirestoreTransport> transport = std::make_shared<FirestoreHttpTransport>();
+	return transport;
+}
+
+std::shared_ptr<FirestoreTransport> FirestoreTransport::Get() {
+	std::lock_guard<std::mutex> guard(transport_mutex);
+	return CurrentTransport();
+}
+
+void FirestoreTransport::Set(std::shared_ptr<FirestoreTransport> transport) {
+	std::lock_guard<std::mutex> guard(transport_mutex);
+	CurrentTransport() = std::move(transport);
+}
+
+void FirestoreTransport::Reset() {
+	Set(std::make_shared<FirestoreHttpTransport>());
+}
+
+std::string RedactFirestoreUrl(const std::string &url) {
+	std::string result = url;
+	for (auto pos = result.find("key="); pos != std::string::npos; pos = result.find("key=", pos + 1)) {
+		if (pos == 0 || (result[pos - 1] != '?' && result[pos - 1] != '&')) {
+			continue;
+		}
+		auto value_start = pos + 4;
+		auto value_end = result.find('&', value_start);
+		result.replace(value_start, value_end == std::string::npos ? std::string::npos : value_end - value_start,
+		               "REDACTED");
+	}
+	return result;
+}
+
+// Replay lookup key of a request
+static std::string ReplayKey(const std::string &method, const std::string &url, const std::string &body) {
+	return method + " " + RedactFirestoreUrl(url) + "\n" + body;
+}
+
+// ============================================================================
+// HTTP
+// ============================================================================
+
+// Scheme+host and path of an absolute URL
+static bool SplitUrl(const std::string &url, std::string &scheme_host, std::string &path) {
+	auto scheme_end = url.find("://");
+	if (scheme_end == std::string::npos) {
+		return false;
+	}
+	auto path_start = url.find('/', scheme_end + 3);
+	if (path_start == std::string::npos) {
+		scheme_host = url;
+		path = "/";
+	} else {
+		scheme_host = url.substr(0, path_start);
+		path = url.substr(path_start);
+	}
+	return true;
+}
+
+FirestoreHttpResponse FirestoreHttpTransport::Send(const FirestoreHttpRequest &request) {
+	FirestoreHttpResponse response;
+	std::string scheme_host, path;
+	if (!SplitUrl(request.url, scheme_host, path)) {
+		response.transport_error = "Failed to parse URL: " + request.url;
+		return response;
+	}
+
+	// Lease a keep-alive connection so TCP/TLS setup is amortized across requests
+	auto cli = FirestoreConnectionPool::Instance().Acquire(scheme_host);
+
+	httplib::Headers headers = {{"Content-Type", "application/json"}};
+	if (!request.auth_header.empty()) {
+		headers.emplace("Authorization", request.auth_header);
+	}
+
+	httplib::Result res;
+	if (request.method == "POST") {
+		res = cli->Post(path, headers, request.body, "application/json");
+	} else if (request.method == "PATCH") {
+		res = cli->Patch(path, headers, request.body, "application/json");
+	} else if (request.method == "DELETE") {
+		res = cli->Delete(path, headers);
+	} else {
+		res = cli->Get(path, headers);
+	}
+
+	if (!res) {
+		// Don't hand a broken connection back to the pool
+		cli.Discard();
+		response.transport_error = "HTTP request failed: " + httplib::to_string(res.error());
+		return response;
+	}
+	response.status = res->status;
+	response.body = std::move(res->body);
+	return response;
+}
+
+// ============================================================================
+// Record
+// ============================================================================
+
+FirestoreRecordingTransport::FirestoreRecordingTransport(std::shared_ptr<FirestoreTransport> inner,
+                                                         const std::string &path)
+    : inner_(std::move(inner)), path_(path), out_(path, std::ios::out | std::ios::app) {
+	if (!out_.is_open()) {
+		throw IOException("Failed to open Firestore HTTP recording '%s' for writing", path);
+	}
+}
+
+FirestoreHttpResponse FirestoreRecordingTransport::Send(const FirestoreHttpRequest &request) {
+	auto response = inner_->Send(request);
+	if (!response.transport_error.empty()) {
+		return response; // Nothing to replay
+	}
+
+	// Bodies are kept as strings, so replay returns them byte for byte
+	json entry = {{"method", request.method},
+	              {"url", RedactFirestoreUrl(request.url)},
+	              {"request_body", request.body},
+	              {"status", response.status},
+	              {"response_body", response.body}};
+	auto line = entry.dump(-1, ' ', false, json::error_handler_t::replace);
+	std::lock_guard<std::mutex> guard(mutex_);
+	out_ << line << '\n';
+	out_.flush();
+	return response;
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+FirestoreReplayTransport::FirestoreReplayTransport(const std::string &path, int64_t latency_ms)
+    : path_(path), latency_ms_(latency_ms) {
+	std::ifstream in(path);
+	if (!in.is_open()) {
+		throw IOException("Failed to open Firestore HTTP recording '%s'", path);
+	}
+	std::string line;
+	idx_t line_number = 0;
+	idx_t exchanges = 0;
+	while (std::getline(in, line)) {
+		line_number++;
+		if (line.empty()) {
+			continue;
+		}
+		json entry = json::parse(line, nullptr, false);
+		if (entry.is_discarded() || !entry.is_object()) {
+			throw InvalidInputException("Invalid Firestore HTTP recording '%s': line %llu is not a JSON object", path,
+			                            line_number);
+		}
+		FirestoreHttpResponse response;
+		response.status = entry.value("status", 0);
+		response.body = entry.value("response_body", "");
+		auto key = ReplayKey(entry.value("method", ""), entry.value("url", ""), entry.value("request_body", ""));
+		responses_[key].responses.push_back(std::move(response));
+		exchanges++;
+	}
+	FS_LOG_INFO("Replaying " + std::to_string(exchanges) + " recorded Firestore exchanges from " + path);
+}
+
+void FirestoreReplayTransport::SetLatencyMs(int64_t latency_ms) {
+	std::lock_guard<std::mutex> guard(mutex_);
+	latency_ms_ = latency_ms;
+}
+
+FirestoreHttpResponse FirestoreReplayTransport::Send(const FirestoreHttpRequest &request) {
+	FirestoreHttpResponse response;
+	int64_t latency_ms;
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		latency_ms = latency_ms_;
+		auto entry = responses_.find(ReplayKey(request.method, request.url, request.body));
+		if (entry == responses_.end()) {
+			response.status = 404;
+			response.body = json {{"error",
+			                       {{"code", 404},
+			                        {"status", "NOT_FOUND"},
+			                        {"message", "No recorded response for " + request.method + " " +
+			                                        RedactFirestoreUrl(request.url) + " in " + path_}}}}
+			                    .dump();
+		} else {
+			auto &recorded = entry->second;
+			response = recorded.responses[recorded.next];
+			recorded.next = (recorded.next + 1) % recorded.responses.size();
+		}
+	}
+	if (latency_ms > 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(latency_ms));
+	}
+	return response;
+}
+
+} // namespace duckdb
@@ -5,6 +5,7 @@
 #include <openssl/bio.h>
 #include <openssl/evp.h>
 #include <openssl/buffer.h>
+#include <charconv>
 #include <map>
 #include <set>
 
@@ -762,6 +763,265 @@ void SetDuckDBValue(Vector &vector, idx_t index, const json &firestore_value, co
 	}
 }
 
+// ============================================================================
+// Per-column writers
+// ============================================================================
+//
+// Each TryWrite* handles one exact Firestore value kind and returns false for anything else,
+// leaving the slot untouched so the caller can fall back to SetDuckDBValue.
+
+static void WriteGeneric(Vector &vector, idx_t index, const json &fv) {
+	SetDuckDBValue(vector, index, fv, vector.GetType());
+}
+
+// Same result as std::stoll (including its leniency), without the exception on the common path
+static bool ParseFirestoreInteger(const json &val, int64_t &result) {
+	if (val.is_number_integer()) {
+		result = val.get<int64_t>();
+		return true;
+	}
+	if (!val.is_string()) {
+		return false;
+	}
+	auto &str = val.get_ref<const std::string &>();
+	auto end = str.data() + str.size();
+	auto parsed = std::from_chars(str.data(), end, result);
+	if (parsed.ec == std::errc() && parsed.ptr == end) {
+		return true;
+	}
+	try {
+		result = std::stoll(str);
+		return true;
+	} catch (const std::exception &) {
+		return false;
+	}
+}
+
+static bool TryWriteString(Vector &vector, idx_t index, const json &fv) {
+	auto it = fv.find("stringValue");
+	if (it == fv.end() || !it->is_string()) {
+		return false;
+	}
+	FlatVector::GetData<string_t>(vector)[index] =
+	    StringVector::AddString(vector, it->get_ref<const std::string &>());
+	return true;
+}
+
+static bool TryWriteBigint(Vector &vector, idx_t index, const json &fv) {
+	auto it = fv.find("integerValue");
+	int64_t result;
+	if (it == fv.end() || !ParseFirestoreInteger(*it, result)) {
+		return false;
+	}
+	FlatVector::GetData<int64_t>(vector)[index] = result;
+	return true;
+}
+
+static bool TryWriteDouble(Vector &vector, idx_t index, const json &fv) {
+	auto it = fv.find("doubleValue");
+	if (it == fv.end() || !it->is_number()) {
+		return false;
+	}
+	FlatVector::GetData<double>(vector)[index] = it->get<double>();
+	return true;
+}
+
+static bool TryWriteBoolean(Vector &vector, idx_t index, const json &fv) {
+	auto it = fv.find("booleanValue");
+	if (it == fv.end() || !it->is_boolean()) {
+		return false;
+	}
+	FlatVector::GetData<bool>(vector)[index] = it->get<bool>();
+	return true;
+}
+
+static bool TryWriteTimestamp(Vector &vector, idx_t index, const json &fv) {
+	auto it = fv.find("timestampValue");
+	if (it == fv.end() || !it->is_string()) {
+		return false;
+	}
+	// Same normalization as FirestoreValueToDuckDB: drop the trailing Z, T -> space
+	std::string ts_str = it->get<std::string>();
+	if (!ts_str.empty() && ts_str.back() == 'Z') {
+		ts_str.pop_back();
+	}
+	size_t t_pos = ts_str.find('T');
+	if (t_pos != std::string::npos) {
+		ts_str[t_pos] = ' ';
+	}
+	try {
+		FlatVector::GetData<timestamp_t>(vector)[index] = Timestamp::FromString(ts_str, false);
+		return true;
+	} catch (const std::exception &) {
+		return false;
+	}
+}
+
+static void WriteVarchar(Vector &vector, idx_t index, const json &fv) {
+	if (TryWriteString(vector, index, fv)) {
+		return;
+	}
+	auto it = fv.find("referenceValue");
+	if (it != fv.end() && it->is_string()) {
+		FlatVector::GetData<string_t>(vector)[index] =
+		    StringVector::AddString(vector, it->get_ref<const std::string &>());
+		return;
+	}
+	WriteGeneric(vector, index, fv);
+}
+
+template <bool (*TRY_WRITE)(Vector &, idx_t, const json &)>
+static void WriteScalar(Vector &vector, idx_t index, const json &fv) {
+	if (!TRY_WRITE(vector, index, fv)) {
+		WriteGeneric(vector, index, fv);
+	}
+}
+
+// LIST(T) where every element is null or exactly a T value
+template <bool (*TRY_WRITE_ELEMENT)(Vector &, idx_t, const json &)>
+static void WriteList(Vector &vector, idx_t index, const json &fv) {
+	auto arr = fv.find("arrayValue");
+	if (arr == fv.end() || !arr->is_object()) {
+		WriteGeneric(vector, index, fv);
+		return;
+	}
+	auto values = arr->find("values");
+	if (values != arr->end() && !values->is_array()) {
+		WriteGeneric(vector, index, fv);
+		return;
+	}
+	idx_t list_size = values == arr->end() ? 0 : values->size();
+
+	auto offset = ListVector::GetListSize(vector);
+	ListVector::Reserve(vector, offset + list_size);
+	auto &child_vector = ListVector::GetEntry(vector);
+	for (idx_t i = 0; i < list_size; i++) {
+		auto &elem = (*values)[i];
+		if (IsFirestoreNull(elem)) {
+			FlatVector::SetNull(child_vector, offset + i, true);
+		} else if (!TRY_WRITE_ELEMENT(child_vector, offset + i, elem)) {
+			// Mixed element types: undo the null marks and convert the whole list generically
+			for (idx_t j = 0; j < i; j++) {
+				FlatVector::SetNull(child_vector, offset + j, false);
+			}
+			WriteGeneric(vector, index, fv);
+			return;
+		}
+	}
+	ListVector::SetListSize(vector, offset + list_size);
+	FlatVector::GetData<list_entry_t>(vector)[index] = list_entry_t(offset, list_size);
+}
+
+static bool IsGeoPointStructType(const LogicalType &type) {
+	auto &child_types = StructType::GetChildTypes(type);
+	return child_types.size() == 2 && child_types[0].first == "latitude" &&
+	       child_types[0].second.id() == LogicalTypeId::DOUBLE && child_types[1].first == "longitude" &&
+	       child_types[1].second.id() == LogicalTypeId::DOUBLE;
+}
+
+static void WriteGeoPoint(Vector &vector, idx_t index, const json &fv) {
+	auto geo = fv.find("geoPointValue");
+	if (geo == fv.end() || !geo->is_object()) {
+		WriteGeneric(vector, index, fv);
+		return;
+	}
+	double coords[2] = {0.0, 0.0};
+	const char *names[2] = {"latitude", "longitude"};
+	for (idx_t i = 0; i < 2; i++) {
+		auto it = geo->find(names[i]);
+		if (it != geo->end()) {
+			if (!it->is_number()) {
+				WriteGeneric(vector, index, fv);
+				return;
+			}
+			coords[i] = it->get<double>();
+		}
+	}
+	auto &entries = StructVector::GetEntries(vector);
+	FlatVector::GetData<double>(*entries[0])[index] = coords[0];
+	FlatVector::GetData<double>(*entries[1])[index] = coords[1];
+}
+
+// ARRAY(DOUBLE, N) from a Firestore vector whose elements are doubles or nulls
+static void WriteVector(Vector &vector, idx_t index, const json &fv) {
+	if (!IsFirestoreVector(fv)) {
+		WriteGeneric(vector, index, fv);
+		return;
+	}
+	const auto &arr = fv["mapValue"]["fields"]["value"]["arrayValue"];
+	auto values = arr.find("values");
+	bool has_values = values != arr.end() && values->is_array();
+	if (values != arr.end() && !has_values) {
+		WriteGeneric(vector, index, fv);
+		return;
+	}
+	if (has_values) {
+		for (auto &elem : *values) {
+			auto dv = elem.find("doubleValue");
+			if (!(dv != elem.end() && dv->is_number()) && !IsFirestoreNull(elem)) {
+				WriteGeneric(vector, index, fv);
+				return;
+			}
+		}
+	}
+
+	auto array_size = ArrayType::GetSize(vector.GetType());
+	idx_t value_count = has_values ? values->size() : 0;
+	auto &child_vector = ArrayVector::GetEntry(vector);
+	auto child_data = FlatVector::GetData<double>(child_vector);
+	for (idx_t i = 0; i < array_size; i++) {
+		idx_t pos = index * array_size + i;
+		if (i < value_count && !IsFirestoreNull((*values)[i])) {
+			child_data[pos] = (*values)[i]["doubleValue"].get<double>();
+		} else {
+			// Null element, or dimension mismatch - pad with nulls
+			FlatVector::SetNull(child_vector, pos, true);
+		}
+	}
+}
+
+FirestoreColumnWriter GetFirestoreColumnWriter(const LogicalType &type) {
+	switch (type.id()) {
+	case LogicalTypeId::VARCHAR:
+		return WriteVarchar;
+	case LogicalTypeId::BIGINT:
+		return WriteScalar<TryWriteBigint>;
+	case LogicalTypeId::DOUBLE:
+		return WriteScalar<TryWriteDouble>;
+	case LogicalTypeId::BOOLEAN:
+		return WriteScalar<TryWriteBoolean>;
+	case LogicalTypeId::TIMESTAMP:
+		return WriteScalar<TryWriteTimestamp>;
+	case LogicalTypeId::LIST:
+		switch (ListType::GetChildType(type).id()) {
+		case LogicalTypeId::VARCHAR:
+			return WriteList<TryWriteString>;
+		case LogicalTypeId::BIGINT:
+			return WriteList<TryWriteBigint>;
+		case LogicalTypeId::DOUBLE:
+			return WriteList<TryWriteDouble>;
+		case LogicalTypeId::BOOLEAN:
+			return WriteList<TryWriteBoolean>;
+		default:
+			break;
+		}
+		break;
+	case LogicalTypeId::STRUCT:
+		if (IsGeoPointStructType(type)) {
+			return WriteGeoPoint;
+		}
+		break;
+	case LogicalTypeId::ARRAY:
+		if (ArrayType::GetChildType(type).id() == LogicalTypeId::DOUBLE) {
+			return WriteVector;
+		}
+		break;
+	default:
+		break;
+	}
+	return WriteGeneric;
+}
+
 // Helper to infer the element type of an array by sampling its elements
 LogicalType InferArrayElementType(const std::vector<json> &document_fields, const std::string &field_name,
                                   idx_t sample_size) {
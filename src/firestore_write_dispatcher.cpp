@@ -0,0 +1,251 @@
+#include "firestore_write_dispatcher.hpp"
+#include "firestore_logger.hpp"
+#include "firestore_retry.hpp"
+#include <chrono>
+
+namespace duckdb {
+
+// google.rpc.Code values a write may succeed on when re-sent
+static bool IsRetryableWriteStatus(int32_t code) {
+	switch (code) {
+	case 4:  // DEADLINE_EXCEEDED
+	case 8:  // RESOURCE_EXHAUSTED
+	case 10: // ABORTED
+	case 13: // INTERNAL
+	case 14: // UNAVAILABLE
+		return true;
+	default:
+		return false;
+	}
+}
+
+static FirestoreErrorCode WriteStatusToErrorCode(int32_t code) {
+	switch (code) {
+	case 5: // NOT_FOUND
+		return FirestoreErrorCode::NOT_FOUND_DOCUMENT;
+	case 7: // PERMISSION_DENIED
+		return FirestoreErrorCode::PERMISSION_DENIED;
+	case 8: // RESOURCE_EXHAUSTED
+		return FirestoreErrorCode::REQUEST_RATE_LIMITED;
+	default:
+		return FirestoreErrorCode::WRITE_BATCH_PARTIAL_FAILURE;
+	}
+}
+
+static std::string GetWriteDocumentName(const json &write) {
+	if (write.contains("update")) {
+		return write["update"].value("name", "");
+	}
+	if (write.contains("delete")) {
+		return write["delete"].get<std::string>();
+	}
+	if (write.contains("transform")) {
+		return write["transform"].value("document", "");
+	}
+	return "";
+}
+
+BatchOperationResult CommitBatchWrites(FirestoreClient &client, const std::vector<json> &writes) {
+	BatchOperationResult result;
+	result.total_requested = writes.size();
+
+	// Indexes (into `writes`) still to be committed
+	std::vector<size_t> pending(writes.size());
+	for (size_t i = 0; i < pending.size(); i++) {
+		pending[i] = i;
+	}
+
+	auto policy = FirestoreRetry::GetPolicy();
+	for (int64_t attempt = 1; !pending.empty(); attempt++) {
+		std::vector<json> batch;
+		batch.reserve(pending.size());
+		for (auto idx : pending) {
+			batch.push_back(writes[idx]);
+		}
+
+		auto statuses = client.BatchWrite(batch);
+
+		std::vector<size_t> retry;
+		for (size_t i = 0; i < pending.size(); i++) {
+			auto &status = statuses[i];
+			if (status.code == 0) {
+				result.add_success();
+			} else if (IsRetryableWriteStatus(status.code) && attempt < policy.max_attempts) {
+				retry.push_back(pending[i]);
+			} else {
+				result.add_failure(pending[i], GetWriteDocumentName(writes[pending[i]]),
+				                   WriteStatusToErrorCode(status.code), status.message);
+			}
+		}
+
+		if (!retry.empty()) {
+			FS_LOG_DEBUG("BatchWrite: retrying " + std::to_string(retry.size()) + " of " +
+			             std::to_string(batch.size()) + " writes (attempt " + std::to_string(attempt + 1) + ")");
+			FirestoreRetry::RecordWriteRetries(retry.size());
+			std::this_thread::sleep_for(FirestoreRetry::BackoffDelay(policy, attempt));
+		}
+		pending = std::move(retry);
+	}
+
+	return result;
+}
+
+void ThrowIfWritesFailed(const BatchOperationResult &result) {
+	if (!result.has_failures()) {
+		return;
+	}
+	auto &first = result.failures.front();
+	FirestoreErrorContext ctx;
+	ctx.withOperation("batch_write").withDocument(first.document_id).withBatchIndex(first.index);
+	throw FirestoreError(FirestoreErrorCode::WRITE_BATCH_PARTIAL_FAILURE,
+	                     std::to_string(result.failed) + " of " + std::to_string(result.total_requested) +
+	                         " writes failed, first: " + first.document_id + ": " + first.error_message,
+	                     ctx);
+}
+
+void LogFailedWrites(const BatchOperationResult &result) {
+	for (auto &failure : result.failures) {
+		FS_LOG_WARN("Write failed during batch operation: " + failure.document_id + ": " + failure.error_message);
+	}
+}
+
+// Send update and delete writes as single-document requests; returns the documents written
+static idx_t CommitIndividualWrites(FirestoreClient &client, const std::vector<json> &writes) {
+	idx_t written = 0;
+	for (auto &write : writes) {
+		// ".../documents/users/u1" -> collection "users", document "u1"
+		auto name = GetWriteDocumentName(write);
+		auto documents = name.find("/documents/");
+		auto path = documents == std::string::npos ? name : name.substr(documents + 11);
+		auto slash = path.rfind('/');
+		auto collection = slash == std::string::npos ? std::string() : path.substr(0, slash);
+		auto document_id = path.substr(slash + 1);
+		try {
+			if (write.contains("delete")) {
+				client.DeleteDocument(collection, document_id);
+			} else {
+				// Keep the write's precondition: a PATCH would otherwise recreate a deleted document
+				bool must_exist = write.contains("currentDocument") && write["currentDocument"].value("exists", false);
+				client.UpdateDocument(collection, document_id, write["update"]["fields"], must_exist);
+			}
+			written++;
+		} catch (const FirestoreNotFoundException &) {
+			FS_LOG_WARN("Document not found during batch operation: " + path);
+		}
+	}
+	return written;
+}
+
+// ============================================================================
+// FirestoreWriteDispatcher
+// ============================================================================
+
+FirestoreWriteDispatcher::FirestoreWriteDispatcher(std::shared_ptr<FirestoreCredentials> credentials,
+                                                   idx_t max_in_flight, std::shared_ptr<FirestoreIOStats> stats)
+    : credentials_(std::move(credentials)), stats_(std::move(stats)),
+      max_in_flight_(max_in_flight == 0 ? 1 : max_in_flight) {
+}
+
+FirestoreWriteDispatcher::~FirestoreWriteDispatcher() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+		// Batches not yet picked up are dropped; requests already sent are allowed to finish
+		in_flight_ -= queue_.size();
+		queue_.clear();
+	}
+	cv_.notify_all();
+	for (auto &worker : workers_) {
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+}
+
+void FirestoreWriteDispatcher::RethrowError() {
+	if (error_) {
+		auto error = error_;
+		error_ = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+void FirestoreWriteDispatcher::Submit(std::vector<json> writes) {
+	Enqueue({std::move(writes), false});
+}
+
+void FirestoreWriteDispatcher::SubmitIndividual(std::vector<json> writes) {
+	Enqueue({std::move(writes), true});
+}
+
+void FirestoreWriteDispatcher::Enqueue(PendingBatch batch) {
+	if (batch.writes.empty()) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock(mutex_);
+	cv_.wait(lock, [&] { return in_flight_ < max_in_flight_ || error_; });
+	RethrowError();
+
+	queue_.push_back(std::move(batch));
+	in_flight_++;
+	// Start workers lazily, so small inserts do not spin up the whole window
+	if (workers_.size() < max_in_flight_ && workers_.size() < in_flight_) {
+		workers_.emplace_back(&FirestoreWriteDispatcher::Run, this);
+	}
+	lock.unlock();
+	cv_.notify_all();
+}
+
+void FirestoreWriteDispatcher::Finish() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	cv_.wait(lock, [&] { return in_flight_ == 0 || error_; });
+	RethrowError();
+}
+
+void FirestoreWriteDispatcher::Run() {
+	FirestoreClient client(credentials_);
+	client.SetStats(stats_);
+	while (true) {
+		PendingBatch batch;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+			if (stop_) {
+				return;
+			}
+			batch = std::move(queue_.front());
+			queue_.pop_front();
+		}
+
+		std::exception_ptr error;
+		try {
+			if (batch.individual) {
+				committed_ += CommitIndividualWrites(client, batch.writes);
+			} else {
+				auto result = CommitBatchWrites(client, batch.writes);
+				committed_ += result.succeeded;
+				if (skip_failed_writes_) {
+					LogFailedWrites(result);
+				} else {
+					ThrowIfWritesFailed(result);
+				}
+			}
+		} catch (...) {
+			error = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			in_flight_--;
+			if (error && !error_) {
+				error_ = error;
+				// Stop sending the rest: the caller is going to fail the statement
+				in_flight_ -= queue_.size();
+				queue_.clear();
+			}
+		}
+		cv_.notify_all();
+	}
+}
+
+} // namespace duckdb
@@ -1,12 +1,22 @@
 #include "firestore_writer.hpp"
 #include "firestore_types.hpp"
 #include "firestore_secrets.hpp"
+#include "firestore_settings.hpp"
 #include "firestore_logger.hpp"
+#include "firestore_path_utils.hpp"
+#include "firestore_write_dispatcher.hpp"
+#include "firestore_index.hpp"
+#include "firestore_page_cursor.hpp"
+#include "firestore_scanner.hpp"
 #include "duckdb/main/extension/extension_loader.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
 #include "duckdb/common/types/data_chunk.hpp"
 #include "duckdb/common/enums/operator_result_type.hpp"
 #include "duckdb/execution/execution_context.hpp"
+#include "duckdb/function/copy_function.hpp"
+#include "duckdb/common/string_util.hpp"
+#include <algorithm>
+#include <random>
 
 namespace duckdb {
 
@@ -31,12 +41,16 @@ struct FirestoreInsertBindData : public TableFunctionData {
 
 struct FirestoreInsertGlobalState : public GlobalTableFunctionState {
 	std::unique_ptr<FirestoreClient> client;
-	idx_t rows_inserted;
+	// Full batches after the first are committed in the background, several at a time
+	std::unique_ptr<FirestoreWriteDispatcher> dispatcher;
+	idx_t rows_inserted; // Rows written on the calling thread (excludes dispatcher->Committed())
 	std::vector<json> batch_writes;
+	bool batch_write_verified; // The first BatchWrite succeeded, so batch mode is permitted
 	bool use_individual_ops;
 	bool count_emitted;
 
-	FirestoreInsertGlobalState() : rows_inserted(0), use_individual_ops(false), count_emitted(false) {
+	FirestoreInsertGlobalState()
+	    : rows_inserted(0), batch_write_verified(false), use_individual_ops(false), count_emitted(false) {
 	}
 	idx_t MaxThreads() const override {
 		return 1;
@@ -114,7 +128,11 @@ static unique_ptr<GlobalTableFunctionState> FirestoreInsertInitGlobal(ClientCont
                                                                       TableFunctionInitInput &input) {
 	auto &bind_data = input.bind_data->Cast<FirestoreInsertBindData>();
 	auto global_state = make_uniq<FirestoreInsertGlobalState>();
+	auto stats = GetFirestoreQueryStats(context);
 	global_state->client = make_uniq<FirestoreClient>(bind_data.credentials);
+	global_state->client->SetStats(stats);
+	global_state->dispatcher = make_uniq<FirestoreWriteDispatcher>(
+	    bind_data.credentials, static_cast<idx_t>(FirestoreSettings::WriteConcurrency(context)), stats);
 	return std::move(global_state);
 }
 
@@ -130,9 +148,23 @@ static void FlushInsertBatchWrites(FirestoreInsertBindData &bind_data, Firestore
 		return;
 	}
 
+	if (global_state.batch_write_verified) {
+		try {
+			global_state.dispatcher->Submit(std::move(global_state.batch_writes));
+		} catch (const std::exception &e) {
+			throw InvalidInputException("Firestore insert failed: " + std::string(e.what()));
+		}
+		global_state.batch_writes.clear();
+		return;
+	}
+
+	// The first batch is committed on this thread: BatchWrite needs admin auth, and a
+	// permission error has to switch the insert to CreateDocument before batches are queued.
 	try {
-		global_state.client->BatchWrite(global_state.batch_writes);
-		global_state.rows_inserted += global_state.batch_writes.size();
+		auto result = CommitBatchWrites(*global_state.client, global_state.batch_writes);
+		global_state.rows_inserted += result.succeeded;
+		ThrowIfWritesFailed(result);
+		global_state.batch_write_verified = true;
 	} catch (const FirestorePermissionException &) {
 		// BatchWrite requires admin auth - fall back to individual CreateDocument calls
 		FS_LOG_WARN("BatchWrite permission denied for insert, falling back to individual CreateDocument calls");
@@ -150,6 +182,8 @@ static void FlushInsertBatchWrites(FirestoreInsertBindData &bind_data, Firestore
 				FS_LOG_WARN("Individual insert failed during fallback: " + std::string(e.what()));
 			}
 		}
+	} catch (const FirestoreError &e) {
+		throw InvalidInputException("Firestore insert failed: " + std::string(e.what()));
 	}
 	global_state.batch_writes.clear();
 }
@@ -160,8 +194,6 @@ static OperatorResultType FirestoreInsertInOutFunction(ExecutionContext &context
 	auto &bind_data = data.bind_data->CastNoConst<FirestoreInsertBindData>();
 	auto &global_state = data.global_state->Cast<FirestoreInsertGlobalState>();
 
-	const size_t BATCH_SIZE = 500;
-
 	for (idx_t row_idx = 0; row_idx < input.size(); row_idx++) {
 		// Build Firestore fields JSON for this row
 		json fields;
@@ -213,7 +245,7 @@ static OperatorResultType FirestoreInsertInOutFunction(ExecutionContext &context
 			json write_op = {{"update", {{"name", doc_path}, {"fields", fields}}}};
 			global_state.batch_writes.push_back(write_op);
 
-			if (global_state.batch_writes.size() >= BATCH_SIZE) {
+			if (global_state.batch_writes.size() >= kFirestoreMaxBatchWrites) {
 				FlushInsertBatchWrites(bind_data, global_state);
 			}
 		}
@@ -234,13 +266,19 @@ static OperatorFinalizeResultType FirestoreInsertFinal(ExecutionContext &context
 		return OperatorFinalizeResultType::FINISHED;
 	}
 
-	// Flush any remaining batch writes
+	// Flush any remaining batch writes and wait for the batches still in flight
 	if (!bind_data.use_auto_ids && !global_state.batch_writes.empty()) {
 		FlushInsertBatchWrites(bind_data, global_state);
 	}
+	try {
+		global_state.dispatcher->Finish();
+	} catch (const std::exception &e) {
+		throw InvalidInputException("Firestore insert failed: " + std::string(e.what()));
+	}
 
 	// Emit the final count
-	FlatVector::GetData<int64_t>(output.data[0])[0] = static_cast<int64_t>(global_state.rows_inserted);
+	auto rows_inserted = global_state.rows_inserted + global_state.dispatcher->Committed();
+	FlatVector::GetData<int64_t>(output.data[0])[0] = static_cast<int64_t>(rows_inserted);
 	output.SetCardinality(1);
 	global_state.count_emitted = true;
 	return OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
@@ -353,6 +391,7 @@ static void FirestoreUpdateFunction(ClientContext &context, TableFunctionInput &
 	try {
 		// Create Firestore client
 		FirestoreClient client(bind_data.credentials);
+		client.SetStats(GetFirestoreQueryStats(context));
 
 		// Build fields JSON for update
 		json fields;
@@ -456,6 +495,7 @@ static void FirestoreDeleteFunction(ClientContext &context, TableFunctionInput &
 	try {
 		// Create Firestore client
 		FirestoreClient client(bind_data.credentials);
+		client.SetStats(GetFirestoreQueryStats(context));
 
 		// Perform delete
 		client.DeleteDocument(bind_data.collection, bind_data.document_id);
@@ -472,6 +512,88 @@ static void FirestoreDeleteFunction(ClientContext &context, TableFunctionInput &
 	global_state.done = true;
 }
 
+// ============================================================================
+// Batched update/delete pipeline shared by the batch and streaming functions
+// ============================================================================
+
+// Single-document requests per task once BatchWrite is denied, so that small fallbacks are
+// still spread over the dispatcher's threads
+static constexpr idx_t kFirestoreIndividualWriteChunk = 25;
+
+// Commits a stream of update or delete writes. The first batch is committed on the calling
+// thread, so a permission error can switch to single-document requests before anything is
+// queued; later batches go to a FirestoreWriteDispatcher, which keeps up to
+// firestore_write_concurrency requests (batches or single-document tasks) in flight. Failed
+// writes are logged and skipped, so the count covers the documents actually written.
+class FirestoreBatchWritePipeline {
+public:
+	FirestoreBatchWritePipeline(ClientContext &context, std::shared_ptr<FirestoreCredentials> credentials) {
+		auto stats = GetFirestoreQueryStats(context);
+		client_ = make_uniq<FirestoreClient>(credentials);
+		client_->SetStats(stats);
+		dispatcher_ = make_uniq<FirestoreWriteDispatcher>(
+		    credentials, static_cast<idx_t>(FirestoreSettings::WriteConcurrency(context)), stats);
+		dispatcher_->SetSkipFailedWrites(true);
+	}
+
+	void Add(json write) {
+		writes_.push_back(std::move(write));
+		if (writes_.size() >= (individual_ ? kFirestoreIndividualWriteChunk : kFirestoreMaxBatchWrites)) {
+			Flush();
+		}
+	}
+
+	// Commit everything added so far; returns the number of documents written
+	idx_t Finish() {
+		Flush();
+		dispatcher_->Finish();
+		return written_ + dispatcher_->Committed();
+	}
+
+private:
+	void Flush() {
+		if (writes_.empty()) {
+			return;
+		}
+		if (individual_) {
+			dispatcher_->SubmitIndividual(std::move(writes_));
+		} else if (batch_write_verified_) {
+			dispatcher_->Submit(std::move(writes_));
+		} else {
+			try {
+				auto result = CommitBatchWrites(*client_, writes_);
+				written_ += result.succeeded;
+				LogFailedWrites(result);
+				batch_write_verified_ = true;
+			} catch (const FirestorePermissionException &) {
+				// BatchWrite requires admin auth (e.g. API key against the emulator)
+				FS_LOG_WARN("BatchWrite permission denied, falling back to individual document requests");
+				individual_ = true;
+				for (idx_t start = 0; start < writes_.size(); start += kFirestoreIndividualWriteChunk) {
+					auto end = std::min<idx_t>(start + kFirestoreIndividualWriteChunk, writes_.size());
+					dispatcher_->SubmitIndividual(std::vector<json>(writes_.begin() + start, writes_.begin() + end));
+				}
+			}
+		}
+		writes_.clear();
+	}
+
+	std::unique_ptr<FirestoreClient> client_;
+	std::unique_ptr<FirestoreWriteDispatcher> dispatcher_;
+	std::vector<json> writes_;
+	idx_t written_ = 0; // Written on the calling thread (excludes dispatcher_->Committed())
+	bool batch_write_verified_ = false;
+	bool individual_ = false;
+};
+
+// Full resource name of a document, as BatchWrite expects it
+static std::string GetFirestoreDocumentName(const FirestoreCredentials &credentials, const std::string &collection,
+                                            const std::string &document_id) {
+	auto resolved = ResolveDocumentPath(collection, document_id);
+	return "projects/" + credentials.project_id + "/databases/" + credentials.database_id + "/documents/" +
+	       resolved.document_path;
+}
+
 // ============================================================================
 // BATCH UPDATE function implementation
 // Usage: CALL firestore_update_batch('collection', ['id1','id2',...], 'field1', value1, ...)
@@ -581,8 +703,6 @@ static void FirestoreUpdateBatchFunction(ClientContext &context, TableFunctionIn
 	int64_t count = 0;
 
 	try {
-		FirestoreClient client(bind_data.credentials);
-
 		// Build fields JSON for update (same for all documents)
 		json fields;
 		for (size_t i = 0; i < bind_data.field_names.size(); i++) {
@@ -590,61 +710,14 @@ static void FirestoreUpdateBatchFunction(ClientContext &context, TableFunctionIn
 			    DuckDBValueToFirestore(bind_data.field_values[i], bind_data.field_values[i].type());
 		}
 
-		// Try batch write first, fall back to individual operations if it fails
-		// (e.g., when running against emulator with API key auth)
-		bool use_individual_ops = false;
-		const size_t BATCH_SIZE = 500;
-		std::vector<json> writes;
-
-		for (size_t i = 0; i < bind_data.document_ids.size(); i++) {
-			const auto &doc_id = bind_data.document_ids[i];
-
-			if (use_individual_ops) {
-				// Individual update - fallback mode
-				try {
-					client.UpdateDocument(bind_data.collection, doc_id, fields);
-					count++;
-				} catch (const FirestoreNotFoundException &) {
-					// Document not found, skip but continue
-					FS_LOG_WARN("Document not found during batch operation: " + doc_id);
-				}
-			} else {
-				auto resolved = ResolveDocumentPath(bind_data.collection, doc_id);
-				// Build full document path for batch write
-				std::string doc_path = "projects/" + bind_data.credentials->project_id + "/databases/" +
-				                       bind_data.credentials->database_id + "/documents/" + resolved.document_path;
-
-				json write_op = {{"update", {{"name", doc_path}, {"fields", fields}}},
-				                 {"updateMask", {{"fieldPaths", bind_data.field_names}}}};
-				writes.push_back(write_op);
-
-				// Execute batch when full or at end
-				if (writes.size() >= BATCH_SIZE || i == bind_data.document_ids.size() - 1) {
-					try {
-						client.BatchWrite(writes);
-						count += writes.size();
-					} catch (const FirestorePermissionException &) {
-						// Batch writes require admin auth - fall back to individual ops
-						use_individual_ops = true;
-						// Process this batch individually
-						for (size_t j = 0; j <= i - (writes.size() - 1); j++) {
-							// These were already counted, skip
-						}
-						// Process remaining items in writes individually
-						for (size_t j = i - (writes.size() - 1); j <= i; j++) {
-							try {
-								client.UpdateDocument(bind_data.collection, bind_data.document_ids[j], fields);
-								count++;
-							} catch (const FirestoreNotFoundException &) {
-								// Document not found, skip
-								FS_LOG_WARN("Document not found during batch operation: " + bind_data.document_ids[j]);
-							}
-						}
-					}
-					writes.clear();
-				}
-			}
+		FirestoreBatchWritePipeline pipeline(context, bind_data.credentials);
+		for (const auto &doc_id : bind_data.document_ids) {
+			pipeline.Add({{"update",
+			               {{"name", GetFirestoreDocumentName(*bind_data.credentials, bind_data.collection, doc_id)},
+			                {"fields", fields}}},
+			              {"updateMask", {{"fieldPaths", bind_data.field_names}}}});
 		}
+		count = static_cast<int64_t>(pipeline.Finish());
 	} catch (const std::exception &e) {
 		throw InvalidInputException("Firestore batch update failed: " + std::string(e.what()));
 	}
@@ -744,60 +817,413 @@ static void FirestoreDeleteBatchFunction(ClientContext &context, TableFunctionIn
 	int64_t count = 0;
 
 	try {
-		FirestoreClient client(bind_data.credentials);
+		FirestoreBatchWritePipeline pipeline(context, bind_data.credentials);
+		for (const auto &doc_id : bind_data.document_ids) {
+			pipeline.Add({{"delete", GetFirestoreDocumentName(*bind_data.credentials, bind_data.collection, doc_id)}});
+		}
+		count = static_cast<int64_t>(pipeline.Finish());
+	} catch (const std::exception &e) {
+		throw InvalidInputException("Firestore batch delete failed: " + std::string(e.what()));
+	}
+
+	FlatVector::GetData<int64_t>(output.data[0])[0] = count;
+	output.SetCardinality(1);
+	global_state.done = true;
+}
+
+// ============================================================================
+// STREAMING UPDATE / DELETE functions implementation (table-in-out)
+// Usage: CALL firestore_update_rows('collection', (SELECT __document_id, status FROM ...))
+//        CALL firestore_delete_rows('collection', (SELECT __document_id FROM ...))
+// The IDs (and field values) are consumed chunk by chunk instead of being collected into a list
+// at bind time, and batches are committed while the input is still being read.
+// ============================================================================
+
+struct FirestoreWriteRowsBindData : public TableFunctionData {
+	std::string collection;
+	std::shared_ptr<FirestoreCredentials> credentials;
+	std::vector<std::string> column_names;
+	std::vector<LogicalType> column_types;
+	idx_t document_id_column_index;
+	// Quoted paths of the columns other than the ID, the update mask of updates
+	std::vector<std::string> field_paths;
+	bool is_delete;
+
+	FirestoreWriteRowsBindData() : document_id_column_index(DConstants::INVALID_INDEX), is_delete(false) {
+	}
+};
+
+struct FirestoreWriteRowsGlobalState : public GlobalTableFunctionState {
+	std::unique_ptr<FirestoreBatchWritePipeline> pipeline;
+	idx_t rows_received;
+	bool count_emitted;
+
+	FirestoreWriteRowsGlobalState() : rows_received(0), count_emitted(false) {
+	}
+	idx_t MaxThreads() const override {
+		return 1;
+	}
+};
+
+static unique_ptr<FunctionData> FirestoreWriteRowsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                       vector<LogicalType> &return_types, vector<string> &names,
+                                                       bool is_delete) {
+	auto result = make_uniq<FirestoreWriteRowsBindData>();
+	result->is_delete = is_delete;
+	const std::string function_name = is_delete ? "firestore_delete_rows" : "firestore_update_rows";
+
+	// Get collection name (first positional argument)
+	result->collection = input.inputs[0].GetValue<string>();
+
+	// Process named parameters
+	std::optional<std::string> project_id;
+	std::optional<std::string> credentials_path;
+	std::optional<std::string> api_key;
+	std::optional<std::string> database_id;
+	std::optional<std::string> document_id_param;
+
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "project_id") {
+			project_id = kv.second.GetValue<string>();
+		} else if (kv.first == "credentials") {
+			credentials_path = kv.second.GetValue<string>();
+		} else if (kv.first == "api_key") {
+			api_key = kv.second.GetValue<string>();
+		} else if (kv.first == "database") {
+			database_id = kv.second.GetValue<string>();
+		} else if (kv.first == "document_id") {
+			document_id_param = kv.second.GetValue<string>();
+		}
+	}
+
+	result->credentials = ResolveFirestoreCredentials(context, project_id, credentials_path, api_key, database_id);
+
+	if (!result->credentials) {
+		throw BinderException("No Firestore credentials found for " + function_name + ".");
+	}
+
+	result->column_names = input.input_table_names;
+	result->column_types = input.input_table_types;
+
+	// The ID column: document_id := 'col', else __document_id, else the only column of a delete
+	auto id_column = document_id_param.value_or("__document_id");
+	for (idx_t i = 0; i < result->column_names.size(); i++) {
+		if (result->column_names[i] == id_column) {
+			result->document_id_column_index = i;
+			break;
+		}
+	}
+	if (result->document_id_column_index == DConstants::INVALID_INDEX) {
+		if (document_id_param.has_value()) {
+			throw BinderException("document_id column '" + id_column + "' not found in input columns.");
+		}
+		if (!is_delete || result->column_names.size() != 1) {
+			throw BinderException(function_name + " requires a document ID column: name it __document_id or pass "
+			                                      "document_id := 'column'");
+		}
+		result->document_id_column_index = 0;
+	}
+
+	if (!is_delete) {
+		for (idx_t i = 0; i < result->column_names.size(); i++) {
+			if (i != result->document_id_column_index) {
+				result->field_paths.push_back(QuoteFirestoreFieldPath(result->column_names[i]));
+			}
+		}
+		if (result->field_paths.empty()) {
+			throw BinderException("firestore_update_rows requires at least one column to update besides the "
+			                      "document ID. Usage: CALL firestore_update_rows('collection', "
+			                      "(SELECT __document_id, field1 FROM ...))");
+		}
+	}
+
+	// Return type: count of written documents
+	names.push_back("count");
+	return_types.push_back(LogicalType::BIGINT);
+
+	return std::move(result);
+}
+
+static unique_ptr<FunctionData> FirestoreUpdateRowsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                        vector<LogicalType> &return_types, vector<string> &names) {
+	return FirestoreWriteRowsBind(context, input, return_types, names, false);
+}
+
+static unique_ptr<FunctionData> FirestoreDeleteRowsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                        vector<LogicalType> &return_types, vector<string> &names) {
+	return FirestoreWriteRowsBind(context, input, return_types, names, true);
+}
+
+static unique_ptr<GlobalTableFunctionState> FirestoreWriteRowsInitGlobal(ClientContext &context,
+                                                                         TableFunctionInitInput &input) {
+	auto &bind_data = input.bind_data->Cast<FirestoreWriteRowsBindData>();
+	auto global_state = make_uniq<FirestoreWriteRowsGlobalState>();
+	global_state->pipeline = make_uniq<FirestoreBatchWritePipeline>(context, bind_data.credentials);
+	return std::move(global_state);
+}
+
+static unique_ptr<LocalTableFunctionState> FirestoreWriteRowsInitLocal(ExecutionContext &context,
+                                                                       TableFunctionInitInput &input,
+                                                                       GlobalTableFunctionState *global_state) {
+	return make_uniq<LocalTableFunctionState>();
+}
+
+static std::string FirestoreWriteRowsFunctionName(const FirestoreWriteRowsBindData &bind_data) {
+	return bind_data.is_delete ? "firestore_delete_rows" : "firestore_update_rows";
+}
+
+static std::string FirestoreWriteRowsOperation(const FirestoreWriteRowsBindData &bind_data) {
+	return bind_data.is_delete ? "Firestore batch delete failed: " : "Firestore batch update failed: ";
+}
+
+static OperatorResultType FirestoreWriteRowsInOutFunction(ExecutionContext &context, TableFunctionInput &data,
+                                                          DataChunk &input, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<FirestoreWriteRowsBindData>();
+	auto &global_state = data.global_state->Cast<FirestoreWriteRowsGlobalState>();
+
+	for (idx_t row_idx = 0; row_idx < input.size(); row_idx++) {
+		Value id_val = input.GetValue(bind_data.document_id_column_index, row_idx);
+		if (id_val.IsNull()) {
+			throw InvalidInputException(FirestoreWriteRowsFunctionName(bind_data) + ": document_id column '" +
+			                            bind_data.column_names[bind_data.document_id_column_index] +
+			                            "' cannot be NULL at row " +
+			                            std::to_string(global_state.rows_received + row_idx));
+		}
+		auto doc_name = GetFirestoreDocumentName(*bind_data.credentials, bind_data.collection, id_val.ToString());
+
+		json write_op;
+		if (bind_data.is_delete) {
+			write_op = {{"delete", doc_name}};
+		} else {
+			json fields = json::object();
+			for (idx_t col_idx = 0; col_idx < input.ColumnCount(); col_idx++) {
+				if (col_idx == bind_data.document_id_column_index) {
+					continue;
+				}
+				fields[bind_data.column_names[col_idx]] =
+				    DuckDBValueToFirestore(input.GetValue(col_idx, row_idx), bind_data.column_types[col_idx]);
+			}
+			write_op = {{"update", {{"name", doc_name}, {"fields", fields}}},
+			            {"updateMask", {{"fieldPaths", bind_data.field_paths}}}};
+		}
+
+		try {
+			global_state.pipeline->Add(std::move(write_op));
+		} catch (const std::exception &e) {
+			throw InvalidInputException(FirestoreWriteRowsOperation(bind_data) + std::string(e.what()));
+		}
+	}
+	global_state.rows_received += input.size();
+
+	output.SetCardinality(0);
+	return OperatorResultType::NEED_MORE_INPUT;
+}
+
+// Finalize: commit the remaining writes and emit the count
+static OperatorFinalizeResultType FirestoreWriteRowsFinal(ExecutionContext &context, TableFunctionInput &data,
+                                                          DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<FirestoreWriteRowsBindData>();
+	auto &global_state = data.global_state->Cast<FirestoreWriteRowsGlobalState>();
+
+	if (global_state.count_emitted) {
+		output.SetCardinality(0);
+		return OperatorFinalizeResultType::FINISHED;
+	}
+
+	idx_t count;
+	try {
+		count = global_state.pipeline->Finish();
+	} catch (const std::exception &e) {
+		throw InvalidInputException(FirestoreWriteRowsOperation(bind_data) + std::string(e.what()));
+	}
+
+	FlatVector::GetData<int64_t>(output.data[0])[0] = static_cast<int64_t>(count);
+	output.SetCardinality(1);
+	global_state.count_emitted = true;
+	return OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+}
+
+// ============================================================================
+// UPDATE / DELETE by query
+// Usage: CALL firestore_delete_where('collection', 'status = ''stale''')
+//        CALL firestore_update_where('collection', 'status = ''pending''', 'field1', value1, ...)
+// A runQuery selecting only __name__ (plus the fields its cursor pages on) finds the documents,
+// and each page is handed to the batch write pipeline while the next one is fetched.
+// ============================================================================
+
+// Documents per runQuery page
+static constexpr int64_t kFirestoreWhereQueryPageSize = 1000;
 
-		// Try batch write first, fall back to individual operations if it fails
-		// (e.g., when running against emulator with API key auth)
-		bool use_individual_ops = false;
-		const size_t BATCH_SIZE = 500;
-		std::vector<json> writes;
-
-		for (size_t i = 0; i < bind_data.document_ids.size(); i++) {
-			const auto &doc_id = bind_data.document_ids[i];
-
-			if (use_individual_ops) {
-				// Individual delete - fallback mode
-				try {
-					client.DeleteDocument(bind_data.collection, doc_id);
-					count++;
-				} catch (const FirestoreNotFoundException &) {
-					// Document not found, skip but continue
-					FS_LOG_WARN("Document not found during batch operation: " + doc_id);
+struct FirestoreWriteWhereBindData : public TableFunctionData {
+	std::string collection;
+	std::shared_ptr<FirestoreCredentials> credentials;
+	json structured_query;
+	bool is_collection_group;
+	bool is_delete;
+	// Updates only: the fields written to every matching document
+	json fields;
+	std::vector<std::string> field_paths;
+
+	FirestoreWriteWhereBindData() : is_collection_group(false), is_delete(false) {
+	}
+};
+
+struct FirestoreWriteWhereGlobalState : public GlobalTableFunctionState {
+	bool done;
+	FirestoreWriteWhereGlobalState() : done(false) {
+	}
+	idx_t MaxThreads() const override {
+		return 1;
+	}
+};
+
+static unique_ptr<FunctionData> FirestoreWriteWhereBind(ClientContext &context, TableFunctionBindInput &input,
+                                                        vector<LogicalType> &return_types, vector<string> &names,
+                                                        bool is_delete) {
+	auto result = make_uniq<FirestoreWriteWhereBindData>();
+	result->is_delete = is_delete;
+	const std::string function_name = is_delete ? "firestore_delete_where" : "firestore_update_where";
+
+	// Get collection name and filter (first two args)
+	result->collection = input.inputs[0].GetValue<string>();
+	result->is_collection_group = !result->collection.empty() && result->collection[0] == '~';
+	if (input.inputs[1].IsNull() || input.inputs[1].GetValue<string>().empty()) {
+		throw BinderException(function_name + " requires a filter. Usage: " + function_name +
+		                      "('collection', 'field = value AND ...'" + (is_delete ? "" : ", 'field1', value1") +
+		                      ")");
+	}
+	auto filters = ParseFirestoreFilterPredicate(input.inputs[1].GetValue<string>());
+
+	// Only the document names are needed, plus the fields the cursor resumes on
+	result->structured_query = BuildFilteredStructuredQuery(result->collection, result->is_collection_group, filters);
+	json select_fields = json::array();
+	for (auto &order : result->structured_query["orderBy"]) {
+		select_fields.push_back({{"fieldPath", order["field"]["fieldPath"]}});
+	}
+	result->structured_query["select"] = {{"fields", select_fields}};
+	result->structured_query["limit"] = kFirestoreWhereQueryPageSize;
+
+	// Parse remaining args as field_name/value pairs
+	if (!is_delete) {
+		if ((input.inputs.size() - 2) % 2 != 0) {
+			throw BinderException("firestore_update_where requires field name/value pairs after the filter.");
+		}
+		result->fields = json::object();
+		for (idx_t i = 2; i < input.inputs.size(); i += 2) {
+			if (input.inputs[i].type().id() != LogicalTypeId::VARCHAR) {
+				throw BinderException("Field name at position " + std::to_string(i) + " must be a string");
+			}
+			auto field_name = input.inputs[i].GetValue<string>();
+			result->fields[field_name] = DuckDBValueToFirestore(input.inputs[i + 1], input.inputs[i + 1].type());
+			result->field_paths.push_back(QuoteFirestoreFieldPath(field_name));
+		}
+		if (result->field_paths.empty()) {
+			throw BinderException("firestore_update_where requires at least one field to update");
+		}
+		// The query pages on its inequality fields; an update that moves a document further along
+		// that order would bring it back on a later page, to be written and counted again
+		for (auto &order : result->structured_query["orderBy"]) {
+			auto order_path = order["field"]["fieldPath"].get<std::string>();
+			for (auto it = result->fields.begin(); it != result->fields.end(); ++it) {
+				if (order_path == it.key() || order_path == QuoteFirestoreFieldPath(it.key())) {
+					throw BinderException("firestore_update_where cannot update '" + it.key() +
+					                      "', which the filter compares with an inequality. Use "
+					                      "firestore_scan with firestore_update_batch instead.");
 				}
-			} else {
-				auto resolved = ResolveDocumentPath(bind_data.collection, doc_id);
-				// Build full document path for batch write
-				std::string doc_path = "projects/" + bind_data.credentials->project_id + "/databases/" +
-				                       bind_data.credentials->database_id + "/documents/" + resolved.document_path;
-
-				json write_op = {{"delete", doc_path}};
-				writes.push_back(write_op);
-
-				// Execute batch when full or at end
-				if (writes.size() >= BATCH_SIZE || i == bind_data.document_ids.size() - 1) {
-					try {
-						client.BatchWrite(writes);
-						count += writes.size();
-					} catch (const FirestorePermissionException &) {
-						// Batch writes require admin auth - fall back to individual ops
-						use_individual_ops = true;
-						// Process remaining items in writes individually
-						for (size_t j = i - (writes.size() - 1); j <= i; j++) {
-							try {
-								client.DeleteDocument(bind_data.collection, bind_data.document_ids[j]);
-								count++;
-							} catch (const FirestoreNotFoundException &) {
-								// Document not found, skip
-								FS_LOG_WARN("Document not found during batch operation: " + bind_data.document_ids[j]);
-							}
-						}
-					}
-					writes.clear();
+			}
+		}
+	}
+
+	// Process named parameters for credentials
+	std::optional<std::string> project_id;
+	std::optional<std::string> credentials_path;
+	std::optional<std::string> api_key;
+	std::optional<std::string> database_id;
+
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "project_id") {
+			project_id = kv.second.GetValue<string>();
+		} else if (kv.first == "credentials") {
+			credentials_path = kv.second.GetValue<string>();
+		} else if (kv.first == "api_key") {
+			api_key = kv.second.GetValue<string>();
+		} else if (kv.first == "database") {
+			database_id = kv.second.GetValue<string>();
+		}
+	}
+
+	result->credentials = ResolveFirestoreCredentials(context, project_id, credentials_path, api_key, database_id);
+
+	if (!result->credentials) {
+		throw BinderException("No Firestore credentials found for " + function_name + ".");
+	}
+
+	// Return type: count of written documents
+	names.push_back("count");
+	return_types.push_back(LogicalType::BIGINT);
+
+	return std::move(result);
+}
+
+static unique_ptr<FunctionData> FirestoreUpdateWhereBind(ClientContext &context, TableFunctionBindInput &input,
+                                                         vector<LogicalType> &return_types, vector<string> &names) {
+	return FirestoreWriteWhereBind(context, input, return_types, names, false);
+}
+
+static unique_ptr<FunctionData> FirestoreDeleteWhereBind(ClientContext &context, TableFunctionBindInput &input,
+                                                         vector<LogicalType> &return_types, vector<string> &names) {
+	return FirestoreWriteWhereBind(context, input, return_types, names, true);
+}
+
+static unique_ptr<GlobalTableFunctionState> FirestoreWriteWhereInitGlobal(ClientContext &context,
+                                                                          TableFunctionInitInput &input) {
+	return make_uniq<FirestoreWriteWhereGlobalState>();
+}
+
+static void FirestoreWriteWhereFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<FirestoreWriteWhereBindData>();
+	auto &global_state = data.global_state->Cast<FirestoreWriteWhereGlobalState>();
+
+	if (global_state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	int64_t count = 0;
+
+	try {
+		auto stats = GetFirestoreQueryStats(context);
+		FirestoreClient client(bind_data.credentials);
+		client.SetStats(stats);
+		FirestoreBatchWritePipeline pipeline(context, bind_data.credentials);
+
+		FirestorePageCursor cursor;
+		cursor.mode = FirestorePageCursor::Mode::RUN_QUERY;
+		cursor.collection = bind_data.collection;
+		cursor.is_collection_group = bind_data.is_collection_group;
+		cursor.structured_query = bind_data.structured_query;
+		cursor.page_size = kFirestoreWhereQueryPageSize;
+		// Fetch the next page while the writes of this one are being queued
+		cursor.StartPrefetch(bind_data.credentials, stats, 2);
+
+		std::vector<FirestoreDocument> page;
+		while (cursor.NextPage(client, page)) {
+			for (auto &doc : page) {
+				if (bind_data.is_delete) {
+					pipeline.Add({{"delete", doc.name}});
+				} else {
+					// The document matched moments ago; don't recreate it if it was deleted since
+					pipeline.Add({{"update", {{"name", doc.name}, {"fields", bind_data.fields}}},
+					              {"updateMask", {{"fieldPaths", bind_data.field_paths}}},
+					              {"currentDocument", {{"exists", true}}}});
 				}
 			}
 		}
+		count = static_cast<int64_t>(pipeline.Finish());
 	} catch (const std::exception &e) {
-		throw InvalidInputException("Firestore batch delete failed: " + std::string(e.what()));
+		throw InvalidInputException(std::string(bind_data.is_delete ? "Firestore delete by query failed: "
+		                                                            : "Firestore update by query failed: ") +
+		                            e.what());
 	}
 
 	FlatVector::GetData<int64_t>(output.data[0])[0] = count;
@@ -925,6 +1351,7 @@ static void FirestoreArrayTransformFunction(ClientContext &context, TableFunctio
 
 	try {
 		FirestoreClient client(bind_data.credentials);
+		client.SetStats(GetFirestoreQueryStats(context));
 
 		// Convert DuckDB values to Firestore format
 		json elements = json::array();
@@ -956,28 +1383,212 @@ static void FirestoreArrayTransformFunction(ClientContext &context, TableFunctio
 // Table-valued function for bulk insert (via COPY or INSERT...SELECT)
 // ============================================================================
 
-// Bind data for firestore output (COPY TO)
+// ============================================================================
+// COPY TO implementation
+// Usage: COPY (SELECT ...) TO 'collection' (FORMAT firestore, DOCUMENT_ID 'id_col', MERGE true)
+// Every thread builds BatchWrite payloads from its own chunks and hands full batches to the
+// shared dispatcher, which commits them in parallel under the write rate limiter.
+// ============================================================================
+
 struct FirestoreCopyBindData : public TableFunctionData {
 	std::string collection;
 	std::shared_ptr<FirestoreCredentials> credentials;
+	std::vector<std::string> column_names;
+	std::vector<LogicalType> column_types;
+	// Column holding the document ID; INVALID_INDEX generates IDs
+	idx_t document_id_column_index;
+	// Merge into existing documents (updateMask of the copied fields) instead of replacing them
+	bool merge;
 	idx_t batch_size;
+	// Quoted paths of every copied field, the update mask of merging writes
+	std::vector<std::string> field_paths;
 
-	FirestoreCopyBindData() : batch_size(500) {
+	FirestoreCopyBindData()
+	    : document_id_column_index(DConstants::INVALID_INDEX), merge(false), batch_size(kFirestoreMaxBatchWrites) {
 	}
 };
 
-// Global state for copy
-struct FirestoreCopyGlobalState : public GlobalTableFunctionState {
-	std::unique_ptr<FirestoreClient> client;
-	std::vector<json> pending_writes;
-	idx_t total_written;
+struct FirestoreCopyGlobalState : public GlobalFunctionData {
+	std::unique_ptr<FirestoreWriteDispatcher> dispatcher;
+};
 
-	FirestoreCopyGlobalState() : total_written(0) {
+struct FirestoreCopyLocalState : public LocalFunctionData {
+	std::vector<json> writes;
+};
+
+// 20-character random document ID from the alphabet Firestore's client libraries use, so rows
+// without an ID column still go through BatchWrite
+static std::string GenerateFirestoreDocumentId() {
+	static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+	thread_local std::mt19937_64 rng(std::random_device {}());
+	std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) - 2);
+	std::string id(20, ' ');
+	for (auto &c : id) {
+		c = alphabet[pick(rng)];
 	}
-	idx_t MaxThreads() const override {
-		return 1;
+	return id;
+}
+
+static std::string GetCopyOptionString(const std::string &name, const vector<Value> &values) {
+	if (values.size() != 1) {
+		throw BinderException("COPY (FORMAT firestore) option '%s' takes exactly one value", name);
 	}
-};
+	return values[0].ToString();
+}
+
+static unique_ptr<FunctionData> FirestoreCopyBind(ClientContext &context, CopyFunctionBindInput &input,
+                                                  const vector<string> &names, const vector<LogicalType> &sql_types) {
+	auto result = make_uniq<FirestoreCopyBindData>();
+	result->collection = input.info.file_path;
+	if (result->collection.empty()) {
+		throw BinderException("COPY (FORMAT firestore) requires a collection path: COPY ... TO 'collection'");
+	}
+
+	std::optional<std::string> project_id;
+	std::optional<std::string> credentials_path;
+	std::optional<std::string> api_key;
+	std::optional<std::string> database_id;
+	std::optional<std::string> document_id;
+
+	for (auto &option : input.info.options) {
+		auto key = StringUtil::Lower(option.first);
+		auto &values = option.second;
+		if (key == "project_id") {
+			project_id = GetCopyOptionString(option.first, values);
+		} else if (key == "credentials") {
+			credentials_path = GetCopyOptionString(option.first, values);
+		} else if (key == "api_key") {
+			api_key = GetCopyOptionString(option.first, values);
+		} else if (key == "database") {
+			database_id = GetCopyOptionString(option.first, values);
+		} else if (key == "document_id") {
+			document_id = GetCopyOptionString(option.first, values);
+		} else if (key == "merge") {
+			// A bare MERGE means true
+			result->merge = values.empty() || BooleanValue::Get(values[0].DefaultCastAs(LogicalType::BOOLEAN));
+		} else if (key == "batch_size") {
+			GetCopyOptionString(option.first, values);
+			auto size = BigIntValue::Get(values[0].DefaultCastAs(LogicalType::BIGINT));
+			if (size < 1 || size > static_cast<int64_t>(kFirestoreMaxBatchWrites)) {
+				throw BinderException("COPY (FORMAT firestore) batch_size must be between 1 and %llu",
+				                      kFirestoreMaxBatchWrites);
+			}
+			result->batch_size = static_cast<idx_t>(size);
+		} else {
+			throw BinderException("Unrecognized option for COPY (FORMAT firestore): '%s'", option.first);
+		}
+	}
+
+	result->credentials = ResolveFirestoreCredentials(context, project_id, credentials_path, api_key, database_id);
+	if (!result->credentials) {
+		throw BinderException("No Firestore credentials found for COPY (FORMAT firestore).");
+	}
+
+	result->column_names = names;
+	result->column_types = sql_types;
+	if (document_id.has_value()) {
+		auto it = std::find(names.begin(), names.end(), document_id.value());
+		if (it == names.end()) {
+			throw BinderException("document_id column '" + document_id.value() + "' not found in COPY columns.");
+		}
+		result->document_id_column_index = static_cast<idx_t>(it - names.begin());
+	}
+	for (idx_t i = 0; i < names.size(); i++) {
+		if (i != result->document_id_column_index) {
+			result->field_paths.push_back(QuoteFirestoreFieldPath(names[i]));
+		}
+	}
+	return std::move(result);
+}
+
+static unique_ptr<GlobalFunctionData> FirestoreCopyInitGlobal(ClientContext &context, FunctionData &bind_data_p,
+                                                              const string &file_path) {
+	auto &bind_data = bind_data_p.Cast<FirestoreCopyBindData>();
+	auto global_state = make_uniq<FirestoreCopyGlobalState>();
+	global_state->dispatcher = make_uniq<FirestoreWriteDispatcher>(
+	    bind_data.credentials, static_cast<idx_t>(FirestoreSettings::WriteConcurrency(context)),
+	    GetFirestoreQueryStats(context));
+	return std::move(global_state);
+}
+
+static unique_ptr<LocalFunctionData> FirestoreCopyInitLocal(ExecutionContext &context, FunctionData &bind_data) {
+	return make_uniq<FirestoreCopyLocalState>();
+}
+
+static void SubmitCopyBatch(FirestoreCopyGlobalState &global_state, FirestoreCopyLocalState &local_state) {
+	if (local_state.writes.empty()) {
+		return;
+	}
+	try {
+		global_state.dispatcher->Submit(std::move(local_state.writes));
+	} catch (const std::exception &e) {
+		throw InvalidInputException("Firestore COPY failed: " + std::string(e.what()));
+	}
+	local_state.writes.clear();
+}
+
+static void FirestoreCopySink(ExecutionContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate,
+                              LocalFunctionData &lstate, DataChunk &input) {
+	auto &bind_data = bind_data_p.Cast<FirestoreCopyBindData>();
+	auto &global_state = gstate.Cast<FirestoreCopyGlobalState>();
+	auto &local_state = lstate.Cast<FirestoreCopyLocalState>();
+	std::string documents_root = "projects/" + bind_data.credentials->project_id + "/databases/" +
+	                             bind_data.credentials->database_id + "/documents/";
+
+	for (idx_t row_idx = 0; row_idx < input.size(); row_idx++) {
+		json fields = json::object();
+		std::string doc_id;
+		for (idx_t col_idx = 0; col_idx < input.ColumnCount(); col_idx++) {
+			Value val = input.GetValue(col_idx, row_idx);
+			if (col_idx == bind_data.document_id_column_index) {
+				if (val.IsNull()) {
+					throw InvalidInputException("COPY (FORMAT firestore): document_id column '" +
+					                            bind_data.column_names[col_idx] + "' cannot be NULL");
+				}
+				doc_id = val.ToString();
+				continue;
+			}
+			fields[bind_data.column_names[col_idx]] = DuckDBValueToFirestore(val, bind_data.column_types[col_idx]);
+		}
+		if (bind_data.document_id_column_index == DConstants::INVALID_INDEX) {
+			doc_id = GenerateFirestoreDocumentId();
+		}
+
+		auto resolved = ResolveDocumentPath(bind_data.collection, doc_id);
+		json write_op = {{"update", {{"name", documents_root + resolved.document_path}, {"fields", fields}}}};
+		if (bind_data.merge) {
+			write_op["updateMask"] = {{"fieldPaths", bind_data.field_paths}};
+		}
+		local_state.writes.push_back(std::move(write_op));
+
+		if (local_state.writes.size() >= bind_data.batch_size) {
+			SubmitCopyBatch(global_state, local_state);
+		}
+	}
+}
+
+static void FirestoreCopyCombine(ExecutionContext &context, FunctionData &bind_data, GlobalFunctionData &gstate,
+                                 LocalFunctionData &lstate) {
+	SubmitCopyBatch(gstate.Cast<FirestoreCopyGlobalState>(), lstate.Cast<FirestoreCopyLocalState>());
+}
+
+static void FirestoreCopyFinalize(ClientContext &context, FunctionData &bind_data_p, GlobalFunctionData &gstate) {
+	auto &bind_data = bind_data_p.Cast<FirestoreCopyBindData>();
+	auto &global_state = gstate.Cast<FirestoreCopyGlobalState>();
+	try {
+		global_state.dispatcher->Finish();
+	} catch (const std::exception &e) {
+		throw InvalidInputException("Firestore COPY failed: " + std::string(e.what()));
+	}
+	FS_LOG_DEBUG("COPY to '" + bind_data.collection + "' committed " +
+	             std::to_string(global_state.dispatcher->Committed()) + " documents");
+}
+
+// Documents can be written in any order, so every thread sinks independently
+static CopyFunctionExecutionMode FirestoreCopyExecutionMode(bool preserve_insertion_order,
+                                                            bool supports_batch_index) {
+	return CopyFunctionExecutionMode::PARALLEL_COPY_TO_FILE;
+}
 
 // ============================================================================
 // Registration
@@ -1055,6 +1666,65 @@ void RegisterFirestoreWriteFunctions(ExtensionLoader &loader) {
 
 	loader.RegisterFunction(delete_batch_func);
 
+	// Register firestore_update_rows table function (table-in-out)
+	// Usage: CALL firestore_update_rows('collection', (SELECT __document_id, field1, ... FROM ...))
+	TableFunction update_rows_func("firestore_update_rows", {LogicalType::VARCHAR, LogicalType::TABLE}, nullptr,
+	                               FirestoreUpdateRowsBind, FirestoreWriteRowsInitGlobal, FirestoreWriteRowsInitLocal);
+
+	update_rows_func.in_out_function = FirestoreWriteRowsInOutFunction;
+	update_rows_func.in_out_function_final = FirestoreWriteRowsFinal;
+
+	update_rows_func.named_parameters["project_id"] = LogicalType::VARCHAR;
+	update_rows_func.named_parameters["credentials"] = LogicalType::VARCHAR;
+	update_rows_func.named_parameters["api_key"] = LogicalType::VARCHAR;
+	update_rows_func.named_parameters["database"] = LogicalType::VARCHAR;
+	update_rows_func.named_parameters["document_id"] = LogicalType::VARCHAR;
+
+	loader.RegisterFunction(update_rows_func);
+
+	// Register firestore_delete_rows table function (table-in-out)
+	// Usage: CALL firestore_delete_rows('collection', (SELECT __document_id FROM ...))
+	TableFunction delete_rows_func("firestore_delete_rows", {LogicalType::VARCHAR, LogicalType::TABLE}, nullptr,
+	                               FirestoreDeleteRowsBind, FirestoreWriteRowsInitGlobal, FirestoreWriteRowsInitLocal);
+
+	delete_rows_func.in_out_function = FirestoreWriteRowsInOutFunction;
+	delete_rows_func.in_out_function_final = FirestoreWriteRowsFinal;
+
+	delete_rows_func.named_parameters["project_id"] = LogicalType::VARCHAR;
+	delete_rows_func.named_parameters["credentials"] = LogicalType::VARCHAR;
+	delete_rows_func.named_parameters["api_key"] = LogicalType::VARCHAR;
+	delete_rows_func.named_parameters["database"] = LogicalType::VARCHAR;
+	delete_rows_func.named_parameters["document_id"] = LogicalType::VARCHAR;
+
+	loader.RegisterFunction(delete_rows_func);
+
+	// Register firestore_update_where table function
+	// Usage: CALL firestore_update_where('collection', 'status = ''pending''', 'field1', value1, ...)
+	TableFunction update_where_func("firestore_update_where", {LogicalType::VARCHAR, LogicalType::VARCHAR},
+	                                FirestoreWriteWhereFunction, FirestoreUpdateWhereBind,
+	                                FirestoreWriteWhereInitGlobal);
+
+	update_where_func.varargs = LogicalType::ANY; // Accept field/value pairs
+	update_where_func.named_parameters["project_id"] = LogicalType::VARCHAR;
+	update_where_func.named_parameters["credentials"] = LogicalType::VARCHAR;
+	update_where_func.named_parameters["api_key"] = LogicalType::VARCHAR;
+	update_where_func.named_parameters["database"] = LogicalType::VARCHAR;
+
+	loader.RegisterFunction(update_where_func);
+
+	// Register firestore_delete_where table function
+	// Usage: CALL firestore_delete_where('collection', 'status = ''stale''')
+	TableFunction delete_where_func("firestore_delete_where", {LogicalType::VARCHAR, LogicalType::VARCHAR},
+	                                FirestoreWriteWhereFunction, FirestoreDeleteWhereBind,
+	                                FirestoreWriteWhereInitGlobal);
+
+	delete_where_func.named_parameters["project_id"] = LogicalType::VARCHAR;
+	delete_where_func.named_parameters["credentials"] = LogicalType::VARCHAR;
+	delete_where_func.named_parameters["api_key"] = LogicalType::VARCHAR;
+	delete_where_func.named_parameters["database"] = LogicalType::VARCHAR;
+
+	loader.RegisterFunction(delete_where_func);
+
 	// Register firestore_array_union table function
 	// Usage: SELECT * FROM firestore_array_union('collection', 'doc_id', 'field', ['val1', 'val2'])
 	// Adds elements to array without duplicates
@@ -1099,12 +1769,22 @@ void RegisterFirestoreWriteFunctions(ExtensionLoader &loader) {
 	array_append_func.named_parameters["database"] = LogicalType::VARCHAR;
 
 	loader.RegisterFunction(array_append_func);
+
+	// Register the COPY format
+	// Usage: COPY (SELECT ...) TO 'collection' (FORMAT firestore, DOCUMENT_ID 'id_col')
+	RegisterFirestoreCopyFunction(loader);
 }
 
 void RegisterFirestoreCopyFunction(ExtensionLoader &loader) {
-	// COPY function registration would go here
-	// This enables: COPY collection FROM 'file.csv' (FORMAT firestore)
-	// Deferred to future implementation
+	CopyFunction copy_func("firestore");
+	copy_func.copy_to_bind = FirestoreCopyBind;
+	copy_func.copy_to_initialize_global = FirestoreCopyInitGlobal;
+	copy_func.copy_to_initialize_local = FirestoreCopyInitLocal;
+	copy_func.copy_to_sink = FirestoreCopySink;
+	copy_func.copy_to_combine = FirestoreCopyCombine;
+	copy_func.copy_to_finalize = FirestoreCopyFinalize;
+	copy_func.execution_mode = FirestoreCopyExecutionMode;
+	loader.RegisterFunction(copy_func);
 }
 
 } // namespace duckdb
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "firestore_client.hpp"
+#include "firestore_index.hpp"
+
+namespace duckdb {
+
+class LogicalOperator;
+
+// One aggregate answered by Firestore
+struct FirestoreAggregation {
+	enum class Kind : uint8_t { COUNT, SUM, AVG };
+	Kind kind;
+	std::string field_path;  // Empty for COUNT
+	LogicalType result_type; // Return type of the DuckDB aggregate it replaces
+};
+
+// Bind data of the internal firestore_aggregate table function. The optimizer builds it when it
+// replaces an ungrouped AGGREGATE over firestore_scan; it is never bound from SQL.
+struct FirestoreAggregateBindData : public TableFunctionData {
+	std::shared_ptr<FirestoreCredentials> credentials;
+	std::string collection;
+	bool is_collection_group = false;
+	std::vector<FirestorePushdownFilter> filters; // All filters of the original query
+	std::vector<FirestoreAggregation> aggregations;
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto copy = make_uniq<FirestoreAggregateBindData>();
+		*copy = *this;
+		return std::move(copy);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<FirestoreAggregateBindData>();
+		if (aggregations.size() != other.aggregations.size()) {
+			return false;
+		}
+		for (idx_t i = 0; i < aggregations.size(); i++) {
+			if (aggregations[i].kind != other.aggregations[i].kind ||
+			    aggregations[i].field_path != other.aggregations[i].field_path ||
+			    aggregations[i].result_type != other.aggregations[i].result_type) {
+				return false;
+			}
+		}
+		return credentials == other.credentials && collection == other.collection &&
+		       is_collection_group == other.is_collection_group &&
+		       BuildWhereClause(filters) == BuildWhereClause(other.filters);
+	}
+};
+
+// Replace ungrouped COUNT(*) / SUM / AVG aggregates over firestore_scan, whose WHERE clause
+// is fully pushed to Firestore, with a single :runAggregationQuery.
+void PushDownFirestoreAggregates(ClientContext &context, unique_ptr<LogicalOperator> &plan);
+
+} // namespace duckdb
@@ -4,11 +4,54 @@
 #include <memory>
 #include <chrono>
 #include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+// OpenSSL's EVP_PKEY, kept opaque so this header does not pull in OpenSSL
+struct evp_pkey_st;
 
 namespace duckdb {
 
 enum class FirestoreAuthType { SERVICE_ACCOUNT, API_KEY };
 
+// OAuth2 access token source for one service account, shared by every request made with its
+// credentials. The signing key is parsed once. A token close to expiry is refreshed on a
+// background thread while requests keep using it; requests only wait when there is no
+// unexpired token at all (the first request, or after a failed refresh).
+class FirestoreTokenProvider : public std::enable_shared_from_this<FirestoreTokenProvider> {
+public:
+	FirestoreTokenProvider(std::string client_email, std::string private_key);
+	~FirestoreTokenProvider();
+
+	FirestoreTokenProvider(const FirestoreTokenProvider &) = delete;
+	FirestoreTokenProvider &operator=(const FirestoreTokenProvider &) = delete;
+
+	// Return a usable access token, fetching one first if needed
+	std::string GetToken();
+
+	// Drop `token` after the server rejected it, so the next request fetches a new one
+	void InvalidateToken(const std::string &token);
+
+private:
+	// Sign a JWT and exchange it for a token; called by the single refreshing thread
+	void RefreshToken();
+	bool HasUsableToken(std::chrono::system_clock::time_point now) const;
+
+	std::string client_email_;
+	std::string private_key_;
+	// Parsed on the first refresh; only touched by the refreshing thread
+	evp_pkey_st *signing_key_ = nullptr;
+
+	std::mutex mutex_;
+	std::condition_variable refreshed_cv_;
+	std::string token_;
+	std::chrono::system_clock::time_point expiry_;
+	std::chrono::system_clock::time_point refresh_at_;
+	bool refreshing_ = false;
+	std::exception_ptr last_error_;
+};
+
 struct FirestoreCredentials {
 	FirestoreAuthType type;
 	std::string project_id;
@@ -22,11 +65,11 @@ struct FirestoreCredentials {
 	// For API_KEY
 	std::string api_key;
 
-	// Cached access token (for SERVICE_ACCOUNT)
-	std::string access_token;
-	std::chrono::system_clock::time_point token_expiry;
+	// Access tokens for SERVICE_ACCOUNT; shared by copies of these credentials
+	std::shared_ptr<FirestoreTokenProvider> token_provider;
 
-	bool IsTokenValid() const;
+	// "Bearer <token>" for SERVICE_ACCOUNT, empty for API_KEY. May block on the first call
+	// while a token is fetched.
 	std::string GetAuthHeader() const;
 	std::string GetUrlSuffix() const;
 };
@@ -43,21 +86,28 @@ public:
 	static std::unique_ptr<FirestoreCredentials> CreateApiKeyCredentials(const std::string &project_id,
 	                                                                     const std::string &api_key);
 
-	// Get/refresh OAuth2 access token for service account
-	static std::string GetAccessToken(FirestoreCredentials &creds);
-
-	// Refresh token if needed
-	static void RefreshTokenIfNeeded(FirestoreCredentials &creds);
+	// Get OAuth2 access token for service account
+	static std::string GetAccessToken(const FirestoreCredentials &creds);
 
 private:
+	friend class FirestoreTokenProvider;
+
+	struct AccessToken {
+		std::string token;
+		std::chrono::seconds expires_in;
+	};
+
+	// Parse a PEM private key; the caller frees it with EVP_PKEY_free
+	static evp_pkey_st *ParsePrivateKey(const std::string &private_key);
+
 	// Create JWT for service account authentication
-	static std::string CreateJWT(const FirestoreCredentials &creds);
+	static std::string CreateJWT(const std::string &client_email, evp_pkey_st *signing_key);
 
 	// Exchange JWT for access token via Google OAuth2
-	static std::string ExchangeJWTForToken(const std::string &jwt);
+	static AccessToken ExchangeJWTForToken(const std::string &jwt);
 
 	// Sign data with RS256 using private key
-	static std::string SignRS256(const std::string &data, const std::string &private_key);
+	static std::string SignRS256(const std::string &data, evp_pkey_st *signing_key);
 
 	// Base64URL encode (no padding, URL-safe)
 	static std::string Base64UrlEncode(const std::string &data);
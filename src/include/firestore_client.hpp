@@ -3,18 +3,21 @@
 #include "firestore_auth.hpp"
 #include "firestore_error.hpp"
 #include "firestore_logger.hpp"
+#include "firestore_stats.hpp"
 #include "duckdb.hpp"
 #include <nlohmann/json.hpp>
 #include <vector>
 #include <optional>
 #include <memory>
+#include <unordered_set>
 
 namespace duckdb {
 
 using json = nlohmann::json;
 
-// Forward declaration
+// Forward declarations
 struct FirestoreIndex;
+struct FirestoreSampleStats;
 
 // Represents a Firestore document
 struct FirestoreDocument {
@@ -25,6 +28,9 @@ struct FirestoreDocument {
 	std::string update_time;
 };
 
+// Set of top-level field names a read needs from each document
+using FirestoreFieldSet = std::unordered_set<std::string>;
+
 // Query parameters for listing documents
 struct FirestoreQuery {
 	std::optional<std::string> order_by;
@@ -32,6 +38,15 @@ struct FirestoreQuery {
 	std::optional<std::string> page_token;
 	int64_t page_size = 1000; // Max allowed by Firestore
 	bool show_missing = true; // Include phantom documents (no fields, only subcollections)
+	// Projection: only these fields are requested (mask.fieldPaths) and decoded. An empty set
+	// returns document names only; nullptr returns whole documents.
+	std::shared_ptr<const FirestoreFieldSet> field_mask;
+};
+
+// Outcome of one write in a :batchWrite call (google.rpc.Status code, 0 = OK)
+struct FirestoreWriteStatus {
+	int32_t code = 0;
+	std::string message;
 };
 
 // Response from listing documents
@@ -65,16 +80,27 @@ public:
 
 	FirestoreDocument GetDocument(const std::string &collection, const std::string &document_id);
 
+	// Fetch many documents in one :batchGet call. `document_paths` are relative to .../documents
+	// (see ResolveDocumentPath); documents that do not exist are left out of the result, and
+	// the result is in no particular order. When `field_mask` is set, only those fields are
+	// requested and decoded.
+	FirestoreListResponse BatchGetDocuments(const std::vector<std::string> &document_paths,
+	                                        std::shared_ptr<const FirestoreFieldSet> field_mask = nullptr);
+
 	// Write operations
 	FirestoreDocument CreateDocument(const std::string &collection, const json &fields,
 	                                 const std::optional<std::string> &document_id = std::nullopt);
 
-	void UpdateDocument(const std::string &collection, const std::string &document_id, const json &fields);
+	// With `must_exist`, a missing document fails with FirestoreNotFoundException instead of
+	// being created
+	void UpdateDocument(const std::string &collection, const std::string &document_id, const json &fields,
+	                    bool must_exist = false);
 
 	void DeleteDocument(const std::string &collection, const std::string &document_id);
 
-	// Batch write for bulk operations
-	void BatchWrite(const std::vector<json> &writes);
+	// Batch write for bulk operations. Writes are applied independently; returns one status
+	// per write, in order.
+	std::vector<FirestoreWriteStatus> BatchWrite(const std::vector<json> &writes);
 
 	// Array field transforms
 	enum class ArrayTransformType {
@@ -87,19 +113,35 @@ public:
 	                    const json &elements, ArrayTransformType transform_type);
 
 	// Collection group query - queries all subcollections with a given name
-	// Use this to query across all documents in subcollections
+	// Returns a single page of up to query.page_size documents (schema sampling); scans
+	// page through collection groups with RunQuery cursors instead
 	FirestoreListResponse CollectionGroupQuery(const std::string &collection_id, const FirestoreQuery &query = {});
 
 	// Infer schema from sample documents
 	// Use ~ prefix for collection group queries (e.g., "~profile")
 	// Returns pairs of (field_name, DuckDB LogicalType)
+	// When `stats` is set, it receives per-field statistics of the sample for filter planning
 	std::vector<std::pair<std::string, LogicalType>> InferSchema(const std::string &collection,
-	                                                             int64_t sample_size = 100, bool show_missing = true);
+	                                                             int64_t sample_size = 100, bool show_missing = true,
+	                                                             FirestoreSampleStats *stats = nullptr);
 
 	// Run a StructuredQuery via :runQuery endpoint (supports WHERE filters)
+	// When `field_mask` is set, only those fields are selected and decoded
 	FirestoreListResponse RunQuery(const std::string &collection, const json &structured_query,
-	                               bool is_collection_group = false);
+	                               bool is_collection_group = false,
+	                               std::shared_ptr<const FirestoreFieldSet> field_mask = nullptr);
 
+	// Run a StructuredAggregationQuery via :runAggregationQuery. `aggregations` is the array of
+	// {"alias": ..., "count"|"sum"|"avg": ...} entries; returns the aggregateFields object
+	// keyed by alias.
+	json RunAggregationQuery(const std::string &collection, const json &structured_query, const json &aggregations,
+	                         bool is_collection_group = false);
+
+	// Split the collection group `collection_id` into at most `partition_count` ranges via
+	// :partitionQuery. Returns the partition boundary document names in __name__ order.
+	std::vector<std::string> PartitionQuery(const std::string &collection_id, int64_t partition_count);
+
+	// One page of the subcollection IDs under a document path ("" lists the root collections)
 	FirestoreCollectionIdsPage ListCollectionIdsPage(const std::string &document_path,
 	                                                 const std::optional<std::string> &page_token = std::nullopt,
 	                                                 int64_t page_size = 100);
@@ -118,8 +160,18 @@ public:
 		return credentials_->project_id;
 	}
 
+	// Count this client's requests under `stats` (a query's statistics) instead of only the
+	// process-wide totals
+	void SetStats(std::shared_ptr<FirestoreIOStats> stats) {
+		stats_ = stats ? std::move(stats) : FirestoreIOStats::Global();
+	}
+	const std::shared_ptr<FirestoreIOStats> &GetStats() const {
+		return stats_;
+	}
+
 private:
 	std::shared_ptr<FirestoreCredentials> credentials_;
+	std::shared_ptr<FirestoreIOStats> stats_ = FirestoreIOStats::Global();
 
 	// Build base URL for Firestore REST API (documents endpoint)
 	std::string BuildBaseUrl() const;
@@ -134,6 +186,22 @@ private:
 	json MakeRequest(const std::string &method, const std::string &url, const json &body = {},
 	                 const FirestoreErrorContext &ctx = {});
 
+	// Make HTTP request and return the raw response body (error responses still throw).
+	// Used by the page readers, which stream-decode the body instead of building a DOM.
+	// Reads and BatchWrite are retried on transient failures per FirestoreRetry::GetPolicy().
+	std::string MakeRequestRaw(const std::string &method, const std::string &url, const json &body = {},
+	                           const FirestoreErrorContext &ctx = {});
+
+	// Send one HTTP request, without retries
+	std::string SendRequest(const std::string &method, const std::string &url, const json &body,
+	                        const FirestoreErrorContext &ctx);
+
+	// Wait for the shared write rate limiter to admit `ops` document writes
+	void AcquireWriteBudget(uint64_t ops);
+
+	// Rate limiter bucket of this database
+	std::string GetRateLimitKey() const;
+
 	// Handle error response with context
 	void HandleError(int status_code, const json &response, const FirestoreErrorContext &ctx);
 
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "firestore_client.hpp"
+
+namespace duckdb {
+
+class ExtensionLoader;
+
+// One collection found below the root of a collection tree walk
+struct FirestoreCollectionTreeEntry {
+	std::string path;          // "users/u1/orders"
+	std::string collection_id; // "orders"
+	std::string parent;        // Document holding the collection ("users/u1"), empty for root collections
+	int64_t depth = 0;         // 1 for the collections directly below the root
+};
+
+// Find every collection below `root`: the database (""), a document ("users/u1"), or a
+// collection ("users", whose documents' subcollections are depth 1). listCollectionIds calls,
+// and the document listings of the collections they find, fan out over `concurrency` worker
+// threads; every document and collection is visited once. `max_depth` stops the walk at
+// collections that many levels below the root (0 = no limit). Rethrows the first failed
+// listing. Entries are sorted by path.
+std::vector<FirestoreCollectionTreeEntry>
+WalkFirestoreCollectionTree(std::shared_ptr<FirestoreCredentials> credentials, const std::string &root,
+                            int64_t max_depth, idx_t concurrency, std::shared_ptr<FirestoreIOStats> stats = nullptr);
+
+// DISCOVERY: firestore_collection_tree('users', max_depth := NULL, concurrency := NULL)
+// Usage: SELECT path FROM firestore_collection_tree('') WHERE collection_id = 'orders';
+// Emits one row per collection below the root: path, collection_id, parent and depth.
+void RegisterFirestoreCollectionTreeFunction(ExtensionLoader &loader);
+
+} // namespace duckdb
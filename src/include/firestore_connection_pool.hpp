@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace httplib {
+class Client;
+}
+
+namespace duckdb {
+
+// Counters exposed through firestore_http_pool_stats()
+struct FirestoreConnectionPoolStats {
+	uint64_t hits = 0;      // Requests served by an idle keep-alive connection
+	uint64_t misses = 0;    // Requests that had to open a new connection
+	uint64_t evictions = 0; // Idle connections dropped (timeout or pool full)
+	uint64_t idle = 0;      // Idle connections currently held by the pool
+};
+
+// Process-wide pool of keep-alive HTTP clients, keyed by scheme+host.
+//
+// A connection is leased exclusively for the duration of one request and handed back
+// afterwards, so the TCP connection and TLS session are reused across pages, queries
+// and threads. Credentials are not part of the key: auth is sent per request via headers.
+class FirestoreConnectionPool {
+public:
+	static constexpr int64_t kDefaultMaxIdlePerHost = 8;
+	static constexpr int64_t kDefaultIdleTimeoutSeconds = 60;
+
+	// RAII handle for a leased client; returns it to the pool on destruction
+	class Lease {
+	public:
+		Lease(FirestoreConnectionPool *pool, std::string key, std::unique_ptr<httplib::Client> client);
+		~Lease();
+		Lease(Lease &&other) noexcept;
+		Lease &operator=(Lease &&other) = delete;
+		Lease(const Lease &) = delete;
+		Lease &operator=(const Lease &) = delete;
+
+		httplib::Client &operator*() const {
+			return *client_;
+		}
+		httplib::Client *operator->() const {
+			return client_.get();
+		}
+
+		// Drop the connection instead of returning it (e.g. after a transport error)
+		void Discard();
+
+	private:
+		FirestoreConnectionPool *pool_;
+		std::string key_;
+		std::unique_ptr<httplib::Client> client_;
+	};
+
+	static FirestoreConnectionPool &Instance();
+
+	// Lease a client for the given scheme+host (e.g. "https://firestore.googleapis.com")
+	Lease Acquire(const std::string &scheme_host);
+
+	// Maximum idle connections retained per host (0 disables pooling)
+	void SetMaxIdlePerHost(int64_t max_idle);
+	// Idle connections older than this are closed instead of reused
+	void SetIdleTimeoutSeconds(int64_t seconds);
+
+	FirestoreConnectionPoolStats GetStats();
+
+	// Close all idle connections
+	void Clear();
+
+	~FirestoreConnectionPool();
+
+private:
+	FirestoreConnectionPool() = default;
+
+	struct IdleConnection {
+		std::unique_ptr<httplib::Client> client;
+		std::chrono::steady_clock::time_point last_used;
+	};
+
+	void Release(const std::string &key, std::unique_ptr<httplib::Client> client);
+	void EvictExpiredLocked(std::deque<IdleConnection> &idle, std::chrono::steady_clock::time_point now);
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, std::deque<IdleConnection>> idle_;
+	int64_t max_idle_per_host_ = kDefaultMaxIdlePerHost;
+	int64_t idle_timeout_seconds_ = kDefaultIdleTimeoutSeconds;
+	FirestoreConnectionPoolStats stats_;
+};
+
+} // namespace duckdb
@@ -10,7 +10,9 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
 #include <memory>
+#include <optional>
 
 namespace duckdb {
 
@@ -45,6 +47,9 @@ struct FirestoreIndex {
 	bool is_single_field;
 };
 
+// Firestore evaluates at most 30 disjunctions per query (IN values, in disjunctive normal form)
+static constexpr idx_t kMaxFirestoreDisjunctions = 30;
+
 // Represents a single filter that can be pushed to Firestore
 struct FirestorePushdownFilter {
 	std::string field_path;
@@ -55,22 +60,46 @@ struct FirestorePushdownFilter {
 	bool is_in_filter = false;   // true for IN filters
 	std::vector<json> in_values; // Values for IN filter
 	bool is_equality = false;    // EQUAL, NOT_EQUAL, IN, NOT_IN, IS_NULL, IS_NOT_NULL
+	// OR across fields: true when this filter is the disjunction of `disjuncts`, each an EQUAL
+	// or IN filter (field_path and firestore_op are unset)
+	bool is_disjunction = false;
+	std::vector<FirestorePushdownFilter> disjuncts;
 };
 
 // Result of analyzing DuckDB filters against Firestore indexes
 struct FirestoreFilterResult {
 	std::vector<FirestorePushdownFilter> pushed_filters;
+	// Which index serves the pushed filters and their estimated selectivity, for EXPLAIN.
+	// Empty when every candidate filter was pushed without having to choose.
+	std::string plan;
 	bool has_pushdown() const {
 		return !pushed_filters.empty();
 	}
 };
 
+// Statistics of one top-level field over the documents sampled by schema inference
+struct FirestoreFieldStats {
+	idx_t present = 0;  // sampled documents that have the field
+	idx_t distinct = 0; // distinct values among them
+	// Range of the numeric values, when any were seen
+	bool has_range = false;
+	double min = 0;
+	double max = 0;
+};
+
+// Sampled statistics used to estimate filter selectivity; empty when nothing was sampled
+struct FirestoreSampleStats {
+	idx_t documents = 0;
+	std::map<std::string, FirestoreFieldStats> fields;
+};
+
 // Cache of available indexes for a collection
 struct FirestoreIndexCache {
 	std::vector<FirestoreIndex> composite_indexes;
 	std::vector<FirestoreIndex> single_field_indexes;
 	bool default_single_field_enabled = true;
 	bool fetch_succeeded = false;
+	FirestoreSampleStats sample_stats;
 };
 
 // Convert a DuckDB TableFilter into Firestore pushdown filters
@@ -80,6 +109,19 @@ std::vector<FirestorePushdownFilter> ConvertDuckDBFilter(const std::string &fiel
 // Build Firestore StructuredQuery `where` clause JSON from pushed filters
 json BuildWhereClause(const std::vector<FirestorePushdownFilter> &filters);
 
+// Whether a pushed filter has to be split into several queries: a disjunction, or an IN list
+// longer than Firestore accepts
+bool RequiresSplitting(const FirestorePushdownFilter &filter);
+
+// Expand pushed filters into the conjunctions of a set of sub-queries whose union is the
+// original query. The first filter that requires splitting is expanded (IN lists into chunks
+// that keep each sub-query within kMaxFirestoreDisjunctions, disjunctions into their
+// branches); any other filter that requires splitting is dropped and left to DuckDB.
+// `may_overlap` is set when a document can match more than one sub-query. Returns a single
+// conjunction when nothing needs splitting.
+std::vector<std::vector<FirestorePushdownFilter>>
+SplitDisjunctiveFilters(const std::vector<FirestorePushdownFilter> &filters, bool &may_overlap);
+
 // Check if a single-field index exists for a field
 bool HasSingleFieldIndex(const std::string &field_path, const FirestoreIndexCache &cache,
                          FirestoreIndex::QueryScope scope);
@@ -93,7 +135,13 @@ bool FindMatchingCompositeIndex(const std::set<std::string> &eq_fields, const st
 bool HasCompositeOrderByIndex(const std::vector<OrderByField> &order_by_fields, const FirestoreIndexCache &cache,
                               FirestoreIndex::QueryScope scope);
 
-// Match DuckDB filters against available indexes, return what can be pushed down
+// Estimated fraction of documents matching a filter, from sampled statistics when available
+double EstimateFilterSelectivity(const FirestorePushdownFilter &filter, const FirestoreSampleStats &stats);
+
+// Match DuckDB filters against available indexes, return what can be pushed down.
+// When not every filter can be served at once (range filters on several fields, or equality
+// plus range filters without a composite index covering them all), the most selective subset
+// that a single-field or composite index supports is pushed and the rest is left to DuckDB.
 FirestoreFilterResult MatchFiltersToIndexes(const std::vector<FirestorePushdownFilter> &candidate_filters,
                                             const FirestoreIndexCache &index_cache, bool is_collection_group);
 
@@ -107,4 +155,21 @@ std::vector<FirestorePushdownFilter> ConvertExpressionToFilters(const Expression
                                                                 const std::vector<LogicalType> &all_column_types,
                                                                 const std::vector<idx_t> &column_id_map);
 
+// Flatten nested ANDs of a bound filter expression into its conjuncts
+void CollectConjuncts(const Expression &expr, std::vector<const Expression *> &out);
+
+// Extract the document IDs an expression restricts __document_id (column 0) to: an equality,
+// an IN list, an OR of those, or an AND containing one. Returns nullopt for any other filter.
+std::optional<std::vector<std::string>> ExtractDocumentIdLookup(const Expression &expr, idx_t table_index,
+                                                                const std::vector<idx_t> &column_id_map);
+
+// Keep only the IDs of `ids` that also appear in `other`, preserving the order of `ids`
+void IntersectDocumentIds(std::vector<std::string> &ids, const std::vector<std::string> &other);
+
+// Parse a SQL predicate over top-level fields ("status = 'stale' AND created < TIMESTAMP '2024-01-01'")
+// into filters that Firestore evaluates on its own: comparisons and BETWEEN with literals, IN /
+// NOT IN lists, IS [NOT] NULL, AND, and OR between equalities on one field. Throws a
+// BinderException for anything else, since nothing is left for DuckDB to filter.
+std::vector<FirestorePushdownFilter> ParseFirestoreFilterPredicate(const std::string &predicate);
+
 } // namespace duckdb
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "firestore_client.hpp"
+#include <string>
+
+namespace duckdb {
+
+// Streaming (SAX) decoder for Firestore document pages.
+//
+// Understands the response shapes of ListDocuments ({"documents": [...], "nextPageToken": ...}),
+// runQuery ([{"document": {...}}, ...]) and batchGet ([{"found": {...}}, ...]). Documents are
+// built directly from the token stream without materializing the response DOM. When
+// `wanted_fields` is set, only those top-level field subtrees are kept; everything else is
+// skipped while parsing.
+FirestoreListResponse DecodeDocumentPage(const std::string &body, const FirestoreFieldSet *wanted_fields = nullptr);
+
+} // namespace duckdb
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+class ExtensionLoader;
+
+// CHANGE STREAM: firestore_listen('collection', poll_interval_ms := 5000, duration_seconds := 0,
+//                                 max_events := NULL, include_initial := true,
+//                                 removed_values := false)
+// Usage: SELECT * FROM firestore_listen('orders', duration_seconds := 60) WHERE status = 'open';
+// Emits one row per added, modified or removed document: the collection's columns followed by
+// __change_type and __update_time. WHERE filters on document columns define the watched set:
+// pushable ones narrow the polled query, and documents leaving the set are emitted as removed
+// (with their last matching values when removed_values is set). Every poll lists the names of
+// the watched set; only added or modified documents are read in full.
+void RegisterFirestoreListenFunction(ExtensionLoader &loader);
+
+} // namespace duckdb
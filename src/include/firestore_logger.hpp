@@ -6,6 +6,10 @@
 #include <chrono>
 #include <mutex>
 #include <fstream>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <vector>
 
 namespace duckdb {
 
@@ -51,6 +55,9 @@ class FirestoreLogSink {
 public:
 	virtual ~FirestoreLogSink() = default;
 	virtual void Log(const FirestoreLogEntry &entry) = 0;
+	// Push buffered output to its destination
+	virtual void Flush() {
+	}
 };
 
 // Default sink that does nothing (for production)
@@ -66,12 +73,13 @@ public:
 	void Log(const FirestoreLogEntry &entry) override;
 };
 
-// Sink that writes to a file
+// Sink that writes to a file. Lines below WARN are flushed by Flush() rather than one by one.
 class FileLogSink : public FirestoreLogSink {
 public:
 	explicit FileLogSink(const std::string &filepath);
 	~FileLogSink();
 	void Log(const FirestoreLogEntry &entry) override;
+	void Flush() override;
 	bool IsOpen() const {
 		return file_.is_open();
 	}
@@ -96,6 +104,54 @@ private:
 	Callback callback_;
 };
 
+// Sink that hands entries to a background thread, which formats them and writes them to
+// `inner`. Loggers never block: entries go into a bounded lock-free ring buffer, and are
+// dropped (and counted) when it is full. Pending entries are written on destruction.
+class AsyncLogSink : public FirestoreLogSink {
+public:
+	explicit AsyncLogSink(std::shared_ptr<FirestoreLogSink> inner, size_t capacity = 8192);
+	~AsyncLogSink();
+	void Log(const FirestoreLogEntry &entry) override;
+	void Flush() override;
+
+	// Entries dropped because the buffer was full
+	uint64_t DroppedCount() const {
+		return dropped_.load(std::memory_order_relaxed);
+	}
+
+	AsyncLogSink(const AsyncLogSink &) = delete;
+	AsyncLogSink &operator=(const AsyncLogSink &) = delete;
+
+private:
+	// Slot of a bounded multi-producer queue: `sequence` tells producers and the writer
+	// whose turn the slot is
+	struct Slot {
+		std::atomic<size_t> sequence;
+		FirestoreLogEntry entry;
+	};
+
+	bool TryPush(const FirestoreLogEntry &entry);
+	bool TryPop(FirestoreLogEntry &out);
+	// Write every queued entry; returns how many were written
+	size_t Drain();
+	void RunWriter();
+
+	std::shared_ptr<FirestoreLogSink> inner_;
+	std::vector<Slot> slots_;
+	size_t mask_;
+	std::atomic<size_t> enqueue_pos_ {0};
+	size_t dequeue_pos_ = 0; // writer thread only
+
+	std::atomic<uint64_t> dropped_ {0};
+	uint64_t reported_dropped_ = 0; // writer thread only
+
+	std::mutex wake_mutex_;
+	std::condition_variable wake_cv_;
+	std::atomic<bool> writer_idle_ {false};
+	std::atomic<bool> stop_ {false};
+	std::thread writer_;
+};
+
 // ============================================================================
 // Global Logger
 // ============================================================================
@@ -113,9 +169,10 @@ public:
 	std::shared_ptr<FirestoreLogSink> GetSink() const;
 	void ResetToDefault(); // Resets to NullLogSink
 
-	// Check if a level would be logged
+	// Check if a level would be logged; a single relaxed load, cheap enough for hot paths
 	bool ShouldLog(FirestoreLogLevel level) const {
-		return level >= level_ && level_ != FirestoreLogLevel::NONE;
+		auto current = level_.load(std::memory_order_relaxed);
+		return level >= current && current != FirestoreLogLevel::NONE;
 	}
 
 	// Core logging method
@@ -146,8 +203,10 @@ public:
 private:
 	FirestoreLogger();
 
-	FirestoreLogLevel level_;
+	std::atomic<FirestoreLogLevel> level_;
+	// Read and replaced only with std::atomic_load/std::atomic_store, so Log never takes mutex_
 	std::shared_ptr<FirestoreLogSink> sink_;
+	// Serializes the setters (level and sink are changed together)
 	mutable std::mutex mutex_;
 };
 
@@ -155,7 +214,8 @@ private:
 // Logging Macros
 // ============================================================================
 
-// These macros automatically capture source location
+// These macros automatically capture source location. `msg` is only evaluated when the
+// level is enabled, so building it costs nothing otherwise.
 
 #define FS_LOG_DEBUG(msg)                                                                                              \
 	do {                                                                                                               \
@@ -185,28 +245,28 @@ private:
 		}                                                                                                              \
 	} while (0)
 
-// Conditional logging with format-like syntax
+// Conditional logging; `cond` is only evaluated when the level is enabled
 #define FS_LOG_DEBUG_IF(cond, msg)                                                                                     \
 	do {                                                                                                               \
-		if (cond) {                                                                                                    \
+		if (::duckdb::FirestoreLogger::Instance().ShouldLog(::duckdb::FirestoreLogLevel::DEBUG) && (cond)) {           \
 			FS_LOG_DEBUG(msg);                                                                                         \
 		}                                                                                                              \
 	} while (0)
 #define FS_LOG_INFO_IF(cond, msg)                                                                                      \
 	do {                                                                                                               \
-		if (cond) {                                                                                                    \
+		if (::duckdb::FirestoreLogger::Instance().ShouldLog(::duckdb::FirestoreLogLevel::INFO) && (cond)) {            \
 			FS_LOG_INFO(msg);                                                                                          \
 		}                                                                                                              \
 	} while (0)
 #define FS_LOG_WARN_IF(cond, msg)                                                                                      \
 	do {                                                                                                               \
-		if (cond) {                                                                                                    \
+		if (::duckdb::FirestoreLogger::Instance().ShouldLog(::duckdb::FirestoreLogLevel::WARN) && (cond)) {            \
 			FS_LOG_WARN(msg);                                                                                          \
 		}                                                                                                              \
 	} while (0)
 #define FS_LOG_ERROR_IF(cond, msg)                                                                                     \
 	do {                                                                                                               \
-		if (cond) {                                                                                                    \
+		if (::duckdb::FirestoreLogger::Instance().ShouldLog(::duckdb::FirestoreLogLevel::ERR) && (cond)) {             \
 			FS_LOG_ERROR(msg);                                                                                         \
 		}                                                                                                              \
 	} while (0)
@@ -5,11 +5,15 @@
 
 namespace duckdb {
 
-// Pre-optimize function that walks the logical plan tree to extract
+// Pre-optimize function. Ungrouped COUNT(*) / SUM / AVG over firestore_scan are first
+// replaced with a runAggregationQuery where possible (see firestore_aggregate.hpp). It then
+// walks the logical plan tree to extract
 // ORDER BY and LIMIT clauses above firestore_scan LogicalGet nodes
 // and injects them into FirestoreScanBindData for server-side pushdown.
 // The original ORDER BY / LIMIT nodes are left in place so DuckDB
 // always re-verifies results (correctness guarantee).
+// Equality joins of __document_id against a VALUES list are recorded as batchGet lookups.
+// ORDER BY a vector distance + LIMIT k is recorded as a findNearest search.
 void FirestorePreOptimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan);
 
 } // namespace duckdb
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "firestore_client.hpp"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+
+struct FirestorePageCursor;
+
+// Background worker that fetches the pages of one cursor ahead of the consumer.
+//
+// Pages of a stream depend on each other (page token / startAt of the previous page), so
+// one thread fetches them in order into a queue bounded by `depth`. Transport errors are
+// handed to the consumer after the pages fetched before them.
+class FirestorePagePrefetcher {
+public:
+	FirestorePagePrefetcher(FirestorePageCursor &cursor, std::shared_ptr<FirestoreCredentials> credentials,
+	                        std::shared_ptr<FirestoreIOStats> stats, idx_t depth);
+	~FirestorePagePrefetcher();
+
+	FirestorePagePrefetcher(const FirestorePagePrefetcher &) = delete;
+	FirestorePagePrefetcher &operator=(const FirestorePagePrefetcher &) = delete;
+
+	// Wait for the next page. Returns false once the stream is drained; rethrows fetch errors.
+	bool Pop(std::vector<FirestoreDocument> &out);
+
+private:
+	void Run();
+
+	FirestorePageCursor &cursor_;
+	FirestoreClient client_;
+	idx_t depth_;
+
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::deque<std::vector<FirestoreDocument>> ready_;
+	std::exception_ptr error_;
+	bool done_ = false;
+	bool stop_ = false;
+	std::thread worker_;
+};
+
+// A resumable position in one stream of Firestore result pages.
+//
+// A scan is made of one cursor (sequential scan) or several (one per partitionQuery range or
+// batchGet chunk).
+// Each cursor owns the query shape and enough position state to fetch the next page on its own,
+// so cursors can be handed to different DuckDB threads.
+struct FirestorePageCursor {
+	enum class Mode : uint8_t {
+		LIST_DOCUMENTS, // GET .../documents/{collection} with pageToken pagination
+		RUN_QUERY,      // :runQuery with startAt cursor pagination (also every collection group scan)
+		BATCH_GET       // :batchGet of a fixed set of documents, returned as a single page
+	};
+
+	Mode mode = Mode::LIST_DOCUMENTS;
+	std::string collection; // As passed to firestore_scan (may carry the ~ prefix)
+	bool is_collection_group = false;
+
+	// LIST_DOCUMENTS: options sent with every page
+	FirestoreQuery list_query;
+	std::string next_page_token;
+
+	// RUN_QUERY: base StructuredQuery (may carry a partition's startAt/endAt)
+	json structured_query;
+	int64_t page_size = 1000;
+	// startAt for the next page; null until the first page has been fetched
+	json next_start_at;
+
+	// BATCH_GET: document paths relative to .../documents (see ResolveDocumentPath)
+	std::vector<std::string> document_paths;
+
+	// Fields requested and decoded for each document (nullptr returns whole documents)
+	std::shared_ptr<const FirestoreFieldSet> field_mask;
+
+	bool exhausted = false;
+
+	// Pages fetched ahead of consumption (e.g. the probe page fetched during InitGlobal)
+	std::deque<std::vector<FirestoreDocument>> buffered_pages;
+
+	// Background prefetching; once started, only the prefetcher advances the position
+	std::unique_ptr<FirestorePagePrefetcher> prefetcher;
+
+	// Fetch the next page, from the buffer if available. Returns false once the stream is done.
+	bool NextPage(FirestoreClient &client, std::vector<FirestoreDocument> &out);
+
+	// Fetch one page from Firestore and append it to buffered_pages
+	void FetchIntoBuffer(FirestoreClient &client);
+
+	// Fetch one page from Firestore and advance the position
+	std::vector<FirestoreDocument> FetchPage(FirestoreClient &client);
+
+	// Keep up to `depth` pages in flight on a background thread, counting its requests under
+	// `stats`. The cursor must not move in memory afterwards.
+	void StartPrefetch(std::shared_ptr<FirestoreCredentials> credentials, std::shared_ptr<FirestoreIOStats> stats,
+	                   idx_t depth);
+
+	// Whether the cursor has nothing left to return
+	bool IsDone() const {
+		return exhausted && buffered_pages.empty() && !prefetcher;
+	}
+};
+
+// Build the startAt cursor that resumes a runQuery right after `last_doc`,
+// using the values of every orderBy field in the query.
+json BuildResumeCursor(const json &structured_query, const FirestoreDocument &last_doc);
+
+} // namespace duckdb
@@ -16,4 +16,19 @@ bool IsFirestoreDocumentPath(const std::string &path);
 // as document-path scans even if the remaining text happens to have even segments.
 bool IsFirestoreDocumentPathCollection(const std::string &collection);
 
+// Compare two document resource names the way Firestore orders __name__:
+// segment by segment, so "a/b" sorts before "a-b/c". Returns <0, 0 or >0.
+int CompareFirestoreDocumentNames(const std::string &left, const std::string &right);
+
+// Collection ID named in a StructuredQuery "from" clause: the last path segment, without the
+// collection-group '~' prefix ("users/u1/orders" -> "orders", "~orders" -> "orders").
+std::string GetFirestoreCollectionId(const std::string &collection);
+
+// Format a top-level field name as a Firestore field path, backtick-quoting names that are
+// not simple identifiers ("name" -> name, "my-field" -> `my-field`).
+std::string QuoteFirestoreFieldPath(const std::string &field_name);
+
+// Parent collection of a document resource name (".../documents/users/u1" -> ".../documents/users").
+std::string GetFirestoreParentPath(const std::string &document_name);
+
 } // namespace duckdb
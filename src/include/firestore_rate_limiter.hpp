@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace duckdb {
+
+// One database's write budget, as reported by firestore_write_rate_stats()
+struct FirestoreWriteRateStats {
+	std::string database;      // projects/{project}/databases/{database}
+	double ramp_ceiling = 0;   // ops/sec allowed by the 500/50/5 ramp-up rule
+	double current_rate = 0;   // ops/sec currently granted (ramp ceiling after AIMD backoff)
+	uint64_t granted_ops = 0;  // Writes let through
+	uint64_t throttled = 0;    // 429/503/RESOURCE_EXHAUSTED responses seen
+	double waited_seconds = 0; // Time writers spent blocked on the limiter
+};
+
+// Process-wide token-bucket limiter for document writes, one bucket per database.
+//
+// Follows Firestore's 500/50/5 ramp-up rule: start at 500 ops/sec and raise the ceiling by 50%
+// every 5 minutes of sustained traffic. Throttling responses halve the granted rate
+// (multiplicative decrease); it then recovers additively towards the ramp ceiling. Writers
+// block in Acquire() instead of failing with RESOURCE_EXHAUSTED halfway through a job.
+class FirestoreRateLimiter {
+public:
+	static constexpr double kInitialOpsPerSecond = 500.0;
+	static constexpr double kRampUpFactor = 1.5;
+	static constexpr int64_t kRampUpIntervalSeconds = 300;
+	static constexpr double kMinOpsPerSecond = 20.0;
+	static constexpr double kAdditiveIncreasePerSecond = 50.0;
+
+	static FirestoreRateLimiter &Instance();
+
+	// Block until `ops` writes may be sent to `database`
+	void Acquire(const std::string &database, uint64_t ops);
+
+	// Firestore pushed back (HTTP 429/503 or a RESOURCE_EXHAUSTED write status)
+	void OnThrottled(const std::string &database);
+
+	void SetEnabled(bool enabled);
+	bool IsEnabled();
+
+	std::vector<FirestoreWriteRateStats> GetStats();
+
+	// Forget all buckets, restarting the ramp-up
+	void Reset();
+
+private:
+	FirestoreRateLimiter() = default;
+
+	using Clock = std::chrono::steady_clock;
+
+	struct Bucket {
+		Clock::time_point ramp_start;
+		Clock::time_point last_refill;
+		Clock::time_point last_decrease;
+		double tokens = 0;
+		double current_rate = kInitialOpsPerSecond;
+		FirestoreWriteRateStats stats;
+	};
+
+	Bucket &GetBucketLocked(const std::string &database, Clock::time_point now);
+	static double RampCeiling(const Bucket &bucket, Clock::time_point now);
+	static void RefillLocked(Bucket &bucket, Clock::time_point now);
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, Bucket> buckets_;
+	bool enabled_ = true;
+};
+
+} // namespace duckdb
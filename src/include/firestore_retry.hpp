@@ -0,0 +1,49 @@
+#pragma once
+
+#include "firestore_error.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace duckdb {
+
+// How transient failures are retried. Process-wide, like the HTTP connection pool.
+struct FirestoreRetryPolicy {
+	static constexpr int64_t kDefaultMaxAttempts = 5;
+	static constexpr int64_t kDefaultBaseDelayMs = 200;
+	static constexpr int64_t kDefaultDeadlineMs = 60000;
+	static constexpr int64_t kMaxDelayMs = 10000;
+
+	int64_t max_attempts = kDefaultMaxAttempts;  // Including the first attempt (1 disables retries)
+	int64_t base_delay_ms = kDefaultBaseDelayMs; // Delay before the first retry; doubles per attempt
+	int64_t deadline_ms = kDefaultDeadlineMs;    // Give up once retrying would exceed this (0 = no deadline)
+};
+
+// Counters exposed through firestore_retry_stats()
+struct FirestoreRetryStats {
+	uint64_t retries = 0;       // Requests re-sent after a transient failure
+	uint64_t recovered = 0;     // Requests that succeeded after at least one retry
+	uint64_t exhausted = 0;     // Requests that failed after using up their attempts or deadline
+	uint64_t write_retries = 0; // Individual writes re-sent after a retryable BatchWrite status
+};
+
+class FirestoreRetry {
+public:
+	static FirestoreRetryPolicy GetPolicy();
+	static void SetMaxAttempts(int64_t max_attempts);
+	static void SetBaseDelayMs(int64_t base_delay_ms);
+	static void SetDeadlineMs(int64_t deadline_ms);
+
+	// Transport failures, HTTP 429 and 5xx responses
+	static bool IsRetryableError(FirestoreErrorCode code);
+
+	// Jittered exponential backoff before retry number `retry` (1-based)
+	static std::chrono::milliseconds BackoffDelay(const FirestoreRetryPolicy &policy, int64_t retry);
+
+	static void RecordRetry();
+	static void RecordWriteRetries(uint64_t writes);
+	static void RecordOutcome(bool recovered);
+	static FirestoreRetryStats GetStats();
+};
+
+} // namespace duckdb
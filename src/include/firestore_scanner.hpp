@@ -2,8 +2,15 @@
 
 #include "duckdb.hpp"
 #include "duckdb/function/table_function.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 #include "firestore_client.hpp"
 #include "firestore_index.hpp"
+#include "firestore_page_cursor.hpp"
+#include "firestore_types.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
 
 namespace duckdb {
 
@@ -11,6 +18,20 @@ class ExtensionLoader;
 
 enum class DocPathOrderType : uint8_t { NONE = 0, ASCENDING, DESCENDING };
 
+// Firestore findNearest caps a vector search at this many documents
+static constexpr int64_t kMaxFirestoreNearestLimit = 1000;
+
+// Vector search extracted by the optimizer extension from
+// ORDER BY <distance>(embedding, <constant vector>) LIMIT k over the scan
+struct FirestoreNearestSearch {
+	std::string vector_field;
+	std::string distance_measure; // "EUCLIDEAN", "COSINE" or "DOT_PRODUCT"
+	json query_vector;            // Firestore vector value (mapValue with __type__: __vector__)
+	int64_t limit = 0;            // LIMIT + OFFSET of the query
+	// Equality filters of the WHERE clause, which Firestore applies before ranking
+	std::vector<FirestorePushdownFilter> pre_filters;
+};
+
 // Bind data - stores parameters from SQL call
 struct FirestoreScanBindData : public TableFunctionData {
 	std::string collection;
@@ -36,6 +57,11 @@ struct FirestoreScanBindData : public TableFunctionData {
 	// we list subcollections during execution and return them as virtual __document_id rows.
 	bool is_document_path = false;
 
+	// Recursive mode: scan the collection and every collection found below it (max_depth levels
+	// deep, 0 = no limit); __document_id returns full paths, as for collection groups.
+	bool recursive = false;
+	int64_t max_depth = 0;
+
 	// Document-path ordering direction (from named param or SQL ORDER BY).
 	DocPathOrderType docpath_named_order = DocPathOrderType::NONE;
 
@@ -53,6 +79,21 @@ struct FirestoreScanBindData : public TableFunctionData {
 	std::vector<OrderByField> sql_pushed_order_by;
 	std::optional<int64_t> sql_pushed_limit;
 
+	// Requested partitionQuery ranges (named `partitions` param; falls back to firestore_scan_partitions)
+	std::optional<int64_t> partitions;
+
+	// Document-ID lookups: when any of these is set, only those documents are fetched, in
+	// batchGet chunks, instead of reading the whole collection. Sets from several sources are
+	// intersected. document_ids comes from the named parameter, filter_document_ids from
+	// WHERE __document_id = / IN (...) (pushdown_complex_filter), and join_document_ids from
+	// joins against a constant relation (optimizer extension).
+	std::optional<std::vector<std::string>> document_ids;
+	std::optional<std::vector<std::string>> filter_document_ids;
+	std::optional<std::vector<std::string>> join_document_ids;
+
+	// findNearest search set by the optimizer extension; the SQL ORDER BY / LIMIT stay in place
+	std::optional<FirestoreNearestSearch> find_nearest;
+
 	unique_ptr<FunctionData> Copy() const override {
 		auto copy = make_uniq<FirestoreScanBindData>();
 		*copy = *this;
@@ -84,26 +125,37 @@ struct FirestoreScanBindData : public TableFunctionData {
 			return true;
 		};
 
+		bool find_nearest_equal = find_nearest.has_value() == other.find_nearest.has_value();
+		if (find_nearest_equal && find_nearest) {
+			find_nearest_equal = find_nearest->vector_field == other.find_nearest->vector_field &&
+			                     find_nearest->distance_measure == other.find_nearest->distance_measure &&
+			                     find_nearest->query_vector == other.find_nearest->query_vector &&
+			                     find_nearest->limit == other.find_nearest->limit;
+		}
+
 		return collection == other.collection && column_names == other.column_names &&
 		       column_types == other.column_types && projected_columns == other.projected_columns &&
 		       limit == other.limit && order_by == other.order_by &&
 		       order_fields_equal(parsed_order_by, other.parsed_order_by) &&
 		       is_collection_group == other.is_collection_group && show_missing == other.show_missing &&
 		       is_document_path == other.is_document_path && docpath_named_order == other.docpath_named_order &&
+		       recursive == other.recursive && max_depth == other.max_depth &&
 		       credentials_equal && order_fields_equal(sql_pushed_order_by, other.sql_pushed_order_by) &&
-		       sql_pushed_limit == other.sql_pushed_limit;
+		       sql_pushed_limit == other.sql_pushed_limit && partitions == other.partitions &&
+		       document_ids == other.document_ids && filter_document_ids == other.filter_document_ids &&
+		       join_document_ids == other.join_document_ids && find_nearest_equal;
 	}
 };
 
 // Global state - shared across threads
 struct FirestoreScanGlobalState : public GlobalTableFunctionState {
 	std::unique_ptr<FirestoreClient> client;
-	std::vector<FirestoreDocument> documents;
+	// I/O statistics of this scan (for EXPLAIN ANALYZE), forwarded to those of its query
+	std::shared_ptr<FirestoreIOStats> stats;
 	std::vector<std::string> docpath_ids;
 	bool is_document_path = false;
-	idx_t current_index;
+	idx_t current_index; // Document-path mode only
 	bool finished;
-	std::string next_page_token;
 
 	// Filter pushdown state
 	FirestoreFilterResult pushdown_result;
@@ -115,21 +167,104 @@ struct FirestoreScanGlobalState : public GlobalTableFunctionState {
 	// it would cut off rows before DuckDB's FILTER node runs.
 	bool pushdown_failed = false;
 
-	// Pagination optimization: track page size to detect end of results
-	int64_t query_page_size = 1000; // The page size used in the query
-	bool last_page_was_full = true; // Whether last fetch returned a full page
+	// The bind data asked for a findNearest search that Firestore rejected or that returned
+	// fewer documents than the limit; the collection was read and ranked by DuckDB instead.
+	bool find_nearest_failed = false;
+
+	// Page streams: a single cursor for a sequential scan, or one per partitionQuery range.
+	// Scan threads claim cursors in order through next_cursor.
+	std::vector<FirestorePageCursor> cursors;
+	std::mutex cursor_lock;
+	idx_t next_cursor = 0;
+
+	// Sub-queries of an OR across fields can return the same document; only the first copy
+	// is emitted
+	bool dedupe_documents = false;
+	std::mutex seen_lock;
+	std::unordered_set<std::string> seen_documents;
+
+	// Rows emitted by all threads, used to enforce the effective limit
+	std::atomic<idx_t> rows_emitted {0};
+
+	// Pages each cursor fetches ahead in the background (0 = fetch on demand)
+	idx_t prefetch_depth = 0;
+
+	// Value writer per projected column, resolved from the bind-time column types
+	// (nullptr for __document_id)
+	std::vector<FirestoreColumnWriter> column_writers;
 
 	FirestoreScanGlobalState() : current_index(0), finished(false) {
 	}
 
+	// Claim the next unassigned cursor, or nullptr when all are taken
+	FirestorePageCursor *ClaimCursor() {
+		std::lock_guard<std::mutex> guard(cursor_lock);
+		if (next_cursor >= cursors.size()) {
+			return nullptr;
+		}
+		return &cursors[next_cursor++];
+	}
+
+	// Drop the documents of `page` that another sub-query already returned
+	void RemoveSeenDocuments(std::vector<FirestoreDocument> &page) {
+		std::lock_guard<std::mutex> guard(seen_lock);
+		page.erase(std::remove_if(page.begin(), page.end(),
+		                          [&](const FirestoreDocument &doc) { return !seen_documents.insert(doc.name).second; }),
+		           page.end());
+	}
+
+	// Whether Firestore applies every candidate filter. Only then may a LIMIT cut the scan off
+	// before DuckDB's FILTER node: with part of the WHERE clause left to DuckDB, rows past the
+	// limit can still match.
+	bool AllFiltersPushed(const std::vector<FirestorePushdownFilter> &candidates) const {
+		return !pushdown_failed && pushdown_result.pushed_filters.size() == candidates.size();
+	}
+
 	idx_t MaxThreads() const override {
-		return 1;
-	} // REST API is sequential
+		if (is_document_path) {
+			return 1;
+		}
+		return MaxValue<idx_t>(cursors.size(), 1);
+	}
+};
+
+// Memory of the decoded pages one scan thread holds (its current page and those prefetched for
+// it), reserved with DuckDB's buffer manager so that it counts against memory_limit: buffers of
+// other operators are evicted to make room, and a scan that does not fit fails with an
+// out-of-memory error instead of exhausting the process.
+class FirestorePageMemoryReservation {
+public:
+	explicit FirestorePageMemoryReservation(BufferManager &buffer_manager) : buffer_manager_(buffer_manager) {
+	}
+	~FirestorePageMemoryReservation() {
+		Resize(0);
+	}
+
+	FirestorePageMemoryReservation(const FirestorePageMemoryReservation &) = delete;
+	FirestorePageMemoryReservation &operator=(const FirestorePageMemoryReservation &) = delete;
+
+	// Grow or shrink the reservation; throws OutOfMemoryException when growing past the limit
+	void Resize(idx_t bytes);
+
+	idx_t Size() const {
+		return size_;
+	}
+
+private:
+	BufferManager &buffer_manager_;
+	idx_t size_ = 0;
 };
 
-// Local state - per-thread state (minimal for single-threaded)
+// Local state - per-thread position within the claimed cursor
 struct FirestoreScanLocalState : public LocalTableFunctionState {
-	// Single-threaded, no local state needed
+	std::unique_ptr<FirestoreClient> client;
+	FirestorePageCursor *cursor = nullptr;
+	std::vector<FirestoreDocument> documents; // Current page
+	idx_t current_index = 0;
+	bool finished = false;
+	// Sized by the largest page seen so far, times the pages this thread can hold at once
+	std::unique_ptr<FirestorePageMemoryReservation> page_memory;
+	idx_t max_page_bytes = 0;
 };
 
 // Register the firestore_scan function
@@ -146,8 +281,14 @@ unique_ptr<LocalTableFunctionState> FirestoreScanInitLocal(ExecutionContext &con
 
 void FirestoreScanFunction(ClientContext &context, TableFunctionInput &data, DataChunk &output);
 
+// StructuredQuery over `collection` with a `where` for `pushed_filters` (if any), ordered by
+// the fields of its inequality filters and then __name__, as Firestore requires for paging
+json BuildFilteredStructuredQuery(const std::string &collection, bool is_collection_group,
+                                  const std::vector<FirestorePushdownFilter> &pushed_filters);
+
 // Clear the schema cache (useful when schema changes or for testing)
 // If collection is empty, clears entire cache. Otherwise clears only entries for that collection.
-void ClearFirestoreSchemaCache(const std::string &collection = "");
+// Entries persisted in `cache_dir` (firestore_schema_cache_dir) are removed as well.
+void ClearFirestoreSchemaCache(const std::string &collection = "", const std::string &cache_dir = "");
 
 } // namespace duckdb
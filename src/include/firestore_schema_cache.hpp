@@ -0,0 +1,86 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "firestore_index.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace duckdb {
+
+// Inferred schema and index metadata of one collection
+struct FirestoreCachedSchema {
+	std::vector<std::pair<std::string, LogicalType>> schema;
+	std::shared_ptr<FirestoreIndexCache> index_cache;
+	// Wall clock, so entries written by another process age correctly
+	std::chrono::system_clock::time_point cached_at;
+
+	bool IsExpired(int64_t ttl_seconds) const {
+		if (ttl_seconds == 0) {
+			return true; // Cache disabled
+		}
+		auto age = std::chrono::system_clock::now() - cached_at;
+		return age > std::chrono::seconds(ttl_seconds);
+	}
+};
+
+// Process-wide schema cache keyed by "project_id:database_id:collection".
+//
+// Entries live in memory and, when a cache directory is configured (firestore_schema_cache_dir),
+// also in one JSON file per key, so a new process can bind without sampling the collection or
+// calling the Admin API. Files are replaced with an atomic rename: concurrent processes may
+// store the same key, and readers only ever see a complete entry.
+//
+// Expired entries can be refreshed in the background (stale-while-revalidate): binds keep using
+// the old entry while a single worker thread re-infers it and swaps the result in. At process
+// exit the worker drops queued refreshes, finishes the one in progress and is joined.
+class FirestoreSchemaCache {
+public:
+	// Re-infers one entry; returns false if it could not be refreshed
+	using Loader = std::function<bool(FirestoreCachedSchema &)>;
+
+	static FirestoreSchemaCache &Instance();
+	~FirestoreSchemaCache();
+
+	// Find an entry younger than `max_age_seconds`, in memory first and then in `cache_dir`
+	// (empty = memory only). Entries loaded from disk are kept in memory.
+	bool Get(const std::string &key, int64_t max_age_seconds, const std::string &cache_dir, FirestoreCachedSchema &out);
+
+	void Put(const std::string &key, const FirestoreCachedSchema &entry, const std::string &cache_dir);
+
+	void Remove(const std::string &key, const std::string &cache_dir);
+
+	// Drop every entry (empty collection) or the entries of one collection, in memory and on disk
+	void Clear(const std::string &collection, const std::string &cache_dir);
+
+	// Queue `loader` to replace the entry for `key`. A key already queued or being refreshed is
+	// not queued again, so a burst of binds on a stale entry triggers a single refresh.
+	void RefreshInBackground(const std::string &key, const std::string &cache_dir, Loader loader);
+
+private:
+	FirestoreSchemaCache();
+
+	struct RefreshTask {
+		std::string key;
+		std::string cache_dir;
+		Loader loader;
+	};
+
+	void RunRefreshes();
+
+	std::mutex mutex_;
+	std::unordered_map<std::string, FirestoreCachedSchema> entries_;
+
+	std::condition_variable refresh_cv_;
+	std::deque<RefreshTask> refresh_queue_;
+	std::unordered_set<std::string> refreshing_; // Keys queued or in progress
+	std::thread refresh_worker_;
+	bool stopping_ = false; // Set by the destructor; guarded by mutex_
+};
+
+} // namespace duckdb
@@ -4,6 +4,10 @@
 #include "duckdb/main/client_config.hpp"
 #include "duckdb/main/client_context.hpp"
 #include "duckdb/main/config.hpp"
+#include "firestore_connection_pool.hpp"
+#include "firestore_rate_limiter.hpp"
+#include "firestore_retry.hpp"
+#include "firestore_transport.hpp"
 
 namespace duckdb {
 
@@ -27,11 +31,241 @@ struct FirestoreSettings {
 		parameter = Value::BIGINT(ttl);
 	}
 
+	// Directory the schema cache is also persisted to, so new processes start warm (empty = memory only)
+	static std::string SchemaCacheDir(const ClientContext &context) {
+		Value value;
+		if (context.TryGetCurrentSetting("firestore_schema_cache_dir", value) && !value.IsNull()) {
+			return value.ToString();
+		}
+		return "";
+	}
+
+	// Serve expired schema cache entries while they are re-inferred on a background thread
+	static constexpr bool kDefaultSchemaCacheStaleWhileRevalidate = false;
+
+	static bool SchemaCacheStaleWhileRevalidate(const ClientContext &context) {
+		Value value;
+		if (context.TryGetCurrentSetting("firestore_schema_cache_stale_while_revalidate", value) && !value.IsNull()) {
+			return BooleanValue::Get(value);
+		}
+		return kDefaultSchemaCacheStaleWhileRevalidate;
+	}
+
+	// Number of partitionQuery ranges a scan is split into (0 or 1 = sequential scan)
+	static constexpr int64_t kDefaultScanPartitions = 0;
+
+	static int64_t ScanPartitions(const ClientContext &context) {
+		Value value;
+		if (context.TryGetCurrentSetting("firestore_scan_partitions", value)) {
+			auto partitions = BigIntValue::Get(value);
+			return partitions < 0 ? 0 : partitions;
+		}
+		return kDefaultScanPartitions;
+	}
+
+	static void SetScanPartitions(ClientContext &context, SetScope scope, Value &parameter) {
+		auto partitions = BigIntValue::Get(parameter);
+		if (partitions < 0) {
+			partitions = 0;
+		}
+		parameter = Value::BIGINT(partitions);
+	}
+
+	// Answer COUNT(*)/SUM/AVG over firestore_scan with a single :runAggregationQuery
+	static constexpr bool kDefaultAggregatePushdown = true;
+
+	static bool AggregatePushdown(const ClientContext &context) {
+		Value value;
+		if (context.TryGetCurrentSetting("firestore_aggregate_pushdown", value) && !value.IsNull()) {
+			return BooleanValue::Get(value);
+		}
+		return kDefaultAggregatePushdown;
+	}
+
+	// Answer ORDER BY <distance>(embedding, <vector>) LIMIT k over firestore_scan with a findNearest query
+	static constexpr bool kDefaultVectorSearchPushdown = true;
+
+	static bool VectorSearchPushdown(const ClientContext &context) {
+		Value value;
+		if (context.TryGetCurrentSetting("firestore_vector_search_pushdown", value) && !value.IsNull()) {
+			return BooleanValue::Get(value);
+		}
+		return kDefaultVectorSearchPushdown;
+	}
+
+	// Pages fetched ahead of the scan on a background thread (0 = no prefetch)
+	static constexpr int64_t kDefaultScanPrefetchPages = 1;
+	static constexpr int64_t kMaxScanPrefetchPages = 16;
+
+	static int64_t ScanPrefetchPages(const ClientContext &context) {
+		Value value;
+		if (context.TryGetCurrentSetting("firestore_scan_prefetch_pages", value)) {
+			return ClampPrefetchPages(BigIntValue::Get(value));
+		}
+		return kDefaultScanPrefetchPages;
+	}
+
+	static void SetScanPrefetchPages(ClientContext &context, SetScope scope, Value &parameter) {
+		parameter = Value::BIGINT(ClampPrefetchPages(BigIntValue::Get(parameter)));
+	}
+
+	// :batchWrite requests firestore_insert keeps in flight at once
+	static constexpr int64_t kDefaultWriteConcurrency = 4;
+	static constexpr int64_t kMaxWriteConcurrency = 64;
+
+	static int64_t WriteConcurrency(const ClientContext &context) {
+		Value value;
+		if (context.TryGetCurrentSetting("firestore_write_concurrency", value)) {
+			return ClampWriteConcurrency(BigIntValue::Get(value));
+		}
+		return kDefaultWriteConcurrency;
+	}
+
+	static void SetWriteConcurrency(ClientContext &context, SetScope scope, Value &parameter) {
+		parameter = Value::BIGINT(ClampWriteConcurrency(BigIntValue::Get(parameter)));
+	}
+
+	// Listing requests a collection tree walk keeps in flight at once
+	static constexpr int64_t kDefaultDiscoveryConcurrency = 16;
+	static constexpr int64_t kMaxDiscoveryConcurrency = 64;
+
+	static int64_t DiscoveryConcurrency(const ClientContext &context) {
+		Value value;
+		if (context.TryGetCurrentSetting("firestore_discovery_concurrency", value)) {
+			return ClampDiscoveryConcurrency(BigIntValue::Get(value));
+		}
+		return kDefaultDiscoveryConcurrency;
+	}
+
+	static void SetDiscoveryConcurrency(ClientContext &context, SetScope scope, Value &parameter) {
+		parameter = Value::BIGINT(ClampDiscoveryConcurrency(BigIntValue::Get(parameter)));
+	}
+
+	// Pace document writes with the 500/50/5 ramp-up rule. The limiter is process-wide.
+	static constexpr bool kDefaultWriteRateLimit = true;
+
+	static void SetWriteRateLimit(ClientContext &context, SetScope scope, Value &parameter) {
+		FirestoreRateLimiter::Instance().SetEnabled(!parameter.IsNull() && BooleanValue::Get(parameter));
+	}
+
+	// Retries of transient failures (reads and BatchWrite). Process-wide, like the HTTP pool.
+	static void SetRetryMaxAttempts(ClientContext &context, SetScope scope, Value &parameter) {
+		auto attempts = BigIntValue::Get(parameter);
+		if (attempts < 1) {
+			attempts = 1; // 1 disables retries
+		}
+		parameter = Value::BIGINT(attempts);
+		FirestoreRetry::SetMaxAttempts(attempts);
+	}
+
+	static void SetRetryBaseDelayMs(ClientContext &context, SetScope scope, Value &parameter) {
+		auto delay = BigIntValue::Get(parameter);
+		if (delay < 0) {
+			delay = 0;
+		}
+		parameter = Value::BIGINT(delay);
+		FirestoreRetry::SetBaseDelayMs(delay);
+	}
+
+	static void SetRetryDeadlineMs(ClientContext &context, SetScope scope, Value &parameter) {
+		auto deadline = BigIntValue::Get(parameter);
+		if (deadline < 0) {
+			deadline = 0; // 0 means no deadline
+		}
+		parameter = Value::BIGINT(deadline);
+		FirestoreRetry::SetDeadlineMs(deadline);
+	}
+
+	// HTTP connection pool settings. The pool is process-wide, so these apply to all connections.
+	static constexpr int64_t kDefaultHttpPoolSize = FirestoreConnectionPool::kDefaultMaxIdlePerHost;
+	static constexpr int64_t kDefaultHttpIdleTimeoutSeconds = FirestoreConnectionPool::kDefaultIdleTimeoutSeconds;
+
+	static void SetHttpPoolSize(ClientContext &context, SetScope scope, Value &parameter) {
+		auto size = BigIntValue::Get(parameter);
+		if (size < 0) {
+			size = 0; // 0 disables connection reuse
+		}
+		parameter = Value::BIGINT(size);
+		FirestoreConnectionPool::Instance().SetMaxIdlePerHost(size);
+	}
+
+	static void SetHttpIdleTimeoutSeconds(ClientContext &context, SetScope scope, Value &parameter) {
+		auto timeout = BigIntValue::Get(parameter);
+		if (timeout < 0) {
+			timeout = 0;
+		}
+		parameter = Value::BIGINT(timeout);
+		FirestoreConnectionPool::Instance().SetIdleTimeoutSeconds(timeout);
+	}
+
+	// HTTP record/replay. The transport is process-wide: recording appends every exchange to a
+	// file, replay serves the responses of such a file instead of contacting Firestore. Setting
+	// either path to '' goes back to the network.
+	static void SetHttpRecord(ClientContext &context, SetScope scope, Value &parameter) {
+		auto path = parameter.IsNull() ? std::string() : parameter.ToString();
+		if (path.empty()) {
+			if (std::dynamic_pointer_cast<FirestoreRecordingTransport>(FirestoreTransport::Get())) {
+				FirestoreTransport::Reset();
+			}
+			return;
+		}
+		FirestoreTransport::Set(
+		    std::make_shared<FirestoreRecordingTransport>(std::make_shared<FirestoreHttpTransport>(), path));
+	}
+
+	static void SetHttpReplay(ClientContext &context, SetScope scope, Value &parameter) {
+		auto path = parameter.IsNull() ? std::string() : parameter.ToString();
+		if (path.empty()) {
+			if (std::dynamic_pointer_cast<FirestoreReplayTransport>(FirestoreTransport::Get())) {
+				FirestoreTransport::Reset();
+			}
+			return;
+		}
+		Value latency;
+		int64_t latency_ms = 0;
+		if (context.TryGetCurrentSetting("firestore_http_replay_latency_ms", latency) && !latency.IsNull()) {
+			latency_ms = BigIntValue::Get(latency);
+		}
+		FirestoreTransport::Set(std::make_shared<FirestoreReplayTransport>(path, latency_ms));
+	}
+
+	static void SetHttpReplayLatencyMs(ClientContext &context, SetScope scope, Value &parameter) {
+		auto latency_ms = BigIntValue::Get(parameter);
+		if (latency_ms < 0) {
+			latency_ms = 0;
+		}
+		parameter = Value::BIGINT(latency_ms);
+		if (auto replay = std::dynamic_pointer_cast<FirestoreReplayTransport>(FirestoreTransport::Get())) {
+			replay->SetLatencyMs(latency_ms);
+		}
+	}
+
 private:
 	static int64_t NormalizeTTL(const Value &value) {
 		auto ttl = BigIntValue::Get(value);
 		return ttl < 0 ? 0 : ttl;
 	}
+
+	static int64_t ClampPrefetchPages(int64_t pages) {
+		if (pages < 0) {
+			return 0;
+		}
+		return pages > kMaxScanPrefetchPages ? kMaxScanPrefetchPages : pages;
+	}
+
+	static int64_t ClampDiscoveryConcurrency(int64_t concurrency) {
+		if (concurrency < 1) {
+			return 1;
+		}
+		return concurrency > kMaxDiscoveryConcurrency ? kMaxDiscoveryConcurrency : concurrency;
+	}
+
+	static int64_t ClampWriteConcurrency(int64_t concurrency) {
+		if (concurrency < 1) {
+			return 1;
+		}
+		return concurrency > kMaxWriteConcurrency ? kMaxWriteConcurrency : concurrency;
+	}
 };
 
 } // namespace duckdb
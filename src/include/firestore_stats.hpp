@@ -0,0 +1,104 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace duckdb {
+
+class ClientContext;
+class ExtensionLoader;
+
+// Groups of Firestore REST endpoints that requests are counted under
+enum class FirestoreEndpoint : uint8_t {
+	LIST,            // documents.list (including collection id listings)
+	RUN_QUERY,       // :runQuery (filtered scans and collection groups)
+	BATCH_GET,       // :batchGet
+	AGGREGATION,     // :runAggregationQuery
+	PARTITION_QUERY, // :partitionQuery
+	GET,             // single document reads
+	WRITE,           // single document creates, updates, deletes and transforms
+	BATCH_WRITE,     // :batchWrite
+	ADMIN,           // index metadata from the Admin API
+	OTHER,
+	COUNT
+};
+
+// Endpoint group of a request, from its FirestoreErrorContext operation name
+FirestoreEndpoint GetFirestoreEndpoint(const std::string &operation);
+
+const char *FirestoreEndpointToString(FirestoreEndpoint endpoint);
+
+// Plain copy of FirestoreIOStats, for reporting
+struct FirestoreIOStatsSnapshot {
+	std::array<uint64_t, static_cast<size_t>(FirestoreEndpoint::COUNT)> requests {};
+	uint64_t request_bytes = 0;
+	uint64_t response_bytes = 0;
+	uint64_t documents_read = 0;
+	uint64_t documents_written = 0;
+	uint64_t pages = 0;
+	uint64_t retries = 0;
+	double request_ms = 0; // Sum of all round-trip times
+	double latency_p50_ms = 0;
+	double latency_p95_ms = 0;
+	double latency_p99_ms = 0;
+	double json_parse_ms = 0;
+	double conversion_ms = 0;
+};
+
+// I/O counters of a set of Firestore requests, safe to update from any thread.
+// Statistics of one query forward every update to the process-wide totals.
+class FirestoreIOStats {
+public:
+	explicit FirestoreIOStats(std::shared_ptr<FirestoreIOStats> parent = nullptr) : parent_(std::move(parent)) {
+	}
+
+	// Process-wide totals since the extension was loaded
+	static const std::shared_ptr<FirestoreIOStats> &Global();
+
+	// One HTTP round trip (each retry attempt counts separately)
+	void RecordRequest(FirestoreEndpoint endpoint, uint64_t request_bytes, uint64_t response_bytes,
+	                   std::chrono::microseconds latency);
+	void RecordPage(uint64_t documents, std::chrono::nanoseconds parse_time);
+	void RecordDocumentsWritten(uint64_t documents);
+	void RecordRetry();
+	void RecordJsonParse(std::chrono::nanoseconds parse_time);
+	// Time spent writing documents into DuckDB vectors
+	void RecordConversion(std::chrono::nanoseconds conversion_time);
+
+	FirestoreIOStatsSnapshot Snapshot() const;
+
+private:
+	// Latency buckets grow by 2^(1/4), starting at 1us: bucket i holds latencies below 2^((i+1)/4) us
+	static constexpr size_t kLatencyBuckets = 128;
+
+	std::shared_ptr<FirestoreIOStats> parent_;
+	std::array<std::atomic<uint64_t>, static_cast<size_t>(FirestoreEndpoint::COUNT)> requests_ {};
+	std::atomic<uint64_t> request_bytes_ {0};
+	std::atomic<uint64_t> response_bytes_ {0};
+	std::atomic<uint64_t> documents_read_ {0};
+	std::atomic<uint64_t> documents_written_ {0};
+	std::atomic<uint64_t> pages_ {0};
+	std::atomic<uint64_t> retries_ {0};
+	std::atomic<uint64_t> request_us_ {0};
+	std::atomic<uint64_t> json_parse_ns_ {0};
+	std::atomic<uint64_t> conversion_ns_ {0};
+	std::array<std::atomic<uint64_t>, kLatencyBuckets> latency_buckets_ {};
+};
+
+// Statistics of the query running on `context`, created on first use. The most recent
+// queries are kept for firestore_stats().
+std::shared_ptr<FirestoreIOStats> GetFirestoreQueryStats(ClientContext &context);
+
+// STATISTICS: firestore_stats()
+// Usage: SELECT * FROM firestore_stats();
+// One 'total' row with the process-wide counters, then one 'query' row per recent query that
+// talked to Firestore, newest first.
+void RegisterFirestoreStatsFunction(ExtensionLoader &loader);
+
+} // namespace duckdb
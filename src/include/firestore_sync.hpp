@@ -0,0 +1,19 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+class ExtensionLoader;
+
+// Table holding one watermark per (collection, target_table, watermark_field)
+static constexpr const char *kFirestoreSyncStateTable = "firestore_sync_state";
+
+// DELTA SYNC: firestore_sync('collection', 'target_table', watermark_field := 'updated_at')
+// Usage: CALL firestore_sync('orders', 'orders_mirror');
+// The first call copies the whole collection into target_table (creating it if needed). Later
+// calls fetch only documents whose watermark field is >= the largest value seen so far and
+// upsert them by __document_id.
+void RegisterFirestoreSyncFunction(ExtensionLoader &loader);
+
+} // namespace duckdb
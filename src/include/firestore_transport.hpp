@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace duckdb {
+
+// One HTTP request as FirestoreClient sends it
+struct FirestoreHttpRequest {
+	std::string method;
+	std::string url;
+	std::string body;
+	std::string auth_header; // Never recorded
+};
+
+struct FirestoreHttpResponse {
+	int status = 0;
+	std::string body;
+	// Set when no response arrived (connection refused, timeout, ...); status and body are unset
+	std::string transport_error;
+};
+
+// How FirestoreClient exchanges requests with Firestore. The process-wide transport is the HTTP
+// connection pool unless a record or replay file is configured (firestore_http_record,
+// firestore_http_replay); other transports, such as gRPC, plug in at the same point.
+class FirestoreTransport {
+public:
+	virtual ~FirestoreTransport() = default;
+
+	// Exchange one request; thread-safe
+	virtual FirestoreHttpResponse Send(const FirestoreHttpRequest &request) = 0;
+
+	// True when requests never reach Firestore, so no access token has to be obtained
+	virtual bool IsOffline() const {
+		return false;
+	}
+
+	static std::shared_ptr<FirestoreTransport> Get();
+	static void Set(std::shared_ptr<FirestoreTransport> transport);
+	// Back to the HTTP connection pool
+	static void Reset();
+};
+
+// Sends requests over keep-alive connections leased from FirestoreConnectionPool
+class FirestoreHttpTransport : public FirestoreTransport {
+public:
+	FirestoreHttpResponse Send(const FirestoreHttpRequest &request) override;
+};
+
+// Forwards requests to another transport and appends every exchange to a JSON Lines file:
+// {"method", "url", "request_body", "status", "response_body"}, one object per line. API keys
+// in URLs are redacted and auth headers are not written.
+class FirestoreRecordingTransport : public FirestoreTransport {
+public:
+	FirestoreRecordingTransport(std::shared_ptr<FirestoreTransport> inner, const std::string &path);
+
+	FirestoreHttpResponse Send(const FirestoreHttpRequest &request) override;
+
+	const std::string &Path() const {
+		return path_;
+	}
+
+private:
+	std::shared_ptr<FirestoreTransport> inner_;
+	std::string path_;
+	std::mutex mutex_;
+	std::ofstream out_;
+};
+
+// Serves the responses of a recording from memory. Requests are matched on method, URL and
+// body; a request recorded several times gets its responses in recorded order, starting over
+// after the last one, so a recording can be replayed any number of times. Unmatched requests
+// fail with 404 NOT_FOUND.
+class FirestoreReplayTransport : public FirestoreTransport {
+public:
+	explicit FirestoreReplayTransport(const std::string &path, int64_t latency_ms = 0);
+
+	FirestoreHttpResponse Send(const FirestoreHttpRequest &request) override;
+
+	bool IsOffline() const override {
+		return true;
+	}
+
+	const std::string &Path() const {
+		return path_;
+	}
+	// Delay added to every response, to model network round trips
+	void SetLatencyMs(int64_t latency_ms);
+
+private:
+	struct RecordedResponses {
+		std::vector<FirestoreHttpResponse> responses;
+		size_t next = 0;
+	};
+
+	std::string path_;
+	std::mutex mutex_;
+	std::unordered_map<std::string, RecordedResponses> responses_;
+	int64_t latency_ms_ = 0;
+};
+
+// `url` with the value of any key= query parameter replaced, as written to recordings
+std::string RedactFirestoreUrl(const std::string &url);
+
+} // namespace duckdb
@@ -39,6 +39,14 @@ json DuckDBValueToFirestore(const Value &value, const LogicalType &source_type);
 // Set a value in a DuckDB vector from Firestore JSON
 void SetDuckDBValue(Vector &vector, idx_t index, const json &firestore_value, const LogicalType &type);
 
+// Writes a Firestore value into row `index` of a flat vector. Writers are specialized per
+// column type and write the common, type-matching values straight into the vector data;
+// anything else (nulls aside) goes through SetDuckDBValue, so results are identical.
+using FirestoreColumnWriter = void (*)(Vector &vector, idx_t index, const json &firestore_value);
+
+// Resolve the writer for a column of the given type (once per scan, not per cell)
+FirestoreColumnWriter GetFirestoreColumnWriter(const LogicalType &type);
+
 // Column information inferred from documents
 struct InferredColumn {
 	std::string name;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "firestore_client.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace duckdb {
+
+// Maximum writes Firestore accepts in one :batchWrite request
+static constexpr idx_t kFirestoreMaxBatchWrites = 500;
+
+// Commit `writes` with :batchWrite. Writes that fail with a retryable status (ABORTED,
+// UNAVAILABLE, RESOURCE_EXHAUSTED, ...) are re-sent on their own, with the backoff and attempt
+// limit of FirestoreRetry::GetPolicy(); every other failure is reported in the result with its
+// index into `writes`. HTTP-level errors that outlast the request retries (e.g. permission
+// denied for the whole request) are thrown.
+BatchOperationResult CommitBatchWrites(FirestoreClient &client, const std::vector<json> &writes);
+
+// Throw a WRITE_BATCH_PARTIAL_FAILURE error naming the first failed write, if any
+void ThrowIfWritesFailed(const BatchOperationResult &result);
+
+// Log every failed write of `result` as a warning
+void LogFailedWrites(const BatchOperationResult &result);
+
+// Keeps up to `max_in_flight` :batchWrite requests outstanding on background threads.
+//
+// Batches are independent, so unlike scan pages they can be committed in any order and in
+// parallel. Submit() may be called from any thread; it blocks while the window is full. The
+// first failed batch is rethrown from the next Submit() or Finish().
+class FirestoreWriteDispatcher {
+public:
+	// Requests are counted under `stats` when set (see FirestoreClient::SetStats)
+	FirestoreWriteDispatcher(std::shared_ptr<FirestoreCredentials> credentials, idx_t max_in_flight,
+	                         std::shared_ptr<FirestoreIOStats> stats = nullptr);
+	~FirestoreWriteDispatcher();
+
+	FirestoreWriteDispatcher(const FirestoreWriteDispatcher &) = delete;
+	FirestoreWriteDispatcher &operator=(const FirestoreWriteDispatcher &) = delete;
+
+	// Queue a batch of at most kFirestoreMaxBatchWrites writes
+	void Submit(std::vector<json> writes);
+
+	// Queue update or delete writes to be sent one document at a time (PATCH / DELETE), for
+	// credentials that may not use :batchWrite. Documents that do not exist are skipped.
+	void SubmitIndividual(std::vector<json> writes);
+
+	// Log failed writes of a batch and carry on instead of failing; call before the first Submit()
+	void SetSkipFailedWrites(bool skip) {
+		skip_failed_writes_ = skip;
+	}
+
+	// Wait until every submitted batch is committed; rethrows the first failure
+	void Finish();
+
+	// Writes acknowledged by Firestore so far
+	idx_t Committed() const {
+		return committed_.load();
+	}
+
+private:
+	struct PendingBatch {
+		std::vector<json> writes;
+		bool individual;
+	};
+
+	void Enqueue(PendingBatch batch);
+	void Run();
+	void RethrowError();
+
+	std::shared_ptr<FirestoreCredentials> credentials_;
+	std::shared_ptr<FirestoreIOStats> stats_;
+	idx_t max_in_flight_;
+
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::deque<PendingBatch> queue_;
+	idx_t in_flight_ = 0; // Queued plus being sent
+	std::exception_ptr error_;
+	bool stop_ = false;
+	bool skip_failed_writes_ = false;
+	std::vector<std::thread> workers_;
+	std::atomic<idx_t> committed_ {0};
+};
+
+} // namespace duckdb
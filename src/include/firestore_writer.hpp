@@ -56,7 +56,19 @@ void RegisterFirestoreUpdateBatchFunction(ExtensionLoader &loader);
 //            (SELECT list(__document_id) FROM firestore_scan('users') WHERE status='deleted'));
 void RegisterFirestoreDeleteBatchFunction(ExtensionLoader &loader);
 
-// For COPY TO firestore
+// STREAMING UPDATE: firestore_update_rows('collection', (SELECT __document_id, field1, ... FROM ...))
+// Every non-ID column is written to the document named by the row; document_id := 'col'
+// names another ID column. IDs are streamed, not collected into a list.
+void RegisterFirestoreUpdateRowsFunction(ExtensionLoader &loader);
+
+// STREAMING DELETE: firestore_delete_rows('collection', (SELECT __document_id FROM ...))
+void RegisterFirestoreDeleteRowsFunction(ExtensionLoader &loader);
+
+// COPY TO: COPY (SELECT ...) TO 'collection' (FORMAT firestore, DOCUMENT_ID 'col', MERGE true,
+//                                             BATCH_SIZE 500)
+// Writes every row as a document with parallel BatchWrite requests; without DOCUMENT_ID the
+// document IDs are generated. MERGE keeps fields that are not copied, otherwise documents are
+// replaced.
 void RegisterFirestoreCopyFunction(ExtensionLoader &loader);
 
 } // namespace duckdb
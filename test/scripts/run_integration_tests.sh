@@ -199,6 +199,17 @@ assert_ge "$COL_COUNT" 2 "SELECT * returns multiple columns ($COL_COUNT)"
 ROW_COUNT=$(run_query "SELECT COUNT(*) FROM firestore_scan('users');")
 assert_eq "$ROW_COUNT" "5" "SELECT * returns 5 rows"
 
+# Test 4c: Projection pushdown (Firestore returns only the projected fields)
+echo "Test 4c: Projection pushdown..."
+ID_ONLY=$(run_query "SELECT count(DISTINCT __document_id) FROM firestore_scan('users');")
+assert_eq "$ID_ONLY" "5" "__document_id-only scan returns every document"
+
+PROJECTED_NAMES=$(run_query "SELECT string_agg(name, '|' ORDER BY name) FROM firestore_scan('users');")
+assert_eq "$PROJECTED_NAMES" "Alice|Bob|Charlie|Diana|Eve" "Single-column projection returns the projected values"
+
+PROJECTED_GROUP=$(run_query "SELECT sum(quantity) FROM firestore_scan('~orders');")
+assert_eq "$PROJECTED_GROUP" "8" "Projected collection group scan returns the projected values"
+
 # Test 5: DuckDB-side filtering
 echo "Test 5: DuckDB-side filtering..."
 PENDING_COUNT=$(run_query "SELECT count(*) FROM firestore_scan('users') WHERE status = 'pending';")
@@ -212,6 +223,29 @@ assert_eq "$ORDER_COUNT" "2" "User1 has 2 orders"
 ORDER_PRODUCT=$(run_query "SELECT product FROM firestore_scan('users/user1/orders') WHERE __document_id = 'order1';")
 assert_eq "$ORDER_PRODUCT" "Widget" "Order1 product is Widget"
 
+# Test 6b: __document_id lookups go through batchGet
+echo "Test 6b: Document ID lookups..."
+LOOKUP_NAMES=$(run_query "SELECT string_agg(name, '|' ORDER BY name) FROM firestore_scan('users') WHERE __document_id IN ('user2', 'user4', 'nope');")
+assert_eq "$LOOKUP_NAMES" "Bob|Diana" "IN lookup returns only the existing requested documents"
+
+LOOKUP_FILTERED=$(run_query "SELECT count(*) FROM firestore_scan('users') WHERE __document_id IN ('user1', 'user2', 'user5') AND status = 'active';")
+assert_eq "$LOOKUP_FILTERED" "2" "Other filters still apply to looked-up documents"
+
+LOOKUP_JOIN=$(run_query "SELECT string_agg(u.name || ':' || k.n, '|' ORDER BY u.name) FROM firestore_scan('users') u JOIN (VALUES ('user1', 1), ('user3', 3)) k(id, n) ON u.__document_id = k.id;")
+assert_eq "$LOOKUP_JOIN" "Alice:1|Charlie:3" "Join against VALUES looks up the join keys"
+
+LOOKUP_PARAM=$(run_query "
+SET VARIABLE ids = (SELECT list(id) FROM (VALUES ('user3'), ('user5'), ('user3')) t(id));
+SELECT string_agg(name, '|' ORDER BY name) FROM firestore_scan('users', document_ids = getvariable('ids'));
+")
+assert_eq "$LOOKUP_PARAM" "Charlie|Eve" "document_ids fetches each listed document once"
+
+LOOKUP_GROUP=$(run_query "SELECT sum(quantity) FROM firestore_scan('~orders') WHERE __document_id IN ('users/user1/orders/order1', 'users/user2/orders/order1', 'users/user1/notes/order1');")
+assert_eq "$LOOKUP_GROUP" "7" "Collection group lookups take full document paths"
+
+LOOKUP_EXPLAIN=$(run_explain "EXPLAIN SELECT name FROM firestore_scan('users') WHERE __document_id IN ('user1', 'user2');")
+assert_contains "$LOOKUP_EXPLAIN" "Firestore Document Lookup: 2 ids" "EXPLAIN shows the document lookup"
+
 # Document-path scan coverage lives in run_real_firestore_tests.sh because
 # Firestore's listCollectionIds metadata operation requires admin-capable auth.
 
@@ -220,6 +254,244 @@ echo "Test 7: Collection group query (all orders across all users)..."
 ALL_ORDERS=$(run_query "SELECT count(*) FROM firestore_scan('~orders');")
 assert_eq "$ALL_ORDERS" "3" "Collection group returns 3 total orders"
 
+# Test 7b: Partitioned scans (partitionQuery ranges read in parallel)
+echo "Test 7b: Partitioned scans..."
+run_query "
+CALL firestore_insert('partition_test', (SELECT 'p' || lpad(i::VARCHAR, 5, '0') AS id, i AS n FROM range(2500) t(i)), document_id := 'id');
+" > /dev/null
+
+PART_COUNT=$(run_query "SET threads = 4; SELECT count(*), sum(n) FROM firestore_scan('partition_test', partitions=4, show_missing=false);")
+assert_eq "$PART_COUNT" "2500,3123750" "Partitioned scan returns every document exactly once"
+
+PART_SETTING=$(run_query "SET threads = 4; SET firestore_scan_partitions = 4; SELECT count(DISTINCT __document_id) FROM firestore_scan('partition_test', show_missing=false);")
+assert_eq "$PART_SETTING" "2500" "firestore_scan_partitions setting partitions scans without the named parameter"
+
+PART_LIMIT=$(run_query "SELECT count(*) FROM (SELECT * FROM firestore_scan('partition_test', partitions=4, show_missing=false) LIMIT 10);")
+assert_eq "$PART_LIMIT" "10" "LIMIT disables partitioning and still returns the right row count"
+
+# Test 7c: Multi-page scans with and without background prefetch
+echo "Test 7c: Page prefetch..."
+PREFETCH_DEEP=$(run_query "SET firestore_scan_prefetch_pages = 4; SELECT count(*), sum(n) FROM firestore_scan('partition_test');")
+assert_eq "$PREFETCH_DEEP" "2500,3123750" "Scan with 4 prefetched pages returns all documents"
+
+PREFETCH_OFF=$(run_query "SET firestore_scan_prefetch_pages = 0; SELECT count(*), sum(n) FROM firestore_scan('partition_test');")
+assert_eq "$PREFETCH_OFF" "2500,3123750" "Scan without prefetch returns all documents"
+
+PREFETCH_FILTER=$(run_query "SET firestore_scan_prefetch_pages = 2; SELECT count(*) FROM firestore_scan('partition_test') WHERE n >= 500;")
+assert_eq "$PREFETCH_FILTER" "2000" "Prefetch follows runQuery cursors for pushed filters"
+
+run_query "
+CALL firestore_delete_batch('partition_test', (SELECT list(__document_id) FROM firestore_scan('partition_test')));
+" > /dev/null
+
+# Test 7c2: Decoded pages are reserved against memory_limit
+echo "Test 7c2: Scan page memory accounting..."
+run_query "CALL firestore_insert('wide_test', (SELECT 'w' || lpad(i::VARCHAR, 5, '0') AS id, i AS n, repeat('x', 50000) AS payload FROM range(200) t(i)), document_id := 'id');" > /dev/null
+
+WIDE_OOM=$(run_explain "SET memory_limit = '4MB'; SET firestore_scan_prefetch_pages = 0; SELECT count(*) FROM firestore_scan('wide_test');")
+assert_contains "$WIDE_OOM" "Out of Memory" "A page larger than memory_limit fails with an out-of-memory error"
+
+WIDE_SCAN=$(run_query "SELECT count(*), sum(length(payload)) FROM firestore_scan('wide_test');")
+assert_eq "$WIDE_SCAN" "200,10000000" "Wide collection scans within the memory limit"
+
+WIDE_RELEASED=$(run_query "CREATE TEMP TABLE wide_copy AS SELECT * FROM firestore_scan('wide_test'); SELECT memory_usage_bytes FROM duckdb_memory() WHERE tag = 'EXTENSION';")
+assert_eq "$WIDE_RELEASED" "0" "Page reservations are released from the EXTENSION tag after the scan"
+
+run_query "
+CALL firestore_delete_batch('wide_test', (SELECT list(__document_id) FROM firestore_scan('wide_test')));
+" > /dev/null
+
+# Test 7d: Collection groups larger than one page follow runQuery cursors
+echo "Test 7d: Multi-page collection group scans..."
+run_query "
+CALL firestore_insert('cg_parent/a/cg_items', (SELECT 'a' || lpad(i::VARCHAR, 5, '0') AS id, i AS n FROM range(1500) t(i)), document_id := 'id');
+CALL firestore_insert('cg_parent/b/cg_items', (SELECT 'b' || lpad(i::VARCHAR, 5, '0') AS id, i AS n FROM range(1000) t(i)), document_id := 'id');
+" > /dev/null
+
+CG_PAGED=$(run_query "SELECT count(*), count(DISTINCT __document_id), sum(n) FROM firestore_scan('~cg_items');")
+assert_eq "$CG_PAGED" "2500,2500,1623750" "Collection group scan pages past the first 1000 documents"
+
+CG_PAGED_NOPREFETCH=$(run_query "SET firestore_scan_prefetch_pages = 0; SELECT count(*) FROM firestore_scan('~cg_items');")
+assert_eq "$CG_PAGED_NOPREFETCH" "2500" "Collection group pagination works without prefetch"
+
+CG_PARTITIONED=$(run_query "SET threads = 4; SELECT count(DISTINCT __document_id), sum(n) FROM firestore_scan('~cg_items', partitions=4);")
+assert_eq "$CG_PARTITIONED" "2500,1623750" "Partitioned collection group scan returns every document exactly once"
+
+run_query "
+CALL firestore_delete_batch('~cg_items', (SELECT list(__document_id) FROM firestore_scan('~cg_items')));
+" > /dev/null
+
+# Test 7e: Bulk inserts keep several BatchWrite requests in flight
+echo "Test 7e: Concurrent BatchWrite inserts..."
+INSERT_CONCURRENT=$(run_query "SET firestore_write_concurrency = 8; CALL firestore_insert('write_test', (SELECT 'w' || lpad(i::VARCHAR, 5, '0') AS id, i AS n FROM range(3200) t(i)), document_id := 'id');")
+assert_eq "$INSERT_CONCURRENT" "3200" "Concurrent insert reports every committed row"
+
+WRITE_COUNT=$(run_query "SELECT count(*), sum(n) FROM firestore_scan('write_test');")
+assert_eq "$WRITE_COUNT" "3200,5118400" "Every batch of the concurrent insert was committed"
+
+INSERT_SERIAL=$(run_query "SET firestore_write_concurrency = 1; CALL firestore_insert('write_test', (SELECT 'w' || lpad(i::VARCHAR, 5, '0') AS id, i * 2 AS n FROM range(1200) t(i)), document_id := 'id');")
+assert_eq "$INSERT_SERIAL" "1200" "Insert with one request in flight reports every row"
+
+WRITE_OVERWRITTEN=$(run_query "SELECT sum(n) FROM firestore_scan('write_test');")
+assert_eq "$WRITE_OVERWRITTEN" "5837800" "Rewritten documents carry the values of the second insert"
+
+run_query "
+CALL firestore_delete_batch('write_test', (SELECT list(__document_id) FROM firestore_scan('write_test')));
+" > /dev/null
+
+# Test 7e2: COPY ... TO (FORMAT firestore) writes from parallel sinks
+echo "Test 7e2: COPY TO firestore..."
+run_query "SET threads = 4; COPY (SELECT 'c' || lpad(i::VARCHAR, 5, '0') AS id, i AS n, 'orig' AS tag FROM range(2600) t(i)) TO 'copy_test' (FORMAT firestore, DOCUMENT_ID 'id');" > /dev/null
+COPY_COUNT=$(run_query "SELECT count(*), sum(n), count(*) FILTER (WHERE tag = 'orig') FROM firestore_scan('copy_test');")
+assert_eq "$COPY_COUNT" "2600,3378700,2600" "COPY writes every row as a document"
+
+run_query "COPY (SELECT 'c' || lpad(i::VARCHAR, 5, '0') AS id, i * 2 AS n FROM range(100) t(i)) TO 'copy_test' (FORMAT firestore, DOCUMENT_ID 'id', MERGE true);" > /dev/null
+run_query "COPY (SELECT 'c' || lpad(i::VARCHAR, 5, '0') AS id, i AS n FROM range(2590, 2600) t(i)) TO 'copy_test' (FORMAT firestore, DOCUMENT_ID 'id');" > /dev/null
+COPY_MERGED=$(run_query "SELECT sum(n), count(*) FILTER (WHERE tag = 'orig') FROM firestore_scan('copy_test');")
+assert_eq "$COPY_MERGED" "3383650,2590" "MERGE keeps uncopied fields, overwrite replaces the document"
+
+run_query "COPY (SELECT i AS n FROM range(700) t(i)) TO 'copy_auto_test' (FORMAT firestore, BATCH_SIZE 200);" > /dev/null
+COPY_AUTO=$(run_query "SELECT count(DISTINCT __document_id), sum(n) FROM firestore_scan('copy_auto_test');")
+assert_eq "$COPY_AUTO" "700,244650" "COPY without DOCUMENT_ID generates unique IDs"
+
+run_query "
+CALL firestore_delete_batch('copy_test', (SELECT list(__document_id) FROM firestore_scan('copy_test')));
+CALL firestore_delete_batch('copy_auto_test', (SELECT list(__document_id) FROM firestore_scan('copy_auto_test')));
+" > /dev/null
+
+# Test 7f: Schema cache persisted to disk is reused by a new process
+echo "Test 7f: Persistent schema cache..."
+SCHEMA_CACHE_DIR=$(mktemp -d)
+run_query "CALL firestore_insert('schema_cache_test', (SELECT 'd' || i AS id, i AS n FROM range(3) t(i)), document_id := 'id');" > /dev/null
+
+COLS_FIRST=$(run_query "SET firestore_schema_cache_dir = '${SCHEMA_CACHE_DIR}'; SELECT count(*) FROM (DESCRIBE SELECT * FROM firestore_scan('schema_cache_test'));")
+assert_eq "$COLS_FIRST" "2" "Inferred schema has __document_id and n"
+
+CACHE_FILES=$(ls "${SCHEMA_CACHE_DIR}"/*.json 2>/dev/null | wc -l | tr -d '[:space:]')
+assert_eq "$CACHE_FILES" "1" "Schema cache entry written to the cache directory"
+
+run_query "CALL firestore_update('schema_cache_test', 'd0', 'extra', 'x');" > /dev/null
+
+COLS_CACHED=$(run_query "SET firestore_schema_cache_dir = '${SCHEMA_CACHE_DIR}'; SELECT count(*) FROM (DESCRIBE SELECT * FROM firestore_scan('schema_cache_test'));")
+assert_eq "$COLS_CACHED" "2" "New process binds from the persisted schema"
+
+COLS_REFRESHED=$(run_query "SET firestore_schema_cache_dir = '${SCHEMA_CACHE_DIR}'; CALL firestore_clear_cache('schema_cache_test'); SELECT count(*) FROM (DESCRIBE SELECT * FROM firestore_scan('schema_cache_test'));")
+assert_eq "$COLS_REFRESHED" "3" "Clearing the cache removes the persisted entry"
+
+# Test 7g: Expired entries are served while they are refreshed in the background
+echo "Test 7g: Stale-while-revalidate schema cache..."
+run_query "CALL firestore_update('schema_cache_test', 'd1', 'later', 'y');" > /dev/null
+sleep 6
+# The scan after the stale bind keeps the process alive while the refresh runs; a refresh in
+# progress at exit is finished before the process ends
+COLS_STALE=$(run_query "SET firestore_schema_cache_dir = '${SCHEMA_CACHE_DIR}'; SET firestore_schema_cache_ttl = 5; SET firestore_schema_cache_stale_while_revalidate = true; CREATE TEMP TABLE stale_cols AS SELECT count(*) AS c FROM (DESCRIBE SELECT * FROM firestore_scan('schema_cache_test')); SELECT count(*) FROM firestore_scan('schema_cache_test'); SELECT c FROM stale_cols;")
+assert_eq "$COLS_STALE" "3" "Expired entry is served without re-inferring in bind"
+
+COLS_BACKGROUND=$(run_query "SET firestore_schema_cache_dir = '${SCHEMA_CACHE_DIR}'; SELECT count(*) FROM (DESCRIBE SELECT * FROM firestore_scan('schema_cache_test'));")
+assert_eq "$COLS_BACKGROUND" "4" "Background refresh replaced the persisted entry"
+
+COLS_SYNC=$(run_query "SET firestore_schema_cache_dir = '${SCHEMA_CACHE_DIR}'; SET firestore_schema_cache_ttl = 5; SELECT count(*) FROM (DESCRIBE SELECT * FROM firestore_scan('schema_cache_test'));")
+assert_eq "$COLS_SYNC" "4" "Without stale-while-revalidate an expired entry is re-inferred"
+
+run_query "
+CALL firestore_delete_batch('schema_cache_test', (SELECT list(__document_id) FROM firestore_scan('schema_cache_test')));
+" > /dev/null
+rm -rf "${SCHEMA_CACHE_DIR}"
+
+# Test 7h: Delta sync into a persistent DuckDB table
+echo "Test 7h: Delta sync with a watermark field..."
+SYNC_DB=$(mktemp -u).duckdb
+run_sync_query() {
+    $DUCKDB -unsigned -csv -noheader "$SYNC_DB" -c "
+LOAD '${EXT_PATH}';
+CREATE SECRET __q (TYPE firestore, PROJECT_ID 'test-project', API_KEY 'fake-key');
+$1
+" 2>&1 | tail -1 | clean_query_output
+}
+run_query "CALL firestore_insert('sync_test', (SELECT 's' || i AS id, i AS n, TIMESTAMP '2024-01-01' + INTERVAL (i) DAY AS updated_at FROM range(3) t(i)), document_id := 'id');" > /dev/null
+
+SYNC_FIRST=$(run_sync_query "SELECT documents FROM firestore_sync('sync_test', 'sync_target');")
+assert_eq "$SYNC_FIRST" "3" "First sync copies the whole collection"
+
+run_query "CALL firestore_update('sync_test', 's1', 'n', 100, 'updated_at', TIMESTAMP '2024-02-01');" > /dev/null
+run_query "CALL firestore_insert('sync_test', (SELECT 's3' AS id, 3 AS n, TIMESTAMP '2024-01-15' AS updated_at), document_id := 'id');" > /dev/null
+
+SYNC_DELTA=$(run_sync_query "SELECT documents FROM firestore_sync('sync_test', 'sync_target');")
+assert_eq "$SYNC_DELTA" "3" "Second sync fetches the changed documents and the watermark boundary"
+
+SYNC_TARGET=$(run_sync_query "SELECT count(*), sum(n) FROM sync_target;")
+assert_eq "$SYNC_TARGET" "4,105" "Changed documents are upserted by __document_id"
+
+SYNC_WATERMARK=$(run_sync_query "SELECT watermark FROM firestore_sync_state WHERE collection = 'sync_test';")
+assert_eq "$SYNC_WATERMARK" "2024-02-0100:00:00" "Watermark advances to the newest updated_at"
+
+SYNC_NOOP=$(run_sync_query "SELECT documents FROM firestore_sync('sync_test', 'sync_target');")
+assert_eq "$SYNC_NOOP" "1" "Unchanged collection only re-reads the boundary document"
+
+# The target table and the sync state go to the database selected with USE
+SYNC_MIRROR_DB=$(mktemp -u).duckdb
+SYNC_USE=$(run_sync_query "ATTACH '${SYNC_MIRROR_DB}' AS mirror; USE mirror; SELECT documents FROM firestore_sync('sync_test', 'mirror_target');")
+assert_eq "$SYNC_USE" "4" "Sync after USE copies the collection"
+
+SYNC_USE_TABLES=$(run_sync_query "ATTACH '${SYNC_MIRROR_DB}' AS mirror; SELECT count(*) FILTER (WHERE database_name = 'mirror'), count(*) FILTER (WHERE database_name <> 'mirror' AND table_name = 'mirror_target') FROM duckdb_tables() WHERE table_name IN ('mirror_target', 'firestore_sync_state');")
+assert_eq "$SYNC_USE_TABLES" "2,0" "Target table and sync state are created in the USE database"
+
+SYNC_USE_ROWS=$(run_sync_query "ATTACH '${SYNC_MIRROR_DB}' AS mirror; SELECT count(*) FROM mirror.mirror_target;")
+assert_eq "$SYNC_USE_ROWS" "4" "USE database holds the synced rows"
+
+run_query "
+CALL firestore_delete_batch('sync_test', (SELECT list(__document_id) FROM firestore_scan('sync_test')));
+" > /dev/null
+rm -f "$SYNC_DB" "$SYNC_DB.wal" "$SYNC_MIRROR_DB" "$SYNC_MIRROR_DB.wal"
+
+# Test 7i: Change stream over a polled snapshot
+echo "Test 7i: firestore_listen change events..."
+run_query "CALL firestore_insert('listen_test', (SELECT 'l' || i AS id, i AS n FROM range(3) t(i)), document_id := 'id');" > /dev/null
+
+LISTEN_INITIAL=$(run_query "SELECT count(*), min(__change_type) FROM firestore_listen('listen_test', duration_seconds := 1);")
+assert_eq "$LISTEN_INITIAL" "3,added" "Initial snapshot is reported as added"
+
+LISTEN_MAX=$(run_query "SELECT count(*) FROM firestore_listen('listen_test', max_events := 2);")
+assert_eq "$LISTEN_MAX" "2" "max_events ends the stream"
+
+(sleep 2; run_query "CALL firestore_update('listen_test', 'l1', 'n', 99);" > /dev/null) &
+LISTEN_MODIFIED=$(run_query "SELECT __document_id, n, __change_type FROM firestore_listen('listen_test', include_initial := false, max_events := 1, duration_seconds := 20, poll_interval_ms := 200);")
+wait
+assert_eq "$LISTEN_MODIFIED" "l1,99,modified" "Updated document is reported as modified"
+
+(sleep 2; run_query "CALL firestore_delete('listen_test', 'l2');" > /dev/null) &
+LISTEN_REMOVED=$(run_query "SELECT __document_id, __change_type FROM firestore_listen('listen_test', include_initial := false, max_events := 1, duration_seconds := 20, poll_interval_ms := 200);")
+wait
+assert_eq "$LISTEN_REMOVED" "l2,removed" "Deleted document is reported as removed"
+
+# Filtered streams report documents leaving the filtered set, with their last matching values
+# when removed_values is set
+(sleep 2; run_query "CALL firestore_update('listen_test', 'l0', 'n', 7);" > /dev/null) &
+LISTEN_LEFT=$(run_query "SELECT __document_id, n, __change_type FROM firestore_listen('listen_test', include_initial := false, removed_values := true, max_events := 1, duration_seconds := 20, poll_interval_ms := 200) WHERE n = 0;")
+wait
+assert_eq "$LISTEN_LEFT" "l0,0,removed" "Document that stops matching the filter is reported as removed"
+
+(sleep 2; run_query "CALL firestore_delete('listen_test', 'l1');" > /dev/null) &
+LISTEN_FILTERED_REMOVED=$(run_query "SELECT __document_id, n, __change_type FROM firestore_listen('listen_test', include_initial := false, removed_values := true, max_events := 1, duration_seconds := 20, poll_interval_ms := 200) WHERE n = 99;")
+wait
+assert_eq "$LISTEN_FILTERED_REMOVED" "l1,99,removed" "Deleted document under a filter is reported as removed"
+
+# Without removed_values only the document ID and version are kept between polls
+(sleep 2; run_query "CALL firestore_update('listen_test', 'l0', 'n', 8);" > /dev/null) &
+LISTEN_NO_VALUES=$(run_query "SELECT __document_id, coalesce(n::VARCHAR, 'null'), __change_type, __update_time IS NOT NULL FROM firestore_listen('listen_test', include_initial := false, max_events := 1, duration_seconds := 20, poll_interval_ms := 200) WHERE n = 7;")
+wait
+assert_eq "$LISTEN_NO_VALUES" "l0,null,removed,true" "Removed rows carry only the ID and version without removed_values"
+
+# Unchanged documents are listed by name only; a poll fetches only the added or modified ones
+(sleep 2; run_query "CALL firestore_update('listen_test', 'l0', 'n', 9);" > /dev/null) &
+LISTEN_BATCH_GETS=$(run_query "SELECT count(*) FROM firestore_listen('listen_test', include_initial := false, max_events := 1, duration_seconds := 20, poll_interval_ms := 200); SELECT requests_by_endpoint['batch_get'] FROM firestore_stats() WHERE scope = 'query' AND query LIKE 'SELECT count(*) FROM firestore_listen%';")
+wait
+assert_eq "$LISTEN_BATCH_GETS" "1" "Only the modified document is fetched in full"
+
+run_query "
+CALL firestore_delete_batch('listen_test', (SELECT list(__document_id) FROM firestore_scan('listen_test')));
+" > /dev/null
+
 # Test 8: Complex filtering with aggregation
 echo "Test 8: Complex filtering with aggregation..."
 ABOVE_AVG=$(run_query "
@@ -276,6 +548,47 @@ assert_eq "$INACTIVE_REMAINING" "0" "No inactive users remain after batch delete
 TOTAL_USERS=$(run_query "SELECT count(*) FROM firestore_scan('users');")
 assert_eq "$TOTAL_USERS" "4" "4 users remain after deleting 1 inactive"
 
+# Test 12b: Streamed update and delete, without collecting the IDs into a list
+echo "Test 12b: Streaming update and delete..."
+run_query "CALL firestore_insert('stream_test', (SELECT 's' || i AS id, i AS n, 'new' AS status FROM range(1200) t(i)), document_id := 'id');" > /dev/null
+
+STREAM_UPDATED=$(run_query "SET firestore_write_concurrency = 4; CALL firestore_update_rows('stream_test', (SELECT __document_id, n * 2 AS n, 'done' AS status FROM firestore_scan('stream_test') WHERE n < 1100));")
+assert_eq "$STREAM_UPDATED" "1100" "firestore_update_rows reports every updated document"
+
+STREAM_STATE=$(run_query "SELECT count(*) FILTER (WHERE status = 'done'), sum(n) FROM firestore_scan('stream_test');")
+assert_eq "$STREAM_STATE" "1100,1323850" "Per-row values written to the streamed IDs only"
+
+STREAM_DELETED=$(run_query "CALL firestore_delete_rows('stream_test', (SELECT __document_id FROM firestore_scan('stream_test') WHERE status = 'done'));")
+assert_eq "$STREAM_DELETED" "1100" "firestore_delete_rows reports every deleted document"
+
+STREAM_LEFT=$(run_query "SELECT count(*), min(n) FROM firestore_scan('stream_test');")
+assert_eq "$STREAM_LEFT" "100,1100" "Only the documents not streamed remain"
+
+run_query "CALL firestore_delete_rows('stream_test', (SELECT __document_id FROM firestore_scan('stream_test')));" > /dev/null
+
+# Test 12c: Delete and update by query, without reading the documents into DuckDB
+echo "Test 12c: Delete and update by query..."
+run_query "CALL firestore_insert('where_test', (SELECT 'w' || i AS id, i AS n, CASE WHEN i % 3 = 0 THEN 'stale' ELSE 'live' END AS state, TIMESTAMP '2024-01-01' + INTERVAL (i) MINUTE AS created FROM range(1500) t(i)), document_id := 'id');" > /dev/null
+
+WHERE_UPDATED=$(run_query "CALL firestore_update_where('where_test', \$\$state = 'live' AND n >= 1000\$\$, 'state', 'late');")
+assert_eq "$WHERE_UPDATED" "334" "firestore_update_where updates every matching document"
+
+WHERE_REORDER=$(run_explain "CALL firestore_update_where('where_test', \$\$n >= 1000\$\$, 'n', 5000);")
+assert_contains "$WHERE_REORDER" "cannot update 'n'" "firestore_update_where rejects updates to a field its range filter pages on"
+WHERE_UNMOVED=$(run_query "SELECT count(*) FROM firestore_scan('where_test') WHERE n >= 1500;")
+assert_eq "$WHERE_UNMOVED" "0" "A rejected update writes nothing"
+
+WHERE_DELETED=$(run_query "CALL firestore_delete_where('where_test', \$\$state IN ('stale', 'late') OR state = 'gone'\$\$);")
+assert_eq "$WHERE_DELETED" "834" "firestore_delete_where deletes every matching document, paging past 1000"
+
+WHERE_LEFT=$(run_query "SELECT count(*), max(n) FROM firestore_scan('where_test') WHERE state = 'live';")
+assert_eq "$WHERE_LEFT" "666,998" "Only live documents below n = 1000 remain"
+
+WHERE_RANGE=$(run_query "CALL firestore_delete_where('where_test', \$\$created < TIMESTAMP '2024-01-01 01:00:00'\$\$);")
+assert_eq "$WHERE_RANGE" "40" "Typed literals filter timestamp fields"
+
+run_query "CALL firestore_delete_rows('where_test', (SELECT __document_id FROM firestore_scan('where_test')));" > /dev/null
+
 # Test 13: Array operations - setup
 echo "Test 13: Array operations setup..."
 curl -s -X POST "http://${FIRESTORE_EMULATOR_HOST}/v1/projects/test-project/databases/(default)/documents/array_test?documentId=arr1" \
@@ -832,6 +1145,26 @@ echo "Test 34: Filter with aggregation..."
 AVG_SCORE=$(run_query "SELECT round(avg(score), 1) FROM firestore_scan('pushdown_test') WHERE status = 'active' AND score IS NOT NULL;")
 assert_eq "$AVG_SCORE" "90.3" "Average score of active users with scores is 90.3"
 
+# Test 34b: Aggregation pushdown (runAggregationQuery)
+echo "Test 34b: Aggregation pushdown..."
+AGG_ACTIVE=$(run_query "SELECT count(*), sum(age) FROM firestore_scan('pushdown_test') WHERE status = 'active';")
+assert_eq "$AGG_ACTIVE" "3,98" "count(*) and sum(age) of active users answered by Firestore"
+
+AGG_RANGE=$(run_query "SELECT sum(age), round(avg(age), 1) FROM firestore_scan('pushdown_test') WHERE age > 28;")
+assert_eq "$AGG_RANGE" "105,35.0" "sum/avg with a pushed range filter"
+
+AGG_EMPTY=$(run_query "SELECT count(*), sum(age) IS NULL, avg(score) IS NULL FROM firestore_scan('pushdown_test') WHERE status = 'nobody';")
+assert_eq "$AGG_EMPTY" "0,true,true" "Aggregates over no rows keep DuckDB's NULL semantics"
+
+AGG_OFF=$(run_query "SET firestore_aggregate_pushdown = false; SELECT count(*), sum(age) FROM firestore_scan('pushdown_test') WHERE status = 'active';")
+assert_eq "$AGG_OFF" "3,98" "Same result with aggregate pushdown disabled"
+
+EXPLAIN_AGG=$(run_explain "EXPLAIN SELECT count(*) FROM firestore_scan('pushdown_test') WHERE status = 'active';")
+assert_contains "$EXPLAIN_AGG" "Firestore Aggregation: count(*)" "EXPLAIN shows the aggregation pushdown"
+
+EXPLAIN_AGG_LIKE=$(run_explain "EXPLAIN SELECT count(*) FROM firestore_scan('pushdown_test') WHERE name LIKE 'A%';")
+assert_not_contains "$EXPLAIN_AGG_LIKE" "Firestore Aggregation" "Aggregates over unpushable filters scan documents"
+
 # =====================================================
 # EXPLAIN Plan Pushdown Validation Tests
 # =====================================================
@@ -878,6 +1211,60 @@ EXPLAIN_MULTI=$(run_explain "EXPLAIN SELECT * FROM firestore_scan('pushdown_test
 assert_contains "$EXPLAIN_MULTI" "Firestore Pushed Filters" "EXPLAIN contains Firestore Pushed Filters for multi-filter"
 assert_contains "$EXPLAIN_MULTI" "status EQUAL 'active'" "EXPLAIN shows status EQUAL in multi-filter"
 
+# Test 40b: Without a composite index, the more selective side is pushed (ages span 25-40)
+echo "Test 40b: Most selective pushable filter is chosen..."
+EXPLAIN_PLAN=$(run_explain "EXPLAIN SELECT * FROM firestore_scan('pushdown_test') WHERE status = 'active' AND age > 38;")
+assert_contains "$EXPLAIN_PLAN" "age GREATER_THAN 38" "EXPLAIN pushes the selective range filter"
+assert_not_contains "$EXPLAIN_PLAN" "status EQUAL" "EXPLAIN leaves the broader equality filter to DuckDB"
+assert_contains "$EXPLAIN_PLAN" "Filter Plan" "EXPLAIN reports the chosen filter plan"
+PLAN_RESULT=$(run_query "SELECT string_agg(name, ',' ORDER BY name) FROM firestore_scan('pushdown_test') WHERE status = 'active' AND age > 38;")
+assert_eq "$PLAN_RESULT" "Eve" "Partially pushed filters return the matching document"
+
+# Test 40c: firestore_stats() reports each query's requests and documents
+echo "Test 40c: Per-query and total I/O statistics..."
+STATS_QUERY=$(run_query "SELECT count(*) FROM firestore_scan('pushdown_test'); SELECT documents_read >= 5, pages >= 1, requests_by_endpoint['list'] >= 1, response_bytes > 0 FROM firestore_stats() WHERE scope = 'query' AND query LIKE '%pushdown_test%';")
+assert_eq "$STATS_QUERY" "true,true,true,true" "Query row counts the sampled and scanned documents"
+STATS_TOTAL=$(run_query "SELECT count(*) FROM firestore_scan('pushdown_test'); SELECT documents_read >= 5, latency_p50_ms > 0, latency_p99_ms >= latency_p50_ms FROM firestore_stats() WHERE scope = 'total';")
+assert_eq "$STATS_TOTAL" "true,true,true" "Total row accumulates every query"
+
+# Test 40d: EXPLAIN shows the pushdown decisions, EXPLAIN ANALYZE the requests made
+echo "Test 40d: Pushdown decisions and network timings in EXPLAIN ANALYZE..."
+EXPLAIN_PLAN=$(run_explain "EXPLAIN SELECT * FROM firestore_scan('pushdown_test') WHERE status = 'active' AND age > 38;")
+assert_contains "$EXPLAIN_PLAN" "runQuery" "EXPLAIN names the Firestore request"
+assert_contains "$EXPLAIN_PLAN" "status EQUAL" "EXPLAIN lists the filter left to DuckDB"
+ANALYZE_PLAN=$(run_explain "EXPLAIN ANALYZE SELECT * FROM firestore_scan('pushdown_test') WHERE status = 'active' AND age > 38;")
+assert_contains "$ANALYZE_PLAN" "Firestore Pages" "EXPLAIN ANALYZE reports the pages fetched"
+assert_contains "$ANALYZE_PLAN" "Round Trips" "EXPLAIN ANALYZE reports the round-trip time"
+assert_contains "$ANALYZE_PLAN" "received" "EXPLAIN ANALYZE reports the bytes received"
+FULL_SCAN_PLAN=$(run_explain "EXPLAIN SELECT * FROM firestore_scan('pushdown_test');")
+assert_contains "$FULL_SCAN_PLAN" "documents.list" "EXPLAIN flags a full-collection scan"
+
+# Test 40e: Recorded exchanges replay the same results without touching the network
+echo "Test 40e: HTTP record and replay..."
+RECORDING="/tmp/fire_duck_recording_$$.jsonl"
+rm -f "$RECORDING"
+REPLAY_SQL="SELECT string_agg(name, ',' ORDER BY name) FROM firestore_scan('pushdown_test') WHERE age > 30;"
+RECORDED=$(run_query "SET firestore_http_record = '$RECORDING'; $REPLAY_SQL")
+RECORDED_LINES=$(wc -l < "$RECORDING" | tr -d ' ')
+assert_ge "$RECORDED_LINES" 1 "Recording captures the request/response pairs"
+REPLAYED=$(run_query "SET firestore_http_replay = '$RECORDING'; $REPLAY_SQL")
+assert_eq "$REPLAYED" "$RECORDED" "Replay returns the recorded result"
+REPLAY_CONNECTIONS=$(run_query "SET firestore_http_replay = '$RECORDING'; $REPLAY_SQL SELECT hits + misses FROM firestore_http_pool_stats();")
+assert_eq "$REPLAY_CONNECTIONS" "0" "Replay opens no connections"
+assert_not_contains "$(cat "$RECORDING")" "fake-key" "Recording redacts the API key"
+rm -f "$RECORDING"
+
+# Test 40f: A LIMIT over partially pushed filters is left to DuckDB. The first ten grp = 1
+# documents all have v < 100, so a limit sent with the pushed half would return no rows.
+echo "Test 40f: LIMIT with partially pushed filters..."
+run_query "CALL firestore_insert('partial_limit_test', (SELECT 'p' || lpad(i::VARCHAR, 3, '0') AS id, i % 4 AS grp, i AS v FROM range(200) t(i)), document_id := 'id');" > /dev/null
+EXPLAIN_PARTIAL=$(run_explain "EXPLAIN SELECT * FROM firestore_scan('partial_limit_test') WHERE grp = 1 AND v >= 100 LIMIT 10;")
+assert_contains "$EXPLAIN_PARTIAL" "grp EQUAL 1" "EXPLAIN pushes the selective equality filter"
+assert_not_contains "$EXPLAIN_PARTIAL" "v GREATER_THAN_OR_EQUAL" "EXPLAIN leaves the range filter to DuckDB"
+PARTIAL_LIMIT=$(run_query "SELECT count(*), bool_and(v >= 100 AND v % 4 = 1) FROM (SELECT v FROM firestore_scan('partial_limit_test') WHERE grp = 1 AND v >= 100 LIMIT 10);")
+assert_eq "$PARTIAL_LIMIT" "10,true" "LIMIT returns every requested row when part of the WHERE clause stays in DuckDB"
+run_query "CALL firestore_delete_batch('partial_limit_test', (SELECT list(__document_id) FROM firestore_scan('partial_limit_test')));" > /dev/null
+
 # Test 41: EXPLAIN shows IN filter pushdown
 echo "Test 41: EXPLAIN shows IN filter pushdown..."
 EXPLAIN_IN=$(run_explain "EXPLAIN SELECT * FROM firestore_scan('pushdown_test') WHERE status IN ('active', 'pending');")
@@ -913,6 +1300,30 @@ assert_eq "$IN_COUNT" "4" "Found 4 users with status IN (active, pending)"
 IN_NAMES=$(run_query "SELECT string_agg(name, ',' ORDER BY name) FROM firestore_scan('pushdown_test') WHERE status IN ('active', 'pending');")
 assert_eq "$IN_NAMES" "Alice,Bob,Diana,Eve" "IN filter returns correct users"
 
+# Test 45b: Long IN lists and ORs across fields run as concurrent sub-queries
+echo "Test 45b: Split IN / OR filter pushdown..."
+LONG_AGES="25,$(seq -s, 31 100)"
+LONG_IN_NAMES=$(run_query "SELECT string_agg(name, ',' ORDER BY name) FROM firestore_scan('pushdown_test') WHERE age IN (${LONG_AGES});")
+assert_eq "$LONG_IN_NAMES" "Bob,Charlie,Eve" "IN list of 71 values returns the matching users"
+
+# Repeated values must not land in two sub-queries: 25 is value 1 and value 31 of the list
+REPEATED_AGES="25,$(seq -s, 31 59),25,$(seq -s, 60 100),25"
+REPEATED_IN_NAMES=$(run_query "SELECT string_agg(name, ',' ORDER BY name) FROM firestore_scan('pushdown_test') WHERE age IN (${REPEATED_AGES});")
+assert_eq "$REPEATED_IN_NAMES" "Bob,Charlie,Eve" "IN list with values repeated across a 30-value chunk returns each user once"
+
+REPEATED_OR_NAMES=$(run_query "SELECT string_agg(name, ',' ORDER BY name) FROM firestore_scan('pushdown_test') WHERE age = 25 OR age IN (${LONG_AGES});")
+assert_eq "$REPEATED_OR_NAMES" "Bob,Charlie,Eve" "OR of an equality repeated in a long IN list returns each user once"
+
+EXPLAIN_LONG_IN=$(run_explain "EXPLAIN SELECT * FROM firestore_scan('pushdown_test') WHERE age IN (${LONG_AGES});")
+assert_contains "$EXPLAIN_LONG_IN" "[71 values]" "EXPLAIN shows the long IN list is pushed"
+assert_contains "$EXPLAIN_LONG_IN" "sub-queries" "EXPLAIN shows the IN list is split into sub-queries"
+
+OR_NAMES=$(run_query "SELECT string_agg(name, ',' ORDER BY name) FROM firestore_scan('pushdown_test') WHERE status = 'active' OR age IN (25, 30);")
+assert_eq "$OR_NAMES" "Alice,Bob,Diana,Eve" "OR across fields returns each matching user once"
+
+EXPLAIN_OR=$(run_explain "EXPLAIN SELECT * FROM firestore_scan('pushdown_test') WHERE status = 'active' OR age IN (25, 30);")
+assert_contains "$EXPLAIN_OR" "Firestore Pushed Filters" "EXPLAIN shows the OR filter is pushed"
+
 # Test 46: Boolean filter pushdown
 echo "Test 46: Boolean-like filter pushdown correctness..."
 # Eve has no score field (NULL), others have numeric scores
@@ -1009,6 +1420,30 @@ curl -s -X POST "http://${FIRESTORE_EMULATOR_HOST}/v1/projects/test-project/data
 NULL_VEC=$(run_query "SELECT vector IS NULL FROM firestore_scan('embeddings') WHERE __document_id = 'emb_null';")
 assert_eq "$NULL_VEC" "true" "Missing vector field is NULL"
 
+# Test 49b: Vector search pushdown (findNearest)
+echo "Test 49b: Vector search pushdown (findNearest)..."
+NEAREST=$(run_query "SELECT string_agg(label, '|' ORDER BY d) FROM (SELECT label, array_distance(vector, [6.5, 7.5, 8.5]::DOUBLE[3]) AS d FROM firestore_scan('embeddings') ORDER BY d LIMIT 2);")
+assert_eq "$NEAREST" "bird|dog" "findNearest returns the two nearest documents"
+
+NEAREST_READS=$(run_query "SELECT label FROM firestore_scan('embeddings') ORDER BY array_distance(vector, [6.5, 7.5, 8.5]::DOUBLE[3]) LIMIT 2; SELECT documents_read FROM firestore_stats() WHERE scope = 'query' AND query LIKE '%array_distance%' LIMIT 1;")
+assert_eq "$NEAREST_READS" "2" "findNearest reads only the k nearest documents"
+
+NEAREST_SIM=$(run_query "SELECT label FROM firestore_scan('embeddings') ORDER BY array_cosine_similarity(vector, [1.0, 2.0, 3.0]::DOUBLE[3]) DESC LIMIT 1;")
+assert_eq "$NEAREST_SIM" "updated_cat" "Cosine similarity DESC is pushed as a COSINE search"
+
+NEAREST_FILTERED=$(run_query "SELECT label FROM firestore_scan('embeddings') WHERE label = 'dog' ORDER BY array_cosine_distance(vector, [7.0, 8.0, 9.0]::DOUBLE[3]) LIMIT 1;")
+assert_eq "$NEAREST_FILTERED" "dog" "Equality filters pre-filter findNearest"
+
+# More rows than documents with a vector: DuckDB ranks the collection, including emb_null
+NEAREST_SHORT=$(run_query "SELECT count(*) FILTER (WHERE vector IS NULL) FROM (SELECT vector FROM firestore_scan('embeddings') ORDER BY array_distance(vector, [1.0, 2.0, 3.0]::DOUBLE[3]) LIMIT 10);")
+assert_eq "$NEAREST_SHORT" "1" "A short findNearest result falls back to reading the collection"
+
+NEAREST_EXPLAIN=$(run_explain "EXPLAIN SELECT label FROM firestore_scan('embeddings') ORDER BY array_cosine_distance(vector, [1.0, 2.0, 3.0]::DOUBLE[3]) LIMIT 3;")
+assert_contains "$NEAREST_EXPLAIN" "findNearest" "EXPLAIN shows the findNearest search"
+
+NEAREST_OFF=$(run_explain "SET firestore_vector_search_pushdown = false; EXPLAIN SELECT label FROM firestore_scan('embeddings') ORDER BY array_cosine_distance(vector, [1.0, 2.0, 3.0]::DOUBLE[3]) LIMIT 3;")
+assert_not_contains "$NEAREST_OFF" "findNearest" "firestore_vector_search_pushdown = false disables findNearest"
+
 # Cleanup vector test data
 echo ""
 echo "Cleaning up vector test data..."
@@ -1333,6 +1768,41 @@ echo "Test 69: show_missing=false returns correct data..."
 SM_VALUE=$(run_query "SELECT value FROM firestore_scan('np_phantom', show_missing=false) WHERE __document_id = 'real1';")
 assert_eq "$SM_VALUE" "real_data" "show_missing=false returns correct field values"
 
+# --- collection tree tests ---
+
+# ct_root/{a,b} with ct_root/a/child/c1/leaf/l1 and ct_root/b/other/o1 below them
+for doc in "ct_root?documentId=a" "ct_root?documentId=b" "ct_root/a/child?documentId=c1" \
+           "ct_root/a/child/c1/leaf?documentId=l1" "ct_root/b/other?documentId=o1"; do
+  curl -s -X POST "http://$FIRESTORE_EMULATOR_HOST/v1/projects/test-project/databases/(default)/documents/$doc" \
+    -H "Content-Type: application/json" \
+    -d '{"fields": {"level": {"stringValue": "'"${doc%%\?*}"'"}}}' > /dev/null
+done
+
+# Test 69b: firestore_collection_tree discovers nested collections
+echo "Test 69b: firestore_collection_tree discovers nested collections..."
+CT_PATHS=$(run_query "SELECT string_agg(path || ':' || depth, '|' ORDER BY path) FROM firestore_collection_tree('ct_root');")
+assert_eq "$CT_PATHS" "ct_root/a/child:1|ct_root/a/child/c1/leaf:2|ct_root/b/other:1" "Collection tree below ct_root"
+
+CT_DEPTH=$(run_query "SELECT count(*) FROM firestore_collection_tree('ct_root', max_depth := 1, concurrency := 2);")
+assert_eq "$CT_DEPTH" "2" "max_depth := 1 stops at the first level"
+
+CT_DOC=$(run_query "SELECT string_agg(path, '|' ORDER BY path) FROM firestore_collection_tree('ct_root/a');")
+assert_eq "$CT_DOC" "ct_root/a/child|ct_root/a/child/c1/leaf" "Collection tree below a document"
+
+CT_DB=$(run_query "SELECT count(*) FROM firestore_collection_tree('') WHERE path = 'ct_root' AND depth = 1;")
+assert_eq "$CT_DB" "1" "Collection tree of the database lists root collections"
+
+# Test 69c: recursive firestore_scan reads the whole tree
+echo "Test 69c: recursive firestore_scan reads the whole tree..."
+CT_SCAN=$(run_query "SELECT count(*) FROM firestore_scan('ct_root', recursive := true);")
+assert_eq "$CT_SCAN" "5" "recursive := true reads every collection below ct_root"
+
+CT_SCAN_DEPTH=$(run_query "SELECT count(*) FROM firestore_scan('ct_root', recursive := true, max_depth := 1);")
+assert_eq "$CT_SCAN_DEPTH" "4" "max_depth := 1 skips deeper collections"
+
+CT_SCAN_ID=$(run_query "SELECT __document_id FROM firestore_scan('ct_root', recursive := true) WHERE level = 'ct_root/a/child/c1/leaf';")
+assert_eq "$CT_SCAN_ID" "ct_root/a/child/c1/leaf/l1" "Recursive scans return full document paths"
+
 # --- database parameter tests ---
 
 # Test 70: database parameter accepted as per-query override
@@ -0,0 +1,92 @@
+#!/bin/bash
+# Seed the Firestore emulator with synthetic collections for the emulator benchmark suite
+# (benchmark/run_emulator_benchmark.sh). Documents are sent with :batchWrite, 500 at a time.
+#
+# Collections:
+#   bench_docs                      BENCH_DOCS documents with name, category (c0-c9), value,
+#                                   score, active, created, BENCH_WIDTH extra integer fields
+#                                   (f0, f1, ...), a map nested BENCH_DEPTH levels deep and an
+#                                   embedding vector of BENCH_VECTOR_DIM doubles
+#   bench_groups/g*/bench_items     BENCH_GROUP_DOCS documents spread over 50 parents, for
+#                                   collection group scans
+#
+# Usage: BENCH_DOCS=20000 BENCH_WIDTH=10 ./test/scripts/seed_benchmark_data.sh
+
+set -e
+
+EMULATOR_HOST="${FIRESTORE_EMULATOR_HOST:-127.0.0.1:8080}"
+PROJECT_ID="${BENCH_PROJECT_ID:-test-project}"
+BENCH_DOCS="${BENCH_DOCS:-20000}"
+BENCH_WIDTH="${BENCH_WIDTH:-10}"
+BENCH_DEPTH="${BENCH_DEPTH:-2}"
+BENCH_VECTOR_DIM="${BENCH_VECTOR_DIM:-16}"
+BENCH_GROUP_DOCS="${BENCH_GROUP_DOCS:-$((BENCH_DOCS / 4))}"
+BENCH_GROUP_PARENTS=50
+BATCH_SIZE=500
+
+DOCUMENTS_ROOT="projects/${PROJECT_ID}/databases/(default)/documents"
+BATCH_WRITE_URL="http://${EMULATOR_HOST}/v1/${DOCUMENTS_ROOT}:batchWrite"
+
+# Print the :batchWrite body for documents [start, end) of a collection kind ("docs" or "items")
+build_batch() {
+    awk -v start="$1" -v end="$2" -v kind="$3" -v root="$DOCUMENTS_ROOT" \
+        -v width="$BENCH_WIDTH" -v depth="$BENCH_DEPTH" -v dim="$BENCH_VECTOR_DIM" \
+        -v parents="$BENCH_GROUP_PARENTS" '
+    function nested(level) {
+        if (level >= depth) {
+            return "{\"stringValue\":\"leaf\"}"
+        }
+        return "{\"mapValue\":{\"fields\":{\"level\":{\"integerValue\":\"" (level + 1) "\"},\"child\":" nested(level + 1) "}}}"
+    }
+    BEGIN {
+        printf "{\"writes\":["
+        for (i = start; i < end; i++) {
+            if (kind == "docs") {
+                path = sprintf("%s/bench_docs/d%07d", root, i)
+            } else {
+                path = sprintf("%s/bench_groups/g%02d/bench_items/i%07d", root, i % parents, i)
+            }
+            fields = sprintf("\"name\":{\"stringValue\":\"item_%d\"},\"category\":{\"stringValue\":\"c%d\"}", i, i % 10)
+            fields = fields sprintf(",\"value\":{\"integerValue\":\"%d\"},\"score\":{\"doubleValue\":%.1f}", i, i * 0.5)
+            fields = fields sprintf(",\"active\":{\"booleanValue\":%s}", i % 2 == 0 ? "true" : "false")
+            fields = fields ",\"created\":{\"timestampValue\":\"2024-01-15T10:30:00Z\"}"
+            for (f = 0; f < width; f++) {
+                fields = fields sprintf(",\"f%d\":{\"integerValue\":\"%d\"}", f, (i * (f + 1)) % 1000)
+            }
+            if (depth > 0) {
+                fields = fields ",\"nested\":" nested(0)
+            }
+            if (dim > 0) {
+                values = ""
+                for (d = 0; d < dim; d++) {
+                    values = values (d > 0 ? "," : "") sprintf("{\"doubleValue\":%.3f}", ((i + d) % 100) / 100.0)
+                }
+                fields = fields ",\"embedding\":{\"mapValue\":{\"fields\":{\"__type__\":{\"stringValue\":\"__vector__\"},\"value\":{\"arrayValue\":{\"values\":[" values "]}}}}}"
+            }
+            printf "%s{\"update\":{\"name\":\"%s\",\"fields\":{%s}}}", (i > start ? "," : ""), path, fields
+        }
+        printf "]}"
+    }'
+}
+
+# Write documents [0, count) of a collection kind in batches
+seed_collection() {
+    local kind="$1"
+    local count="$2"
+    local start=0
+    while [ "$start" -lt "$count" ]; do
+        local end=$((start + BATCH_SIZE))
+        if [ "$end" -gt "$count" ]; then
+            end="$count"
+        fi
+        build_batch "$start" "$end" "$kind" |
+            curl -sf -X POST "$BATCH_WRITE_URL" -H "Content-Type: application/json" --data-binary @- > /dev/null
+        start="$end"
+    done
+}
+
+echo "Seeding benchmark data: ${BENCH_DOCS} documents (width ${BENCH_WIDTH}, depth ${BENCH_DEPTH}," \
+    "vector ${BENCH_VECTOR_DIM}), ${BENCH_GROUP_DOCS} collection group documents..."
+seed_collection docs "$BENCH_DOCS"
+seed_collection items "$BENCH_GROUP_DOCS"
+echo "Benchmark data seeded."
@@ -85,6 +85,11 @@ curl -s -X POST "http://127.0.0.1:8080/v1/projects/test-project/databases/(defau
   -H "Content-Type: application/json" \
   -d '{"fields":{"label":{"stringValue":"bird"},"vector":{"mapValue":{"fields":{"__type__":{"stringValue":"__vector__"},"value":{"arrayValue":{"values":[{"doubleValue":7.0},{"doubleValue":8.0},{"doubleValue":9.0}]}}}}}}}'
 
+# Synthetic benchmark collections, when requested (see benchmark/run_emulator_benchmark.sh)
+if [ -n "${BENCH_DOCS:-}" ]; then
+    "$(dirname "$0")/seed_benchmark_data.sh"
+fi
+
 echo ""
 echo "Test data seeded successfully!"
 echo "Emulator PID: $EMULATOR_PID"